@@ -0,0 +1,104 @@
+/*! Gathers the time steps of a field into a single time-series archive.
+ * \file archive.cpp
+ */
+
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <sys/stat.h>
+
+#include <petscsys.h>
+
+#include "petibm-utilities/archive.h"
+#include "petibm-utilities/field.h"
+#include "petibm-utilities/grid.h"
+#include "petibm-utilities/misc.h"
+#include "petibm-utilities/timestep.h"
+
+
+int main(int argc, char **argv)
+{
+	PetscErrorCode ierr;
+	std::string directory, outdir, filepath;
+	PetibmGrid grid;
+	PetibmGridCtx gridCtx;
+	PetibmField field;
+	PetibmFieldCtx fieldCtx;
+	PetibmFieldPool pool;
+	PetibmTimeStepCtx stepCtx;
+	PetibmArchive archive;
+	PetibmArchiveCtx archiveCtx;
+	PetscInt ite, record;
+	PetscReal dt = 1.0;
+	PetscBool found = PETSC_FALSE;
+
+	ierr = PetscInitialize(&argc, &argv, nullptr, nullptr); CHKERRQ(ierr);
+
+	// parse command-line options
+	ierr = PetibmGetDirectory(&directory); CHKERRQ(ierr);
+	ierr = PetibmTimeStepGetOptions(nullptr, &stepCtx); CHKERRQ(ierr);
+	ierr = PetibmGridGetOptions("grid_", &gridCtx); CHKERRQ(ierr);
+	ierr = PetibmFieldGetOptions("field_", &fieldCtx); CHKERRQ(ierr);
+	ierr = PetibmArchiveGetOptions("archive_", &archiveCtx); CHKERRQ(ierr);
+	{
+		char dir[PETSC_MAX_PATH_LEN];
+		ierr = PetscOptionsGetString(nullptr, nullptr, "-output_directory",
+		                             dir, sizeof(dir), &found); CHKERRQ(ierr);
+		outdir = (!found) ? directory : dir;
+		mkdir((outdir).c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+	}
+	{
+		char path[PETSC_MAX_PATH_LEN];
+		ierr = PetscOptionsGetString(nullptr, nullptr, "-archive_path",
+		                             path, sizeof(path), &found); CHKERRQ(ierr);
+		filepath = (!found) ? outdir+"/archive.h5" : path;
+	}
+	// time of a step: step times time-step size
+	ierr = PetscOptionsGetReal(nullptr, nullptr, "-dt", &dt, &found); CHKERRQ(ierr);
+	// default grid: group with the name of the field in the grid file
+	if (!std::strlen(gridCtx.path))
+	{
+		ierr = PetscStrcpy(
+			gridCtx.path, (directory+"/grid.h5").c_str()); CHKERRQ(ierr);
+	}
+	if (!std::strlen(gridCtx.name))
+	{
+		ierr = PetscStrcpy(gridCtx.name, fieldCtx.name); CHKERRQ(ierr);
+	}
+	ierr = PetibmGridCtxDetectSizes(
+		gridCtx.path, gridCtx.name, &gridCtx); CHKERRQ(ierr);
+	ierr = PetibmGridCtxPrintf("Grid", gridCtx); CHKERRQ(ierr);
+	ierr = PetibmFieldCtxPrintf("Field", fieldCtx); CHKERRQ(ierr);
+	ierr = PetibmArchiveCtxPrintf("Archive", archiveCtx); CHKERRQ(ierr);
+
+	// create and read the grid, create the field
+	ierr = PetibmGridInitialize(gridCtx, grid); CHKERRQ(ierr);
+	ierr = PetibmGridHDF5Read(gridCtx.path, gridCtx.name, grid); CHKERRQ(ierr);
+	ierr = PetibmFieldInitialize(fieldCtx, grid, pool, field); CHKERRQ(ierr);
+	ierr = PetibmArchiveOpen(filepath, archiveCtx, archive); CHKERRQ(ierr);
+
+	// loop over the time steps to fill the archive
+	for (ite=stepCtx.start; ite<=stepCtx.end; ite+=stepCtx.step)
+	{
+		ierr = PetscPrintf(
+			PETSC_COMM_WORLD, "[time-step %d]\n", ite); CHKERRQ(ierr);
+		// get name of time-step file
+		std::stringstream ss;
+		ss << std::setfill('0') << std::setw(7) << ite << ".h5";
+		std::string filename(ss.str());
+		ierr = PetibmFieldHDF5Read(
+			directory+"/"+filename, fieldCtx.name, field); CHKERRQ(ierr);
+		ierr = PetibmArchiveSetStep(archive, ite, ite*dt, &record); CHKERRQ(ierr);
+		ierr = PetibmArchiveFieldWrite(
+			archive, fieldCtx.name, record, field); CHKERRQ(ierr);
+	}
+
+	ierr = PetibmArchiveClose(archive); CHKERRQ(ierr);
+	ierr = PetibmFieldDestroy(field); CHKERRQ(ierr);
+	ierr = PetibmGridDestroy(grid); CHKERRQ(ierr);
+	ierr = PetibmFieldPoolDestroy(pool); CHKERRQ(ierr);
+
+	ierr = PetscFinalize(); CHKERRQ(ierr);
+
+	return 0;
+} // main
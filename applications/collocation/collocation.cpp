@@ -0,0 +1,134 @@
+/*! Averages the staggered 3D velocity field at cell centers.
+ * \file collocation.cpp
+ */
+
+#include <iomanip>
+#include <sstream>
+#include <sys/stat.h>
+
+#include <petscsys.h>
+#include <petscdmda.h>
+
+#include "petibm-utilities/collocation.h"
+#include "petibm-utilities/field.h"
+#include "petibm-utilities/grid.h"
+#include "petibm-utilities/misc.h"
+#include "petibm-utilities/threads.h"
+#include "petibm-utilities/timestep.h"
+#include "petibm-utilities/vorticity.h"
+
+
+int main(int argc, char **argv)
+{
+	PetscErrorCode ierr;
+	std::string directory, outdir, gridpath;
+	PetibmGrid grid;
+	PetibmGridCtx gridCtx;
+	PetibmField ux, uy, uz, u;
+	PetibmFieldCtx fieldCtx;
+	PetibmFieldPool pool;
+	PetibmTimeStepCtx stepCtx;
+	DM da;
+	PetscReal bc_values[3];
+	PetscInt ite;
+	PetscBool found = PETSC_FALSE;
+
+	ierr = PetscInitialize(&argc, &argv, nullptr, nullptr); CHKERRQ(ierr);
+	ierr = PetibmThreadsInitialize(); CHKERRQ(ierr);
+
+	// parse command-line options
+	ierr = PetibmGetDirectory(&directory); CHKERRQ(ierr);
+	ierr = PetibmTimeStepGetOptions(nullptr, &stepCtx); CHKERRQ(ierr);
+	ierr = PetibmGridGetOptions(nullptr, &gridCtx); CHKERRQ(ierr);
+	ierr = PetibmFieldGetOptions(nullptr, &fieldCtx); CHKERRQ(ierr);
+	{
+		char dir[PETSC_MAX_PATH_LEN];
+		ierr = PetscOptionsGetString(nullptr, nullptr, "-output_directory",
+		                             dir, sizeof(dir), &found); CHKERRQ(ierr);
+		outdir = (!found) ? directory : dir;
+		mkdir((outdir).c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+	}
+	// boundary values of the components, beyond the non-periodic boundaries
+	// (default: the value of `-bc_value`)
+	bc_values[0] = bc_values[1] = bc_values[2] = fieldCtx.bc_value;
+	ierr = PetscOptionsGetReal(nullptr, nullptr, "-ux_bc_value",
+	                           bc_values, &found); CHKERRQ(ierr);
+	ierr = PetscOptionsGetReal(nullptr, nullptr, "-uy_bc_value",
+	                           bc_values+1, &found); CHKERRQ(ierr);
+	ierr = PetscOptionsGetReal(nullptr, nullptr, "-uz_bc_value",
+	                           bc_values+2, &found); CHKERRQ(ierr);
+	{
+		char path[PETSC_MAX_PATH_LEN];
+		ierr = PetscOptionsGetString(nullptr, nullptr, "-grid_path",
+		                             path, sizeof(path), &found); CHKERRQ(ierr);
+		gridpath = (!found) ? directory+"/grid.h5" : path;
+	}
+	ierr = PetibmGridCtxDetectSizes(gridpath, "p", &gridCtx); CHKERRQ(ierr);
+	if (gridCtx.nz <= 0)
+		SETERRQ(PETSC_COMM_WORLD, PETSC_ERR_SUP,
+		        "The velocity is only collocated for 3D fields");
+
+	// the velocity is collocated on the grid of the pressure
+	grid.dim = 3;
+	ierr = PetibmGridlineHDF5ReadShared(
+		gridpath, "p", "x", gridCtx.nx, &grid.x.coords); CHKERRQ(ierr);
+	ierr = PetibmGridlineHDF5ReadShared(
+		gridpath, "p", "y", gridCtx.ny, &grid.y.coords); CHKERRQ(ierr);
+	ierr = PetibmGridlineHDF5ReadShared(
+		gridpath, "p", "z", gridCtx.nz, &grid.z.coords); CHKERRQ(ierr);
+	ierr = PetibmGridHDF5Write(
+		outdir+"/grid.h5", "velocity", grid); CHKERRQ(ierr);
+	// create base DMDA object
+	ierr = PetibmVorticityCreateDM(gridCtx, fieldCtx, &da); CHKERRQ(ierr);
+	// create the staggered velocity components and the collocated velocity
+	ierr = PetibmVorticityCreateVelocityDM(
+		da, 0, DMDA_STENCIL_STAR, 1, &ux.da); CHKERRQ(ierr);
+	ierr = PetibmFieldInitialize(pool, ux); CHKERRQ(ierr);
+	ierr = PetibmFieldSetBoundaryPoints(bc_values[0], ux); CHKERRQ(ierr);
+	ierr = PetibmVorticityCreateVelocityDM(
+		da, 1, DMDA_STENCIL_STAR, 1, &uy.da); CHKERRQ(ierr);
+	ierr = PetibmFieldInitialize(pool, uy); CHKERRQ(ierr);
+	ierr = PetibmFieldSetBoundaryPoints(bc_values[1], uy); CHKERRQ(ierr);
+	ierr = PetibmVorticityCreateVelocityDM(
+		da, 2, DMDA_STENCIL_STAR, 1, &uz.da); CHKERRQ(ierr);
+	ierr = PetibmFieldInitialize(pool, uz); CHKERRQ(ierr);
+	ierr = PetibmFieldSetBoundaryPoints(bc_values[2], uz); CHKERRQ(ierr);
+	ierr = PetibmCollocationInitialize(da, pool, u); CHKERRQ(ierr);
+
+	// loop over the time steps to collocate the velocity
+	for (ite=stepCtx.start; ite<=stepCtx.end; ite+=stepCtx.step)
+	{
+		ierr = PetscPrintf(
+			PETSC_COMM_WORLD, "[time-step %d]\n", ite); CHKERRQ(ierr);
+		// get name of time-step file
+		std::stringstream ss;
+		ss << std::setfill('0') << std::setw(7) << ite << ".h5";
+		std::string filename(ss.str());
+		// read velocity field
+		ierr = PetibmFieldHDF5Read(directory+"/"+filename, "u", ux); CHKERRQ(ierr);
+		ierr = PetibmFieldHDF5Read(directory+"/"+filename, "v", uy); CHKERRQ(ierr);
+		ierr = PetibmFieldHDF5Read(directory+"/"+filename, "w", uz); CHKERRQ(ierr);
+		ierr = PetibmCollocationComputeField(ux, uy, uz, u); CHKERRQ(ierr);
+		ierr = PetibmFieldHDF5Write(
+			outdir+"/"+filename, "velocity", u); CHKERRQ(ierr);
+	}
+
+	ierr = PetibmGridDestroy(grid); CHKERRQ(ierr);
+	ierr = DMDestroy(&da); CHKERRQ(ierr);
+	ierr = PetibmFieldDestroy(ux); CHKERRQ(ierr);
+	ierr = PetibmFieldDestroy(uy); CHKERRQ(ierr);
+	ierr = PetibmFieldDestroy(uz); CHKERRQ(ierr);
+	ierr = PetibmFieldDestroy(u); CHKERRQ(ierr);
+	ierr = PetscOptionsHasName(
+		nullptr, nullptr, "-field_pool_view", &found); CHKERRQ(ierr);
+	if (found)
+	{
+		ierr = PetibmFieldPoolView(pool); CHKERRQ(ierr);
+	}
+	ierr = PetibmFieldPoolDestroy(pool); CHKERRQ(ierr);
+
+	ierr = PetibmThreadsFinalize(); CHKERRQ(ierr);
+	ierr = PetscFinalize(); CHKERRQ(ierr);
+
+	return 0;
+} // main
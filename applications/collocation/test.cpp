@@ -0,0 +1,113 @@
+/*! Tests the collocation of the staggered velocity at cell centers.
+ *
+ * A uniform velocity, with the same boundary values, should come out exactly
+ * uniform at all cell centers, including the cells next to the boundaries,
+ * with and without periodic directions.
+ * \file test.cpp
+ */
+
+#include <petscsys.h>
+#include <petscdmda.h>
+
+#include "petibm-utilities/collocation.h"
+#include "petibm-utilities/field.h"
+#include "petibm-utilities/grid.h"
+#include "petibm-utilities/threads.h"
+#include "petibm-utilities/vorticity.h"
+
+
+/*! Collocates a uniform velocity and counts the wrong cell-centered values.
+ *
+ * \param gridCtx The sizes of the cell-centered grid.
+ * \param fieldCtx The periodicity of the field.
+ * \param values The uniform value of each component.
+ * \param errors Number of wrong values (passed by pointer).
+ */
+PetscErrorCode AppCollocateUniform(
+	const PetibmGridCtx gridCtx, const PetibmFieldCtx fieldCtx,
+	const PetscReal values[3], PetscInt *errors)
+{
+	PetscErrorCode ierr;
+	PetibmFieldPool pool;
+	PetibmField velocity[3], u;
+	DM da;
+	DMDALocalInfo info;
+	PetscReal ****u_a;
+	PetscInt d, i, j, k;
+
+	PetscFunctionBeginUser;
+
+	ierr = PetibmVorticityCreateDM(gridCtx, fieldCtx, &da); CHKERRQ(ierr);
+	for (d=0; d<3; d++)
+	{
+		ierr = PetibmVorticityCreateVelocityDM(
+			da, d, DMDA_STENCIL_STAR, 1, &velocity[d].da); CHKERRQ(ierr);
+		ierr = PetibmFieldInitialize(pool, velocity[d]); CHKERRQ(ierr);
+		ierr = PetibmFieldSetBoundaryPoints(
+			values[d], velocity[d]); CHKERRQ(ierr);
+		ierr = VecSet(velocity[d].global, values[d]); CHKERRQ(ierr);
+	}
+	ierr = PetibmCollocationInitialize(da, pool, u); CHKERRQ(ierr);
+	ierr = VecSet(u.global, -1.0); CHKERRQ(ierr);
+
+	ierr = PetibmCollocationComputeField(
+		velocity[0], velocity[1], velocity[2], u); CHKERRQ(ierr);
+
+	ierr = DMDAGetLocalInfo(u.da, &info); CHKERRQ(ierr);
+	ierr = DMDAVecGetArrayDOF(u.da, u.global, &u_a); CHKERRQ(ierr);
+	*errors = 0;
+	for (k=info.zs; k<info.zs+info.zm; k++)
+		for (j=info.ys; j<info.ys+info.ym; j++)
+			for (i=info.xs; i<info.xs+info.xm; i++)
+				for (d=0; d<3; d++)
+					if (u_a[k][j][i][d] != values[d])
+						(*errors)++;
+	ierr = DMDAVecRestoreArrayDOF(u.da, u.global, &u_a); CHKERRQ(ierr);
+	ierr = MPI_Allreduce(MPI_IN_PLACE, errors, 1, MPIU_INT, MPI_SUM,
+	                     PETSC_COMM_WORLD); CHKERRQ(ierr);
+
+	for (d=0; d<3; d++)
+	{
+		ierr = PetibmFieldDestroy(velocity[d]); CHKERRQ(ierr);
+	}
+	ierr = PetibmFieldDestroy(u); CHKERRQ(ierr);
+	ierr = DMDestroy(&da); CHKERRQ(ierr);
+	ierr = PetibmFieldPoolDestroy(pool); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // AppCollocateUniform
+
+
+int main(int argc, char **argv)
+{
+	PetscErrorCode ierr;
+	PetibmGridCtx gridCtx;
+	PetibmFieldCtx fieldCtx;
+	const PetscReal values[3] = {1.25, -0.5, 0.75};
+	PetscInt errors, c;
+
+	ierr = PetscInitialize(&argc, &argv, nullptr, nullptr); CHKERRQ(ierr);
+	ierr = PetibmThreadsInitialize(); CHKERRQ(ierr);
+
+	gridCtx.nx = 9;
+	gridCtx.ny = 7;
+	gridCtx.nz = 6;
+	// no periodic direction, then periodic in x and z
+	for (c=0; c<2; c++)
+	{
+		fieldCtx.periodic_x = fieldCtx.periodic_z = (PetscBool) (c == 1);
+		ierr = AppCollocateUniform(
+			gridCtx, fieldCtx, values, &errors); CHKERRQ(ierr);
+		if (errors)
+			SETERRQ2(PETSC_COMM_WORLD, PETSC_ERR_PLIB,
+			         "Collocation of a uniform velocity: %D wrong values "
+			         "(%s)", errors, (c == 1) ? "periodic" : "not periodic");
+		ierr = PetscPrintf(PETSC_COMM_WORLD, "uniform velocity (%s): ok\n",
+		                   (c == 1) ? "periodic" : "not periodic"); CHKERRQ(ierr);
+	}
+
+	ierr = PetibmThreadsFinalize(); CHKERRQ(ierr);
+	ierr = PetscFinalize(); CHKERRQ(ierr);
+
+	return 0;
+} // main
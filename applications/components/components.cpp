@@ -0,0 +1,107 @@
+/*! Labels and tracks the connected components of a thresholded field.
+ * \file components.cpp
+ */
+
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <sys/stat.h>
+
+#include <petscsys.h>
+
+#include "petibm-utilities/components.h"
+#include "petibm-utilities/field.h"
+#include "petibm-utilities/grid.h"
+#include "petibm-utilities/misc.h"
+#include "petibm-utilities/threads.h"
+#include "petibm-utilities/timestep.h"
+
+
+int main(int argc, char **argv)
+{
+	PetscErrorCode ierr;
+	std::string directory, outdir;
+	PetibmGrid grid;
+	PetibmGridCtx gridCtx;
+	PetibmField field;
+	PetibmFieldCtx fieldCtx;
+	PetibmFieldPool pool;
+	PetibmTimeStepCtx stepCtx;
+	PetibmComponentsCtx compsCtx;
+	PetibmComponents comps;
+	PetscInt ite;
+	PetscBool found = PETSC_FALSE;
+
+	ierr = PetscInitialize(&argc, &argv, nullptr, nullptr); CHKERRQ(ierr);
+	ierr = PetibmThreadsInitialize(); CHKERRQ(ierr);
+
+	// parse command-line options
+	ierr = PetibmGetDirectory(&directory); CHKERRQ(ierr);
+	ierr = PetibmTimeStepGetOptions(nullptr, &stepCtx); CHKERRQ(ierr);
+	ierr = PetibmGridGetOptions("grid_", &gridCtx); CHKERRQ(ierr);
+	ierr = PetibmFieldGetOptions("field_", &fieldCtx); CHKERRQ(ierr);
+	ierr = PetibmComponentsGetOptions(nullptr, &compsCtx); CHKERRQ(ierr);
+	{
+		char dir[PETSC_MAX_PATH_LEN];
+		ierr = PetscOptionsGetString(nullptr, nullptr, "-output_directory",
+		                             dir, sizeof(dir), &found); CHKERRQ(ierr);
+		outdir = (!found) ? directory : dir;
+		mkdir((outdir).c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+	}
+	// default grid: group with the name of the field in the grid file
+	if (!std::strlen(gridCtx.path))
+	{
+		ierr = PetscStrcpy(
+			gridCtx.path, (directory+"/grid.h5").c_str()); CHKERRQ(ierr);
+	}
+	if (!std::strlen(gridCtx.name))
+	{
+		ierr = PetscStrcpy(gridCtx.name, fieldCtx.name); CHKERRQ(ierr);
+	}
+	ierr = PetibmGridCtxDetectSizes(
+		gridCtx.path, gridCtx.name, &gridCtx); CHKERRQ(ierr);
+	ierr = PetibmGridCtxPrintf("Grid", gridCtx); CHKERRQ(ierr);
+	ierr = PetibmFieldCtxPrintf("Field", fieldCtx); CHKERRQ(ierr);
+	ierr = PetibmComponentsCtxPrintf("Components", compsCtx); CHKERRQ(ierr);
+
+	// create and read the grid, create the field
+	{
+		const PetscBool periodic[3] = {
+			fieldCtx.periodic_x, fieldCtx.periodic_y, fieldCtx.periodic_z};
+		ierr = PetibmGridInitialize(gridCtx, periodic, grid); CHKERRQ(ierr);
+	}
+	ierr = PetibmGridHDF5Read(gridCtx.path, gridCtx.name, grid); CHKERRQ(ierr);
+	ierr = PetibmFieldInitialize(fieldCtx, grid, pool, field); CHKERRQ(ierr);
+	ierr = PetibmComponentsInitialize(field, comps); CHKERRQ(ierr);
+	std::string filepath = outdir+"/components-"+fieldCtx.name+".txt";
+	ierr = PetibmComponentsWriteHeader(filepath, compsCtx); CHKERRQ(ierr);
+
+	// loop over the time steps to label and track the components
+	for (ite=stepCtx.start; ite<=stepCtx.end; ite+=stepCtx.step)
+	{
+		ierr = PetscPrintf(
+			PETSC_COMM_WORLD, "[time-step %d]\n", ite); CHKERRQ(ierr);
+		// get name of time-step file
+		std::stringstream ss;
+		ss << std::setfill('0') << std::setw(7) << ite << ".h5";
+		std::string filename(ss.str());
+		ierr = PetibmFieldHDF5Read(
+			directory+"/"+filename, fieldCtx.name, field); CHKERRQ(ierr);
+		ierr = PetibmComponentsCompute(
+			compsCtx, grid, field, comps); CHKERRQ(ierr);
+		ierr = PetibmComponentsWrite(filepath, ite, comps); CHKERRQ(ierr);
+		ierr = PetscPrintf(PETSC_COMM_WORLD, "\t- components: %d "
+		                   "(exchanges: %d, tracks: %d)\n", comps.count,
+		                   comps.iterations, comps.tracks); CHKERRQ(ierr);
+	}
+
+	ierr = PetibmComponentsDestroy(comps); CHKERRQ(ierr);
+	ierr = PetibmFieldDestroy(field); CHKERRQ(ierr);
+	ierr = PetibmGridDestroy(grid); CHKERRQ(ierr);
+	ierr = PetibmFieldPoolDestroy(pool); CHKERRQ(ierr);
+
+	ierr = PetibmThreadsFinalize(); CHKERRQ(ierr);
+	ierr = PetscFinalize(); CHKERRQ(ierr);
+
+	return 0;
+} // main
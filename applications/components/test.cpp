@@ -0,0 +1,182 @@
+/*! Tests the labeling and tracking of connected components.
+ *
+ * Known blobs on a doubly periodic 2D grid (a square across the corner of
+ * the domain, a T and a U spanning most of the domain, and a single point
+ * smaller than the minimum size) are labeled, shifted by one point along x,
+ * and labeled again.
+ * The number of components, their sizes and volumes, and the continuity of
+ * their tracks are checked; the result should not depend on the number of
+ * processes, so the test is meant to be run on several.
+ * \file test.cpp
+ */
+
+#include <cmath>
+
+#include <petscsys.h>
+#include <petscdmda.h>
+
+#include "petibm-utilities/components.h"
+#include "petibm-utilities/field.h"
+#include "petibm-utilities/grid.h"
+#include "petibm-utilities/threads.h"
+
+
+/*! Gets the blob of a point (0: background, 4: the point too small to be a
+ * component).
+ *
+ * \param i Index of the point along x.
+ * \param j Index of the point along y.
+ */
+PetscInt AppBlob(const PetscInt i, const PetscInt j)
+{
+	if ((i >= 22 or i <= 1) and (j >= 18 or j <= 1))
+		return 1;
+	if ((j >= 9 and j <= 10 and i >= 5 and i <= 18) or
+	    (i >= 11 and i <= 12 and j >= 9 and j <= 16))
+		return 2;
+	if ((j >= 13 and j <= 18 and (i == 15 or i == 19)) or
+	    (j == 18 and i >= 15 and i <= 19))
+		return 3;
+	if (i == 3 and j == 5)
+		return 4;
+	return 0;
+} // AppBlob
+
+
+/*! Sets the field: the value of a point is the index of its blob, shifted
+ * along x (periodic).
+ *
+ * \param shift Shift along x.
+ * \param field The field (passed by reference).
+ */
+PetscErrorCode AppSetBlobs(const PetscInt shift, PetibmField &field)
+{
+	PetscErrorCode ierr;
+	DMDALocalInfo info;
+	PetscReal **f;
+	PetscInt i, j;
+
+	PetscFunctionBeginUser;
+
+	ierr = DMDAGetLocalInfo(field.da, &info); CHKERRQ(ierr);
+	ierr = DMDAVecGetArray(field.da, field.global, &f); CHKERRQ(ierr);
+	for (j=info.ys; j<info.ys+info.ym; j++)
+		for (i=info.xs; i<info.xs+info.xm; i++)
+			f[j][i] = AppBlob((i - shift + info.mx) % info.mx, j);
+	ierr = DMDAVecRestoreArray(field.da, field.global, &f); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // AppSetBlobs
+
+
+int main(int argc, char **argv)
+{
+	PetscErrorCode ierr;
+	PetibmGridCtx gridCtx;
+	PetibmGrid grid;
+	PetibmFieldCtx fieldCtx;
+	PetibmField field;
+	PetibmComponentsCtx ctx;
+	PetibmComponents comps;
+	PetibmGridline *lines[2];
+	DMDALocalInfo info;
+	PetscMPIInt rank;
+	PetscReal *x;
+	PetscInt nx = 24, ny = 20, d, i, j, b, shift, errors = 0;
+	// sizes, volumes (unit cells on the periodic grid), tracks and ids of the
+	// blobs
+	PetscInt sizes[5], tracks[5] = {-1, -1, -1, -1, -1},
+	         ids[5] = {-1, -1, -1, -1, -1};
+	PetscReal volumes[5];
+
+	ierr = PetscInitialize(&argc, &argv, nullptr, nullptr); CHKERRQ(ierr);
+	ierr = PetibmThreadsInitialize(); CHKERRQ(ierr);
+
+	ierr = MPI_Comm_rank(PETSC_COMM_WORLD, &rank); CHKERRQ(ierr);
+
+	// uniform grid with unit spacing, stations at the indices
+	gridCtx.nx = nx;
+	gridCtx.ny = ny;
+	{
+		const PetscBool periodic[2] = {PETSC_TRUE, PETSC_TRUE};
+		ierr = PetibmGridInitialize(gridCtx, periodic, grid); CHKERRQ(ierr);
+	}
+	lines[0] = &grid.x;
+	lines[1] = &grid.y;
+	for (d=0; d<2; d++)
+	{
+		ierr = DMDAGetLocalInfo(lines[d]->da, &info); CHKERRQ(ierr);
+		ierr = DMDAVecGetArray(lines[d]->da, lines[d]->coords, &x); CHKERRQ(ierr);
+		for (i=info.xs; i<info.xs+info.xm; i++)
+			x[i] = i;
+		ierr = DMDAVecRestoreArray(
+			lines[d]->da, lines[d]->coords, &x); CHKERRQ(ierr);
+	}
+	fieldCtx.periodic_x = fieldCtx.periodic_y = PETSC_TRUE;
+	ierr = PetibmFieldInitialize(fieldCtx, grid, field); CHKERRQ(ierr);
+	ctx.threshold = 0.5;
+	ctx.min_size = 2;
+	ierr = PetibmComponentsInitialize(field, comps); CHKERRQ(ierr);
+
+	for (shift=0; shift<2; shift++)
+	{
+		ierr = AppSetBlobs(shift, field); CHKERRQ(ierr);
+		ierr = PetibmComponentsCompute(ctx, grid, field, comps); CHKERRQ(ierr);
+		if (comps.count != 3)
+			SETERRQ1(PETSC_COMM_WORLD, PETSC_ERR_PLIB,
+			         "%D components instead of 3", comps.count);
+		if (rank == 0)
+		{
+			for (b=0; b<5; b++)
+			{
+				sizes[b] = 0;
+				volumes[b] = 0.0;
+			}
+			for (j=0; j<ny; j++)
+				for (i=0; i<nx; i++)
+				{
+					b = AppBlob((i - shift + nx) % nx, j);
+					sizes[b]++;
+					volumes[b] += 1.0;
+				}
+			// the peak of a component is the index of its blob
+			for (auto &c : comps.catalog)
+			{
+				b = (PetscInt) c.peak;
+				if (b < 1 or b > 3 or c.size != sizes[b] or
+				    std::abs(c.volume - volumes[b]) > 1.0e-12)
+				{
+					errors++;
+					continue;
+				}
+				// same track as the blob before the shift, continued from the
+				// component of the blob
+				if (shift == 0)
+					tracks[b] = c.track;
+				else if (c.track != tracks[b] or c.parent != ids[b])
+					errors++;
+				ids[b] = c.id;
+			}
+			if (comps.tracks != 3)
+				errors++;
+		}
+		ierr = MPI_Bcast(&errors, 1, MPIU_INT, 0,
+		                 PETSC_COMM_WORLD); CHKERRQ(ierr);
+		if (errors)
+			SETERRQ2(PETSC_COMM_WORLD, PETSC_ERR_PLIB,
+			         "Components (shift %D): %D wrong statistics or tracks",
+			         shift, errors);
+		ierr = PetscPrintf(PETSC_COMM_WORLD, "components (shift %d): ok "
+		                   "(exchanges: %d)\n", shift,
+		                   comps.iterations); CHKERRQ(ierr);
+	}
+
+	ierr = PetibmComponentsDestroy(comps); CHKERRQ(ierr);
+	ierr = PetibmFieldDestroy(field); CHKERRQ(ierr);
+	ierr = PetibmGridDestroy(grid); CHKERRQ(ierr);
+
+	ierr = PetibmThreadsFinalize(); CHKERRQ(ierr);
+	ierr = PetscFinalize(); CHKERRQ(ierr);
+
+	return 0;
+} // main
@@ -2,18 +2,25 @@
  * \file convert.cpp
  */
 
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fstream>
+#include <iomanip>
+#include <set>
+#include <sstream>
 #include <string>
+#include <sys/stat.h>
+#include <vector>
 
 #include <petscsys.h>
 #include <petscdmda.h>
 
 #include "petibm-utilities/field.h"
 #include "petibm-utilities/grid.h"
+#include "petibm-utilities/info.h"
 #include "petibm-utilities/misc.h"
-
-#ifndef DIMENSIONS
-#define DIMENSIONS 2
-#endif
+#include "petibm-utilities/timestep.h"
 
 
 struct AppCtx
@@ -21,6 +28,11 @@ struct AppCtx
 	char source[PETSC_MAX_PATH_LEN];
 	char destination[PETSC_MAX_PATH_LEN];
 	PetscBool hdf52binary = PETSC_FALSE;
+	PetscBool native = PETSC_FALSE;
+	PetscBool batch = PETSC_FALSE;  // convert whole directories
+	PetscInt group_size = 0;  // processes per file in batch mode (0: from field sizes)
+	PetscInt points_per_process = 4194304;  // points per process in batch mode
+	char manifest[PETSC_MAX_PATH_LEN] = "";  // manifest of completed conversions
 }; // AppCtx
 
 
@@ -37,8 +49,7 @@ PetscErrorCode AppGetOptions(const char prefix[], AppCtx *ctx)
 	                             path, sizeof(path), &found); CHKERRQ(ierr);
 	if (found)
 	{
-		ierr = PetscOptionsInsertFile(
-			PETSC_COMM_WORLD, nullptr, path, PETSC_FALSE); CHKERRQ(ierr);
+		ierr = PetibmOptionsInsertFile(path); CHKERRQ(ierr);
 	}
 	ierr = PetscOptionsGetString(nullptr, prefix, "-source", ctx->source,
 	                             sizeof(ctx->source), &found); CHKERRQ(ierr);
@@ -47,77 +58,417 @@ PetscErrorCode AppGetOptions(const char prefix[], AppCtx *ctx)
 		sizeof(ctx->destination), &found); CHKERRQ(ierr);
 	ierr = PetscOptionsGetBool(
 		nullptr, prefix, "-hdf52binary", &ctx->hdf52binary, &found); CHKERRQ(ierr);
+	ierr = PetscOptionsGetBool(
+		nullptr, prefix, "-native", &ctx->native, &found); CHKERRQ(ierr);
+	ierr = PetscOptionsGetBool(
+		nullptr, prefix, "-batch", &ctx->batch, &found); CHKERRQ(ierr);
+	ierr = PetscOptionsGetInt(
+		nullptr, prefix, "-group_size", &ctx->group_size, &found); CHKERRQ(ierr);
+	ierr = PetscOptionsGetInt(nullptr, prefix, "-points_per_process",
+	                          &ctx->points_per_process, &found); CHKERRQ(ierr);
+	ierr = PetscOptionsGetString(nullptr, prefix, "-manifest", ctx->manifest,
+	                             sizeof(ctx->manifest), &found); CHKERRQ(ierr);
 
 	PetscFunctionReturn(0);
 } // AppGetOptions
 
 
-int main(int argc, char **argv)
+/*! Creates the DMDA object of a field.
+ *
+ * \param comm MPI communicator.
+ * \param dim Dimension of the field.
+ * \param gridCtx The context of the grid (number of points).
+ * \param fieldCtx The context of the field (periodicity).
+ * \param da The DMDA object (passed by pointer).
+ */
+PetscErrorCode AppCreateDMDA(const MPI_Comm comm, const PetscInt dim,
+                             const PetibmGridCtx gridCtx,
+                             const PetibmFieldCtx fieldCtx, DM *da)
 {
 	PetscErrorCode ierr;
-	PetscInt dim = DIMENSIONS;
-	DM da;
-	PetibmGridCtx gridCtx;
-	PetibmFieldCtx fieldCtx;
-	AppCtx appCtx;
-	PetibmField field;
 	DMBoundaryType bType_x, bType_y, bType_z;
 
-	ierr = PetscInitialize(&argc, &argv, nullptr, nullptr); CHKERRQ(ierr);
-
-	// parse command-line options
-	ierr = PetibmGridGetOptions(nullptr, &gridCtx); CHKERRQ(ierr);
-	ierr = PetibmFieldGetOptions(nullptr, &fieldCtx); CHKERRQ(ierr);
-	ierr = AppGetOptions(nullptr, &appCtx); CHKERRQ(ierr);
+	PetscFunctionBeginUser;
 
-	// create DMDA object
 	bType_x = (fieldCtx.periodic_x) ? DM_BOUNDARY_PERIODIC : DM_BOUNDARY_GHOSTED;
 	bType_y = (fieldCtx.periodic_y) ? DM_BOUNDARY_PERIODIC : DM_BOUNDARY_GHOSTED;
 	bType_z = (fieldCtx.periodic_z) ? DM_BOUNDARY_PERIODIC : DM_BOUNDARY_GHOSTED;
 	if (dim == 2)
 	{
-		ierr = DMDACreate2d(PETSC_COMM_WORLD,
+		ierr = DMDACreate2d(comm,
 		                    bType_x, bType_y,
 		                    DMDA_STENCIL_STAR,
 		                    gridCtx.nx, gridCtx.ny,
 		                    PETSC_DECIDE, PETSC_DECIDE,
 		                    1, 1, nullptr, nullptr,
-		                    &da); CHKERRQ(ierr);
+		                    da); CHKERRQ(ierr);
 	}
 	else if (dim == 3)
 	{
-		ierr = DMDACreate3d(PETSC_COMM_WORLD,
+		ierr = DMDACreate3d(comm,
 		                    bType_x, bType_y, bType_z,
 		                    DMDA_STENCIL_STAR,
 		                    gridCtx.nx, gridCtx.ny, gridCtx.nz,
 		                    PETSC_DECIDE, PETSC_DECIDE, PETSC_DECIDE,
 		                    1, 1, nullptr, nullptr, nullptr,
-		                    &da); CHKERRQ(ierr);
+		                    da); CHKERRQ(ierr);
 	}
 	else
-		SETERRQ(PETSC_COMM_WORLD, PETSC_ERR_SUP,
+		SETERRQ(comm, PETSC_ERR_SUP,
 		        "Support only provided for 2D or 3D DMDA objects");
-	ierr = DMSetFromOptions(da); CHKERRQ(ierr);
-	ierr = DMSetUp(da); CHKERRQ(ierr);
+	ierr = DMSetFromOptions(*da); CHKERRQ(ierr);
+	ierr = DMSetUp(*da); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // AppCreateDMDA
+
+
+/*! Converts a field from one file to another.
+ *
+ * \param appCtx The context of the application (direction of the conversion).
+ * \param source Path of the input file.
+ * \param destination Path of the output file.
+ * \param name Name of the field.
+ * \param field The field (passed by reference).
+ */
+PetscErrorCode AppConvert(const AppCtx appCtx, const std::string source,
+                          const std::string destination,
+                          const std::string name, PetibmField &field)
+{
+	PetscErrorCode ierr;
+
+	PetscFunctionBeginUser;
 
-	// initialize, read, and write
-	ierr = PetibmFieldInitialize(da, field); CHKERRQ(ierr);
 	if (appCtx.hdf52binary)
 	{
-		ierr = PetibmFieldHDF5Read(
-			appCtx.source, fieldCtx.name, field); CHKERRQ(ierr);
-		ierr = PetibmFieldBinaryWrite(
-			appCtx.destination, fieldCtx.name, field); CHKERRQ(ierr);
+		ierr = PetibmFieldHDF5Read(source, name, field); CHKERRQ(ierr);
+		if (appCtx.native)
+		{
+			ierr = PetibmFieldNativeWrite(destination, name, field); CHKERRQ(ierr);
+		}
+		else
+		{
+			ierr = PetibmFieldBinaryWrite(destination, name, field); CHKERRQ(ierr);
+		}
+	}
+	else
+	{
+		if (appCtx.native)
+		{
+			ierr = PetibmFieldNativeRead(source, name, field); CHKERRQ(ierr);
+		}
+		else
+		{
+			ierr = PetibmFieldBinaryRead(source, name, field); CHKERRQ(ierr);
+		}
+		ierr = PetibmFieldHDF5Write(destination, name, field); CHKERRQ(ierr);
+	}
+
+	PetscFunctionReturn(0);
+} // AppConvert
+
+
+/*! Reads the manifest of completed conversions and merges its parts.
+ *
+ * The parts (`<manifest>.<group>`, one per group of processes of a batch,
+ * possibly interrupted) are merged into the manifest, then removed.
+ *
+ * \param manifest Path of the manifest.
+ * \param done The completed conversions, as "<step> <field>" (passed by reference).
+ */
+PetscErrorCode AppManifestMerge(
+	const std::string manifest, std::set<std::string> &done)
+{
+	const std::string dirname = (manifest.find('/') == std::string::npos) ?
+	                            "." : manifest.substr(0, manifest.rfind('/')),
+	                  prefix = manifest.substr(manifest.rfind('/') + 1) + ".";
+	std::vector<std::string> parts;
+	std::string line;
+	DIR *dir;
+	struct dirent *entry;
+
+	PetscFunctionBeginUser;
+
+	dir = opendir(dirname.c_str());
+	if (dir != nullptr)
+	{
+		while ((entry = readdir(dir)) != nullptr)
+			if (std::string(entry->d_name).compare(0, prefix.size(), prefix) == 0)
+				parts.push_back(dirname + "/" + entry->d_name);
+		closedir(dir);
+	}
+	parts.insert(parts.begin(), manifest);
+	for (auto &part : parts)
+	{
+		std::ifstream infile(part.c_str());
+		while (std::getline(infile, line))
+			if (!line.empty())
+				done.insert(line);
+	}
+	if (parts.size() > 1)
+	{
+		std::ofstream outfile(manifest.c_str());
+		for (auto &entry : done)
+			outfile << entry << "\n";
+		outfile.close();
+		if (!outfile.good())
+			SETERRQ(PETSC_COMM_SELF, PETSC_ERR_FILE_WRITE,
+			        "Cannot write the manifest");
+		for (size_t i=1; i<parts.size(); i++)
+			std::remove(parts[i].c_str());
+	}
+
+	PetscFunctionReturn(0);
+} // AppManifestMerge
+
+
+/*! Converts the fields of a range of time steps, file by file.
+ *
+ * The processes are split into groups (a single process for small fields,
+ * which then converts whole files serially) that take the next pending
+ * conversion from a counter held by rank 0 (dynamic scheduling); each group
+ * records its completed conversions in its own part of the manifest, so that
+ * a restarted batch skips them.
+ *
+ * \param dim Dimension of the fields.
+ * \param appCtx The context of the application.
+ * \param gridCtx The default context of the grids (overridden per field with
+ *        the prefix `<field>_`).
+ * \param fieldCtx The context of the fields (periodicity).
+ */
+PetscErrorCode AppBatch(const PetscInt dim, const AppCtx appCtx,
+                        const PetibmGridCtx gridCtx,
+                        const PetibmFieldCtx fieldCtx)
+{
+	PetscErrorCode ierr;
+	std::string directory, outdir, manifest;
+	PetibmTimeStepCtx stepCtx;
+	std::vector<std::string> names;
+	std::vector<PetibmGridCtx> gridCtxs;
+	std::vector<PetibmField> fields;
+	std::vector<PetscBool> created;
+	std::vector<PetscInt> tasks, units;
+	std::set<std::string> done;
+	PetibmFieldPool pool;
+	PetscInt ite, f, ntasks, npoints = 1, group, u;
+	PetscMPIInt rank, size, grank, next, unit, one = 1;
+	MPI_Comm comm;
+	MPI_Win win;
+	PetscBool found;
+
+	PetscFunctionBeginUser;
+
+	ierr = MPI_Comm_rank(PETSC_COMM_WORLD, &rank); CHKERRQ(ierr);
+	ierr = MPI_Comm_size(PETSC_COMM_WORLD, &size); CHKERRQ(ierr);
+
+	// directories, time steps, and fields (each with its own grid options)
+	ierr = PetibmGetDirectory(&directory); CHKERRQ(ierr);
+	ierr = PetibmTimeStepGetOptions(nullptr, &stepCtx); CHKERRQ(ierr);
+	{
+		char dir[PETSC_MAX_PATH_LEN];
+		ierr = PetscOptionsGetString(nullptr, nullptr, "-output_directory",
+		                             dir, sizeof(dir), &found); CHKERRQ(ierr);
+		outdir = (!found) ? directory : dir;
+		mkdir((outdir).c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+	}
+	{
+		char *strings[64];
+		PetscInt n = 64, i;
+		ierr = PetscOptionsGetStringArray(
+			nullptr, nullptr, "-fields", strings, &n, &found); CHKERRQ(ierr);
+		if (!found)
+			names.push_back(fieldCtx.name);
+		for (i=0; found and i<n; i++)
+		{
+			names.push_back(strings[i]);
+			ierr = PetscFree(strings[i]); CHKERRQ(ierr);
+		}
+	}
+	for (auto &name : names)
+	{
+		PetibmGridCtx ctx = gridCtx;
+		ierr = PetibmGridGetOptions((name+"_").c_str(), &ctx); CHKERRQ(ierr);
+		gridCtxs.push_back(ctx);
+		npoints = PetscMax(npoints,
+		                   ctx.nx * ctx.ny * ((dim == 3) ? ctx.nz : 1));
+	}
+	manifest = (std::strlen(appCtx.manifest)) ?
+	           appCtx.manifest : outdir+"/convert-manifest.txt";
+
+	// pending conversions (time step, field), listed by rank 0
+	if (rank == 0)
+	{
+		ierr = AppManifestMerge(manifest, done); CHKERRQ(ierr);
+		for (ite=stepCtx.start; ite<=stepCtx.end; ite+=stepCtx.step)
+			for (f=0; f<(PetscInt) names.size(); f++)
+				if (!done.count(std::to_string(ite) + " " + names[f]))
+				{
+					tasks.push_back(ite);
+					tasks.push_back(f);
+				}
+		ntasks = tasks.size() / 2;
 	}
+	ierr = MPI_Bcast(&ntasks, 1, MPIU_INT, 0, PETSC_COMM_WORLD); CHKERRQ(ierr);
+	tasks.resize(2 * ntasks);
+	ierr = MPI_Bcast(tasks.data(), 2 * ntasks, MPIU_INT,
+	                 0, PETSC_COMM_WORLD); CHKERRQ(ierr);
+	// a unit of work is a single conversion, except when writing HDF5 files:
+	// all the fields of a time step then go to the same group (same file)
+	for (u=0; u<ntasks; u++)
+		if (u == 0 or appCtx.hdf52binary or tasks[2*u] != tasks[2*u-2])
+			units.push_back(u);
+	units.push_back(ntasks);
+	ierr = PetscPrintf(PETSC_COMM_WORLD, "[batch: %D conversions pending]\n",
+	                   ntasks); CHKERRQ(ierr);
+
+	// groups of processes: one process per group is the serial path
+	group = (appCtx.group_size > 0) ?
+	        appCtx.group_size :
+	        (npoints + appCtx.points_per_process - 1) / appCtx.points_per_process;
+	group = PetscMax(1, PetscMin(group, size));
+	if (group == 1)
+		comm = PETSC_COMM_SELF;
 	else
 	{
-		ierr = PetibmFieldBinaryRead(
-			appCtx.source, fieldCtx.name, field); CHKERRQ(ierr);
-		ierr = PetibmFieldHDF5Write(
-			appCtx.destination, fieldCtx.name, field); CHKERRQ(ierr);
+		ierr = MPI_Comm_split(
+			PETSC_COMM_WORLD, rank / group, rank, &comm); CHKERRQ(ierr);
 	}
+	ierr = MPI_Comm_rank(comm, &grank); CHKERRQ(ierr);
+	std::string part = manifest + "." + std::to_string(rank / group);
+
+	// shared counter of the next unit of work
+	next = 0;
+	ierr = MPI_Win_create(&next, (rank == 0) ? sizeof(next) : 0, sizeof(next),
+	                      MPI_INFO_NULL, PETSC_COMM_WORLD, &win); CHKERRQ(ierr);
+	fields.resize(names.size());
+	created.assign(names.size(), PETSC_FALSE);
+	while (true)
+	{
+		if (grank == 0)
+		{
+			ierr = MPI_Win_lock(MPI_LOCK_EXCLUSIVE, 0, 0, win); CHKERRQ(ierr);
+			ierr = MPI_Fetch_and_op(
+				&one, &unit, MPI_INT, 0, 0, MPI_SUM, win); CHKERRQ(ierr);
+			ierr = MPI_Win_unlock(0, win); CHKERRQ(ierr);
+		}
+		ierr = MPI_Bcast(&unit, 1, MPI_INT, 0, comm); CHKERRQ(ierr);
+		u = unit;
+		if (u >= (PetscInt) units.size() - 1)
+			break;
+		for (PetscInt t=units[u]; t<units[u+1]; t++)
+		{
+			ite = tasks[2*t];
+			f = tasks[2*t+1];
+			// the field of a group is created once and reused for all steps
+			if (!created[f])
+			{
+				ierr = AppCreateDMDA(comm, dim, gridCtxs[f], fieldCtx,
+				                     &fields[f].da); CHKERRQ(ierr);
+				ierr = PetibmFieldInitialize(pool, fields[f]); CHKERRQ(ierr);
+				created[f] = PETSC_TRUE;
+			}
+			std::stringstream ss;
+			ss << std::setfill('0') << std::setw(7) << ite;
+			std::string step(ss.str()), source, destination;
+			if (appCtx.hdf52binary)
+			{
+				source = directory+"/"+step+".h5";
+				destination = outdir+"/"+step+"/"+names[f]+".dat";
+				if (grank == 0)
+					mkdir((outdir+"/"+step).c_str(),
+					      S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+				ierr = MPI_Barrier(comm); CHKERRQ(ierr);
+			}
+			else
+			{
+				source = directory+"/"+step+"/"+names[f]+".dat";
+				destination = outdir+"/"+step+".h5";
+			}
+			ierr = AppConvert(
+				appCtx, source, destination, names[f], fields[f]); CHKERRQ(ierr);
+			if (grank == 0)
+			{
+				std::ofstream outfile(part.c_str(), std::ios::app);
+				outfile << ite << " " << names[f] << "\n";
+			}
+		}
+	}
+	ierr = MPI_Win_free(&win); CHKERRQ(ierr);
+	for (f=0; f<(PetscInt) names.size(); f++)
+		if (created[f])
+		{
+			ierr = PetibmFieldDestroy(fields[f]); CHKERRQ(ierr);
+		}
+	ierr = PetibmFieldPoolDestroy(pool); CHKERRQ(ierr);
+	if (group > 1)
+	{
+		ierr = MPI_Comm_free(&comm); CHKERRQ(ierr);
+	}
+
+	// merge the parts of the manifest once all groups are done
+	ierr = MPI_Barrier(PETSC_COMM_WORLD); CHKERRQ(ierr);
+	if (rank == 0)
+	{
+		done.clear();
+		ierr = AppManifestMerge(manifest, done); CHKERRQ(ierr);
+	}
+
+	PetscFunctionReturn(0);
+} // AppBatch
+
+
+int main(int argc, char **argv)
+{
+	PetscErrorCode ierr;
+	PetscInt dim;
+	DM da;
+	PetibmGridCtx gridCtx;
+	PetibmFieldCtx fieldCtx;
+	AppCtx appCtx;
+	PetibmField field;
+	PetibmFieldPool pool;
+
+	ierr = PetscInitialize(&argc, &argv, nullptr, nullptr); CHKERRQ(ierr);
+
+	// parse command-line options
+	ierr = PetibmGridGetOptions(nullptr, &gridCtx); CHKERRQ(ierr);
+	ierr = PetibmFieldGetOptions(nullptr, &fieldCtx); CHKERRQ(ierr);
+	ierr = AppGetOptions(nullptr, &appCtx); CHKERRQ(ierr);
+	// sizes missing from the command line are those of the HDF5 dataset
+	if (appCtx.hdf52binary and !appCtx.batch and gridCtx.nx <= 0)
+	{
+		std::vector<PetscInt> shape;
+		ierr = PetibmInfoHDF5GetShape(
+			appCtx.source, fieldCtx.name, shape); CHKERRQ(ierr);
+		if (shape.size() == 2 or shape.size() == 3)
+		{
+			gridCtx.nx = shape.back();
+			gridCtx.ny = shape[shape.size()-2];
+			gridCtx.nz = (shape.size() == 3) ? shape[0] : 0;
+		}
+	}
+	// the dimension of the field is given by the number of points in z
+	dim = (gridCtx.nz > 0) ? 3 : 2;
+
+	if (appCtx.batch)
+	{
+		ierr = AppBatch(dim, appCtx, gridCtx, fieldCtx); CHKERRQ(ierr);
+		ierr = PetscFinalize(); CHKERRQ(ierr);
+		return 0;
+	}
+
+	// create DMDA object
+	ierr = AppCreateDMDA(
+		PETSC_COMM_WORLD, dim, gridCtx, fieldCtx, &da); CHKERRQ(ierr);
+
+	// initialize, read, and write (no ghosted local vector needed)
+	field.da = da;
+	ierr = PetibmFieldInitialize(pool, field); CHKERRQ(ierr);
+	ierr = AppConvert(appCtx, appCtx.source, appCtx.destination,
+	                  fieldCtx.name, field); CHKERRQ(ierr);
 
 	ierr = PetibmFieldDestroy(field); CHKERRQ(ierr);
+	ierr = PetibmFieldPoolDestroy(pool); CHKERRQ(ierr);
 	ierr = PetscFinalize(); CHKERRQ(ierr);
 	return 0;
 } // main
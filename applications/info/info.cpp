@@ -0,0 +1,75 @@
+/*! Reports the datasets of field and grid files from their headers.
+ * \file info.cpp
+ */
+
+#include <fstream>
+#include <string>
+
+#include <petscsys.h>
+#include <petscviewerhdf5.h>
+
+#include "petibm-utilities/info.h"
+#include "petibm-utilities/misc.h"
+
+
+int main(int argc, char **argv)
+{
+	PetscErrorCode ierr;
+	std::vector<PetibmDatasetInfo> datasets;
+	std::vector<std::string> paths;
+	PetscInt sample = 0, i, n = 64;
+	PetscMPIInt rank, hdf5;
+	PetscBool found = PETSC_FALSE;
+	char *strings[64];
+
+	ierr = PetscInitialize(&argc, &argv, nullptr, nullptr); CHKERRQ(ierr);
+
+	ierr = MPI_Comm_rank(PETSC_COMM_WORLD, &rank); CHKERRQ(ierr);
+
+	// parse command-line options
+	ierr = PetscOptionsGetStringArray(
+		nullptr, nullptr, "-path", strings, &n, &found); CHKERRQ(ierr);
+	if (!found)
+		SETERRQ(PETSC_COMM_WORLD, PETSC_ERR_ARG_WRONG,
+		        "Provide the file(s) to inspect with -path <file>[,<file>...]");
+	for (i=0; i<n; i++)
+	{
+		paths.push_back(strings[i]);
+		ierr = PetscFree(strings[i]); CHKERRQ(ierr);
+	}
+	// stride along the first dimension to compute the ranges (0: headers only)
+	ierr = PetscOptionsGetInt(
+		nullptr, nullptr, "-sample", &sample, &found); CHKERRQ(ierr);
+
+	for (auto &path : paths)
+	{
+		// HDF5 signature checked by rank 0, otherwise PETSc binary
+		hdf5 = 0;
+		if (rank == 0)
+		{
+			if (!std::ifstream(path.c_str()).good())
+				hdf5 = -1;
+			else
+				hdf5 = (H5Fis_hdf5(path.c_str()) > 0) ? 1 : 0;
+		}
+		ierr = MPI_Bcast(&hdf5, 1, MPI_INT, 0, PETSC_COMM_WORLD); CHKERRQ(ierr);
+		if (hdf5 < 0)
+			SETERRQ1(PETSC_COMM_WORLD, PETSC_ERR_FILE_OPEN,
+			         "Cannot open the file %s", path.c_str());
+		if (hdf5)
+		{
+			ierr = PetibmInfoHDF5Read(path, sample, datasets); CHKERRQ(ierr);
+		}
+		else
+		{
+			ierr = PetibmInfoBinaryRead(
+				path, (sample > 0) ? PETSC_TRUE : PETSC_FALSE,
+				datasets); CHKERRQ(ierr);
+		}
+		ierr = PetibmInfoPrintf(path, datasets); CHKERRQ(ierr);
+	}
+
+	ierr = PetscFinalize(); CHKERRQ(ierr);
+
+	return 0;
+} // main
@@ -11,10 +11,7 @@
 #include "petibm-utilities/field.h"
 #include "petibm-utilities/grid.h"
 #include "petibm-utilities/misc.h"
-
-#ifndef DIMENSIONS
-#define DIMENSIONS 2
-#endif
+#include "petibm-utilities/threads.h"
 
 
 int main(int argc, char **argv)
@@ -22,12 +19,14 @@ int main(int argc, char **argv)
 	PetscErrorCode ierr;
 	PetibmField fieldA, fieldB;
 	PetibmFieldCtx fieldACtx, fieldBCtx;
+	PetibmFieldPool pool;
 	PetibmGrid gridA, gridB;
 	PetibmGridCtx gridACtx, gridBCtx;
-	const PetscInt dim = DIMENSIONS;
+	PetscInt dim;
 	std::string outdir;
 
 	ierr = PetscInitialize(&argc, &argv, nullptr, nullptr); CHKERRQ(ierr);
+	ierr = PetibmThreadsInitialize(); CHKERRQ(ierr);
 	
 	{
 		PetscBool found = PETSC_FALSE;
@@ -40,7 +39,11 @@ int main(int argc, char **argv)
 
 	// Create and read the grid A
 	ierr = PetibmGridGetOptions("gridA_", &gridACtx); CHKERRQ(ierr);
+	ierr = PetibmGridCtxDetectSizes(
+		gridACtx.path, gridACtx.name, &gridACtx); CHKERRQ(ierr);
 	ierr = PetibmGridCtxPrintf("Grid A", gridACtx); CHKERRQ(ierr);
+	// the dimension of the problem is given by grid A
+	dim = (gridACtx.nz > 0) ? 3 : 2;
 	ierr = PetibmGridInitialize(gridACtx, gridA); CHKERRQ(ierr);
 	ierr = PetscObjectViewFromOptions(
 		(PetscObject) gridA.x.da, nullptr, "-gridA_x_dmda_view"); CHKERRQ(ierr);
@@ -58,7 +61,7 @@ int main(int argc, char **argv)
 	// Create and read the field A
 	ierr = PetibmFieldGetOptions("fieldA_", &fieldACtx); CHKERRQ(ierr);
 	ierr = PetibmFieldCtxPrintf("Field A", fieldACtx); CHKERRQ(ierr);
-	ierr = PetibmFieldInitialize(fieldACtx, gridA, fieldA); CHKERRQ(ierr);
+	ierr = PetibmFieldInitialize(fieldACtx, gridA, pool, fieldA); CHKERRQ(ierr);
 	ierr = PetscObjectViewFromOptions(
 		(PetscObject) fieldA.da, nullptr, "-fieldA_dmda_view"); CHKERRQ(ierr);
 	ierr = PetibmFieldHDF5Read(
@@ -68,17 +71,25 @@ int main(int argc, char **argv)
 
 	// Create and read the grid B
 	ierr = PetibmGridGetOptions("gridB_", &gridBCtx); CHKERRQ(ierr);
+	ierr = PetibmGridCtxDetectSizes(
+		gridBCtx.path, gridBCtx.name, &gridBCtx); CHKERRQ(ierr);
 	ierr = PetibmGridCtxPrintf("Grid B", gridBCtx); CHKERRQ(ierr);
-	Vec coords[dim];
-	ierr = VecCreateSeq(PETSC_COMM_SELF, gridBCtx.nx, coords); CHKERRQ(ierr);
+	// the stations are read distributed over the processes of each gridline
+	Vec coords[3];
+	MPI_Comm comm;
+	ierr = PetscObjectGetComm((PetscObject) gridA.x.da, &comm); CHKERRQ(ierr);
+	ierr = VecCreateMPI(comm, PETSC_DECIDE, gridBCtx.nx, coords); CHKERRQ(ierr);
 	ierr = PetibmGridlineHDF5Read(
 		gridBCtx.path, gridBCtx.name, "x", coords[0]); CHKERRQ(ierr);
-	ierr = VecCreateSeq(PETSC_COMM_SELF, gridBCtx.ny, coords+1); CHKERRQ(ierr);
+	ierr = PetscObjectGetComm((PetscObject) gridA.y.da, &comm); CHKERRQ(ierr);
+	ierr = VecCreateMPI(comm, PETSC_DECIDE, gridBCtx.ny, coords+1); CHKERRQ(ierr);
 	ierr = PetibmGridlineHDF5Read(
 		gridBCtx.path, gridBCtx.name, "y", coords[1]); CHKERRQ(ierr);
 	if (dim == 3)
 	{
-		ierr = VecCreateSeq(PETSC_COMM_SELF, gridBCtx.nz, coords+2); CHKERRQ(ierr);
+		ierr = PetscObjectGetComm((PetscObject) gridA.z.da, &comm); CHKERRQ(ierr);
+		ierr = VecCreateMPI(
+			comm, PETSC_DECIDE, gridBCtx.nz, coords+2); CHKERRQ(ierr);
 		ierr = PetibmGridlineHDF5Read(
 			gridBCtx.path, gridBCtx.name, "z", coords[2]); CHKERRQ(ierr);
 	}
@@ -92,14 +103,16 @@ int main(int argc, char **argv)
 		ierr = PetscObjectViewFromOptions(
 			(PetscObject) gridB.z.da, nullptr, "-gridB_z_dmda_view"); CHKERRQ(ierr);
 	}
-	ierr = PetibmGridHDF5Read(
-		gridBCtx.path, gridBCtx.name, gridB); CHKERRQ(ierr);
+	for (PetscInt d=0; d<dim; d++)
+	{
+		ierr = VecDestroy(coords+d); CHKERRQ(ierr);
+	}
 	ierr = PetibmGridSetBoundaryPoints(
 		gridBCtx.starts, gridBCtx.ends, gridB); CHKERRQ(ierr);
 	// Create the field B
 	ierr = PetibmFieldGetOptions("fieldB_", &fieldBCtx); CHKERRQ(ierr);
 	ierr = PetibmFieldCtxPrintf("Field B", fieldBCtx); CHKERRQ(ierr);
-	ierr = PetibmFieldInitialize(fieldBCtx, gridB, fieldB); CHKERRQ(ierr);
+	ierr = PetibmFieldInitialize(fieldBCtx, gridB, pool, fieldB); CHKERRQ(ierr);
 	ierr = PetscObjectViewFromOptions(
 		(PetscObject) fieldB.da, nullptr, "-fieldB_dmda_view"); CHKERRQ(ierr);
 	ierr = PetibmFieldSetBoundaryPoints(
@@ -115,6 +128,17 @@ int main(int argc, char **argv)
 	ierr = PetibmFieldDestroy(fieldB); CHKERRQ(ierr);
 	ierr = PetibmGridDestroy(gridA); CHKERRQ(ierr);
 	ierr = PetibmGridDestroy(gridB); CHKERRQ(ierr);
+	{
+		PetscBool found = PETSC_FALSE;
+		ierr = PetscOptionsHasName(
+			nullptr, nullptr, "-field_pool_view", &found); CHKERRQ(ierr);
+		if (found)
+		{
+			ierr = PetibmFieldPoolView(pool); CHKERRQ(ierr);
+		}
+	}
+	ierr = PetibmFieldPoolDestroy(pool); CHKERRQ(ierr);
+	ierr = PetibmThreadsFinalize(); CHKERRQ(ierr);
 	ierr = PetscFinalize(); CHKERRQ(ierr);
 
 	return 0;
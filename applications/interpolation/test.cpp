@@ -11,10 +11,6 @@
 #include "petibm-utilities/grid.h"
 #include "petibm-utilities/misc.h"
 
-#ifndef DIMENSIONS
-#define DIMENSIONS 2
-#endif
-
 
 int main(int argc, char **argv)
 {
@@ -31,12 +27,14 @@ int main(int argc, char **argv)
 	          ends[3] = {1.0, 2.0, 4.0},
 	          h;
 	PetscBool found, fine2coarse = PETSC_FALSE;
-	const PetscInt dim = DIMENSIONS;
+	PetscInt dim = 2;
 
 	ierr = PetscInitialize(&argc, &argv, nullptr, nullptr); CHKERRQ(ierr);
 
 	ierr = PetscOptionsGetBool(nullptr, nullptr, "-fine_to_coarse",
 	                           &fine2coarse, &found); CHKERRQ(ierr);
+	ierr = PetscOptionsGetInt(nullptr, nullptr, "-dim",
+	                          &dim, &found); CHKERRQ(ierr);
 
 	gridACtx.nx = (fine2coarse) ? 8 : 6;
 	gridACtx.ny = (fine2coarse) ? 7 : 5;
@@ -0,0 +1,175 @@
+/*! Measures the bandwidth of the binary field I/O (rank-0 path vs MPI-IO).
+ * \file iobench.cpp
+ */
+
+#include <cstdio>
+#include <string>
+#include <sys/stat.h>
+
+#include <petscsys.h>
+#include <petscdmda.h>
+
+#include "petibm-utilities/field.h"
+#include "petibm-utilities/grid.h"
+#include "petibm-utilities/misc.h"
+
+
+/*! Writes and reads a field, keeping the best times over the repetitions.
+ *
+ * \param filepath Path of the file.
+ * \param native Use the native layout instead of the PETSc binary format.
+ * \param repeat Number of repetitions.
+ * \param field The field (passed by reference).
+ * \param twrite Best time to write the field (passed by pointer).
+ * \param tread Best time to read the field (passed by pointer).
+ */
+PetscErrorCode AppMeasure(const std::string filepath, const PetscBool native,
+                          const PetscInt repeat, PetibmField &field,
+                          PetscReal *twrite, PetscReal *tread)
+{
+	PetscErrorCode ierr;
+	PetscScalar sum, check;
+	PetscReal t;
+	PetscInt r;
+
+	PetscFunctionBeginUser;
+
+	ierr = VecSum(field.global, &sum); CHKERRQ(ierr);
+	*twrite = *tread = PETSC_MAX_REAL;
+	for (r=0; r<repeat; r++)
+	{
+		ierr = MPI_Barrier(PETSC_COMM_WORLD); CHKERRQ(ierr);
+		t = MPI_Wtime();
+		if (native)
+		{
+			ierr = PetibmFieldNativeWrite(filepath, "bench", field); CHKERRQ(ierr);
+		}
+		else
+		{
+			ierr = PetibmFieldBinaryWrite(filepath, "bench", field); CHKERRQ(ierr);
+		}
+		ierr = MPI_Barrier(PETSC_COMM_WORLD); CHKERRQ(ierr);
+		*twrite = PetscMin(*twrite, MPI_Wtime() - t);
+		ierr = VecSet(field.global, 0.0); CHKERRQ(ierr);
+		ierr = MPI_Barrier(PETSC_COMM_WORLD); CHKERRQ(ierr);
+		t = MPI_Wtime();
+		if (native)
+		{
+			ierr = PetibmFieldNativeRead(filepath, "bench", field); CHKERRQ(ierr);
+		}
+		else
+		{
+			ierr = PetibmFieldBinaryRead(filepath, "bench", field); CHKERRQ(ierr);
+		}
+		ierr = MPI_Barrier(PETSC_COMM_WORLD); CHKERRQ(ierr);
+		*tread = PetscMin(*tread, MPI_Wtime() - t);
+		ierr = VecSum(field.global, &check); CHKERRQ(ierr);
+		if (PetscAbsScalar(check - sum) > 1.0e-8 * PetscAbsScalar(sum))
+			SETERRQ(PETSC_COMM_WORLD, PETSC_ERR_PLIB,
+			        "The field read differs from the field written");
+	}
+
+	PetscFunctionReturn(0);
+} // AppMeasure
+
+
+int main(int argc, char **argv)
+{
+	PetscErrorCode ierr;
+	std::string outdir;
+	PetibmGridCtx gridCtx;
+	PetibmField field;
+	PetibmFieldPool pool;
+	DM da;
+	PetscInt repeat = 3, M, nlocal, rstart, i, path, format;
+	PetscReal *arr, twrite, tread, gbytes;
+	PetscMPIInt rank, size;
+	PetscBool found = PETSC_FALSE;
+	const char *paths[2] = {"rank-0", "MPI-IO"},
+	           *formats[2] = {"binary", "native"};
+
+	ierr = PetscInitialize(&argc, &argv, nullptr, nullptr); CHKERRQ(ierr);
+
+	ierr = MPI_Comm_rank(PETSC_COMM_WORLD, &rank); CHKERRQ(ierr);
+	ierr = MPI_Comm_size(PETSC_COMM_WORLD, &size); CHKERRQ(ierr);
+
+	// parse command-line options
+	ierr = PetibmGridGetOptions(nullptr, &gridCtx); CHKERRQ(ierr);
+	{
+		char dir[PETSC_MAX_PATH_LEN];
+		ierr = PetscOptionsGetString(nullptr, nullptr, "-output_directory",
+		                             dir, sizeof(dir), &found); CHKERRQ(ierr);
+		outdir = (!found) ? "." : dir;
+		mkdir((outdir).c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+	}
+	ierr = PetscOptionsGetInt(
+		nullptr, nullptr, "-repeat", &repeat, &found); CHKERRQ(ierr);
+
+	// create the field (3D unless nz is not positive) and fill it
+	if (gridCtx.nz > 0)
+	{
+		ierr = DMDACreate3d(PETSC_COMM_WORLD,
+		                    DM_BOUNDARY_GHOSTED, DM_BOUNDARY_GHOSTED,
+		                    DM_BOUNDARY_GHOSTED,
+		                    DMDA_STENCIL_STAR,
+		                    gridCtx.nx, gridCtx.ny, gridCtx.nz,
+		                    PETSC_DECIDE, PETSC_DECIDE, PETSC_DECIDE,
+		                    1, 1, nullptr, nullptr, nullptr,
+		                    &da); CHKERRQ(ierr);
+	}
+	else
+	{
+		ierr = DMDACreate2d(PETSC_COMM_WORLD,
+		                    DM_BOUNDARY_GHOSTED, DM_BOUNDARY_GHOSTED,
+		                    DMDA_STENCIL_STAR,
+		                    gridCtx.nx, gridCtx.ny,
+		                    PETSC_DECIDE, PETSC_DECIDE,
+		                    1, 1, nullptr, nullptr,
+		                    &da); CHKERRQ(ierr);
+	}
+	ierr = DMSetFromOptions(da); CHKERRQ(ierr);
+	ierr = DMSetUp(da); CHKERRQ(ierr);
+	field.da = da;
+	ierr = PetibmFieldInitialize(pool, field); CHKERRQ(ierr);
+	ierr = VecGetSize(field.global, &M); CHKERRQ(ierr);
+	ierr = VecGetLocalSize(field.global, &nlocal); CHKERRQ(ierr);
+	ierr = VecGetOwnershipRange(field.global, &rstart, nullptr); CHKERRQ(ierr);
+	ierr = VecGetArray(field.global, &arr); CHKERRQ(ierr);
+	for (i=0; i<nlocal; i++)
+		arr[i] = (PetscReal) ((rstart + i) % 1000);
+	ierr = VecRestoreArray(field.global, &arr); CHKERRQ(ierr);
+	gbytes = M * sizeof(PetscReal) / 1.0e9;
+
+	ierr = PetscPrintf(PETSC_COMM_WORLD,
+	                   "[%d processes, %D values, %g GB, best of %D]\n",
+	                   size, M, gbytes, repeat); CHKERRQ(ierr);
+	ierr = PetscPrintf(PETSC_COMM_WORLD,
+	                   "%-8s %-8s %12s %12s\n", "path", "format",
+	                   "write GB/s", "read GB/s"); CHKERRQ(ierr);
+	// the I/O path is switched through the options database
+	for (path=0; path<2; path++)
+	{
+		ierr = PetscOptionsSetValue(nullptr, "-viewer_binary_mpiio",
+		                            (path == 0) ? "false" : "true"); CHKERRQ(ierr);
+		for (format=0; format<2; format++)
+		{
+			std::string filepath = outdir + "/iobench-" + formats[format] + ".dat";
+			ierr = AppMeasure(filepath, (format == 1) ? PETSC_TRUE : PETSC_FALSE,
+			                  repeat, field, &twrite, &tread); CHKERRQ(ierr);
+			ierr = PetscPrintf(PETSC_COMM_WORLD, "%-8s %-8s %12.3f %12.3f\n",
+			                   paths[path], formats[format],
+			                   gbytes / twrite, gbytes / tread); CHKERRQ(ierr);
+			if (rank == 0)
+			{
+				std::remove(filepath.c_str());
+				std::remove((filepath+".info").c_str());
+			}
+		}
+	}
+
+	ierr = PetibmFieldDestroy(field); CHKERRQ(ierr);
+	ierr = PetibmFieldPoolDestroy(pool); CHKERRQ(ierr);
+	ierr = PetscFinalize(); CHKERRQ(ierr);
+
+	return 0;
+} // main
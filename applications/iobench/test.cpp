@@ -0,0 +1,150 @@
+/*! Tests the round trip of a field through the native format.
+ *
+ * The value of each point is its natural index, so the values read can be
+ * checked point by point whatever the decomposition.
+ * `-mode write` and `-mode read` split the round trip between two runs (for
+ * example on different numbers of processes); the default does both.
+ * \file test.cpp
+ */
+
+#include <string>
+
+#include <petscsys.h>
+#include <petscdmda.h>
+
+#include "petibm-utilities/field.h"
+
+
+/*! Creates a field split between the processes along one direction.
+ *
+ * \param dim The dimension.
+ * \param sizes The number of points in each direction.
+ * \param d The direction split between the processes.
+ * \param field The field to create (passed by reference).
+ */
+PetscErrorCode AppCreateField(
+	const PetscInt dim, const PetscInt sizes[], const PetscInt d,
+	PetibmField &field)
+{
+	PetscErrorCode ierr;
+	PetscMPIInt size;
+	PetscInt procs[3] = {1, 1, 1};
+	DM da;
+
+	PetscFunctionBeginUser;
+
+	ierr = MPI_Comm_size(PETSC_COMM_WORLD, &size); CHKERRQ(ierr);
+	procs[d] = size;
+	if (dim == 3)
+	{
+		ierr = DMDACreate3d(PETSC_COMM_WORLD,
+		                    DM_BOUNDARY_GHOSTED, DM_BOUNDARY_GHOSTED,
+		                    DM_BOUNDARY_GHOSTED, DMDA_STENCIL_BOX,
+		                    sizes[0], sizes[1], sizes[2],
+		                    procs[0], procs[1], procs[2], 1, 1,
+		                    nullptr, nullptr, nullptr, &da); CHKERRQ(ierr);
+	}
+	else
+	{
+		ierr = DMDACreate2d(PETSC_COMM_WORLD,
+		                    DM_BOUNDARY_GHOSTED, DM_BOUNDARY_GHOSTED,
+		                    DMDA_STENCIL_BOX,
+		                    sizes[0], sizes[1], procs[0], procs[1], 1, 1,
+		                    nullptr, nullptr, &da); CHKERRQ(ierr);
+	}
+	ierr = DMSetUp(da); CHKERRQ(ierr);
+	ierr = PetibmFieldInitialize(da, field); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // AppCreateField
+
+
+/*! Sets or checks the natural index as the value of each point.
+ *
+ * \param field The field.
+ * \param check Check the values instead of setting them?
+ * \param errors Number of points with a wrong value (passed by pointer).
+ */
+PetscErrorCode AppNaturalValues(
+	PetibmField &field, const PetscBool check, PetscInt *errors)
+{
+	PetscErrorCode ierr;
+	DMDALocalInfo info;
+	PetscReal *values;
+	PetscInt i, j, k, p = 0;
+
+	PetscFunctionBeginUser;
+
+	ierr = DMDAGetLocalInfo(field.da, &info); CHKERRQ(ierr);
+	ierr = VecGetArray(field.global, &values); CHKERRQ(ierr);
+	*errors = 0;
+	for (k=info.zs; k<info.zs+info.zm; k++)
+		for (j=info.ys; j<info.ys+info.ym; j++)
+			for (i=info.xs; i<info.xs+info.xm; i++, p++)
+			{
+				PetscReal natural = i + info.mx * (j + info.my * k);
+				if (!check)
+					values[p] = natural;
+				else if (values[p] != natural)
+					(*errors)++;
+			}
+	ierr = VecRestoreArray(field.global, &values); CHKERRQ(ierr);
+	ierr = MPI_Allreduce(MPI_IN_PLACE, errors, 1, MPIU_INT, MPI_SUM,
+	                     PETSC_COMM_WORLD); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // AppNaturalValues
+
+
+int main(int argc, char **argv)
+{
+	PetscErrorCode ierr;
+	PetibmField field;
+	PetscInt dim = 3, sizes[3] = {13, 11, 7}, d, errors;
+	const char *const modes[] = {"both", "write", "read"};
+	PetscInt mode = 0;
+	char path[PETSC_MAX_PATH_LEN] = "native-test.bin";
+	PetscBool found;
+
+	ierr = PetscInitialize(&argc, &argv, nullptr, nullptr); CHKERRQ(ierr);
+
+	ierr = PetscOptionsGetInt(nullptr, nullptr, "-dim",
+	                          &dim, &found); CHKERRQ(ierr);
+	ierr = PetscOptionsGetEList(nullptr, nullptr, "-mode", modes, 3,
+	                            &mode, &found); CHKERRQ(ierr);
+	ierr = PetscOptionsGetString(nullptr, nullptr, "-path",
+	                             path, sizeof(path), &found); CHKERRQ(ierr);
+
+	// write from a decomposition along the y-direction
+	if (mode != 2)
+	{
+		ierr = AppCreateField(dim, sizes, 1, field); CHKERRQ(ierr);
+		ierr = AppNaturalValues(field, PETSC_FALSE, &errors); CHKERRQ(ierr);
+		ierr = PetibmFieldNativeWrite(path, "test", field); CHKERRQ(ierr);
+		ierr = PetibmFieldDestroy(field); CHKERRQ(ierr);
+	}
+	// read into the same decomposition (direct loads, unless the file was
+	// written on another number of processes) and into a decomposition along
+	// the x-direction (scattered loads)
+	if (mode != 1)
+	{
+		for (d=1; d>=0; d--)
+		{
+			ierr = AppCreateField(dim, sizes, d, field); CHKERRQ(ierr);
+			ierr = VecSet(field.global, -1.0); CHKERRQ(ierr);
+			ierr = PetibmFieldNativeRead(path, "test", field); CHKERRQ(ierr);
+			ierr = AppNaturalValues(field, PETSC_TRUE, &errors); CHKERRQ(ierr);
+			ierr = PetibmFieldDestroy(field); CHKERRQ(ierr);
+			if (errors)
+				SETERRQ2(PETSC_COMM_WORLD, PETSC_ERR_PLIB,
+				         "Native round trip: %D wrong values (split along %s)",
+				         errors, (d == 0) ? "x" : "y");
+			ierr = PetscPrintf(PETSC_COMM_WORLD, "native round trip (split "
+			                   "along %s): ok\n", (d == 0) ? "x" : "y"); CHKERRQ(ierr);
+		}
+	}
+
+	ierr = PetscFinalize(); CHKERRQ(ierr);
+
+	return 0;
+} // main
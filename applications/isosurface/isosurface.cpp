@@ -0,0 +1,99 @@
+/*! Extracts isosurfaces of a 3D field at every saved time step.
+ * \file isosurface.cpp
+ */
+
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <sys/stat.h>
+
+#include <petscsys.h>
+
+#include "petibm-utilities/field.h"
+#include "petibm-utilities/grid.h"
+#include "petibm-utilities/isosurface.h"
+#include "petibm-utilities/misc.h"
+#include "petibm-utilities/timestep.h"
+
+
+int main(int argc, char **argv)
+{
+	PetscErrorCode ierr;
+	std::string directory, outdir;
+	PetibmGrid grid;
+	PetibmGridCtx gridCtx;
+	PetibmField field;
+	PetibmFieldCtx fieldCtx;
+	PetibmFieldPool pool;
+	PetibmTimeStepCtx stepCtx;
+	PetibmIsoSurface surf;
+	PetscReal value = 0.0;
+	PetscInt ite;
+	PetscBool found = PETSC_FALSE;
+
+	ierr = PetscInitialize(&argc, &argv, nullptr, nullptr); CHKERRQ(ierr);
+
+	// parse command-line options
+	ierr = PetibmGetDirectory(&directory); CHKERRQ(ierr);
+	ierr = PetibmTimeStepGetOptions(nullptr, &stepCtx); CHKERRQ(ierr);
+	ierr = PetibmGridGetOptions("grid_", &gridCtx); CHKERRQ(ierr);
+	ierr = PetibmFieldGetOptions("field_", &fieldCtx); CHKERRQ(ierr);
+	{
+		char dir[PETSC_MAX_PATH_LEN];
+		ierr = PetscOptionsGetString(nullptr, nullptr, "-output_directory",
+		                             dir, sizeof(dir), &found); CHKERRQ(ierr);
+		outdir = (!found) ? directory : dir;
+		mkdir((outdir).c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+	}
+	ierr = PetscOptionsGetReal(
+		nullptr, nullptr, "-iso_value", &value, &found); CHKERRQ(ierr);
+	// default grid: group with the name of the field in the grid file
+	if (!std::strlen(gridCtx.path))
+	{
+		ierr = PetscStrcpy(
+			gridCtx.path, (directory+"/grid.h5").c_str()); CHKERRQ(ierr);
+	}
+	if (!std::strlen(gridCtx.name))
+	{
+		ierr = PetscStrcpy(gridCtx.name, fieldCtx.name); CHKERRQ(ierr);
+	}
+	ierr = PetibmGridCtxDetectSizes(
+		gridCtx.path, gridCtx.name, &gridCtx); CHKERRQ(ierr);
+	if (gridCtx.nz <= 0)
+		SETERRQ(PETSC_COMM_WORLD, PETSC_ERR_SUP,
+		        "Isosurfaces are only extracted from 3D fields");
+	ierr = PetibmGridCtxPrintf("Grid", gridCtx); CHKERRQ(ierr);
+	ierr = PetibmFieldCtxPrintf("Field", fieldCtx); CHKERRQ(ierr);
+
+	// create and read the grid, create the field
+	ierr = PetibmGridInitialize(gridCtx, grid); CHKERRQ(ierr);
+	ierr = PetibmGridHDF5Read(gridCtx.path, gridCtx.name, grid); CHKERRQ(ierr);
+	ierr = PetibmFieldInitialize(fieldCtx, grid, pool, field); CHKERRQ(ierr);
+
+	// loop over the time steps to extract the isosurface
+	for (ite=stepCtx.start; ite<=stepCtx.end; ite+=stepCtx.step)
+	{
+		ierr = PetscPrintf(
+			PETSC_COMM_WORLD, "[time-step %d]\n", ite); CHKERRQ(ierr);
+		// get name of time-step file
+		std::stringstream ss;
+		ss << std::setfill('0') << std::setw(7) << ite;
+		std::string filename(ss.str());
+		ierr = PetibmFieldHDF5Read(
+			directory+"/"+filename+".h5", fieldCtx.name, field); CHKERRQ(ierr);
+		ierr = PetibmIsoSurfaceCompute(grid, field, value, surf); CHKERRQ(ierr);
+		ierr = PetibmIsoSurfacePLYWrite(
+			outdir+"/"+filename+"-"+fieldCtx.name+".ply", surf); CHKERRQ(ierr);
+		ierr = PetscPrintf(PETSC_COMM_WORLD, "\t- vertices: %d\n",
+		                   surf.size); CHKERRQ(ierr);
+	}
+
+	ierr = PetibmIsoSurfaceDestroy(surf); CHKERRQ(ierr);
+	ierr = PetibmFieldDestroy(field); CHKERRQ(ierr);
+	ierr = PetibmGridDestroy(grid); CHKERRQ(ierr);
+	ierr = PetibmFieldPoolDestroy(pool); CHKERRQ(ierr);
+
+	ierr = PetscFinalize(); CHKERRQ(ierr);
+
+	return 0;
+} // main
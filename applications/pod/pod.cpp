@@ -0,0 +1,128 @@
+/*! Computes the proper orthogonal decomposition of the time steps of a field.
+ * \file pod.cpp
+ */
+
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <sys/stat.h>
+
+#include <petscsys.h>
+
+#include "petibm-utilities/field.h"
+#include "petibm-utilities/grid.h"
+#include "petibm-utilities/misc.h"
+#include "petibm-utilities/pod.h"
+#include "petibm-utilities/timestep.h"
+
+
+int main(int argc, char **argv)
+{
+	PetscErrorCode ierr;
+	std::string directory, outdir;
+	PetibmGrid grid;
+	PetibmGridCtx gridCtx;
+	PetibmField field;
+	PetibmFieldCtx fieldCtx;
+	PetibmFieldPool pool;
+	PetibmTimeStepCtx stepCtx;
+	PetibmPODCtx podCtx;
+	PetibmPOD pod;
+	std::vector<PetscInt> steps;
+	PetscInt ite;
+	PetscBool found = PETSC_FALSE;
+
+	ierr = PetscInitialize(&argc, &argv, nullptr, nullptr); CHKERRQ(ierr);
+
+	// parse command-line options
+	ierr = PetibmGetDirectory(&directory); CHKERRQ(ierr);
+	ierr = PetibmTimeStepGetOptions(nullptr, &stepCtx); CHKERRQ(ierr);
+	ierr = PetibmGridGetOptions("grid_", &gridCtx); CHKERRQ(ierr);
+	ierr = PetibmFieldGetOptions("field_", &fieldCtx); CHKERRQ(ierr);
+	ierr = PetibmPODGetOptions("pod_", &podCtx); CHKERRQ(ierr);
+	{
+		char dir[PETSC_MAX_PATH_LEN];
+		ierr = PetscOptionsGetString(nullptr, nullptr, "-output_directory",
+		                             dir, sizeof(dir), &found); CHKERRQ(ierr);
+		outdir = (!found) ? directory : dir;
+		mkdir((outdir).c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+	}
+	// default grid: group with the name of the field in the grid file
+	if (!std::strlen(gridCtx.path))
+	{
+		ierr = PetscStrcpy(
+			gridCtx.path, (directory+"/grid.h5").c_str()); CHKERRQ(ierr);
+	}
+	if (!std::strlen(gridCtx.name))
+	{
+		ierr = PetscStrcpy(gridCtx.name, fieldCtx.name); CHKERRQ(ierr);
+	}
+	ierr = PetibmGridCtxDetectSizes(
+		gridCtx.path, gridCtx.name, &gridCtx); CHKERRQ(ierr);
+	ierr = PetibmGridCtxPrintf("Grid", gridCtx); CHKERRQ(ierr);
+	ierr = PetibmFieldCtxPrintf("Field", fieldCtx); CHKERRQ(ierr);
+	ierr = PetibmPODCtxPrintf("POD", podCtx); CHKERRQ(ierr);
+
+	// create and read the grid, create the field
+	{
+		const PetscBool periodic[3] = {
+			fieldCtx.periodic_x, fieldCtx.periodic_y, fieldCtx.periodic_z};
+		ierr = PetibmGridInitialize(gridCtx, periodic, grid); CHKERRQ(ierr);
+	}
+	ierr = PetibmGridHDF5Read(gridCtx.path, gridCtx.name, grid); CHKERRQ(ierr);
+	ierr = PetibmFieldInitialize(fieldCtx, grid, pool, field); CHKERRQ(ierr);
+
+	// the snapshots are the saved time steps
+	for (ite=stepCtx.start; ite<=stepCtx.end; ite+=stepCtx.step)
+		steps.push_back(ite);
+	auto read = [&](const PetscInt s, PetibmField &snapshot) -> PetscErrorCode
+	{
+		PetscErrorCode ierr;
+		PetscFunctionBeginUser;
+		std::stringstream ss;
+		ss << std::setfill('0') << std::setw(7) << steps[s] << ".h5";
+		ierr = PetibmFieldHDF5Read(
+			directory+"/"+ss.str(), fieldCtx.name, snapshot); CHKERRQ(ierr);
+		PetscFunctionReturn(0);
+	};
+	auto write = [&](const PetscInt k, const PetibmField &mode) -> PetscErrorCode
+	{
+		PetscErrorCode ierr;
+		PetscFunctionBeginUser;
+		std::stringstream ss;
+		ss << "mode" << std::setfill('0') << std::setw(4) << k;
+		ierr = PetibmFieldHDF5Write(
+			outdir+"/pod-"+fieldCtx.name+".h5", ss.str(), mode); CHKERRQ(ierr);
+		ierr = PetscPrintf(
+			PETSC_COMM_WORLD, "\t- mode %d written\n", k); CHKERRQ(ierr);
+		PetscFunctionReturn(0);
+	};
+
+	// first passes: Gram matrix of the snapshots, then its eigenpairs
+	ierr = PetibmPODInitialize(
+		podCtx, grid, field, steps.size(), pod); CHKERRQ(ierr);
+	ierr = PetibmPODComputeGram(podCtx, read, field, pod); CHKERRQ(ierr);
+	ierr = PetscPrintf(PETSC_COMM_WORLD, "[Gram matrix] snapshots: %d, "
+	                   "reads: %d\n", pod.size, pod.reads); CHKERRQ(ierr);
+	ierr = PetibmPODSolve(podCtx, pod); CHKERRQ(ierr);
+	ierr = PetibmPODWriteEigenvalues(
+		outdir+"/pod-"+fieldCtx.name+"-eigenvalues.txt", pod); CHKERRQ(ierr);
+	ierr = PetibmPODWriteCoefficients(
+		outdir+"/pod-"+fieldCtx.name+"-coefficients.txt", steps,
+		podCtx.modes, pod); CHKERRQ(ierr);
+	// second pass: the modes
+	ierr = PetscPrintf(PETSC_COMM_WORLD, "[modes]\n"); CHKERRQ(ierr);
+	ierr = PetibmPODComputeModes(
+		podCtx, read, write, field, pod); CHKERRQ(ierr);
+	ierr = PetscPrintf(PETSC_COMM_WORLD, "\t- total reads: %d\n",
+	                   pod.reads); CHKERRQ(ierr);
+
+	ierr = PetibmPODDestroy(pod); CHKERRQ(ierr);
+	ierr = PetibmFieldDestroy(field); CHKERRQ(ierr);
+	ierr = PetibmGridDestroy(grid); CHKERRQ(ierr);
+	ierr = PetibmFieldPoolDestroy(pool); CHKERRQ(ierr);
+
+	ierr = PetscFinalize(); CHKERRQ(ierr);
+
+	return 0;
+} // main
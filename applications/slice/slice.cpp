@@ -0,0 +1,113 @@
+/*! Extracts a 2D slice of a 3D field at every saved time step.
+ * \file slice.cpp
+ */
+
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <sys/stat.h>
+
+#include <petscsys.h>
+
+#include "petibm-utilities/grid.h"
+#include "petibm-utilities/image.h"
+#include "petibm-utilities/misc.h"
+#include "petibm-utilities/slice.h"
+#include "petibm-utilities/timestep.h"
+
+
+int main(int argc, char **argv)
+{
+	PetscErrorCode ierr;
+	std::string directory, outdir;
+	PetibmGridCtx gridCtx;
+	PetibmFieldCtx fieldCtx;
+	PetibmSliceCtx sliceCtx;
+	PetibmTimeStepCtx stepCtx;
+	PetibmSlice slice;
+	PetibmImageCtx imageCtx;
+	PetibmImage image;
+	std::string extension;
+	PetscInt ite;
+	PetscBool found = PETSC_FALSE,
+	          render = PETSC_FALSE,
+	          writeSlice = PETSC_TRUE;
+
+	ierr = PetscInitialize(&argc, &argv, nullptr, nullptr); CHKERRQ(ierr);
+
+	// parse command-line options
+	ierr = PetibmGetDirectory(&directory); CHKERRQ(ierr);
+	ierr = PetibmTimeStepGetOptions(nullptr, &stepCtx); CHKERRQ(ierr);
+	ierr = PetibmGridGetOptions("grid_", &gridCtx); CHKERRQ(ierr);
+	ierr = PetibmFieldGetOptions("field_", &fieldCtx); CHKERRQ(ierr);
+	ierr = PetibmSliceGetOptions("slice_", &sliceCtx); CHKERRQ(ierr);
+	ierr = PetibmImageGetOptions("image_", &imageCtx); CHKERRQ(ierr);
+	ierr = PetibmImageGetExtension(imageCtx, &extension); CHKERRQ(ierr);
+	// render the slice into an image? write the 2D field?
+	ierr = PetscOptionsGetBool(
+		nullptr, nullptr, "-render", &render, &found); CHKERRQ(ierr);
+	ierr = PetscOptionsGetBool(
+		nullptr, nullptr, "-write_slice", &writeSlice, &found); CHKERRQ(ierr);
+	{
+		char dir[PETSC_MAX_PATH_LEN];
+		ierr = PetscOptionsGetString(nullptr, nullptr, "-output_directory",
+		                             dir, sizeof(dir), &found); CHKERRQ(ierr);
+		outdir = (!found) ? directory+"/slice" : dir;
+		mkdir((outdir).c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+	}
+	// default grid: group with the name of the field in the grid file
+	if (!std::strlen(gridCtx.path))
+	{
+		ierr = PetscStrcpy(
+			gridCtx.path, (directory+"/grid.h5").c_str()); CHKERRQ(ierr);
+	}
+	if (!std::strlen(gridCtx.name))
+	{
+		ierr = PetscStrcpy(gridCtx.name, fieldCtx.name); CHKERRQ(ierr);
+	}
+	ierr = PetibmGridCtxDetectSizes(
+		gridCtx.path, gridCtx.name, &gridCtx); CHKERRQ(ierr);
+	ierr = PetibmGridCtxPrintf("Grid", gridCtx); CHKERRQ(ierr);
+	ierr = PetibmFieldCtxPrintf("Field", fieldCtx); CHKERRQ(ierr);
+	ierr = PetibmSliceCtxPrintf("Slice", sliceCtx); CHKERRQ(ierr);
+
+	// bracket the slice and write its 2D grid
+	ierr = PetibmSliceInitialize(sliceCtx, gridCtx, slice); CHKERRQ(ierr);
+	if (writeSlice)
+	{
+		ierr = PetibmSliceGridHDF5Write(
+			outdir+"/grid.h5", fieldCtx.name, slice); CHKERRQ(ierr);
+	}
+
+	// loop over the time steps to extract the slice
+	for (ite=stepCtx.start; ite<=stepCtx.end; ite+=stepCtx.step)
+	{
+		ierr = PetscPrintf(
+			PETSC_COMM_WORLD, "[time-step %d]\n", ite); CHKERRQ(ierr);
+		// get name of time-step file
+		std::stringstream ss;
+		ss << std::setfill('0') << std::setw(7) << ite;
+		std::string filename(ss.str());
+		ierr = PetibmSliceHDF5Read(
+			directory+"/"+filename+".h5", fieldCtx.name, slice); CHKERRQ(ierr);
+		if (writeSlice)
+		{
+			ierr = PetibmSliceHDF5Write(
+				outdir+"/"+filename+".h5", fieldCtx.name, slice); CHKERRQ(ierr);
+		}
+		// frame rendered by the processes holding the slice
+		if (render and slice.comm != MPI_COMM_NULL)
+		{
+			ierr = PetibmImageRender(
+				imageCtx, slice.field, slice.stations, image); CHKERRQ(ierr);
+			ierr = PetibmImageWrite(outdir+"/"+filename+"-"+fieldCtx.name+
+			                        "."+extension, imageCtx, image); CHKERRQ(ierr);
+		}
+	}
+
+	ierr = PetibmSliceDestroy(slice); CHKERRQ(ierr);
+
+	ierr = PetscFinalize(); CHKERRQ(ierr);
+
+	return 0;
+} // main
@@ -0,0 +1,124 @@
+/*! Computes the 1D energy spectrum of a field along a periodic direction.
+ * \file spectra.cpp
+ */
+
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <sys/stat.h>
+
+#include <petscsys.h>
+
+#include "petibm-utilities/field.h"
+#include "petibm-utilities/grid.h"
+#include "petibm-utilities/misc.h"
+#include "petibm-utilities/spectra.h"
+#include "petibm-utilities/threads.h"
+#include "petibm-utilities/timestep.h"
+
+
+int main(int argc, char **argv)
+{
+	PetscErrorCode ierr;
+	std::string directory, outdir;
+	PetibmGrid grid;
+	PetibmGridCtx gridCtx;
+	PetibmField field;
+	PetibmFieldCtx fieldCtx;
+	PetibmFieldPool pool;
+	PetibmTimeStepCtx stepCtx;
+	PetibmSpectrum spectrum;
+	const char *const directions[] = {"x", "y", "z"};
+	const PetscBool *periodic[3] = {&fieldCtx.periodic_x, &fieldCtx.periodic_y,
+	                                &fieldCtx.periodic_z};
+	PetscInt direction = 2, ite, n;
+	PetscReal length;
+	Vec line;
+	const PetscReal *x;
+	PetscBool found = PETSC_FALSE;
+
+	ierr = PetscInitialize(&argc, &argv, nullptr, nullptr); CHKERRQ(ierr);
+	ierr = PetibmThreadsInitialize(); CHKERRQ(ierr);
+
+	// parse command-line options
+	ierr = PetibmGetDirectory(&directory); CHKERRQ(ierr);
+	ierr = PetibmTimeStepGetOptions(nullptr, &stepCtx); CHKERRQ(ierr);
+	ierr = PetibmGridGetOptions("grid_", &gridCtx); CHKERRQ(ierr);
+	ierr = PetibmFieldGetOptions("field_", &fieldCtx); CHKERRQ(ierr);
+	{
+		char dir[PETSC_MAX_PATH_LEN];
+		ierr = PetscOptionsGetString(nullptr, nullptr, "-output_directory",
+		                             dir, sizeof(dir), &found); CHKERRQ(ierr);
+		outdir = (!found) ? directory : dir;
+		mkdir((outdir).c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+	}
+	ierr = PetscOptionsGetEList(nullptr, nullptr, "-direction", directions, 3,
+	                            &direction, &found); CHKERRQ(ierr);
+	// default grid: group with the name of the field in the grid file
+	if (!std::strlen(gridCtx.path))
+	{
+		ierr = PetscStrcpy(
+			gridCtx.path, (directory+"/grid.h5").c_str()); CHKERRQ(ierr);
+	}
+	if (!std::strlen(gridCtx.name))
+	{
+		ierr = PetscStrcpy(gridCtx.name, fieldCtx.name); CHKERRQ(ierr);
+	}
+	ierr = PetibmGridCtxDetectSizes(
+		gridCtx.path, gridCtx.name, &gridCtx); CHKERRQ(ierr);
+	if (direction == 2 and gridCtx.nz <= 0)
+		SETERRQ(PETSC_COMM_WORLD, PETSC_ERR_ARG_OUTOFRANGE,
+		        "A 2D field has no z-direction");
+	if (!*periodic[direction])
+		SETERRQ1(PETSC_COMM_WORLD, PETSC_ERR_ARG_INCOMP,
+		         "The field should be periodic in the %s-direction",
+		         directions[direction]);
+	ierr = PetibmGridCtxPrintf("Grid", gridCtx); CHKERRQ(ierr);
+	ierr = PetibmFieldCtxPrintf("Field", fieldCtx); CHKERRQ(ierr);
+
+	// create and read the grid, create the field
+	ierr = PetibmGridInitialize(gridCtx, grid); CHKERRQ(ierr);
+	ierr = PetibmGridHDF5Read(gridCtx.path, gridCtx.name, grid); CHKERRQ(ierr);
+	ierr = PetibmFieldInitialize(fieldCtx, grid, pool, field); CHKERRQ(ierr);
+	// period: the stations span it less one spacing
+	n = (direction == 0) ? gridCtx.nx : (direction == 1) ? gridCtx.ny : gridCtx.nz;
+	ierr = PetibmGridlineHDF5ReadShared(
+		gridCtx.path, gridCtx.name, directions[direction], n,
+		&line); CHKERRQ(ierr);
+	ierr = VecGetArrayRead(line, &x); CHKERRQ(ierr);
+	length = (n > 1) ? x[n-1] - x[0] + x[1] - x[0] : 1.0;
+	ierr = VecRestoreArrayRead(line, &x); CHKERRQ(ierr);
+	ierr = VecDestroy(&line); CHKERRQ(ierr);
+	// the transpose plan is built once for all the time steps
+	ierr = PetibmSpectrumInitialize(
+		field, direction, length, spectrum); CHKERRQ(ierr);
+	std::string prefix = outdir+"/spectrum-"+fieldCtx.name+"-"+
+	                     directions[direction];
+	ierr = PetibmSpectrumWriteHeader(prefix+".txt", spectrum); CHKERRQ(ierr);
+
+	// loop over the time steps to accumulate the spectra
+	for (ite=stepCtx.start; ite<=stepCtx.end; ite+=stepCtx.step)
+	{
+		ierr = PetscPrintf(
+			PETSC_COMM_WORLD, "[time-step %d]\n", ite); CHKERRQ(ierr);
+		// get name of time-step file
+		std::stringstream ss;
+		ss << std::setfill('0') << std::setw(7) << ite << ".h5";
+		std::string filename(ss.str());
+		ierr = PetibmFieldHDF5Read(
+			directory+"/"+filename, fieldCtx.name, field); CHKERRQ(ierr);
+		ierr = PetibmSpectrumCompute(field, spectrum); CHKERRQ(ierr);
+		ierr = PetibmSpectrumWrite(prefix+".txt", ite, spectrum); CHKERRQ(ierr);
+	}
+	ierr = PetibmSpectrumWriteMean(prefix+"-mean.txt", spectrum); CHKERRQ(ierr);
+
+	ierr = PetibmSpectrumDestroy(spectrum); CHKERRQ(ierr);
+	ierr = PetibmFieldDestroy(field); CHKERRQ(ierr);
+	ierr = PetibmGridDestroy(grid); CHKERRQ(ierr);
+	ierr = PetibmFieldPoolDestroy(pool); CHKERRQ(ierr);
+
+	ierr = PetibmThreadsFinalize(); CHKERRQ(ierr);
+	ierr = PetscFinalize(); CHKERRQ(ierr);
+
+	return 0;
+} // main
@@ -0,0 +1,101 @@
+/*! Tests the real-to-complex discrete Fourier transform.
+ *
+ * The coefficients of lengths 1, primes, powers of 2 and mixed radices (even
+ * and odd) are checked against a direct transform, and the one-sided energies
+ * against Parseval's identity.
+ * \file test.cpp
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <vector>
+
+#include <petscsys.h>
+
+#include "petibm-utilities/fft.h"
+
+
+/*! Checks the transform of a sequence of a given length.
+ *
+ * \param n Length of the sequence.
+ * \param error Maximum error of the coefficients, relative to the sum of the
+ *        magnitudes of the sequence (passed by pointer).
+ * \param parseval Error of the sum of the energies, relative to the mean of
+ *        the squares of the sequence (passed by pointer).
+ */
+PetscErrorCode AppCheckLength(
+	const PetscInt n, PetscReal *error, PetscReal *parseval)
+{
+	PetscErrorCode ierr;
+	PetibmFFT fft;
+	std::vector<PetscReal> x(n);
+	std::vector<std::complex<PetscReal>> X(n/2+1), work;
+	PetscReal norm = 0.0, mean = 0.0, energy = 0.0;
+	PetscInt j, k;
+
+	PetscFunctionBeginUser;
+
+	ierr = PetibmFFTInitialize(n, fft); CHKERRQ(ierr);
+	work.resize(fft.worksize);
+	// no symmetry and a nonzero mean
+	for (j=0; j<n; j++)
+	{
+		x[j] = 0.3 + std::sin(1.3*j*j + 0.7) + 0.1*j*std::cos(2.9*j);
+		norm += std::abs(x[j]);
+		mean += x[j]*x[j] / n;
+	}
+	PetibmFFTExecute(fft, x.data(), X.data(), work.data());
+
+	*error = 0.0;
+	for (k=0; k<=n/2; k++)
+	{
+		std::complex<PetscReal> direct = 0.0;
+		// exact angles: the product j*k reduced modulo n
+		for (j=0; j<n; j++)
+			direct += x[j] * std::polar<PetscReal>(
+				1.0, -2.0*PETSC_PI*((j*k) % n)/n);
+		*error = std::max(*error, std::abs(X[k] - direct) / norm);
+		energy += ((k == 0 or 2*k == n) ? 1.0 : 2.0)
+		          * std::norm(X[k]) / ((PetscReal) n*n);
+	}
+	*parseval = std::abs(energy - mean) / mean;
+
+	PetscFunctionReturn(0);
+} // AppCheckLength
+
+
+int main(int argc, char **argv)
+{
+	PetscErrorCode ierr;
+	// 1, primes, powers of 2, mixed radices
+	const PetscInt lengths[] = {1, 2, 3, 5, 7, 13, 31, 97, 127,
+	                            4, 8, 16, 64, 256, 1024,
+	                            6, 9, 12, 15, 30, 45, 60, 100, 210, 243,
+	                            360, 1000, 2*3*5*7*11};
+	PetscReal error, parseval, tol = 1.0e-12;
+	PetscBool found;
+
+	ierr = PetscInitialize(&argc, &argv, nullptr, nullptr); CHKERRQ(ierr);
+
+	ierr = PetscOptionsGetReal(nullptr, nullptr, "-tolerance",
+	                           &tol, &found); CHKERRQ(ierr);
+
+	for (const PetscInt n : lengths)
+	{
+		ierr = AppCheckLength(n, &error, &parseval); CHKERRQ(ierr);
+		if (error > tol)
+			SETERRQ2(PETSC_COMM_WORLD, PETSC_ERR_PLIB,
+			         "Transform of length %D: error %g", n, (double) error);
+		if (parseval > tol)
+			SETERRQ2(PETSC_COMM_WORLD, PETSC_ERR_PLIB,
+			         "Transform of length %D: energies off by %g",
+			         n, (double) parseval);
+		ierr = PetscPrintf(PETSC_COMM_WORLD, "length %d: ok (error %g, "
+		                   "Parseval %g)\n", n, error, parseval); CHKERRQ(ierr);
+	}
+
+	ierr = PetscFinalize(); CHKERRQ(ierr);
+
+	return 0;
+} // main
@@ -0,0 +1,229 @@
+/*! Measures the effective memory bandwidth of the vorticity kernels.
+ * \file stencilbench.cpp
+ */
+
+#include <string>
+
+#include <petscsys.h>
+#include <petscdmda.h>
+
+#include "petibm-utilities/expression.h"
+#include "petibm-utilities/field.h"
+#include "petibm-utilities/grid.h"
+#include "petibm-utilities/misc.h"
+#include "petibm-utilities/threads.h"
+#include "petibm-utilities/vorticity.h"
+
+
+/*! Measures the bandwidth of the STREAM triad a = b + s * c on the local
+ * values of three vectors, keeping the best time over the repetitions.
+ *
+ * \param a The vector to compute.
+ * \param b The first vector.
+ * \param c The second vector.
+ * \param repeat Number of repetitions.
+ * \param time Best time (passed by pointer).
+ */
+PetscErrorCode AppTriad(Vec a, Vec b, Vec c, const PetscInt repeat,
+                        PetscReal *time)
+{
+	PetscErrorCode ierr;
+	PetscScalar *a_a, *b_a, *c_a;
+	PetscInt n, r;
+	PetscReal t;
+	const PetscScalar s = 3.0;
+
+	PetscFunctionBeginUser;
+
+	ierr = VecGetLocalSize(a, &n); CHKERRQ(ierr);
+	ierr = VecGetArray(a, &a_a); CHKERRQ(ierr);
+	ierr = VecGetArray(b, &b_a); CHKERRQ(ierr);
+	ierr = VecGetArray(c, &c_a); CHKERRQ(ierr);
+	*time = PETSC_MAX_REAL;
+	for (r=0; r<repeat; r++)
+	{
+		ierr = MPI_Barrier(PETSC_COMM_WORLD); CHKERRQ(ierr);
+		t = MPI_Wtime();
+		ierr = PetibmThreadsRun([&](const PetscInt tid, const PetscInt nt)
+		{
+			PetscInt i, start, end;
+			PetibmThreadsGetSlab(0, n, tid, nt, &start, &end);
+			for (i=start; i<end; i++)
+				a_a[i] = b_a[i] + s * c_a[i];
+		}); CHKERRQ(ierr);
+		ierr = MPI_Barrier(PETSC_COMM_WORLD); CHKERRQ(ierr);
+		*time = PetscMin(*time, MPI_Wtime() - t);
+	}
+	ierr = VecRestoreArray(a, &a_a); CHKERRQ(ierr);
+	ierr = VecRestoreArray(b, &b_a); CHKERRQ(ierr);
+	ierr = VecRestoreArray(c, &c_a); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // AppTriad
+
+
+int main(int argc, char **argv)
+{
+	PetscErrorCode ierr;
+	PetibmGridCtx gridCtx;
+	PetibmVorticityCtx tiledCtx;
+	PetibmDerivativeOperator d1, d2;
+	PetibmQuantityArgs args;
+	PetibmGrid grid;
+	PetibmField u, v, w;
+	PetibmFieldPool pool;
+	DM da;
+	Vec *coords[3] = {&grid.x.coords, &grid.y.coords, &grid.z.coords};
+	PetscInt repeat = 5, dim, sizes[3], M, d, r, c;
+	PetscReal *arr, time, t, triad, gbytes, norm;
+	PetscMPIInt size;
+	PetscBool found = PETSC_FALSE;
+
+	ierr = PetscInitialize(&argc, &argv, nullptr, nullptr); CHKERRQ(ierr);
+	ierr = PetibmThreadsInitialize(); CHKERRQ(ierr);
+
+	ierr = MPI_Comm_size(PETSC_COMM_WORLD, &size); CHKERRQ(ierr);
+
+	// parse command-line options
+	gridCtx.nx = gridCtx.ny = gridCtx.nz = 256;
+	ierr = PetibmGridGetOptions(nullptr, &gridCtx); CHKERRQ(ierr);
+	ierr = PetibmVorticityGetOptions(nullptr, &tiledCtx); CHKERRQ(ierr);
+	ierr = PetscOptionsGetInt(
+		nullptr, nullptr, "-repeat", &repeat, &found); CHKERRQ(ierr);
+	dim = (gridCtx.nz > 0) ? 3 : 2;
+	sizes[0] = gridCtx.nx;
+	sizes[1] = gridCtx.ny;
+	sizes[2] = gridCtx.nz;
+
+	// velocity and vorticity fields share the layout of a ghosted DMDA
+	if (dim == 3)
+	{
+		ierr = DMDACreate3d(PETSC_COMM_WORLD,
+		                    DM_BOUNDARY_GHOSTED, DM_BOUNDARY_GHOSTED,
+		                    DM_BOUNDARY_GHOSTED,
+		                    DMDA_STENCIL_STAR,
+		                    gridCtx.nx, gridCtx.ny, gridCtx.nz,
+		                    PETSC_DECIDE, PETSC_DECIDE, PETSC_DECIDE,
+		                    1, tiledCtx.order/2, nullptr, nullptr, nullptr,
+		                    &da); CHKERRQ(ierr);
+	}
+	else
+	{
+		ierr = DMDACreate2d(PETSC_COMM_WORLD,
+		                    DM_BOUNDARY_GHOSTED, DM_BOUNDARY_GHOSTED,
+		                    DMDA_STENCIL_STAR,
+		                    gridCtx.nx, gridCtx.ny,
+		                    PETSC_DECIDE, PETSC_DECIDE,
+		                    1, tiledCtx.order/2, nullptr, nullptr,
+		                    &da); CHKERRQ(ierr);
+	}
+	ierr = DMSetFromOptions(da); CHKERRQ(ierr);
+	ierr = DMSetUp(da); CHKERRQ(ierr);
+	// each field holds a reference to the pooled DMDA
+	for (PetibmField *f : {&u, &v, &w})
+	{
+		f->da = da;
+		ierr = PetibmFieldInitialize(pool, *f); CHKERRQ(ierr);
+	}
+	ierr = VecSetRandom(u.global, nullptr); CHKERRQ(ierr);
+	ierr = VecSetRandom(v.global, nullptr); CHKERRQ(ierr);
+	// uniform stations, held by every process
+	grid.dim = dim;
+	for (d=0; d<dim; d++)
+	{
+		ierr = VecCreateSeq(
+			PETSC_COMM_SELF, sizes[d], coords[d]); CHKERRQ(ierr);
+		ierr = VecGetArray(*coords[d], &arr); CHKERRQ(ierr);
+		for (PetscInt i=0; i<sizes[d]; i++)
+			arr[i] = (PetscReal) i / sizes[d];
+		ierr = VecRestoreArray(*coords[d], &arr); CHKERRQ(ierr);
+	}
+	if (dim == 3)
+	{
+		ierr = PetibmVorticityXCreateOperators(
+			tiledCtx, grid, grid, grid, d1, d2); CHKERRQ(ierr);
+	}
+	else
+	{
+		ierr = PetibmVorticityZCreateOperators(
+			tiledCtx, grid, grid, grid, d1, d2); CHKERRQ(ierr);
+	}
+	// inputs of the same component computed by the expression engine
+	args.u[dim-2] = &u;
+	args.u[dim-1] = &v;
+	args.d[dim-2] = &d1;
+	args.d[dim-1] = &d2;
+	ierr = VecGetSize(w.global, &M); CHKERRQ(ierr);
+	// compulsory traffic: two velocity components read, the vorticity written
+	gbytes = 3.0 * M * sizeof(PetscScalar) / 1.0e9;
+
+	ierr = AppTriad(w.global, u.global, v.global, repeat, &triad); CHKERRQ(ierr);
+	ierr = PetscPrintf(PETSC_COMM_WORLD,
+	                   "[%d processes, %D points, order %D, %g GB per sweep, "
+	                   "best of %D]\n",
+	                   size, M, tiledCtx.order, gbytes, repeat); CHKERRQ(ierr);
+	ierr = PetscPrintf(PETSC_COMM_WORLD, "%-24s %12s %10s\n",
+	                   "kernel", "GB/s", "of triad"); CHKERRQ(ierr);
+	ierr = PetscPrintf(PETSC_COMM_WORLD, "%-24s %12.3f %9.1f%%\n",
+	                   "STREAM triad", gbytes / triad, 100.0); CHKERRQ(ierr);
+	// untiled and tiled traversals, through pointer tables and flat indexing,
+	// then the fused loop of the expression engine
+	for (c=0; c<5; c++)
+	{
+		PetibmVorticityCtx ctx = tiledCtx;
+		const std::string name = (dim == 3) ? "wx" : "wz";
+		std::string label = name;
+		ctx.flat = (c % 2) ? PETSC_TRUE : PETSC_FALSE;
+		if (c < 2)
+			ctx.tile_j = ctx.tile_k = 0;
+		if (c < 4)
+		{
+			label += (c < 2) ? " untiled" : " tiled";
+			label += (ctx.flat) ? " flat" : " pointers";
+		}
+		else
+			label += " expression";
+		time = PETSC_MAX_REAL;
+		for (r=0; r<repeat; r++)
+		{
+			ierr = MPI_Barrier(PETSC_COMM_WORLD); CHKERRQ(ierr);
+			t = MPI_Wtime();
+			// the ghost update of the velocity is part of the measured time
+			if (c == 4)
+			{
+				ierr = PetibmQuantityCompute(name, args, w); CHKERRQ(ierr);
+			}
+			else if (dim == 3)
+			{
+				ierr = PetibmVorticityXComputeField(
+					ctx, d1, d2, u, v, w); CHKERRQ(ierr);
+			}
+			else
+			{
+				ierr = PetibmVorticityZComputeField(
+					ctx, d1, d2, u, v, w); CHKERRQ(ierr);
+			}
+			ierr = MPI_Barrier(PETSC_COMM_WORLD); CHKERRQ(ierr);
+			time = PetscMin(time, MPI_Wtime() - t);
+		}
+		ierr = VecNorm(w.global, NORM_1, &norm); CHKERRQ(ierr);
+		ierr = PetscPrintf(PETSC_COMM_WORLD, "%-24s %12.3f %9.1f%% (|w|_1 = %g)\n",
+		                   label.c_str(), gbytes / time,
+		                   100.0 * triad / time, norm); CHKERRQ(ierr);
+	}
+
+	for (d=0; d<dim; d++)
+	{
+		ierr = VecDestroy(coords[d]); CHKERRQ(ierr);
+	}
+	ierr = PetibmDerivativeOperatorDestroy(d1); CHKERRQ(ierr);
+	ierr = PetibmDerivativeOperatorDestroy(d2); CHKERRQ(ierr);
+	ierr = PetibmFieldDestroy(u); CHKERRQ(ierr);
+	ierr = PetibmFieldDestroy(v); CHKERRQ(ierr);
+	ierr = PetibmFieldDestroy(w); CHKERRQ(ierr);
+	ierr = PetibmFieldPoolDestroy(pool); CHKERRQ(ierr);
+	ierr = PetibmThreadsFinalize(); CHKERRQ(ierr);
+	ierr = PetscFinalize(); CHKERRQ(ierr);
+
+	return 0;
+} // main
@@ -0,0 +1,311 @@
+/*! Tests the quantities computed by the expression engine.
+ *
+ * On the periodic unit cube, stretched in every direction:
+ * `wz` should match the z-vorticity of PetibmVorticityZComputeField (orders
+ * 2 and 4) to round-off, and `divergence` of u = sin(2 pi x),
+ * v = sin(2 pi y), w = sin(2 pi z), with operators from the faces to the cell
+ * centers, should converge at second order to 2 pi (cos(2 pi x) +
+ * cos(2 pi y) + cos(2 pi z)).
+ * \file test.cpp
+ */
+
+#include <cmath>
+
+#include <petscsys.h>
+#include <petscdmda.h>
+
+#include "petibm-utilities/expression.h"
+#include "petibm-utilities/field.h"
+#include "petibm-utilities/grid.h"
+#include "petibm-utilities/threads.h"
+#include "petibm-utilities/vorticity.h"
+
+
+/*! Stretched coordinate, x(0) = 0 and x(1) = 1 with x(s+1) = x(s)+1.
+ *
+ * \param s Uniform coordinate.
+ */
+PetscReal AppStretch(const PetscReal s)
+{
+	return s + 0.5 * std::sin(2.0*PETSC_PI*s) / (2.0*PETSC_PI);
+} // AppStretch
+
+
+/*! Creates the stations of a periodic gridline of n cells.
+ *
+ * The faces are at the stretched coordinates of s = (i+1)/n and the cell
+ * centers midway between two faces, so that the first boundary (x = 0) is
+ * mirrored from the first center and face.
+ *
+ * \param n Number of cells.
+ * \param faces Stations of the faces (passed by pointer).
+ * \param centers Stations of the cell centers (passed by pointer).
+ */
+PetscErrorCode AppCreateStations(const PetscInt n, Vec *faces, Vec *centers)
+{
+	PetscErrorCode ierr;
+	PetscReal *f, *c;
+	PetscInt i;
+
+	PetscFunctionBeginUser;
+
+	ierr = VecCreateSeq(PETSC_COMM_SELF, n, faces); CHKERRQ(ierr);
+	ierr = VecCreateSeq(PETSC_COMM_SELF, n, centers); CHKERRQ(ierr);
+	ierr = VecGetArray(*faces, &f); CHKERRQ(ierr);
+	ierr = VecGetArray(*centers, &c); CHKERRQ(ierr);
+	for (i=0; i<n; i++)
+	{
+		f[i] = AppStretch((i+1.0)/n);
+		c[i] = 0.5*(((i > 0) ? f[i-1] : 0.0) + f[i]);
+	}
+	ierr = VecRestoreArray(*centers, &c); CHKERRQ(ierr);
+	ierr = VecRestoreArray(*faces, &f); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // AppCreateStations
+
+
+/*! Sets a field to sin(2 pi s), s being the station along an axis.
+ *
+ * \param stations The stations of the field along the axis.
+ * \param axis The axis (0: x, 1: y, 2: z).
+ * \param field The field (passed by reference).
+ */
+PetscErrorCode AppSetSine(
+	const Vec stations, const PetscInt axis, PetibmField &field)
+{
+	PetscErrorCode ierr;
+	DMDALocalInfo info;
+	const PetscReal *s;
+	PetscReal ***f;
+	PetscInt i, j, k;
+
+	PetscFunctionBeginUser;
+
+	ierr = DMDAGetLocalInfo(field.da, &info); CHKERRQ(ierr);
+	ierr = VecGetArrayRead(stations, &s); CHKERRQ(ierr);
+	ierr = DMDAVecGetArray(field.da, field.global, &f); CHKERRQ(ierr);
+	for (k=info.zs; k<info.zs+info.zm; k++)
+		for (j=info.ys; j<info.ys+info.ym; j++)
+			for (i=info.xs; i<info.xs+info.xm; i++)
+				f[k][j][i] = std::sin(
+					2.0*PETSC_PI*s[(axis == 0) ? i : (axis == 1) ? j : k]);
+	ierr = DMDAVecRestoreArray(field.da, field.global, &f); CHKERRQ(ierr);
+	ierr = VecRestoreArrayRead(stations, &s); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // AppSetSine
+
+
+/*! Computes the z-vorticity with the kernel and with the expression engine
+ * on a grid of n x n x 4 cells and gets their difference.
+ *
+ * \param n Number of cells in the x- and y-directions.
+ * \param order Order of accuracy of the derivatives.
+ * \param diff Maximum difference, relative to the maximum vorticity (passed
+ *        by pointer).
+ */
+PetscErrorCode AppCompareVorticity(
+	const PetscInt n, const PetscInt order, PetscReal *diff)
+{
+	PetscErrorCode ierr;
+	PetibmGridCtx gridCtx;
+	PetibmFieldCtx fieldCtx;
+	PetibmVorticityCtx vortCtx;
+	PetibmGrid gridux, griduy, gridwz;
+	PetibmDerivativeOperator dx, dy;
+	PetibmFieldPool pool;
+	PetibmField ux, uy, wz, expr;
+	PetibmQuantityArgs args;
+	const PetscBool less[3] = {PETSC_TRUE, PETSC_TRUE, PETSC_FALSE};
+	DM da;
+	PetscReal norm;
+
+	PetscFunctionBeginUser;
+
+	gridCtx.nx = gridCtx.ny = n;
+	gridCtx.nz = 4;
+	fieldCtx.periodic_x = fieldCtx.periodic_y = fieldCtx.periodic_z = PETSC_TRUE;
+	vortCtx.order = order;
+
+	ierr = AppCreateStations(
+		n, &gridux.x.coords, &griduy.x.coords); CHKERRQ(ierr);
+	ierr = AppCreateStations(
+		n, &griduy.y.coords, &gridux.y.coords); CHKERRQ(ierr);
+	gridwz.dim = 2;
+	ierr = VecCreateSeq(PETSC_COMM_SELF, n-1, &gridwz.x.coords); CHKERRQ(ierr);
+	ierr = VecCreateSeq(PETSC_COMM_SELF, n-1, &gridwz.y.coords); CHKERRQ(ierr);
+	ierr = PetibmVorticityZComputeGrid(gridux, griduy, gridwz); CHKERRQ(ierr);
+	ierr = PetibmVorticityZCreateOperators(
+		vortCtx, gridux, griduy, gridwz, dx, dy); CHKERRQ(ierr);
+
+	ierr = PetibmVorticityCreateDM(gridCtx, fieldCtx, &da); CHKERRQ(ierr);
+	ierr = PetibmVorticityCreateVelocityDM(
+		da, 0, DMDA_STENCIL_BOX, order/2, &ux.da); CHKERRQ(ierr);
+	ierr = PetibmFieldInitialize(pool, ux); CHKERRQ(ierr);
+	ierr = PetibmVorticityCreateVelocityDM(
+		da, 1, DMDA_STENCIL_BOX, order/2, &uy.da); CHKERRQ(ierr);
+	ierr = PetibmFieldInitialize(pool, uy); CHKERRQ(ierr);
+	ierr = PetibmVorticityCreateStaggeredDM(
+		da, less, DMDA_STENCIL_STAR, 1, &wz.da); CHKERRQ(ierr);
+	ierr = PetibmFieldInitialize(pool, wz); CHKERRQ(ierr);
+	ierr = PetibmVorticityCreateStaggeredDM(
+		da, less, DMDA_STENCIL_STAR, 1, &expr.da); CHKERRQ(ierr);
+	ierr = PetibmFieldInitialize(pool, expr); CHKERRQ(ierr);
+
+	ierr = AppSetSine(gridux.y.coords, 1, ux); CHKERRQ(ierr);
+	ierr = AppSetSine(griduy.x.coords, 0, uy); CHKERRQ(ierr);
+
+	ierr = PetibmVorticityZComputeField(
+		vortCtx, dx, dy, ux, uy, wz); CHKERRQ(ierr);
+	args.u[0] = &ux;
+	args.u[1] = &uy;
+	args.d[0] = &dx;
+	args.d[1] = &dy;
+	ierr = PetibmQuantityCompute("wz", args, expr); CHKERRQ(ierr);
+
+	ierr = VecNorm(wz.global, NORM_INFINITY, &norm); CHKERRQ(ierr);
+	ierr = VecAXPY(expr.global, -1.0, wz.global); CHKERRQ(ierr);
+	ierr = VecNorm(expr.global, NORM_INFINITY, diff); CHKERRQ(ierr);
+	*diff /= norm;
+
+	ierr = PetibmDerivativeOperatorDestroy(dx); CHKERRQ(ierr);
+	ierr = PetibmDerivativeOperatorDestroy(dy); CHKERRQ(ierr);
+	ierr = PetibmFieldDestroy(ux); CHKERRQ(ierr);
+	ierr = PetibmFieldDestroy(uy); CHKERRQ(ierr);
+	ierr = PetibmFieldDestroy(wz); CHKERRQ(ierr);
+	ierr = PetibmFieldDestroy(expr); CHKERRQ(ierr);
+	ierr = DMDestroy(&da); CHKERRQ(ierr);
+	ierr = PetibmFieldPoolDestroy(pool); CHKERRQ(ierr);
+	ierr = PetibmGridDestroy(gridux); CHKERRQ(ierr);
+	ierr = PetibmGridDestroy(griduy); CHKERRQ(ierr);
+	ierr = PetibmGridDestroy(gridwz); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // AppCompareVorticity
+
+
+/*! Computes the divergence on a grid of n x n x n cells and gets the error.
+ *
+ * \param n Number of cells in each direction.
+ * \param error Maximum error (passed by pointer).
+ */
+PetscErrorCode AppDivergenceError(const PetscInt n, PetscReal *error)
+{
+	PetscErrorCode ierr;
+	PetibmGridCtx gridCtx;
+	PetibmFieldCtx fieldCtx;
+	PetibmFieldPool pool;
+	PetibmField u[3], div;
+	PetibmDerivativeOperator d[3];
+	PetibmQuantityArgs args;
+	Vec faces[3], centers[3];
+	DM da;
+	DMDALocalInfo info;
+	const PetscReal *c[3];
+	PetscReal ***div_a, exact;
+	PetscInt a, i, j, k;
+
+	PetscFunctionBeginUser;
+
+	gridCtx.nx = gridCtx.ny = gridCtx.nz = n;
+	fieldCtx.periodic_x = fieldCtx.periodic_y = fieldCtx.periodic_z = PETSC_TRUE;
+	ierr = PetibmVorticityCreateDM(gridCtx, fieldCtx, &da); CHKERRQ(ierr);
+	for (a=0; a<3; a++)
+	{
+		ierr = AppCreateStations(n, faces+a, centers+a); CHKERRQ(ierr);
+		// from the faces of the component to the cell centers
+		ierr = PetibmDerivativeOperatorCreate(
+			faces[a], n, 2, PETIBM_DERIVATIVE_BACKWARD, 1.0, d[a]); CHKERRQ(ierr);
+		ierr = PetibmVorticityCreateVelocityDM(
+			da, a, DMDA_STENCIL_STAR, 1, &u[a].da); CHKERRQ(ierr);
+		ierr = PetibmFieldInitialize(pool, u[a]); CHKERRQ(ierr);
+		ierr = AppSetSine(faces[a], a, u[a]); CHKERRQ(ierr);
+		args.u[a] = u + a;
+		args.d[a] = d + a;
+	}
+	ierr = PetscObjectReference((PetscObject) da); CHKERRQ(ierr);
+	div.da = da;
+	ierr = PetibmFieldInitialize(pool, div); CHKERRQ(ierr);
+
+	ierr = PetibmQuantityCompute("divergence", args, div); CHKERRQ(ierr);
+
+	ierr = DMDAGetLocalInfo(div.da, &info); CHKERRQ(ierr);
+	for (a=0; a<3; a++)
+	{
+		ierr = VecGetArrayRead(centers[a], c+a); CHKERRQ(ierr);
+	}
+	ierr = DMDAVecGetArray(div.da, div.global, &div_a); CHKERRQ(ierr);
+	*error = 0.0;
+	for (k=info.zs; k<info.zs+info.zm; k++)
+		for (j=info.ys; j<info.ys+info.ym; j++)
+			for (i=info.xs; i<info.xs+info.xm; i++)
+			{
+				exact = 2.0*PETSC_PI*(std::cos(2.0*PETSC_PI*c[0][i]) +
+				                      std::cos(2.0*PETSC_PI*c[1][j]) +
+				                      std::cos(2.0*PETSC_PI*c[2][k]));
+				*error = PetscMax(*error, std::abs(div_a[k][j][i] - exact));
+			}
+	ierr = DMDAVecRestoreArray(div.da, div.global, &div_a); CHKERRQ(ierr);
+	ierr = MPI_Allreduce(MPI_IN_PLACE, error, 1, MPIU_REAL, MPI_MAX,
+	                     PETSC_COMM_WORLD); CHKERRQ(ierr);
+
+	for (a=0; a<3; a++)
+	{
+		ierr = VecRestoreArrayRead(centers[a], c+a); CHKERRQ(ierr);
+		ierr = VecDestroy(faces+a); CHKERRQ(ierr);
+		ierr = VecDestroy(centers+a); CHKERRQ(ierr);
+		ierr = PetibmDerivativeOperatorDestroy(d[a]); CHKERRQ(ierr);
+		ierr = PetibmFieldDestroy(u[a]); CHKERRQ(ierr);
+	}
+	ierr = PetibmFieldDestroy(div); CHKERRQ(ierr);
+	ierr = DMDestroy(&da); CHKERRQ(ierr);
+	ierr = PetibmFieldPoolDestroy(pool); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // AppDivergenceError
+
+
+int main(int argc, char **argv)
+{
+	PetscErrorCode ierr;
+	const PetscInt orders[2] = {2, 4};
+	PetscReal diff, error[2], rate, tol = 1.0e-12;
+	PetscInt o, r;
+	PetscBool found;
+
+	ierr = PetscInitialize(&argc, &argv, nullptr, nullptr); CHKERRQ(ierr);
+	ierr = PetibmThreadsInitialize(); CHKERRQ(ierr);
+
+	ierr = PetscOptionsGetReal(nullptr, nullptr, "-tolerance",
+	                           &tol, &found); CHKERRQ(ierr);
+
+	for (o=0; o<2; o++)
+	{
+		ierr = AppCompareVorticity(32, orders[o], &diff); CHKERRQ(ierr);
+		ierr = PetscPrintf(PETSC_COMM_WORLD, "wz (order %d): difference %g\n",
+		                   orders[o], diff); CHKERRQ(ierr);
+		if (diff > tol)
+			SETERRQ2(PETSC_COMM_WORLD, PETSC_ERR_PLIB,
+			         "Quantity wz (order %D) differs from the kernel by %g",
+			         orders[o], (double) diff);
+	}
+
+	for (r=0; r<2; r++)
+	{
+		ierr = AppDivergenceError(16 << r, error+r); CHKERRQ(ierr);
+		ierr = PetscPrintf(PETSC_COMM_WORLD, "divergence, %d cells: error "
+		                   "%g\n", 16 << r, error[r]); CHKERRQ(ierr);
+	}
+	rate = std::log2(error[0]/error[1]);
+	ierr = PetscPrintf(PETSC_COMM_WORLD, "divergence: rate of convergence "
+	                   "%g\n", rate); CHKERRQ(ierr);
+	if (rate < 1.5)
+		SETERRQ1(PETSC_COMM_WORLD, PETSC_ERR_PLIB,
+		         "The divergence converges at rate %g", (double) rate);
+
+	ierr = PetibmThreadsFinalize(); CHKERRQ(ierr);
+	ierr = PetscFinalize(); CHKERRQ(ierr);
+
+	return 0;
+} // main
@@ -0,0 +1,122 @@
+/*! Computes the streamfunction from the 2D vorticity field.
+ * \file streamfunction.cpp
+ */
+
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <sys/stat.h>
+
+#include <petscsys.h>
+
+#include "petibm-utilities/field.h"
+#include "petibm-utilities/grid.h"
+#include "petibm-utilities/misc.h"
+#include "petibm-utilities/streamfunction.h"
+#include "petibm-utilities/timestep.h"
+
+
+int main(int argc, char **argv)
+{
+	PetscErrorCode ierr;
+	std::string directory, outdir;
+	PetibmGrid grid, gridout;
+	PetibmGridCtx gridCtx;
+	PetibmField wz, psi;
+	PetibmFieldCtx fieldCtx;
+	PetibmFieldPool pool;
+	PetibmTimeStepCtx stepCtx;
+	PetibmStreamFunction solver;
+	PetscInt ite, its;
+	PetscReal rnorm;
+	PetscBool found = PETSC_FALSE;
+
+	ierr = PetscInitialize(&argc, &argv, nullptr, nullptr); CHKERRQ(ierr);
+
+	// parse command-line options
+	ierr = PetibmGetDirectory(&directory); CHKERRQ(ierr);
+	ierr = PetibmTimeStepGetOptions(nullptr, &stepCtx); CHKERRQ(ierr);
+	ierr = PetibmGridGetOptions("grid_", &gridCtx); CHKERRQ(ierr);
+	ierr = PetibmFieldGetOptions("field_", &fieldCtx); CHKERRQ(ierr);
+	{
+		char dir[PETSC_MAX_PATH_LEN];
+		ierr = PetscOptionsGetString(nullptr, nullptr, "-output_directory",
+		                             dir, sizeof(dir), &found); CHKERRQ(ierr);
+		outdir = (!found) ? directory : dir;
+		mkdir((outdir).c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+	}
+	// default field: the z-vorticity written by petibm-vorticity2d
+	if (!std::strlen(fieldCtx.name))
+	{
+		ierr = PetscStrcpy(fieldCtx.name, "wz"); CHKERRQ(ierr);
+	}
+	// default grid: group with the name of the field in the grid file
+	if (!std::strlen(gridCtx.path))
+	{
+		ierr = PetscStrcpy(
+			gridCtx.path, (directory+"/grid.h5").c_str()); CHKERRQ(ierr);
+	}
+	if (!std::strlen(gridCtx.name))
+	{
+		ierr = PetscStrcpy(gridCtx.name, fieldCtx.name); CHKERRQ(ierr);
+	}
+	ierr = PetibmGridCtxDetectSizes(
+		gridCtx.path, gridCtx.name, &gridCtx); CHKERRQ(ierr);
+	if (gridCtx.nz > 0)
+		SETERRQ(PETSC_COMM_WORLD, PETSC_ERR_SUP,
+		        "The streamfunction is only computed from 2D fields");
+	ierr = PetibmGridCtxPrintf("Grid", gridCtx); CHKERRQ(ierr);
+	ierr = PetibmFieldCtxPrintf("Field", fieldCtx); CHKERRQ(ierr);
+
+	// create and read the grid, create the fields
+	ierr = PetibmGridInitialize(gridCtx, grid); CHKERRQ(ierr);
+	ierr = PetibmGridHDF5Read(gridCtx.path, gridCtx.name, grid); CHKERRQ(ierr);
+	ierr = PetibmFieldInitialize(fieldCtx, grid, pool, wz); CHKERRQ(ierr);
+	psi.da = wz.da;
+	ierr = PetibmFieldInitialize(pool, psi); CHKERRQ(ierr);
+	ierr = VecSet(psi.global, 0.0); CHKERRQ(ierr);
+	// the streamfunction lives on the grid of the vorticity
+	gridout.dim = 2;
+	ierr = PetibmGridlineHDF5ReadShared(
+		gridCtx.path, gridCtx.name, "x", gridCtx.nx,
+		&gridout.x.coords); CHKERRQ(ierr);
+	ierr = PetibmGridlineHDF5ReadShared(
+		gridCtx.path, gridCtx.name, "y", gridCtx.ny,
+		&gridout.y.coords); CHKERRQ(ierr);
+	ierr = PetibmGridHDF5Write(outdir+"/grid.h5", "psi", gridout); CHKERRQ(ierr);
+	ierr = PetibmStreamFunctionInitialize(grid, wz.da, solver); CHKERRQ(ierr);
+	ierr = PetscPrintf(PETSC_COMM_WORLD, "+ Solver:\n\t- %s (%d levels)\n",
+	                   (solver.levels > 2) ? "geometric multigrid" :
+	                   "algebraic multigrid", solver.levels); CHKERRQ(ierr);
+
+	// loop over the time steps, each solve starting from the previous solution
+	for (ite=stepCtx.start; ite<=stepCtx.end; ite+=stepCtx.step)
+	{
+		ierr = PetscPrintf(
+			PETSC_COMM_WORLD, "[time-step %d]\n", ite); CHKERRQ(ierr);
+		// get name of time-step file
+		std::stringstream ss;
+		ss << std::setfill('0') << std::setw(7) << ite << ".h5";
+		std::string filename(ss.str());
+		ierr = PetibmFieldHDF5Read(
+			directory+"/"+filename, fieldCtx.name, wz); CHKERRQ(ierr);
+		ierr = PetibmStreamFunctionSolve(solver, wz, psi); CHKERRQ(ierr);
+		ierr = KSPGetIterationNumber(solver.ksp, &its); CHKERRQ(ierr);
+		ierr = KSPGetResidualNorm(solver.ksp, &rnorm); CHKERRQ(ierr);
+		ierr = PetscPrintf(PETSC_COMM_WORLD,
+		                   "\t- iterations: %d (residual: %g)\n",
+		                   its, rnorm); CHKERRQ(ierr);
+		ierr = PetibmFieldHDF5Write(outdir+"/"+filename, "psi", psi); CHKERRQ(ierr);
+	}
+
+	ierr = PetibmStreamFunctionDestroy(solver); CHKERRQ(ierr);
+	ierr = PetibmFieldDestroy(wz); CHKERRQ(ierr);
+	ierr = PetibmFieldDestroy(psi); CHKERRQ(ierr);
+	ierr = PetibmGridDestroy(grid); CHKERRQ(ierr);
+	ierr = PetibmGridDestroy(gridout); CHKERRQ(ierr);
+	ierr = PetibmFieldPoolDestroy(pool); CHKERRQ(ierr);
+
+	ierr = PetscFinalize(); CHKERRQ(ierr);
+
+	return 0;
+} // main
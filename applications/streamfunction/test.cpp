@@ -0,0 +1,161 @@
+/*! Tests the solver of the streamfunction with manufactured solutions.
+ *
+ * psi = sin(pi x) sin(pi y) on the unit square, zero on the boundaries, and
+ * psi = sin(2 pi x) sin(2 pi y) on the periodic unit square (`-periodic`),
+ * on a stretched grid; the solver should converge at second order and a
+ * warm-started solve of a nearby vorticity should take fewer iterations than
+ * the first solve.
+ * \file test.cpp
+ */
+
+#include <cmath>
+
+#include <petscsys.h>
+
+#include "petibm-utilities/field.h"
+#include "petibm-utilities/grid.h"
+#include "petibm-utilities/streamfunction.h"
+
+
+/*! Stretched coordinate, x(0) = 0 and x(1) = 1 with x(s+1) = x(s)+1.
+ *
+ * \param s Uniform coordinate.
+ */
+PetscReal AppStretch(const PetscReal s)
+{
+	return s + 0.6 * std::sin(2.0*PETSC_PI*s) / (2.0*PETSC_PI);
+} // AppStretch
+
+
+/*! Solves on a grid of n x n points and gets the error.
+ *
+ * \param n Number of points in each direction.
+ * \param periodic Periodic domain?
+ * \param error Maximum error (passed by pointer).
+ * \param h Spacing of the uniform coordinate (passed by pointer).
+ * \param cold Iterations of the first solve (passed by pointer).
+ * \param warm Iterations of the warm-started solve (passed by pointer).
+ */
+PetscErrorCode AppSolve(
+	const PetscInt n, const PetscBool periodic, PetscReal *error,
+	PetscReal *h, PetscInt *cold, PetscInt *warm)
+{
+	PetscErrorCode ierr;
+	PetibmGridCtx gridCtx;
+	PetibmGrid grid;
+	PetibmFieldCtx fieldCtx;
+	PetibmField psi, wz, exact;
+	PetibmStreamFunction solver;
+	PetibmGridline *lines[2];
+	DMDALocalInfo info;
+	PetscReal *x, *y, **w, **e, k = (periodic) ? 2.0*PETSC_PI : PETSC_PI,
+	          shift;
+	PetscInt d, i, j;
+
+	PetscFunctionBeginUser;
+
+	// stations: uniform coordinate s = (i+1)/(n+1) with the boundaries at
+	// s = 0 and s = 1, or s = i/n with periodicity
+	gridCtx.nx = gridCtx.ny = n;
+	ierr = PetibmGridInitialize(gridCtx, grid); CHKERRQ(ierr);
+	*h = (periodic) ? 1.0/n : 1.0/(n+1);
+	lines[0] = &grid.x;
+	lines[1] = &grid.y;
+	for (d=0; d<2; d++)
+	{
+		ierr = DMDAGetLocalInfo(lines[d]->da, &info); CHKERRQ(ierr);
+		ierr = DMDAVecGetArray(lines[d]->da, lines[d]->coords, &x); CHKERRQ(ierr);
+		for (i=info.xs; i<info.xs+info.xm; i++)
+			x[i] = AppStretch(((periodic) ? i : i+1) * (*h));
+		ierr = DMDAVecRestoreArray(
+			lines[d]->da, lines[d]->coords, &x); CHKERRQ(ierr);
+	}
+	fieldCtx.periodic_x = fieldCtx.periodic_y = periodic;
+	ierr = PetibmFieldInitialize(fieldCtx, grid, psi); CHKERRQ(ierr);
+	ierr = PetibmFieldInitialize(fieldCtx, grid, wz); CHKERRQ(ierr);
+	ierr = PetibmFieldInitialize(fieldCtx, grid, exact); CHKERRQ(ierr);
+
+	// manufactured solution: -Laplacian(psi) = 2 k^2 psi
+	ierr = PetibmGridGlobalToLocal(grid); CHKERRQ(ierr);
+	ierr = DMDAGetLocalInfo(psi.da, &info); CHKERRQ(ierr);
+	ierr = DMDAVecGetArray(grid.x.da, grid.x.local, &x); CHKERRQ(ierr);
+	ierr = DMDAVecGetArray(grid.y.da, grid.y.local, &y); CHKERRQ(ierr);
+	ierr = DMDAVecGetArray(wz.da, wz.global, &w); CHKERRQ(ierr);
+	ierr = DMDAVecGetArray(exact.da, exact.global, &e); CHKERRQ(ierr);
+	for (j=info.ys; j<info.ys+info.ym; j++)
+		for (i=info.xs; i<info.xs+info.xm; i++)
+		{
+			e[j][i] = std::sin(k*x[i]) * std::sin(k*y[j]);
+			w[j][i] = 2.0 * k * k * e[j][i];
+		}
+	ierr = DMDAVecRestoreArray(exact.da, exact.global, &e); CHKERRQ(ierr);
+	ierr = DMDAVecRestoreArray(wz.da, wz.global, &w); CHKERRQ(ierr);
+	ierr = DMDAVecRestoreArray(grid.y.da, grid.y.local, &y); CHKERRQ(ierr);
+	ierr = DMDAVecRestoreArray(grid.x.da, grid.x.local, &x); CHKERRQ(ierr);
+
+	ierr = PetibmStreamFunctionInitialize(grid, psi.da, solver); CHKERRQ(ierr);
+	ierr = VecSet(psi.global, 0.0); CHKERRQ(ierr);
+	ierr = PetibmStreamFunctionSolve(solver, wz, psi); CHKERRQ(ierr);
+	ierr = KSPGetIterationNumber(solver.ksp, cold); CHKERRQ(ierr);
+
+	// error, up to a constant with periodicity
+	ierr = VecAXPY(exact.global, -1.0, psi.global); CHKERRQ(ierr);
+	if (periodic)
+	{
+		ierr = VecSum(exact.global, &shift); CHKERRQ(ierr);
+		ierr = VecShift(exact.global, -shift/(n*n)); CHKERRQ(ierr);
+	}
+	ierr = VecNorm(exact.global, NORM_INFINITY, error); CHKERRQ(ierr);
+
+	// next "time step": a vorticity 1% larger, from the previous solution
+	ierr = VecScale(wz.global, 1.01); CHKERRQ(ierr);
+	ierr = PetibmStreamFunctionSolve(solver, wz, psi); CHKERRQ(ierr);
+	ierr = KSPGetIterationNumber(solver.ksp, warm); CHKERRQ(ierr);
+
+	ierr = PetibmStreamFunctionDestroy(solver); CHKERRQ(ierr);
+	ierr = PetibmFieldDestroy(psi); CHKERRQ(ierr);
+	ierr = PetibmFieldDestroy(wz); CHKERRQ(ierr);
+	ierr = PetibmFieldDestroy(exact); CHKERRQ(ierr);
+	ierr = PetibmGridDestroy(grid); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // AppSolve
+
+
+int main(int argc, char **argv)
+{
+	PetscErrorCode ierr;
+	PetscBool periodic = PETSC_FALSE, found;
+	PetscInt n, r, cold[2], warm[2];
+	PetscReal error[2], h[2], order;
+
+	ierr = PetscInitialize(&argc, &argv, nullptr, nullptr); CHKERRQ(ierr);
+
+	ierr = PetscOptionsGetBool(nullptr, nullptr, "-periodic",
+	                           &periodic, &found); CHKERRQ(ierr);
+
+	// sizes that coarsen down to a few points (multigrid on every level)
+	for (r=0; r<2; r++)
+	{
+		n = (periodic) ? 32 << r : (32 << r) + 1;
+		ierr = AppSolve(
+			n, periodic, error+r, h+r, cold+r, warm+r); CHKERRQ(ierr);
+		ierr = PetscPrintf(PETSC_COMM_WORLD, "%d x %d: error %g, iterations "
+		                   "%d (warm-started: %d)\n", n, n, error[r],
+		                   cold[r], warm[r]); CHKERRQ(ierr);
+		if (warm[r] >= cold[r])
+			SETERRQ2(PETSC_COMM_WORLD, PETSC_ERR_PLIB,
+			         "The warm-started solve took %D iterations (first "
+			         "solve: %D)", warm[r], cold[r]);
+	}
+	order = std::log(error[0]/error[1]) / std::log(h[0]/h[1]);
+	ierr = PetscPrintf(PETSC_COMM_WORLD, "order of convergence: %g\n",
+	                   order); CHKERRQ(ierr);
+	if (order < 1.8)
+		SETERRQ(PETSC_COMM_WORLD, PETSC_ERR_PLIB,
+		        "The streamfunction does not converge at second order");
+
+	ierr = PetscFinalize(); CHKERRQ(ierr);
+
+	return 0;
+} // main
@@ -0,0 +1,212 @@
+/*! Computes the Q-criterion and lambda2 fields from the 3D velocity vector field.
+ * \file vortex.cpp
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <sys/stat.h>
+#include <functional>
+
+#include <petscsys.h>
+#include <petscdmda.h>
+
+#include "petibm-utilities/field.h"
+#include "petibm-utilities/grid.h"
+#include "petibm-utilities/misc.h"
+#include "petibm-utilities/pyramid.h"
+#include "petibm-utilities/timestep.h"
+#include "petibm-utilities/vortex.h"
+#include "petibm-utilities/vorticity.h"
+
+
+int main(int argc, char **argv)
+{
+	PetscErrorCode ierr;
+	std::string directory, outdir, gridpath;
+	PetibmGrid grid, gridux, griduy, griduz;
+	PetibmGridCtx gridCtx;
+	PetibmField ux, uy, uz, q, lambda2, strain;
+	PetibmFieldCtx fieldCtx;
+	PetibmFieldPool pool;
+	PetibmPyramid pyramid;
+	PetibmTimeStepCtx stepCtx;
+	DM da;
+	PetscReal bc_values[3];
+	PetscInt ite, levels = 0;
+	PetscBool found = PETSC_FALSE,
+	          compute_q = PETSC_FALSE,
+	          compute_lambda2 = PETSC_FALSE,
+	          compute_strain = PETSC_FALSE;
+
+	ierr = PetscInitialize(&argc, &argv, nullptr, nullptr); CHKERRQ(ierr);
+
+	// parse command-line options
+	ierr = PetibmGetDirectory(&directory); CHKERRQ(ierr);
+	ierr = PetibmTimeStepGetOptions(nullptr, &stepCtx); CHKERRQ(ierr);
+	ierr = PetibmGridGetOptions(nullptr, &gridCtx); CHKERRQ(ierr);
+	ierr = PetibmFieldGetOptions(nullptr, &fieldCtx); CHKERRQ(ierr);
+	{
+		char dir[PETSC_MAX_PATH_LEN];
+		ierr = PetscOptionsGetString(nullptr, nullptr, "-output_directory",
+		                             dir, sizeof(dir), &found); CHKERRQ(ierr);
+		outdir = (!found) ? directory : dir;
+		mkdir((outdir).c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+	}
+	// boundary values of the components, beyond the non-periodic boundaries
+	// (default: the value of `-bc_value`)
+	bc_values[0] = bc_values[1] = bc_values[2] = fieldCtx.bc_value;
+	ierr = PetscOptionsGetReal(nullptr, nullptr, "-ux_bc_value",
+	                           bc_values, &found); CHKERRQ(ierr);
+	ierr = PetscOptionsGetReal(nullptr, nullptr, "-uy_bc_value",
+	                           bc_values+1, &found); CHKERRQ(ierr);
+	ierr = PetscOptionsGetReal(nullptr, nullptr, "-uz_bc_value",
+	                           bc_values+2, &found); CHKERRQ(ierr);
+	{
+		char path[PETSC_MAX_PATH_LEN];
+		ierr = PetscOptionsGetString(nullptr, nullptr, "-grid_path",
+		                             path, sizeof(path), &found); CHKERRQ(ierr);
+		gridpath = (!found) ? directory+"/grid.h5" : path;
+	}
+	ierr = PetibmGridCtxDetectSizes(gridpath, "p", &gridCtx); CHKERRQ(ierr);
+	ierr = PetscOptionsGetBool(
+		nullptr, nullptr, "-compute_q", &compute_q, &found); CHKERRQ(ierr);
+	ierr = PetscOptionsGetBool(
+		nullptr, nullptr, "-compute_lambda2", &compute_lambda2, &found); CHKERRQ(ierr);
+	ierr = PetscOptionsGetBool(
+		nullptr, nullptr, "-compute_strain", &compute_strain, &found); CHKERRQ(ierr);
+	ierr = PetscOptionsGetInt(
+		nullptr, nullptr, "-pyramid_levels", &levels, &found); CHKERRQ(ierr);
+
+	// read cell-centered and staggered gridline stations
+	ierr = PetibmVorticityReadGrids(
+		gridpath, gridCtx, fieldCtx, grid, gridux, griduy, griduz); CHKERRQ(ierr);
+	// the quantities are computed at cell centers
+	if (compute_q)
+	{
+		ierr = PetibmGridHDF5Write(outdir+"/grid.h5", "q", grid); CHKERRQ(ierr);
+	}
+	if (compute_lambda2)
+	{
+		ierr = PetibmGridHDF5Write(
+			outdir+"/grid.h5", "lambda2", grid); CHKERRQ(ierr);
+	}
+	if (compute_strain)
+	{
+		ierr = PetibmGridHDF5Write(
+			outdir+"/grid.h5", "strain", grid); CHKERRQ(ierr);
+	}
+	// create base DMDA object and DMDAs for the velocity components
+	ierr = PetibmVorticityCreateDM(gridCtx, fieldCtx, &da); CHKERRQ(ierr);
+	ierr = PetibmVorticityCreateVelocityDM(
+		da, 0, DMDA_STENCIL_BOX, 1, &ux.da); CHKERRQ(ierr);
+	ierr = PetibmFieldInitialize(pool, ux); CHKERRQ(ierr);
+	ierr = PetibmFieldSetBoundaryPoints(bc_values[0], ux); CHKERRQ(ierr);
+	ierr = PetibmVorticityCreateVelocityDM(
+		da, 1, DMDA_STENCIL_BOX, 1, &uy.da); CHKERRQ(ierr);
+	ierr = PetibmFieldInitialize(pool, uy); CHKERRQ(ierr);
+	ierr = PetibmFieldSetBoundaryPoints(bc_values[1], uy); CHKERRQ(ierr);
+	ierr = PetibmVorticityCreateVelocityDM(
+		da, 2, DMDA_STENCIL_BOX, 1, &uz.da); CHKERRQ(ierr);
+	ierr = PetibmFieldInitialize(pool, uz); CHKERRQ(ierr);
+	ierr = PetibmFieldSetBoundaryPoints(bc_values[2], uz); CHKERRQ(ierr);
+	// create vectors for the quantities (cell-centered, base DMDA)
+	if (compute_q)
+	{
+		ierr = PetscObjectReference((PetscObject) da); CHKERRQ(ierr);
+		q.da = da;
+		ierr = PetibmFieldInitialize(pool, q); CHKERRQ(ierr);
+	}
+	if (compute_lambda2)
+	{
+		ierr = PetscObjectReference((PetscObject) da); CHKERRQ(ierr);
+		lambda2.da = da;
+		ierr = PetibmFieldInitialize(pool, lambda2); CHKERRQ(ierr);
+	}
+	if (compute_strain)
+	{
+		ierr = PetscObjectReference((PetscObject) da); CHKERRQ(ierr);
+		strain.da = da;
+		ierr = PetibmFieldInitialize(pool, strain); CHKERRQ(ierr);
+	}
+	// coarse levels of the quantities (same layout for all of them)
+	if (levels > 0 && (compute_q || compute_lambda2 || compute_strain))
+	{
+		ierr = PetibmPyramidInitialize(
+			grid, (compute_q) ? q : (compute_lambda2) ? lambda2 : strain,
+			levels, pyramid); CHKERRQ(ierr);
+	}
+
+	// loop over the time steps to compute the vortex-identification fields
+	for (ite=stepCtx.start; ite<=stepCtx.end; ite+=stepCtx.step)
+	{
+		ierr = PetscPrintf(
+			PETSC_COMM_WORLD, "[time-step %d]\n", ite); CHKERRQ(ierr);
+		// get name of time-step file
+		std::stringstream ss;
+		ss << std::setfill('0') << std::setw(7) << ite << ".h5";
+		std::string filename(ss.str());
+		// read velocity field
+		ierr = PetibmFieldHDF5Read(directory+"/"+filename, "u", ux); CHKERRQ(ierr);
+		ierr = PetibmFieldHDF5Read(directory+"/"+filename, "v", uy); CHKERRQ(ierr);
+		ierr = PetibmFieldHDF5Read(directory+"/"+filename, "w", uz); CHKERRQ(ierr);
+		// single sweep over the cells for all requested quantities
+		ierr = PetibmVortexComputeFields(
+			grid, gridux, griduy, griduz, ux, uy, uz,
+			(compute_q) ? &q : nullptr,
+			(compute_lambda2) ? &lambda2 : nullptr,
+			(compute_strain) ? &strain : nullptr); CHKERRQ(ierr);
+		if (compute_q)
+		{
+			ierr = PetibmFieldHDF5Write(outdir+"/"+filename, "q", q); CHKERRQ(ierr);
+			ierr = PetibmPyramidHDF5Write(
+				outdir+"/"+filename, "q", q, pyramid); CHKERRQ(ierr);
+		}
+		if (compute_lambda2)
+		{
+			ierr = PetibmFieldHDF5Write(
+				outdir+"/"+filename, "lambda2", lambda2); CHKERRQ(ierr);
+			ierr = PetibmPyramidHDF5Write(
+				outdir+"/"+filename, "lambda2", lambda2, pyramid); CHKERRQ(ierr);
+		}
+		if (compute_strain)
+		{
+			ierr = PetibmFieldHDF5Write(
+				outdir+"/"+filename, "strain", strain); CHKERRQ(ierr);
+			ierr = PetibmPyramidHDF5Write(
+				outdir+"/"+filename, "strain", strain, pyramid); CHKERRQ(ierr);
+		}
+	}
+
+	ierr = PetibmGridDestroy(grid); CHKERRQ(ierr);
+	ierr = PetibmGridDestroy(gridux); CHKERRQ(ierr);
+	ierr = PetibmGridDestroy(griduy); CHKERRQ(ierr);
+	ierr = PetibmGridDestroy(griduz); CHKERRQ(ierr);
+	ierr = DMDestroy(&da); CHKERRQ(ierr);
+	ierr = PetibmPyramidDestroy(pyramid); CHKERRQ(ierr);
+	ierr = PetibmFieldDestroy(ux); CHKERRQ(ierr);
+	ierr = PetibmFieldDestroy(uy); CHKERRQ(ierr);
+	ierr = PetibmFieldDestroy(uz); CHKERRQ(ierr);
+	if (compute_q)
+	{
+		ierr = PetibmFieldDestroy(q); CHKERRQ(ierr);
+	}
+	if (compute_lambda2)
+	{
+		ierr = PetibmFieldDestroy(lambda2); CHKERRQ(ierr);
+	}
+	if (compute_strain)
+	{
+		ierr = PetibmFieldDestroy(strain); CHKERRQ(ierr);
+	}
+	ierr = PetscOptionsHasName(
+		nullptr, nullptr, "-field_pool_view", &found); CHKERRQ(ierr);
+	if (found)
+	{
+		ierr = PetibmFieldPoolView(pool); CHKERRQ(ierr);
+	}
+	ierr = PetibmFieldPoolDestroy(pool); CHKERRQ(ierr);
+	
+	ierr = PetscFinalize(); CHKERRQ(ierr);
+
+	return 0;
+} // main
@@ -0,0 +1,221 @@
+/*! Tests the order of accuracy of the z-vorticity.
+ *
+ * ux = sin(2 pi y) and uy = sin(2 pi x) on the periodic unit cube, stretched
+ * in x and y, so that wz = 2 pi (cos(2 pi x) - cos(2 pi y)) (evaluated midway
+ * between the cell centers the derivatives are taken from); the derivatives
+ * of order 2 and 4 should converge at their order, and the fourth-order ones
+ * should be more accurate than the second-order ones on every grid.
+ * \file test.cpp
+ */
+
+#include <cmath>
+
+#include <petscsys.h>
+#include <petscdmda.h>
+
+#include "petibm-utilities/field.h"
+#include "petibm-utilities/grid.h"
+#include "petibm-utilities/threads.h"
+#include "petibm-utilities/vorticity.h"
+
+
+/*! Stretched coordinate, x(0) = 0 and x(1) = 1 with x(s+1) = x(s)+1.
+ *
+ * \param s Uniform coordinate.
+ */
+PetscReal AppStretch(const PetscReal s)
+{
+	return s + 0.5 * std::sin(2.0*PETSC_PI*s) / (2.0*PETSC_PI);
+} // AppStretch
+
+
+/*! Creates the stations of a periodic gridline of n cells.
+ *
+ * The faces are at the stretched coordinates of s = (i+1)/n and the cell
+ * centers midway between two faces, so that the first boundary (x = 0) is
+ * mirrored from the first center and face.
+ *
+ * \param n Number of cells.
+ * \param faces Stations of the faces (passed by pointer).
+ * \param centers Stations of the cell centers (passed by pointer).
+ */
+PetscErrorCode AppCreateStations(const PetscInt n, Vec *faces, Vec *centers)
+{
+	PetscErrorCode ierr;
+	PetscReal *f, *c;
+	PetscInt i;
+
+	PetscFunctionBeginUser;
+
+	ierr = VecCreateSeq(PETSC_COMM_SELF, n, faces); CHKERRQ(ierr);
+	ierr = VecCreateSeq(PETSC_COMM_SELF, n, centers); CHKERRQ(ierr);
+	ierr = VecGetArray(*faces, &f); CHKERRQ(ierr);
+	ierr = VecGetArray(*centers, &c); CHKERRQ(ierr);
+	for (i=0; i<n; i++)
+	{
+		f[i] = AppStretch((i+1.0)/n);
+		c[i] = 0.5*(((i > 0) ? f[i-1] : 0.0) + f[i]);
+	}
+	ierr = VecRestoreArray(*centers, &c); CHKERRQ(ierr);
+	ierr = VecRestoreArray(*faces, &f); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // AppCreateStations
+
+
+/*! Computes the z-vorticity on a grid of n x n x 4 cells and gets the error.
+ *
+ * \param n Number of cells in the x- and y-directions.
+ * \param order Order of accuracy of the derivatives.
+ * \param error Maximum error (passed by pointer).
+ */
+PetscErrorCode AppComputeError(
+	const PetscInt n, const PetscInt order, PetscReal *error)
+{
+	PetscErrorCode ierr;
+	PetibmGridCtx gridCtx;
+	PetibmFieldCtx fieldCtx;
+	PetibmVorticityCtx vortCtx;
+	PetibmGrid gridux, griduy, gridwz;
+	PetibmDerivativeOperator dx, dy;
+	PetibmFieldPool pool;
+	PetibmField ux, uy, wz;
+	const PetscBool less[3] = {PETSC_TRUE, PETSC_TRUE, PETSC_FALSE};
+	DM da;
+	DMDALocalInfo info;
+	const PetscReal *x, *y;
+	PetscReal ***u_a, ***w_a, xm, ym, exact;
+	PetscInt i, j, k;
+
+	PetscFunctionBeginUser;
+
+	gridCtx.nx = gridCtx.ny = n;
+	gridCtx.nz = 4;
+	fieldCtx.periodic_x = fieldCtx.periodic_y = fieldCtx.periodic_z = PETSC_TRUE;
+	vortCtx.order = order;
+
+	// stations of the velocity components and of the z-vorticity
+	ierr = AppCreateStations(
+		n, &gridux.x.coords, &griduy.x.coords); CHKERRQ(ierr);
+	ierr = AppCreateStations(
+		n, &griduy.y.coords, &gridux.y.coords); CHKERRQ(ierr);
+	gridwz.dim = 2;
+	ierr = VecCreateSeq(PETSC_COMM_SELF, n-1, &gridwz.x.coords); CHKERRQ(ierr);
+	ierr = VecCreateSeq(PETSC_COMM_SELF, n-1, &gridwz.y.coords); CHKERRQ(ierr);
+	ierr = PetibmVorticityZComputeGrid(gridux, griduy, gridwz); CHKERRQ(ierr);
+	ierr = PetibmVorticityZCreateOperators(
+		vortCtx, gridux, griduy, gridwz, dx, dy); CHKERRQ(ierr);
+
+	ierr = PetibmVorticityCreateDM(gridCtx, fieldCtx, &da); CHKERRQ(ierr);
+	ierr = PetibmVorticityCreateVelocityDM(
+		da, 0, DMDA_STENCIL_BOX, order/2, &ux.da); CHKERRQ(ierr);
+	ierr = PetibmFieldInitialize(pool, ux); CHKERRQ(ierr);
+	ierr = PetibmVorticityCreateVelocityDM(
+		da, 1, DMDA_STENCIL_BOX, order/2, &uy.da); CHKERRQ(ierr);
+	ierr = PetibmFieldInitialize(pool, uy); CHKERRQ(ierr);
+	ierr = PetibmVorticityCreateStaggeredDM(
+		da, less, DMDA_STENCIL_STAR, 1, &wz.da); CHKERRQ(ierr);
+	ierr = PetibmFieldInitialize(pool, wz); CHKERRQ(ierr);
+
+	// ux = sin(2 pi y) at the cell centers along y
+	ierr = DMDAGetLocalInfo(ux.da, &info); CHKERRQ(ierr);
+	ierr = VecGetArrayRead(gridux.y.coords, &y); CHKERRQ(ierr);
+	ierr = DMDAVecGetArray(ux.da, ux.global, &u_a); CHKERRQ(ierr);
+	for (k=info.zs; k<info.zs+info.zm; k++)
+		for (j=info.ys; j<info.ys+info.ym; j++)
+			for (i=info.xs; i<info.xs+info.xm; i++)
+				u_a[k][j][i] = std::sin(2.0*PETSC_PI*y[j]);
+	ierr = DMDAVecRestoreArray(ux.da, ux.global, &u_a); CHKERRQ(ierr);
+	ierr = VecRestoreArrayRead(gridux.y.coords, &y); CHKERRQ(ierr);
+	// uy = sin(2 pi x) at the cell centers along x
+	ierr = DMDAGetLocalInfo(uy.da, &info); CHKERRQ(ierr);
+	ierr = VecGetArrayRead(griduy.x.coords, &x); CHKERRQ(ierr);
+	ierr = DMDAVecGetArray(uy.da, uy.global, &u_a); CHKERRQ(ierr);
+	for (k=info.zs; k<info.zs+info.zm; k++)
+		for (j=info.ys; j<info.ys+info.ym; j++)
+			for (i=info.xs; i<info.xs+info.xm; i++)
+				u_a[k][j][i] = std::sin(2.0*PETSC_PI*x[i]);
+	ierr = DMDAVecRestoreArray(uy.da, uy.global, &u_a); CHKERRQ(ierr);
+	ierr = VecRestoreArrayRead(griduy.x.coords, &x); CHKERRQ(ierr);
+
+	ierr = PetibmVorticityZComputeField(
+		vortCtx, dx, dy, ux, uy, wz); CHKERRQ(ierr);
+
+	// the point i of the vorticity lies between the centers i-1 and i
+	ierr = DMDAGetLocalInfo(wz.da, &info); CHKERRQ(ierr);
+	ierr = VecGetArrayRead(griduy.x.coords, &x); CHKERRQ(ierr);
+	ierr = VecGetArrayRead(gridux.y.coords, &y); CHKERRQ(ierr);
+	ierr = DMDAVecGetArray(wz.da, wz.global, &w_a); CHKERRQ(ierr);
+	*error = 0.0;
+	for (k=info.zs; k<info.zs+info.zm; k++)
+		for (j=info.ys; j<info.ys+info.ym; j++)
+			for (i=info.xs; i<info.xs+info.xm; i++)
+			{
+				xm = 0.5*(((i > 0) ? x[i-1] : x[n-1] - 1.0) + x[i]);
+				ym = 0.5*(((j > 0) ? y[j-1] : y[n-1] - 1.0) + y[j]);
+				exact = 2.0*PETSC_PI*(std::cos(2.0*PETSC_PI*xm) -
+				                      std::cos(2.0*PETSC_PI*ym));
+				*error = PetscMax(*error, std::abs(w_a[k][j][i] - exact));
+			}
+	ierr = DMDAVecRestoreArray(wz.da, wz.global, &w_a); CHKERRQ(ierr);
+	ierr = VecRestoreArrayRead(gridux.y.coords, &y); CHKERRQ(ierr);
+	ierr = VecRestoreArrayRead(griduy.x.coords, &x); CHKERRQ(ierr);
+	ierr = MPI_Allreduce(MPI_IN_PLACE, error, 1, MPIU_REAL, MPI_MAX,
+	                     PETSC_COMM_WORLD); CHKERRQ(ierr);
+
+	ierr = PetibmDerivativeOperatorDestroy(dx); CHKERRQ(ierr);
+	ierr = PetibmDerivativeOperatorDestroy(dy); CHKERRQ(ierr);
+	ierr = PetibmFieldDestroy(ux); CHKERRQ(ierr);
+	ierr = PetibmFieldDestroy(uy); CHKERRQ(ierr);
+	ierr = PetibmFieldDestroy(wz); CHKERRQ(ierr);
+	ierr = DMDestroy(&da); CHKERRQ(ierr);
+	ierr = PetibmFieldPoolDestroy(pool); CHKERRQ(ierr);
+	ierr = PetibmGridDestroy(gridux); CHKERRQ(ierr);
+	ierr = PetibmGridDestroy(griduy); CHKERRQ(ierr);
+	ierr = PetibmGridDestroy(gridwz); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // AppComputeError
+
+
+int main(int argc, char **argv)
+{
+	PetscErrorCode ierr;
+	const PetscInt orders[2] = {2, 4};
+	PetscReal error[2][2], rate;
+	PetscInt o, r, n;
+
+	ierr = PetscInitialize(&argc, &argv, nullptr, nullptr); CHKERRQ(ierr);
+	ierr = PetibmThreadsInitialize(); CHKERRQ(ierr);
+
+	for (o=0; o<2; o++)
+	{
+		for (r=0; r<2; r++)
+		{
+			n = 32 << r;
+			ierr = AppComputeError(
+				n, orders[o], &error[o][r]); CHKERRQ(ierr);
+			ierr = PetscPrintf(PETSC_COMM_WORLD, "order %d, %d x %d: error "
+			                   "%g\n", orders[o], n, n,
+			                   error[o][r]); CHKERRQ(ierr);
+		}
+		rate = std::log2(error[o][0]/error[o][1]);
+		ierr = PetscPrintf(PETSC_COMM_WORLD, "order %d: rate of convergence "
+		                   "%g\n", orders[o], rate); CHKERRQ(ierr);
+		if (rate < orders[o] - 0.5)
+			SETERRQ2(PETSC_COMM_WORLD, PETSC_ERR_PLIB,
+			         "The derivatives of order %D converge at rate %g",
+			         orders[o], (double) rate);
+	}
+	for (r=0; r<2; r++)
+		if (error[1][r] >= error[0][r])
+			SETERRQ2(PETSC_COMM_WORLD, PETSC_ERR_PLIB,
+			         "The fourth-order error (%g) is not below the "
+			         "second-order one (%g)",
+			         (double) error[1][r], (double) error[0][r]);
+
+	ierr = PetibmThreadsFinalize(); CHKERRQ(ierr);
+	ierr = PetscFinalize(); CHKERRQ(ierr);
+
+	return 0;
+} // main
@@ -13,6 +13,7 @@
 #include "petibm-utilities/field.h"
 #include "petibm-utilities/grid.h"
 #include "petibm-utilities/misc.h"
+#include "petibm-utilities/threads.h"
 #include "petibm-utilities/timestep.h"
 #include "petibm-utilities/vorticity.h"
 
@@ -25,6 +26,9 @@ int main(int argc, char **argv)
 	PetibmGridCtx gridCtx, griduxCtx, griduyCtx;
 	PetibmField ux, uy, wz;
 	PetibmFieldCtx fieldCtx;
+	PetibmVorticityCtx vortCtx;
+	PetibmDerivativeOperator wzdx, wzdy;
+	PetibmFieldPool pool;
 	PetibmTimeStepCtx stepCtx;
 	DM da;
 	const PetscInt *plx, *ply;
@@ -32,18 +36,17 @@ int main(int argc, char **argv)
 	PetscInt M, N, m, n;
 	DMBoundaryType bType_x, bType_y;
 	PetscInt ite;
-	PetscMPIInt rank;
 	PetscBool found = PETSC_FALSE;
 
 	ierr = PetscInitialize(&argc, &argv, nullptr, nullptr); CHKERRQ(ierr);
-
-	ierr = MPI_Comm_rank(PETSC_COMM_WORLD, &rank); CHKERRQ(ierr);
+	ierr = PetibmThreadsInitialize(); CHKERRQ(ierr);
 
 	// parse command-line options
 	ierr = PetibmGetDirectory(&directory); CHKERRQ(ierr);
 	ierr = PetibmTimeStepGetOptions(nullptr, &stepCtx); CHKERRQ(ierr);
 	ierr = PetibmGridGetOptions(nullptr, &gridCtx); CHKERRQ(ierr);
 	ierr = PetibmFieldGetOptions(nullptr, &fieldCtx); CHKERRQ(ierr);
+	ierr = PetibmVorticityGetOptions(nullptr, &vortCtx); CHKERRQ(ierr);
 	{
 		char dir[PETSC_MAX_PATH_LEN];
 		ierr = PetscOptionsGetString(nullptr, nullptr, "-output_directory",
@@ -57,49 +60,37 @@ int main(int argc, char **argv)
 		                             path, sizeof(path), &found); CHKERRQ(ierr);
 		gridpath = (!found) ? directory+"/grid.h5" : path;
 	}
+	ierr = PetibmGridCtxDetectSizes(gridpath, "p", &gridCtx); CHKERRQ(ierr);
 
 	// read cell-centered gridline stations
-	ierr = VecCreateSeq(
-		PETSC_COMM_SELF, gridCtx.nx, &grid.x.coords); CHKERRQ(ierr);
-	ierr = VecCreateSeq(
-		PETSC_COMM_SELF, gridCtx.ny, &grid.y.coords); CHKERRQ(ierr);
-	ierr = PetibmGridlineHDF5Read(
-		gridpath, "p", "x", grid.x.coords); CHKERRQ(ierr);
-	ierr = PetibmGridlineHDF5Read(
-		gridpath, "p", "y", grid.y.coords); CHKERRQ(ierr);
+	ierr = PetibmGridlineHDF5ReadShared(
+		gridpath, "p", "x", gridCtx.nx, &grid.x.coords); CHKERRQ(ierr);
+	ierr = PetibmGridlineHDF5ReadShared(
+		gridpath, "p", "y", gridCtx.ny, &grid.y.coords); CHKERRQ(ierr);
 	// read staggered gridline stations for x-velocity
 	griduxCtx.nx = (fieldCtx.periodic_x) ? gridCtx.nx : gridCtx.nx-1;
 	griduxCtx.ny = gridCtx.ny;
-	ierr = VecCreateSeq(
-		PETSC_COMM_SELF, griduxCtx.nx, &gridux.x.coords); CHKERRQ(ierr);
-	ierr = VecCreateSeq(
-		PETSC_COMM_SELF, griduxCtx.ny, &gridux.y.coords); CHKERRQ(ierr);
-	ierr = PetibmGridlineHDF5Read(
-		gridpath, "u", "x", gridux.x.coords); CHKERRQ(ierr);
-	ierr = PetibmGridlineHDF5Read(
-		gridpath, "u", "y", gridux.y.coords); CHKERRQ(ierr);
+	ierr = PetibmGridlineHDF5ReadShared(
+		gridpath, "u", "x", griduxCtx.nx, &gridux.x.coords); CHKERRQ(ierr);
+	ierr = PetibmGridlineHDF5ReadShared(
+		gridpath, "u", "y", griduxCtx.ny, &gridux.y.coords); CHKERRQ(ierr);
 	// read staggered gridline stations for y-velocity
 	griduyCtx.nx = gridCtx.nx;
 	griduyCtx.ny = (fieldCtx.periodic_y) ? gridCtx.ny : gridCtx.ny-1;
-	ierr = VecCreateSeq(
-		PETSC_COMM_SELF, griduyCtx.nx, &griduy.x.coords); CHKERRQ(ierr);
-	ierr = VecCreateSeq(
-		PETSC_COMM_SELF, griduyCtx.ny, &griduy.y.coords); CHKERRQ(ierr);
-	ierr = PetibmGridlineHDF5Read(
-		gridpath, "v", "x", griduy.x.coords); CHKERRQ(ierr);
-	ierr = PetibmGridlineHDF5Read(
-		gridpath, "v", "y", griduy.y.coords); CHKERRQ(ierr);
+	ierr = PetibmGridlineHDF5ReadShared(
+		gridpath, "v", "x", griduyCtx.nx, &griduy.x.coords); CHKERRQ(ierr);
+	ierr = PetibmGridlineHDF5ReadShared(
+		gridpath, "v", "y", griduyCtx.ny, &griduy.y.coords); CHKERRQ(ierr);
 	// create grid for z-vorticity
 	ierr = VecCreateSeq(
 		PETSC_COMM_SELF, gridCtx.nx-1, &gridwz.x.coords); CHKERRQ(ierr);
 	ierr = VecCreateSeq(
 		PETSC_COMM_SELF, gridCtx.ny-1, &gridwz.y.coords); CHKERRQ(ierr);
 	ierr = PetibmVorticityZComputeGrid(gridux, griduy, gridwz); CHKERRQ(ierr);
-	if (rank == 0)
-	{
-		gridpath = outdir + "/grid.h5";
-		ierr = PetibmGridHDF5Write(gridpath, "wz", gridwz); CHKERRQ(ierr);
-	}
+	ierr = PetibmVorticityZCreateOperators(
+		vortCtx, gridux, griduy, gridwz, wzdx, wzdy); CHKERRQ(ierr);
+	gridpath = outdir + "/grid.h5";
+	ierr = PetibmGridHDF5Write(gridpath, "wz", gridwz); CHKERRQ(ierr);
 	// create base DMDA object
 	bType_x = (fieldCtx.periodic_x) ? DM_BOUNDARY_PERIODIC : DM_BOUNDARY_GHOSTED;
 	bType_y = (fieldCtx.periodic_y) ? DM_BOUNDARY_PERIODIC : DM_BOUNDARY_GHOSTED;
@@ -135,14 +126,13 @@ int main(int argc, char **argv)
 	ierr = DMDACreate2d(PETSC_COMM_WORLD,
 	                    bType_x, bType_y,
 	                    DMDA_STENCIL_BOX,
-	                    M, N, m, n, 1, 1, lx, ly,
+	                    M, N, m, n, 1, vortCtx.order/2, lx, ly,
 	                    &ux.da); CHKERRQ(ierr);
 	ierr = DMSetFromOptions(ux.da); CHKERRQ(ierr);
 	ierr = DMSetUp(ux.da);
 	ierr = PetscFree(lx); CHKERRQ(ierr);
 	ierr = PetscFree(ly); CHKERRQ(ierr);
-	ierr = DMCreateGlobalVector(ux.da, &ux.global); CHKERRQ(ierr);
-	ierr = DMCreateLocalVector(ux.da, &ux.local); CHKERRQ(ierr);
+	ierr = PetibmFieldInitialize(pool, ux); CHKERRQ(ierr);
 	// create DMDA and vector for velocity in y-direction
 	ierr = PetscMalloc(m*sizeof(*lx), &lx); CHKERRQ(ierr);
 	ierr = PetscMalloc(n*sizeof(*ly), &ly); CHKERRQ(ierr);
@@ -158,14 +148,13 @@ int main(int argc, char **argv)
 	ierr = DMDACreate2d(PETSC_COMM_WORLD,
 	                    bType_x, bType_y,
 	                    DMDA_STENCIL_BOX,
-	                    M, N, m, n, 1, 1, lx, ly,
+	                    M, N, m, n, 1, vortCtx.order/2, lx, ly,
 	                    &uy.da); CHKERRQ(ierr);
 	ierr = DMSetFromOptions(uy.da); CHKERRQ(ierr);
 	ierr = DMSetUp(uy.da); CHKERRQ(ierr);
 	ierr = PetscFree(lx); CHKERRQ(ierr);
 	ierr = PetscFree(ly); CHKERRQ(ierr);
-	ierr = DMCreateGlobalVector(uy.da, &uy.global); CHKERRQ(ierr);
-	ierr = DMCreateLocalVector(uy.da, &uy.local); CHKERRQ(ierr);
+	ierr = PetibmFieldInitialize(pool, uy); CHKERRQ(ierr);
 	// create DMDA and vector for z-vorticity
 	ierr = PetscMalloc(m*sizeof(*lx), &lx); CHKERRQ(ierr);
 	ierr = PetscMalloc(n*sizeof(*ly), &ly); CHKERRQ(ierr);
@@ -182,8 +171,7 @@ int main(int argc, char **argv)
 	ierr = DMSetUp(wz.da); CHKERRQ(ierr);
 	ierr = PetscFree(lx); CHKERRQ(ierr);
 	ierr = PetscFree(ly); CHKERRQ(ierr);
-	ierr = DMCreateGlobalVector(wz.da, &wz.global); CHKERRQ(ierr);
-	ierr = DMCreateLocalVector(wz.da, &wz.local); CHKERRQ(ierr);
+	ierr = PetibmFieldInitialize(pool, wz); CHKERRQ(ierr);
 
 	// loop over the time steps to compute the z-vorticity
 	for (ite=stepCtx.start; ite<=stepCtx.end; ite+=stepCtx.step)
@@ -199,18 +187,29 @@ int main(int argc, char **argv)
 		ierr = PetibmFieldHDF5Read(directory+"/"+filename, "v", uy); CHKERRQ(ierr);
 		// compute the z-vorticity field
 		ierr = PetibmVorticityZComputeField(
-			gridux, griduy, ux, uy, wz); CHKERRQ(ierr);
+			vortCtx, wzdx, wzdy, ux, uy, wz); CHKERRQ(ierr);
 		ierr = PetibmFieldHDF5Write(outdir+"/"+filename, "wz", wz); CHKERRQ(ierr);
 	}
 
+	ierr = PetibmGridDestroy(grid); CHKERRQ(ierr);
 	ierr = PetibmGridDestroy(gridux); CHKERRQ(ierr);
 	ierr = PetibmGridDestroy(griduy); CHKERRQ(ierr);
 	ierr = PetibmGridDestroy(gridwz); CHKERRQ(ierr);
+	ierr = PetibmDerivativeOperatorDestroy(wzdx); CHKERRQ(ierr);
+	ierr = PetibmDerivativeOperatorDestroy(wzdy); CHKERRQ(ierr);
 	ierr = DMDestroy(&da); CHKERRQ(ierr);
 	ierr = PetibmFieldDestroy(ux); CHKERRQ(ierr);
 	ierr = PetibmFieldDestroy(uy); CHKERRQ(ierr);
 	ierr = PetibmFieldDestroy(wz); CHKERRQ(ierr);
+	ierr = PetscOptionsHasName(
+		nullptr, nullptr, "-field_pool_view", &found); CHKERRQ(ierr);
+	if (found)
+	{
+		ierr = PetibmFieldPoolView(pool); CHKERRQ(ierr);
+	}
+	ierr = PetibmFieldPoolDestroy(pool); CHKERRQ(ierr);
 	
+	ierr = PetibmThreadsFinalize(); CHKERRQ(ierr);
 	ierr = PetscFinalize(); CHKERRQ(ierr);
 
 	return 0;
@@ -0,0 +1,140 @@
+/*! Definition of the structure PetibmArchive and related functions.
+ * \file archive.h
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <petscsys.h>
+#include <petscviewerhdf5.h>
+
+#include "petibm-utilities/field.h"
+
+
+/*! Structure holding the options of a time-series archive.
+ */
+struct PetibmArchiveCtx
+{
+	PetscInt layout = 0;  /// chunk layout (0: history, 1: slice)
+	PetscInt chunk_steps = 16;  /// number of records per chunk (history layout)
+}; // PetibmArchiveCtx
+
+
+/*! Structure holding an open time-series archive.
+ *
+ * The archive is a single HDF5 file where each field is a chunked, extendible
+ * dataset with dimensions (t, z, y, x) (or (t, y, x) in 2D), and where the
+ * datasets `step` and `time` index the records along the first dimension.
+ * The `history` layout uses chunks spanning several records over a small
+ * spatial tile (cheap time histories at a point); the `slice` layout uses
+ * chunks holding planes of a single record (cheap snapshots and slices).
+ */
+struct PetibmArchive
+{
+	PetscInt layout = 0,  /// chunk layout of the datasets created
+	         chunk_steps = 16;  /// number of records per chunk (history layout)
+	std::vector<PetscInt> steps;  /// time-step index of each record
+	std::vector<PetscReal> times;  /// time of each record
+	PetscViewer viewer = nullptr;  /// viewer holding the file
+	hid_t file = -1;  /// identifier of the HDF5 file
+}; // PetibmArchive
+
+
+/*! Gets options from command-line or config file.
+ *
+ * `-layout <history|slice>` and `-chunk_steps <n>`.
+ *
+ * \param prefix String to prepend to options.
+ * \param ctx The PetibmArchiveCtx structure to fill (passed by pointer).
+ */
+PetscErrorCode PetibmArchiveGetOptions(
+	const char prefix[], PetibmArchiveCtx *ctx);
+
+
+PetscErrorCode PetibmArchiveCtxPrintf(
+	const std::string name, const PetibmArchiveCtx ctx);
+
+
+/*! Opens a time-series archive, creating the file if it does not exist.
+ *
+ * Collective on PETSC_COMM_WORLD; the time/step index of an existing archive
+ * is read on every process.
+ *
+ * \param filepath Path of the archive.
+ * \param ctx The archive context (layout of the datasets to create).
+ * \param archive The archive (passed by reference).
+ */
+PetscErrorCode PetibmArchiveOpen(
+	const std::string filepath, const PetibmArchiveCtx ctx,
+	PetibmArchive &archive);
+
+
+/*! Gets the record of a time step, appending it to the index if needed.
+ *
+ * Collective.
+ *
+ * \param archive The archive (passed by reference).
+ * \param step The time-step index.
+ * \param time The time of the step.
+ * \param record The record of the step (passed by pointer).
+ */
+PetscErrorCode PetibmArchiveSetStep(
+	PetibmArchive &archive, const PetscInt step, const PetscReal time,
+	PetscInt *record);
+
+
+/*! Writes a field into a record of the archive.
+ *
+ * Collective; the dataset `name` is created on first write and extended to
+ * the number of records of the index, then each process writes its block.
+ * The field should have a single component.
+ *
+ * \param archive The archive (passed by reference).
+ * \param name Name of the field.
+ * \param record The record to write.
+ * \param field The field.
+ */
+PetscErrorCode PetibmArchiveFieldWrite(
+	PetibmArchive &archive, const std::string name, const PetscInt record,
+	const PetibmField field);
+
+
+/*! Reads a record of the archive into a field.
+ *
+ * Collective; each process reads its block.
+ * The field should have a single component.
+ *
+ * \param archive The archive (passed by reference).
+ * \param name Name of the field.
+ * \param record The record to read.
+ * \param field The field (passed by reference).
+ */
+PetscErrorCode PetibmArchiveFieldRead(
+	PetibmArchive &archive, const std::string name, const PetscInt record,
+	PetibmField &field);
+
+
+/*! Reads the time history of a field at a grid point.
+ *
+ * Collective; each process reads the history at its own point (indices
+ * ordered x, y, z) for all the records of the index.
+ * The points are checked on all processes before the collective read, so
+ * that an invalid point on one process raises the error on all of them.
+ *
+ * \param archive The archive (passed by reference).
+ * \param name Name of the field.
+ * \param index The indices of the grid point.
+ * \param values The values, one per record (passed by reference).
+ */
+PetscErrorCode PetibmArchiveHistoryRead(
+	PetibmArchive &archive, const std::string name, const PetscInt index[],
+	std::vector<PetscReal> &values);
+
+
+/*! Closes a time-series archive.
+ *
+ * \param archive The archive (passed by reference).
+ */
+PetscErrorCode PetibmArchiveClose(PetibmArchive &archive);
@@ -0,0 +1,182 @@
+/*! Definition of the structure PetibmArray and related functions.
+ * \file array.h
+ */
+
+#pragma once
+
+#include <petscsys.h>
+#include <petscdmda.h>
+
+
+/*! Structure holding a dimension-generic view of the values of a DMDA vector.
+ *
+ * The values are indexed (k, j, i) in 2D as in 3D (k is ignored in 2D, where
+ * the local information of the DMDA spans the single plane k = 0), so a
+ * kernel templated on the dimension has one loop body for both cases and
+ * the dimension is resolved at compile time.
+ */
+template <PetscInt dim, typename T>
+struct PetibmArray
+{
+	typedef T value_type;
+
+	T **v2 = nullptr;  /// values of a 2D vector
+	T ***v3 = nullptr;  /// values of a 3D vector
+
+	inline T &operator()(
+		const PetscInt k, const PetscInt j, const PetscInt i) const
+	{
+		return (dim == 3) ? v3[k][j][i] : v2[j][i];
+	}
+
+	/// row along x, indexed by the global index i
+	inline T *Row(const PetscInt k, const PetscInt j) const
+	{
+		return (dim == 3) ? v3[k][j] : v2[j];
+	}
+}; // PetibmArray
+
+
+/*! Structure holding a flat view of the values of a DMDA vector.
+ *
+ * The address of a row along x is computed from the corners (ghosted corners
+ * for a local vector) of the process instead of being looked up in the
+ * tables of pointers built by DMDAVecGetArray.
+ * As with DMDAVecGetArray, the components of a point are interleaved along x:
+ * with several degrees of freedom, the index along x is i*dof + c.
+ */
+template <typename T>
+struct PetibmFlatArray
+{
+	typedef T value_type;
+
+	T *v = nullptr;  /// values of the vector
+	PetscInt xs = 0,  /// first index along x (times the degrees of freedom)
+	         ys = 0,  /// first index along y
+	         zs = 0,  /// first index along z
+	         xm = 0,  /// number of values along x (points times the dof)
+	         ym = 0;  /// number of points along y
+
+	inline T &operator()(
+		const PetscInt k, const PetscInt j, const PetscInt i) const
+	{
+		return Row(k, j)[i];
+	}
+
+	/// row along x, indexed by the global index i
+	inline T *Row(const PetscInt k, const PetscInt j) const
+	{
+		return v + ((PetscInt64) (k - zs) * ym + (j - ys)) * xm - xs;
+	}
+}; // PetibmFlatArray
+
+
+/*! Gets the view of the values of a DMDA vector.
+ *
+ * \param da The DMDA object.
+ * \param vec The vector (global or local).
+ * \param arr The view (passed by reference).
+ */
+template <PetscInt dim, typename T>
+inline PetscErrorCode PetibmArrayGet(
+	const DM da, const Vec vec, PetibmArray<dim, T> &arr)
+{
+	PetscErrorCode ierr;
+
+	PetscFunctionBeginUser;
+
+	if (dim == 3)
+	{
+		ierr = DMDAVecGetArray(da, vec, &arr.v3); CHKERRQ(ierr);
+	}
+	else
+	{
+		ierr = DMDAVecGetArray(da, vec, &arr.v2); CHKERRQ(ierr);
+	}
+
+	PetscFunctionReturn(0);
+} // PetibmArrayGet
+
+
+/*! Restores the view of the values of a DMDA vector.
+ *
+ * \param da The DMDA object.
+ * \param vec The vector (global or local).
+ * \param arr The view (passed by reference).
+ */
+template <PetscInt dim, typename T>
+inline PetscErrorCode PetibmArrayRestore(
+	const DM da, const Vec vec, PetibmArray<dim, T> &arr)
+{
+	PetscErrorCode ierr;
+
+	PetscFunctionBeginUser;
+
+	if (dim == 3)
+	{
+		ierr = DMDAVecRestoreArray(da, vec, &arr.v3); CHKERRQ(ierr);
+	}
+	else
+	{
+		ierr = DMDAVecRestoreArray(da, vec, &arr.v2); CHKERRQ(ierr);
+	}
+
+	PetscFunctionReturn(0);
+} // PetibmArrayRestore
+
+
+/*! Gets the flat view of the values of a DMDA vector.
+ *
+ * \param da The DMDA object.
+ * \param vec The vector (global or local).
+ * \param arr The view (passed by reference).
+ */
+template <typename T>
+inline PetscErrorCode PetibmArrayGet(
+	const DM da, const Vec vec, PetibmFlatArray<T> &arr)
+{
+	PetscErrorCode ierr;
+	PetscInt n, m, p, size;
+
+	PetscFunctionBeginUser;
+
+	ierr = VecGetLocalSize(vec, &size); CHKERRQ(ierr);
+	ierr = DMDAGetCorners(
+		da, &arr.xs, &arr.ys, &arr.zs, &arr.xm, &arr.ym, &p); CHKERRQ(ierr);
+	// a local vector spans the ghosted corners
+	ierr = DMDAGetInfo(da, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+	                   nullptr, &n, nullptr, nullptr, nullptr, nullptr,
+	                   nullptr); CHKERRQ(ierr);
+	m = arr.xm * arr.ym * p * n;
+	if (m != size)
+	{
+		ierr = DMDAGetGhostCorners(
+			da, &arr.xs, &arr.ys, &arr.zs, &arr.xm, &arr.ym, &p); CHKERRQ(ierr);
+	}
+	// the row stride counts the interleaved components
+	arr.xs *= n;
+	arr.xm *= n;
+	ierr = VecGetArray(vec, &arr.v); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmArrayGet
+
+
+/*! Restores the flat view of the values of a DMDA vector.
+ *
+ * \param da The DMDA object.
+ * \param vec The vector (global or local).
+ * \param arr The view (passed by reference).
+ */
+template <typename T>
+inline PetscErrorCode PetibmArrayRestore(
+	const DM da, const Vec vec, PetibmFlatArray<T> &arr)
+{
+	PetscErrorCode ierr;
+
+	PetscFunctionBeginUser;
+
+	ierr = VecRestoreArray(vec, &arr.v); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmArrayRestore
@@ -0,0 +1,49 @@
+/*! Definition of the functions to collocate the staggered velocity field.
+ * \file collocation.h
+ */
+
+#pragma once
+
+#include <petscsys.h>
+#include <petscdmda.h>
+
+#include "petibm-utilities/field.h"
+#include "petibm-utilities/pool.h"
+
+
+/*! Initializes the cell-centered velocity field, with interleaved components.
+ *
+ * The DMDA object has the sizes, boundary types, and ownership ranges of the
+ * cell-centered DMDA, 3 degrees of freedom (the components x, y, z of each
+ * point are contiguous), and no ghost points.
+ *
+ * \param da The cell-centered DMDA object (3D).
+ * \param pool The pool (passed by reference).
+ * \param u The velocity field to initialize (passed by reference).
+ */
+PetscErrorCode PetibmCollocationInitialize(
+	const DM da, PetibmFieldPool &pool, PetibmField &u);
+
+
+/*! Averages the staggered 3D velocity field at cell centers.
+ *
+ * The components are on the faces of the cells (MAC staggering: ux on the
+ * x-faces, uy on the y-faces, uz on the z-faces, with the last face of a
+ * non-periodic direction on the boundary and not stored), so each component
+ * at a cell center is the mean of the two faces normal to it.
+ * The ghost points of the three components are exchanged together, and the
+ * three averages are done in a single sweep over the cells, on the threads
+ * of the process.
+ * The boundary faces of a non-periodic direction are not stored: their
+ * values are the external boundary values of the components (`bc_value`,
+ * set with PetibmFieldSetBoundaryPoints), applied when the local vectors are
+ * borrowed.
+ *
+ * \param ux The velocity field in the x-direction.
+ * \param uy The velocity field in the y-direction.
+ * \param uz The velocity field in the z-direction.
+ * \param u The cell-centered velocity field, from PetibmCollocationInitialize
+ *          (passed by reference).
+ */
+PetscErrorCode PetibmCollocationComputeField(
+	PetibmField ux, PetibmField uy, PetibmField uz, PetibmField &u);
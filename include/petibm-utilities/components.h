@@ -0,0 +1,141 @@
+/*! Definition of the structure PetibmComponents and related functions.
+ * \file components.h
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <petscsys.h>
+#include <petscvec.h>
+#include <petscdmda.h>
+
+#include "petibm-utilities/field.h"
+#include "petibm-utilities/grid.h"
+
+
+/*! Structure holding the options of the connected-component labeling.
+ */
+struct PetibmComponentsCtx
+{
+	PetscReal threshold = 0.0;  /// points with a value above the threshold are in the mask
+	PetscBool absolute = PETSC_FALSE;  /// threshold the magnitude of the value?
+	PetscInt min_size = 1;  /// minimum number of points of a component
+}; // PetibmComponentsCtx
+
+
+/*! Structure holding the statistics of a connected component.
+ */
+struct PetibmComponent
+{
+	PetscInt id = -1,  /// index of the component in the catalog of the time step
+	         track = -1,  /// index of the track the component belongs to
+	         parent = -1,  /// component of the previous time step with the largest overlap
+	         size = 0;  /// number of points
+	PetscReal volume = 0.0,  /// volume (area in 2D) of the cells of the points
+	          centroid[3] = {0.0, 0.0, 0.0},  /// volume-weighted centroid
+	          peak = 0.0,  /// value of largest magnitude (largest value if not absolute)
+	          location[3] = {0.0, 0.0, 0.0},  /// coordinates of the peak
+	          overlap = 0.0;  /// volume shared with the parent
+}; // PetibmComponent
+
+
+/*! Structure holding the connected components of the thresholded field and
+ * their tracks over the time steps.
+ *
+ * Only the catalog of the components is kept on rank 0; the labels of the
+ * points stay distributed and those of the previous time step are kept to
+ * match the components by overlap.
+ */
+struct PetibmComponents
+{
+	Vec labels = nullptr,  /// label of each point (-1: not in a component)
+	    local = nullptr,  /// local ghosted vector for the labels
+	    previous = nullptr;  /// labels of the previous time step
+	std::vector<PetibmComponent> catalog;  /// components of the last time step (rank 0)
+	PetscInt count = 0,  /// number of components of the last time step
+	         steps = 0,  /// number of time steps labeled
+	         tracks = 0,  /// number of tracks started
+	         iterations = 0;  /// number of ghost exchanges of the last labeling
+}; // PetibmComponents
+
+
+/*! Gets options from command-line or config file.
+ *
+ * `-threshold <value>`, `-absolute <true|false>`, `-min_size <n>`.
+ *
+ * \param prefix String to prepend to options.
+ * \param ctx The PetibmComponentsCtx structure to fill (passed by pointer).
+ */
+PetscErrorCode PetibmComponentsGetOptions(
+	const char prefix[], PetibmComponentsCtx *ctx);
+
+
+PetscErrorCode PetibmComponentsCtxPrintf(
+	const std::string name, const PetibmComponentsCtx ctx);
+
+
+/*! Initializes the connected components of a field.
+ *
+ * \param field The field (scalar).
+ * \param comps The components to initialize (passed by reference).
+ */
+PetscErrorCode PetibmComponentsInitialize(
+	const PetibmField field, PetibmComponents &comps);
+
+
+/*! Labels the connected components of the thresholded field and matches them
+ * with the components of the previous time step.
+ *
+ * The points on process are labeled with a union-find (face neighbors); the
+ * labels are then merged across the process boundaries by exchanging the
+ * ghost labels until no label changes.
+ * The statistics of each component are reduced on the process owning its
+ * label, components smaller than `min_size` are discarded, and the others
+ * are numbered consecutively.
+ * A component continues the track of the component of the previous time step
+ * it overlaps most, if it is the largest overlap of that component; otherwise
+ * it starts a new track.
+ * The centroids are not unwrapped across periodic boundaries.
+ * Collective.
+ *
+ * \param ctx The options.
+ * \param grid The grid of the field (passed by reference).
+ * \param field The field.
+ * \param comps The components (passed by reference).
+ */
+PetscErrorCode PetibmComponentsCompute(
+	const PetibmComponentsCtx ctx, PetibmGrid &grid, const PetibmField field,
+	PetibmComponents &comps);
+
+
+/*! Writes the header of an ASCII catalog file; the file is overwritten.
+ *
+ * \param filepath Path of the output file.
+ * \param ctx The options.
+ */
+PetscErrorCode PetibmComponentsWriteHeader(
+	const std::string filepath, const PetibmComponentsCtx ctx);
+
+
+/*! Appends the catalog of the last time step to an ASCII file.
+ *
+ * One row per component: the time-step index, the index of the component,
+ * its track, its parent, the number of points, the volume, the centroid, the
+ * peak value and its location, and the overlap with the parent.
+ *
+ * \param filepath Path of the output file.
+ * \param step The time-step index.
+ * \param comps The components.
+ */
+PetscErrorCode PetibmComponentsWrite(
+	const std::string filepath, const PetscInt step,
+	const PetibmComponents &comps);
+
+
+/*! Destroys a PetibmComponents structure.
+ *
+ * \param comps The components (passed by reference).
+ */
+PetscErrorCode PetibmComponentsDestroy(PetibmComponents &comps);
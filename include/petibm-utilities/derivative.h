@@ -0,0 +1,73 @@
+/*! Definition of the structure PetibmDerivativeOperator and related functions.
+ * \file derivative.h
+ */
+
+#pragma once
+
+#include <petscsys.h>
+#include <petscvec.h>
+
+
+/*! Location of the derivative relative to the stations it is computed from.
+ */
+enum PetibmDerivativeStaggering
+{
+	PETIBM_DERIVATIVE_BACKWARD,  /// output i lies between the stations i-1 and i
+	PETIBM_DERIVATIVE_FORWARD  /// output i lies between the stations i and i+1
+}; // PetibmDerivativeStaggering
+
+
+/*! Structure holding the stencil coefficients of a first derivative along
+ * one gridline.
+ *
+ * The derivative at output index i is the sum over s in [0, width) of
+ * `Coeffs(i)[s] * f[i + offset + s]`, so a kernel applies it with
+ * multiply-adds only; the inverse spacings are computed once, when the
+ * operator is created, instead of at every point of every time step.
+ */
+struct PetibmDerivativeOperator
+{
+	PetscInt order = 2,  /// order of accuracy (2 or 4)
+	         width = 2,  /// number of points of the stencil
+	         offset = -1,  /// index of the first point of the stencil relative to the output
+	         size = 0;  /// number of output indices
+	PetscReal *coeffs = nullptr;  /// coefficients, `width` per output index
+
+	/// coefficients of the stencil at output index i
+	inline const PetscReal *Coeffs(const PetscInt i) const
+	{
+		return coeffs + (PetscInt64) i * width;
+	}
+}; // PetibmDerivativeOperator
+
+
+/*! Creates the first-derivative operator of a gridline.
+ *
+ * The derivative is evaluated midway between two consecutive stations.
+ * At second order, the stencil holds these two stations (inverse spacing);
+ * at fourth order, it also holds the next station on each side (weights of
+ * the derivative of the Lagrange polynomial on the stretched stations) and
+ * falls back to second order where it would leave the gridline.
+ * On a periodic gridline, the stations beyond the ends are those of the other
+ * end shifted by the period, and the fourth-order stencil is used everywhere;
+ * otherwise, they are extrapolated with the spacing at that end.
+ * The fields the operator is applied to need ghost points `width/2` deep.
+ *
+ * \param stations Sequential vector with all the stations of the gridline.
+ * \param n Number of output indices.
+ * \param order Order of accuracy (2 or 4).
+ * \param stagger Location of the output relative to the stations.
+ * \param period Period of the gridline (0: not periodic).
+ * \param op The operator to create (passed by reference).
+ */
+PetscErrorCode PetibmDerivativeOperatorCreate(
+	const Vec stations, const PetscInt n, const PetscInt order,
+	const PetibmDerivativeStaggering stagger, const PetscReal period,
+	PetibmDerivativeOperator &op);
+
+
+/*! Destroys a PetibmDerivativeOperator structure.
+ *
+ * \param op The operator to destroy (passed by reference).
+ */
+PetscErrorCode PetibmDerivativeOperatorDestroy(PetibmDerivativeOperator &op);
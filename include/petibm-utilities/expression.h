@@ -0,0 +1,363 @@
+/*! Definition of the expressions on fields and of the registry of quantities.
+ * \file expression.h
+ */
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <petscsys.h>
+#include <petscdmda.h>
+
+#include "petibm-utilities/array.h"
+#include "petibm-utilities/derivative.h"
+#include "petibm-utilities/field.h"
+#include "petibm-utilities/threads.h"
+
+
+/*! Base of the nodes of an expression.
+ *
+ * An expression such as `dx(v) - dy(u)` is a tree of nodes known at compile
+ * time; PetibmExpressionEvaluate computes it point by point in a single loop,
+ * without temporary fields.
+ * Each node provides the value at a point (k, j, i) of the output, lists the
+ * fields it reads (Collect), and takes the views of their local values
+ * (Bind).
+ */
+template <typename E>
+struct PetibmExpr
+{
+	inline const E &Self() const { return static_cast<const E &>(*this); }
+}; // PetibmExpr
+
+
+/*! Node holding the values of a field (read from its local vector).
+ */
+struct PetibmExprField : public PetibmExpr<PetibmExprField>
+{
+	PetibmField *field = nullptr;  /// the field
+	PetibmFlatArray<PetscReal> arr;  /// view of the local values of the field
+
+	PetibmExprField(PetibmField &f) : field(&f) {}
+
+	inline PetscReal operator()(
+		const PetscInt k, const PetscInt j, const PetscInt i) const
+	{
+		return arr(k, j, i);
+	}
+
+	inline void Collect(std::vector<PetibmField *> &fields) const
+	{
+		for (PetibmField *f : fields)
+			if (f == field)
+				return;
+		fields.push_back(field);
+	}
+
+	inline void Bind(const std::vector<PetibmField *> &fields,
+	                 const std::vector<PetibmFlatArray<PetscReal>> &views)
+	{
+		for (size_t n=0; n<fields.size(); n++)
+			if (fields[n] == field)
+				arr = views[n];
+	}
+}; // PetibmExprField
+
+
+/*! Node holding a constant.
+ */
+struct PetibmExprScalar : public PetibmExpr<PetibmExprScalar>
+{
+	PetscReal value;  /// the constant
+
+	PetibmExprScalar(const PetscReal v) : value(v) {}
+
+	inline PetscReal operator()(
+		const PetscInt, const PetscInt, const PetscInt) const
+	{
+		return value;
+	}
+
+	inline void Collect(std::vector<PetibmField *> &) const {}
+
+	inline void Bind(const std::vector<PetibmField *> &,
+	                 const std::vector<PetibmFlatArray<PetscReal>> &) {}
+}; // PetibmExprScalar
+
+
+/*! Node applying a derivative operator along a direction (0: x, 1: y, 2: z).
+ *
+ * The index of the output along the direction selects the coefficients of
+ * the operator, which are applied to the points of the stencil of the
+ * operand.
+ */
+template <PetscInt dir, typename E>
+struct PetibmExprDerivative : public PetibmExpr<PetibmExprDerivative<dir, E>>
+{
+	E e;  /// the operand
+	const PetibmDerivativeOperator *op;  /// the derivative operator
+
+	PetibmExprDerivative(const E &e_, const PetibmDerivativeOperator *op_)
+		: e(e_), op(op_) {}
+
+	inline PetscReal operator()(
+		const PetscInt k, const PetscInt j, const PetscInt i) const
+	{
+		const PetscInt q = (dir == 0) ? i : (dir == 1) ? j : k;
+		const PetscReal *c = op->Coeffs(q);
+		PetscReal r = 0.0;
+		PetscInt s, p;
+
+		for (s=0; s<op->width; s++)
+		{
+			p = q + op->offset + s;
+			r += c[s] * ((dir == 0) ? e(k, j, p) : (dir == 1) ? e(k, p, i) : e(p, j, i));
+		}
+		return r;
+	}
+
+	inline void Collect(std::vector<PetibmField *> &fields) const
+	{
+		e.Collect(fields);
+	}
+
+	inline void Bind(const std::vector<PetibmField *> &fields,
+	                 const std::vector<PetibmFlatArray<PetscReal>> &views)
+	{
+		e.Bind(fields, views);
+	}
+}; // PetibmExprDerivative
+
+
+/*! Node combining two operands with a binary operation.
+ */
+template <typename L, typename R, typename Op>
+struct PetibmExprBinary : public PetibmExpr<PetibmExprBinary<L, R, Op>>
+{
+	L l;  /// the left operand
+	R r;  /// the right operand
+
+	PetibmExprBinary(const L &l_, const R &r_) : l(l_), r(r_) {}
+
+	inline PetscReal operator()(
+		const PetscInt k, const PetscInt j, const PetscInt i) const
+	{
+		return Op::Apply(l(k, j, i), r(k, j, i));
+	}
+
+	inline void Collect(std::vector<PetibmField *> &fields) const
+	{
+		l.Collect(fields);
+		r.Collect(fields);
+	}
+
+	inline void Bind(const std::vector<PetibmField *> &fields,
+	                 const std::vector<PetibmFlatArray<PetscReal>> &views)
+	{
+		l.Bind(fields, views);
+		r.Bind(fields, views);
+	}
+}; // PetibmExprBinary
+
+
+struct PetibmExprPlus
+{
+	static inline PetscReal Apply(const PetscReal a, const PetscReal b) { return a + b; }
+};
+
+struct PetibmExprMinus
+{
+	static inline PetscReal Apply(const PetscReal a, const PetscReal b) { return a - b; }
+};
+
+struct PetibmExprTimes
+{
+	static inline PetscReal Apply(const PetscReal a, const PetscReal b) { return a * b; }
+};
+
+struct PetibmExprDivides
+{
+	static inline PetscReal Apply(const PetscReal a, const PetscReal b) { return a / b; }
+};
+
+
+#define PETIBM_EXPR_BINARY(symbol, Op) \
+template <typename L, typename R> \
+inline PetibmExprBinary<L, R, Op> operator symbol( \
+	const PetibmExpr<L> &l, const PetibmExpr<R> &r) \
+{ \
+	return PetibmExprBinary<L, R, Op>(l.Self(), r.Self()); \
+} \
+template <typename L> \
+inline PetibmExprBinary<L, PetibmExprScalar, Op> operator symbol( \
+	const PetibmExpr<L> &l, const PetscReal r) \
+{ \
+	return PetibmExprBinary<L, PetibmExprScalar, Op>(l.Self(), r); \
+} \
+template <typename R> \
+inline PetibmExprBinary<PetibmExprScalar, R, Op> operator symbol( \
+	const PetscReal l, const PetibmExpr<R> &r) \
+{ \
+	return PetibmExprBinary<PetibmExprScalar, R, Op>(l, r.Self()); \
+}
+
+PETIBM_EXPR_BINARY(+, PetibmExprPlus)
+PETIBM_EXPR_BINARY(-, PetibmExprMinus)
+PETIBM_EXPR_BINARY(*, PetibmExprTimes)
+PETIBM_EXPR_BINARY(/, PetibmExprDivides)
+
+#undef PETIBM_EXPR_BINARY
+
+
+/*! Derivative along a direction, applied to an expression with `d(e)`.
+ */
+template <PetscInt dir>
+struct PetibmExprDiff
+{
+	const PetibmDerivativeOperator *op;  /// the derivative operator
+
+	template <typename E>
+	inline PetibmExprDerivative<dir, E> operator()(const PetibmExpr<E> &e) const
+	{
+		return PetibmExprDerivative<dir, E>(e.Self(), op);
+	}
+}; // PetibmExprDiff
+
+
+/// derivative in the x-direction with a given operator
+inline PetibmExprDiff<0> PetibmExprDx(const PetibmDerivativeOperator &op)
+{
+	return PetibmExprDiff<0>{&op};
+}
+
+/// derivative in the y-direction with a given operator
+inline PetibmExprDiff<1> PetibmExprDy(const PetibmDerivativeOperator &op)
+{
+	return PetibmExprDiff<1>{&op};
+}
+
+/// derivative in the z-direction with a given operator
+inline PetibmExprDiff<2> PetibmExprDz(const PetibmDerivativeOperator &op)
+{
+	return PetibmExprDiff<2>{&op};
+}
+
+
+/*! Evaluates an expression into a field.
+ *
+ * The local vectors of the fields read by the expression are obtained once
+ * (ghost values included), then the owned points of the output are split in
+ * slabs along the slowest dimension between the threads of the process and
+ * computed in a single loop.
+ * The fields read need ghost points as deep as the stencils applied to them.
+ *
+ * \param expression The expression.
+ * \param out The field to compute (passed by reference).
+ */
+template <typename E>
+PetscErrorCode PetibmExpressionEvaluate(
+	const PetibmExpr<E> &expression, PetibmField &out)
+{
+	PetscErrorCode ierr;
+	E expr = expression.Self();
+	std::vector<PetibmField *> fields;
+	std::vector<PetibmFlatArray<PetscReal>> views;
+	PetibmFlatArray<PetscReal> out_a;
+	DMDALocalInfo info;
+
+	PetscFunctionBeginUser;
+
+	expr.Collect(fields);
+	views.resize(fields.size());
+	for (size_t n=0; n<fields.size(); n++)
+	{
+		if (fields[n] == &out)
+			SETERRQ(PETSC_COMM_WORLD, PETSC_ERR_ARG_IDN,
+			        "The output field cannot be read by the expression");
+		ierr = PetibmFieldGetLocal(*fields[n]); CHKERRQ(ierr);
+		ierr = PetibmArrayGet(
+			fields[n]->da, fields[n]->local, views[n]); CHKERRQ(ierr);
+	}
+	expr.Bind(fields, views);
+
+	ierr = DMDAGetLocalInfo(out.da, &info); CHKERRQ(ierr);
+	ierr = PetibmArrayGet(out.da, out.global, out_a); CHKERRQ(ierr);
+	ierr = PetibmThreadsRun([&](const PetscInt t, const PetscInt n)
+	{
+		PetscInt i, j, k, ys = info.ys, ye = info.ys+info.ym,
+		         zs = info.zs, ze = info.zs+info.zm;
+		PetscReal *row;
+		// static slabs along the slowest dimension (z in 3D, y in 2D)
+		if (info.dim == 3)
+			PetibmThreadsGetSlab(info.zs, info.zs+info.zm, t, n, &zs, &ze);
+		else
+			PetibmThreadsGetSlab(info.ys, info.ys+info.ym, t, n, &ys, &ye);
+		for (k=zs; k<ze; k++)
+			for (j=ys; j<ye; j++)
+			{
+				row = out_a.Row(k, j);
+				for (i=info.xs; i<info.xs+info.xm; i++)
+					row[i] = expr(k, j, i);
+			}
+	}); CHKERRQ(ierr);
+	ierr = PetibmArrayRestore(out.da, out.global, out_a); CHKERRQ(ierr);
+
+	for (size_t n=0; n<fields.size(); n++)
+	{
+		ierr = PetibmArrayRestore(
+			fields[n]->da, fields[n]->local, views[n]); CHKERRQ(ierr);
+		ierr = PetibmFieldRestoreLocal(*fields[n]); CHKERRQ(ierr);
+	}
+
+	PetscFunctionReturn(0);
+} // PetibmExpressionEvaluate
+
+
+/*! Structure holding the inputs of a registered quantity.
+ *
+ * The operator d[a] differentiates along the axis a and maps to the location
+ * of the output, so each quantity expects its own operators:
+ * - `wx`, `wy`, `wz`: the operators of PetibmVorticity?CreateOperators (for
+ *   `wz`, d[0] on the x-stations of u[1] and d[1] on the y-stations of u[0]),
+ *   mapping to the vorticity points;
+ * - `divergence`: d[a] on the stations of u[a] along the axis a (its faces),
+ *   with PETIBM_DERIVATIVE_BACKWARD, mapping to the cell centers; the
+ *   vorticity operators cannot be reused.
+ */
+struct PetibmQuantityArgs
+{
+	PetibmField *u[3] = {nullptr, nullptr, nullptr};  /// velocity components (x, y, z)
+	const PetibmDerivativeOperator *d[3] = {nullptr, nullptr, nullptr};  /// derivative operators along x, y, z, to the location of the output
+}; // PetibmQuantityArgs
+
+
+/*! Function computing a quantity into a field from its inputs.
+ */
+typedef std::function<PetscErrorCode(
+	const PetibmQuantityArgs &, PetibmField &)> PetibmQuantityFunction;
+
+
+/*! Registers a quantity under a name (replacing a previous one, if any).
+ *
+ * The function usually evaluates an expression on the inputs with
+ * PetibmExpressionEvaluate, so that a new quantity needs no loop of its own.
+ * The quantities `wx`, `wy`, `wz` (vorticity components) and `divergence`
+ * are registered by default (see PetibmQuantityArgs for their operators).
+ *
+ * \param name Name of the quantity.
+ * \param function The function computing it.
+ */
+PetscErrorCode PetibmQuantityRegister(
+	const std::string name, const PetibmQuantityFunction function);
+
+
+/*! Computes a registered quantity.
+ *
+ * \param name Name of the quantity.
+ * \param args The inputs.
+ * \param out The field to compute (passed by reference).
+ */
+PetscErrorCode PetibmQuantityCompute(
+	const std::string name, const PetibmQuantityArgs &args, PetibmField &out);
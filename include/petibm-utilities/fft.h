@@ -0,0 +1,54 @@
+/*! Definition of the structure PetibmFFT and related functions.
+ * \file fft.h
+ */
+
+#pragma once
+
+#include <complex>
+#include <vector>
+
+#include <petscsys.h>
+
+
+/*! Structure holding the plan of a real-to-complex discrete Fourier transform.
+ *
+ * A sequence of even length n is packed into a complex sequence of length
+ * n/2 (even values as real parts, odd values as imaginary parts), transformed,
+ * and unpacked; a sequence of odd length is transformed as a complex sequence
+ * of length n.
+ * The complex transform is a mixed-radix decimation in time over the prime
+ * factors of its length.
+ */
+struct PetibmFFT
+{
+	PetscInt n = 0,  /// length of the real sequences
+	         m = 0,  /// length of the complex transform
+	         worksize = 0;  /// number of complex values of the work array
+	std::vector<PetscInt> factors;  /// radices of the complex transform
+	std::vector<std::complex<PetscReal>> twiddles,  /// roots of unity of length m
+	                                     rotations;  /// roots of unity of length n (unpacking)
+}; // PetibmFFT
+
+
+/*! Initializes the plan of the transform of real sequences of a given length.
+ *
+ * \param n Length of the real sequences.
+ * \param fft The plan to initialize (passed by reference).
+ */
+PetscErrorCode PetibmFFTInitialize(const PetscInt n, PetibmFFT &fft);
+
+
+/*! Transforms a real sequence.
+ *
+ * The n/2+1 non-redundant coefficients X[k] = sum_j x[j] exp(-2 i pi j k / n)
+ * are computed. Thread-safe (no PETSc or MPI call): each thread passes its own
+ * work array.
+ *
+ * \param fft The plan.
+ * \param in The real sequence (n values).
+ * \param out The coefficients (n/2+1 values).
+ * \param work Work array (fft.worksize values).
+ */
+void PetibmFFTExecute(
+	const PetibmFFT &fft, const PetscReal *in,
+	std::complex<PetscReal> *out, std::complex<PetscReal> *work);
@@ -8,6 +8,7 @@
 #include <petscdmda.h>
 
 #include "petibm-utilities/grid.h"
+#include "petibm-utilities/pool.h"
 
 
 /*! Structure holding the field (decomposition and vectors).
@@ -16,7 +17,9 @@ struct PetibmField
 {
 	DM da;  /// the decomposition of the field
 	Vec global,  /// parallel vector containing the field values
-	    local;  /// sequential ghosted vector containing the field values on process.
+	    local = nullptr;  /// sequential ghosted vector containing the field values on process.
+	PetscReal bc_value = 0.0;  /// value at external boundary ghost points
+	PetibmFieldPool *pool = nullptr;  /// pool lending the local vector (if any)
 }; // PetibmField
 
 
@@ -24,8 +27,8 @@ struct PetibmField
  */
 struct PetibmFieldCtx
 {
-	char path[PETSC_MAX_PATH_LEN];  /// path of the file containing field values
-	char name[PETSC_MAX_PATH_LEN];  /// name of the field
+	char path[PETSC_MAX_PATH_LEN] = "";  /// path of the file containing field values
+	char name[PETSC_MAX_PATH_LEN] = "";  /// name of the field
 	PetscReal bc_value = 0.0;  /// value to set at external boundary points
 	PetscBool periodic_x = PETSC_FALSE,  /// is field periodic in the x-direction?
 	          periodic_y = PETSC_FALSE,  /// is field periodic in the y-direction?
@@ -70,7 +73,40 @@ PetscErrorCode PetibmFieldInitialize(
 PetscErrorCode PetibmFieldInitialize(const DM da, PetibmField &field);
 
 
+/*! Initializes a PetibmField structure based on the grid, through a pool.
+ *
+ * The DMDA object is shared with the fields of the pool that have the same
+ * layout. Only the global vector is created; the local vector is borrowed
+ * from the pool with PetibmFieldGetLocal.
+ *
+ * \param ctx The context.
+ * \param grid The grid used a reference for domain decomposition of the field.
+ * \param pool The pool (passed by reference).
+ * \param field The field to initialize (passed by reference).
+ */
+PetscErrorCode PetibmFieldInitialize(
+	const PetibmFieldCtx ctx, const PetibmGrid grid,
+	PetibmFieldPool &pool, PetibmField &field);
+
+
+/*! Initializes a PetibmField structure with a DMDA object already set, through
+ * a pool.
+ *
+ * If the pool holds a DMDA object with the same layout, the DMDA of the field
+ * is destroyed and replaced by the pooled one.
+ * Only the global vector is created; the local vector is borrowed from the
+ * pool with PetibmFieldGetLocal.
+ *
+ * \param pool The pool (passed by reference).
+ * \param field The field to initialize (passed by reference).
+ */
+PetscErrorCode PetibmFieldInitialize(PetibmFieldPool &pool, PetibmField &field);
+
+
 /*! Sets the value at external boundary points.
+ *
+ * The value is kept with the field and applied every time the local vector is
+ * obtained with PetibmFieldGetLocal.
  *
  * \param value The value on the external boundaries.
  * \param field The field to modify (passed by reference).
@@ -86,6 +122,45 @@ PetscErrorCode PetibmFieldSetBoundaryPoints(
 PetscErrorCode PetibmFieldGlobalToLocal(PetibmField &field);
 
 
+/*! Gets the local vector of a field, filled with the global values and the
+ * value at external boundary points.
+ *
+ * If the field belongs to a pool, the local vector is borrowed from the pool
+ * and should be returned with PetibmFieldRestoreLocal.
+ *
+ * \param field The field to work on (passed by reference).
+ */
+PetscErrorCode PetibmFieldGetLocal(PetibmField &field);
+
+
+/*! Restores the local vector of a field obtained with PetibmFieldGetLocal.
+ *
+ * \param field The field to work on (passed by reference).
+ */
+PetscErrorCode PetibmFieldRestoreLocal(PetibmField &field);
+
+
+/*! Gets the local vectors of several fields in a single ghost exchange.
+ *
+ * The scatters of all the fields are started before any of them is
+ * completed, so that the messages to the neighbors travel together; the
+ * local vectors are then handled as with PetibmFieldGetLocal.
+ *
+ * \param n Number of fields.
+ * \param fields The fields to work on.
+ */
+PetscErrorCode PetibmFieldGetLocal(const PetscInt n, PetibmField *fields[]);
+
+
+/*! Restores the local vectors of several fields obtained with
+ * PetibmFieldGetLocal.
+ *
+ * \param n Number of fields.
+ * \param fields The fields to work on.
+ */
+PetscErrorCode PetibmFieldRestoreLocal(const PetscInt n, PetibmField *fields[]);
+
+
 /*! Destroys the PETSc objects of a PetibmField structure.
  *
  * \param field The PetibmField structure (passed by reference).
@@ -146,38 +221,50 @@ PetscErrorCode PetibmFieldBinaryWrite(
 	const std::string filepath, const std::string name, const PetibmField field);
 
 
-/*! Interpolates field A associated with grid A onto grid B.
+/*! Identifier at the beginning of a file in native layout.
+ */
+static const PetscInt PetibmFieldNativeClassId = 1211299;
+
+
+/*! Reads the field values stored in native (decomposition) layout from file.
  *
- * \param gridA The grid to interpolate from.
- * \param fieldA The field to interpolate.
- * \param gridB The grid to interpolate on.
- * \param fieldB The resulting interpolated field (passed by reference).
+ * When the decomposition of the field matches the header of the file, each
+ * process loads its block directly; otherwise, the blocks are loaded as
+ * stored and scattered to the decomposition of the field.
+ *
+ * \param filepath Path of the input file.
+ * \param name The name of the field.
+ * \param field The PetibmField structure (passed by reference).
  */
-PetscErrorCode PetibmFieldInterpolate(
-	PetibmGrid gridA, PetibmField fieldA, PetibmGrid gridB, PetibmField &fieldB);
+PetscErrorCode PetibmFieldNativeRead(
+	const std::string filepath, const std::string name, PetibmField &field);
 
 
-/*! Interpolates a 2D field A associated with grid A onto grid B.
+/*! Writes the field values into file in native (decomposition) layout.
  *
- * Performs bi-linear interpolation.
+ * The file holds a small header with the decomposition of the field (number
+ * of points, components, and processes, ownership ranges), then the blocks of
+ * the processes in rank order; no redistribution to natural ordering is done.
+ * `-native_alignment <bytes>` pads the header so that the values start at a
+ * multiple of the given number of bytes (e.g., the stripe size of the file
+ * system) for the collective MPI-IO writes (`-viewer_binary_mpiio`).
  *
- * \param gridA The grid to interpolate from.
- * \param fieldA The field to interpolate.
- * \param gridB The grid to interpolate on.
- * \param fieldB The resulting interpolated field (passed by reference).
+ * \param filepath Path of the output file.
+ * \param name Name of the field.
+ * \param field PetibmField structure.
  */
-PetscErrorCode PetibmFieldInterpolate2D(
-	PetibmGrid gridA, PetibmField fieldA, PetibmGrid gridB, PetibmField &fieldB);
+PetscErrorCode PetibmFieldNativeWrite(
+	const std::string filepath, const std::string name, const PetibmField field);
 
 
-/*! Interpolates a 3D field A associated with grid A onto grid B.
+/*! Interpolates field A associated with grid A onto grid B.
  *
- * Performs tri-linear interpolation.
+ * Dispatches to the interpolation kernel specialized for the dimension.
  *
  * \param gridA The grid to interpolate from.
  * \param fieldA The field to interpolate.
  * \param gridB The grid to interpolate on.
  * \param fieldB The resulting interpolated field (passed by reference).
  */
-PetscErrorCode PetibmFieldInterpolate3D(
+PetscErrorCode PetibmFieldInterpolate(
 	PetibmGrid gridA, PetibmField fieldA, PetibmGrid gridB, PetibmField &fieldB);
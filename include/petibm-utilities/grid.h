@@ -5,6 +5,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include <petscsys.h>
 #include <petscvec.h>
@@ -15,8 +16,8 @@
  */
 struct PetibmGridCtx
 {
-	char path[PETSC_MAX_PATH_LEN];  /// path of the file containing the grid
-	char name[PETSC_MAX_PATH_LEN];  /// name of the grid
+	char path[PETSC_MAX_PATH_LEN] = "";  /// path of the file containing the grid
+	char name[PETSC_MAX_PATH_LEN] = "";  /// name of the grid
 	PetscInt nx = 0,  /// number of points in the x-direction
 	         ny = 0,  /// number of points in the y-direction
 	         nz = 0;  /// number of points in the z-direction
@@ -29,9 +30,9 @@ struct PetibmGridCtx
  */
 struct PetibmGridline
 {
-	DM da;  /// 1D DMDA object
-	Vec coords,  /// vector containing the gridline stations
-	    local;  /// local ghosted vector for stations on process
+	DM da = nullptr;  /// 1D DMDA object
+	Vec coords = nullptr,  /// vector containing the gridline stations
+	    local = nullptr;  /// local ghosted vector for stations on process
 }; // PetibmGridline
 
 
@@ -59,11 +60,28 @@ PetscErrorCode PetibmGridCtxPrintf(
 	const std::string name, const PetibmGridCtx ctx);
 
 
+/*! Fills the number of points missing from the context with the sizes of
+ * the gridlines stored in a file.
+ *
+ * Collective on PETSC_COMM_WORLD; sizes already set (greater than 0) are kept
+ * and a gridline absent from the file (e.g., `z` in 2D) leaves its size unset.
+ *
+ * \param filepath Path of the file with the gridline stations.
+ * \param name Name of the grid.
+ * \param ctx The PetibmGridCtx structure to fill (passed by pointer).
+ */
+PetscErrorCode PetibmGridCtxDetectSizes(
+	const std::string filepath, const std::string name, PetibmGridCtx *ctx);
+
+
 /*! Initializes the grid based on the context.
  *
  * Creates a 1D DMDA object for each direction and creates the local global
  * vectors associated with each DMDA.
- * The domain is decomposed along the y-direction only.
+ * The gridlines follow the decomposition of a field DMDA of the same size:
+ * each gridline is distributed over the processes that share the same
+ * location along the other directions, and each process holds only the
+ * stations it owns plus ghosts.
  *
  * \param ctx The grid context.
  * \param grid The grid to initialize (passed by reference).
@@ -72,12 +90,27 @@ PetscErrorCode PetibmGridInitialize(
 	const PetibmGridCtx ctx, PetibmGrid &grid);
 
 
+/*! Initializes the grid based on the context and the periodicity of the
+ * fields.
+ *
+ * As PetibmGridInitialize(ctx, grid), with periodic gridline DMDAs along the
+ * periodic directions of the fields (the ghost stations are then wrapped and
+ * the external boundary points are not set).
+ *
+ * \param ctx The grid context.
+ * \param periodic Periodicity of the fields in each direction.
+ * \param grid The grid to initialize (passed by reference).
+ */
+PetscErrorCode PetibmGridInitialize(
+	const PetibmGridCtx ctx, const PetscBool periodic[], PetibmGrid &grid);
+
+
 /*! Initializes a grid, providing the coordinates, based on a reference grid.
  *
  * Creates a 1D DMDA objects for each direction and creates the local and global
  * vectors associated with each DMDA.
- * The coordinates are provided as an array of sequential vectors, each vectors
- * containing the stations along a gridline.
+ * The coordinates are provided as an array of vectors, each vectors containing
+ * the stations along a gridline (see PetibmGridlineInitialize).
  * The decomposition followed the decomposition of a reference grid so that
  * physically closed points are located on the same process.
  *
@@ -93,11 +126,16 @@ PetscErrorCode PetibmGridInitialize(
  * gridline.
  *
  * Creates a 1D DMDA object for the direction and creates the local and global
- * vectors associated with it.
- * The coordinates are provided as a sequential vector containing the stations
- * along the gridline.
+ * vectors associated with it; the stations are copied into the global vector.
+ * The coordinates are provided either as a sequential vector containing all
+ * the stations along the gridline, or as a vector distributed over the
+ * communicator of the reference gridline (any layout).
  * The decomposition followed the decomposition of a reference gridline so that
- * physically closed points are located on the same process.
+ * physically closed points are located on the same process: the ownership
+ * ranges are obtained by a distributed binary search of the last station
+ * owned by each process of the reference gridline (a process owning no
+ * station ends where the previous one ends).
+ * The boundary type is the one of the reference gridline.
  *
  * \param other The gridline used as a reference.
  * \param coords The stations along the direction.
@@ -118,6 +156,8 @@ PetscErrorCode PetibmGridSetBoundaryPoints(
 
 
 /*! Sets the starting end ending points for a gridline.
+ *
+ * Nothing is done on a periodic gridline (the ghost stations are wrapped).
  *
  * \param start The starting point.
  * \param end The ending point.
@@ -141,6 +181,21 @@ PetscErrorCode PetibmGridGlobalToLocal(PetibmGrid &grid);
 PetscErrorCode PetibmGridlineGlobalToLocal(PetibmGridline &line);
 
 
+/*! Gets the widths of the cells around the stations of a gridline on process.
+ *
+ * Trapezoidal rule: half the distance between the neighboring stations,
+ * and half the distance to the single neighbor at the ends of the gridline.
+ * On a periodic gridline, the station beyond an end is one mean end spacing
+ * away (as in PetibmStreamFunction), so that the end cells get full widths.
+ * Collective on the communicator of the gridline.
+ *
+ * \param line The gridline to work on (passed by reference).
+ * \param widths The widths of the stations on process (passed by reference).
+ */
+PetscErrorCode PetibmGridlineGetWidths(
+	PetibmGridline &line, std::vector<PetscReal> &widths);
+
+
 /*! Destroys a PetibmGrid structure.
  *
  * \param grid The PetibmGrid structure to destroy (passed by reference).
@@ -158,6 +213,10 @@ PetscErrorCode PetibmGridlineDestroy(PetibmGridline &line);
 /*! Reads the gridlines from file.
  *
  * The gridlines should be stored in HDF5 format in the same file.
+ * Unless `-replicated_read rank`, the stations are read once (per node or on
+ * rank 0) with PetibmGridlineHDF5ReadShared and each process copies the
+ * stations it owns; otherwise, each copy of a gridline is read over its own
+ * communicator.
  *
  * \param filepath Path of the input file.
  * \param varname Name of variable (group name in the HDF5).
@@ -170,17 +229,47 @@ PetscErrorCode PetibmGridHDF5Read(
 /*! Reads the gridline stations from a file.
  *
  * The stations along the gridline should be stored in HDF5 format.
+ * Collective on the communicator of the vector.
  *
  * \param filepath The path of the input file.
  * \param varname The name of the variable.
  * \param name The name of the gridline (the direction).
- * \param line The sequential vector to fill (passed by reference).
+ * \param line The vector to fill, sequential or distributed (passed by
+ *        reference).
  */
 PetscErrorCode PetibmGridlineHDF5Read(
 	const std::string filepath, const std::string varname,
 	const std::string name, Vec &line);
 
+
+/*! Creates a sequential vector with the gridline stations read from a file.
+ *
+ * Collective on PETSC_COMM_WORLD.
+ * The mode is set with the option `-replicated_read <rank|root|node>`
+ * (default: `rank`, every process reads the file).
+ * With `root` (or `node`), rank 0 (or one process per node) reads the file;
+ * the stations are broadcast to one process per node and held in a node-local
+ * MPI-3 shared-memory window that backs the vector of every process on the
+ * node.
+ * If the read or the broadcast fails, every process falls back to reading
+ * the file.
+ * The vector should be considered read-only; destroying it (on all processes)
+ * frees the window.
+ *
+ * \param filepath The path of the input file.
+ * \param varname The name of the variable.
+ * \param name The name of the gridline (the direction).
+ * \param n The number of stations along the gridline.
+ * \param line The sequential vector to create (passed by pointer).
+ */
+PetscErrorCode PetibmGridlineHDF5ReadShared(
+	const std::string filepath, const std::string varname,
+	const std::string name, const PetscInt n, Vec *line);
+
 /*! Writes the gridlines into file in HDF5 format.
+ *
+ * Collective on PETSC_COMM_WORLD: only the copy of each gridline held by
+ * rank 0 is written, over the communicator of its vector.
  *
  * \param filepath Path of the output file.
  * \param varname Name of the grid.
@@ -0,0 +1,115 @@
+/*! Definition of the structure PetibmImage and related functions.
+ * \file image.h
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <petscsys.h>
+#include <petscvec.h>
+#include <petscdmda.h>
+
+#include "petibm-utilities/field.h"
+
+
+/*! Structure holding information about the rendering of a 2D field.
+ */
+struct PetibmImageCtx
+{
+	PetscInt colormap = 0,  /// index of the colormap (gray, viridis, coolwarm, jet)
+	         format = 0,  /// index of the image format (ppm, png)
+	         width = 0;  /// width of the image in pixels (0: number of x-stations)
+	PetscReal min = 0.0,  /// value mapped to the lower end of the colormap
+	          max = 0.0;  /// value mapped to the upper end (if min == max: field range)
+}; // PetibmImageCtx
+
+
+/*! Structure holding a rendered image.
+ *
+ * The pixels are composited on the first process of the communicator of the
+ * field; the other processes hold no pixel.
+ */
+struct PetibmImage
+{
+	PetscInt width = 0,  /// width of the image in pixels
+	         height = 0;  /// height of the image in pixels
+	PetscBool owner = PETSC_FALSE;  /// does the process hold the pixels?
+	std::vector<unsigned char> pixels;  /// RGB pixels, row by row from the top
+}; // PetibmImage
+
+
+/*! Gets options from command-line or config file.
+ *
+ * `-colormap <gray|viridis|coolwarm|jet>`, `-format <ppm|png>`,
+ * `-width <pixels>`, `-min <value>`, and `-max <value>`.
+ *
+ * \param prefix String to prepend to options.
+ * \param ctx The PetibmImageCtx structure to fill (passed by pointer).
+ */
+PetscErrorCode PetibmImageGetOptions(
+	const char prefix[], PetibmImageCtx *ctx);
+
+
+/*! Gets the file extension of the image format.
+ *
+ * \param ctx The image context.
+ * \param extension The extension, without the dot (passed by pointer).
+ */
+PetscErrorCode PetibmImageGetExtension(
+	const PetibmImageCtx ctx, std::string *extension);
+
+
+/*! Renders a colormapped image of a 2D field.
+ *
+ * Collective on the communicator of the field.
+ * The pixels are uniformly distributed over the domain covered by the
+ * stations (the height follows the aspect ratio of the domain) and the field
+ * is interpolated bi-linearly at their centers.
+ * Each process rasterizes the pixels whose center lies in the part of the
+ * domain it owns (a rectangle of pixels); the rectangles are composited on
+ * the first process.
+ *
+ * \param ctx The image context.
+ * \param field The 2D field to render (passed by reference).
+ * \param stations Sequential vectors with all the stations in the x- and y-directions.
+ * \param image The image (passed by reference).
+ */
+PetscErrorCode PetibmImageRender(
+	const PetibmImageCtx ctx, PetibmField &field, const Vec stations[],
+	PetibmImage &image);
+
+
+/*! Writes an image into a file.
+ *
+ * Nothing is done on the processes that do not hold the pixels.
+ *
+ * \param filepath Path of the output file.
+ * \param ctx The image context (to get the format).
+ * \param image The image.
+ */
+PetscErrorCode PetibmImageWrite(
+	const std::string filepath, const PetibmImageCtx ctx,
+	const PetibmImage &image);
+
+
+/*! Writes an image into a binary PPM file (P6).
+ *
+ * \param filepath Path of the output file.
+ * \param image The image.
+ */
+PetscErrorCode PetibmImagePPMWrite(
+	const std::string filepath, const PetibmImage &image);
+
+
+/*! Writes an image into a PNG file.
+ *
+ * The encoder is self-contained: the zlib stream is made of stored
+ * (uncompressed) deflate blocks.
+ *
+ * \param filepath Path of the output file.
+ * \param image The image.
+ */
+PetscErrorCode PetibmImagePNGWrite(
+	const std::string filepath, const PetibmImage &image);
@@ -0,0 +1,79 @@
+/*! Definition of the structure PetibmDatasetInfo and related functions.
+ * \file info.h
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <petscsys.h>
+
+
+/*! Structure holding the metadata of a dataset (or vector) in a file.
+ */
+struct PetibmDatasetInfo
+{
+	std::string name;  /// path of the dataset in the file
+	std::string type;  /// type of the values (e.g., float64)
+	std::vector<PetscInt> shape;  /// number of values along each dimension
+	std::vector<PetscInt> chunk;  /// chunk dimensions (empty if not chunked)
+	PetscBool ranged = PETSC_FALSE;  /// is the range of the values computed?
+	PetscReal min = 0.0,  /// minimum value
+	          max = 0.0;  /// maximum value
+}; // PetibmDatasetInfo
+
+
+/*! Gets the shape of a dataset in an HDF5 file, without reading the values.
+ *
+ * Collective on PETSC_COMM_WORLD; rank 0 reads the header and broadcasts the
+ * shape, which is left empty if the file or the dataset does not exist.
+ *
+ * \param filepath Path of the file.
+ * \param name Path of the dataset in the file.
+ * \param shape The shape, slowest dimension first (passed by reference).
+ */
+PetscErrorCode PetibmInfoHDF5GetShape(
+	const std::string filepath, const std::string name,
+	std::vector<PetscInt> &shape);
+
+
+/*! Gets the metadata of all the datasets of an HDF5 file.
+ *
+ * Collective on PETSC_COMM_WORLD; rank 0 walks the headers and broadcasts
+ * them.
+ * With `sample` greater than 0, the range of the values of each dataset is
+ * computed from every `sample`-th index along its first dimension, the
+ * selected indices being read in parallel (hyperslab per process).
+ *
+ * \param filepath Path of the file.
+ * \param sample Stride of the indices read along the first dimension (0: no range).
+ * \param datasets The metadata of the datasets (passed by reference).
+ */
+PetscErrorCode PetibmInfoHDF5Read(
+	const std::string filepath, const PetscInt sample,
+	std::vector<PetibmDatasetInfo> &datasets);
+
+
+/*! Gets the metadata of the vector stored in a PETSc binary file.
+ *
+ * Collective on PETSC_COMM_WORLD; rank 0 reads the header (and the
+ * decomposition header of a file in native layout, which gives the shape).
+ * With `range`, the vector is loaded in parallel to compute its range.
+ *
+ * \param filepath Path of the file.
+ * \param range Compute the range of the values?
+ * \param datasets The metadata of the vector (passed by reference).
+ */
+PetscErrorCode PetibmInfoBinaryRead(
+	const std::string filepath, const PetscBool range,
+	std::vector<PetibmDatasetInfo> &datasets);
+
+
+/*! Prints the metadata of datasets.
+ *
+ * \param filepath Path of the file.
+ * \param datasets The metadata of the datasets.
+ */
+PetscErrorCode PetibmInfoPrintf(
+	const std::string filepath, const std::vector<PetibmDatasetInfo> &datasets);
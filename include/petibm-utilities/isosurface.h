@@ -0,0 +1,71 @@
+/*! Definition of the structure PetibmIsoSurface and related functions.
+ * \file isosurface.h
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <petscsys.h>
+#include <petscdmda.h>
+
+#include "petibm-utilities/field.h"
+#include "petibm-utilities/grid.h"
+
+
+/*! Structure holding the part of an isosurface (triangle mesh) on process.
+ *
+ * A vertex lies on an edge of the grid; it is owned by the process owning
+ * the lower node of the edge, so that vertices on the boundaries between
+ * processes are not duplicated.
+ * The triangles refer to the vertices with their global index.
+ */
+struct PetibmIsoSurface
+{
+	std::vector<float> points;  /// coordinates (x, y, z) of the vertices on process
+	std::vector<PetscInt> triangles;  /// global indices of the triangle vertices
+	PetscInt start = 0,  /// global index of the first vertex on process
+	         size = 0;  /// total number of vertices
+	DM da = nullptr;  /// DMDA with the vertex indices on the edges (3 dof)
+	Vec global = nullptr,  /// global vector with the vertex indices
+	    local = nullptr;  /// local ghosted vector with the vertex indices
+}; // PetibmIsoSurface
+
+
+/*! Extracts an isosurface of a 3D field with marching cubes.
+ *
+ * Each process polygonizes the cells whose lower corner it owns, using the
+ * ghost values of the field; the vertex indices are exchanged through a
+ * ghosted DMDA with the layout of the field.
+ * The gridlines of the grid should be distributed (PetibmGridInitialize).
+ * The triangles are oriented consistently, and the surface is closed
+ * wherever it does not cross the external boundaries of the domain.
+ *
+ * \param grid The grid of the field (passed by reference).
+ * \param field The field (passed by reference).
+ * \param value The iso-value.
+ * \param surf The isosurface (passed by reference).
+ */
+PetscErrorCode PetibmIsoSurfaceCompute(
+	PetibmGrid &grid, PetibmField &field, const PetscReal value,
+	PetibmIsoSurface &surf);
+
+
+/*! Writes the isosurface into a binary PLY file.
+ *
+ * Collective; the processes write their vertices and triangles at their
+ * offsets in the same file with MPI-IO.
+ *
+ * \param filepath Path of the output file.
+ * \param surf The isosurface.
+ */
+PetscErrorCode PetibmIsoSurfacePLYWrite(
+	const std::string filepath, const PetibmIsoSurface &surf);
+
+
+/*! Destroys a PetibmIsoSurface structure.
+ *
+ * \param surf The isosurface (passed by reference).
+ */
+PetscErrorCode PetibmIsoSurfaceDestroy(PetibmIsoSurface &surf);
@@ -23,6 +23,17 @@
 PetscErrorCode PetibmGetDirectory(std::string *directory);
 
 
+/*! Inserts a configuration file into the options database, once.
+ *
+ * PETSc reads the file on rank 0 and broadcasts its content; a file already
+ * inserted (e.g., shared by the grid, field, and time-step options) is not
+ * read again.
+ *
+ * \param path Path of the configuration file.
+ */
+PetscErrorCode PetibmOptionsInsertFile(const std::string path);
+
+
 /*! Counts the number of points within provided boundaries.
  *
  * \param x The sequential vector containing the points.
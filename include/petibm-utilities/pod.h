@@ -0,0 +1,172 @@
+/*! Definition of the structure PetibmPOD and related functions.
+ * \file pod.h
+ */
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <petscsys.h>
+#include <petscvec.h>
+#include <petscdmda.h>
+
+#include "petibm-utilities/field.h"
+#include "petibm-utilities/grid.h"
+
+
+/*! Structure holding the options of the proper orthogonal decomposition.
+ */
+struct PetibmPODCtx
+{
+	PetscInt block = 8,  /// number of snapshots held in memory during a pass
+	         modes = 4;  /// number of modes to reconstruct
+	PetscBool subtract_mean = PETSC_TRUE,  /// decompose the fluctuations around the mean?
+	          weighted = PETSC_TRUE;  /// weight the inner product with the cell volumes?
+}; // PetibmPODCtx
+
+
+/*! Function reading a snapshot (index in the sequence) into the global vector
+ * of a field.
+ */
+typedef std::function<PetscErrorCode(const PetscInt, PetibmField &)>
+	PetibmPODReadFunction;
+
+
+/*! Function writing a mode (index of the mode) held in the global vector of a
+ * field.
+ */
+typedef std::function<PetscErrorCode(const PetscInt, const PetibmField &)>
+	PetibmPODWriteFunction;
+
+
+/*! Structure holding the proper orthogonal decomposition of a sequence of
+ * snapshots (method of snapshots).
+ */
+struct PetibmPOD
+{
+	PetscInt size = 0,  /// number of snapshots
+	         reads = 0;  /// number of snapshots read so far
+	std::vector<PetscReal> gram,  /// inner products of the snapshots (size x size)
+	                       eigenvalues,  /// eigenvalues of the Gram matrix, decreasing
+	                       eigenvectors;  /// eigenvectors, one after the other
+	Vec weights = nullptr;  /// weights of the inner product (nullptr: none)
+}; // PetibmPOD
+
+
+/*! Gets options from command-line or config file.
+ *
+ * `-block <n>`, `-modes <n>`, `-subtract_mean <true|false>`,
+ * `-weighted <true|false>`.
+ *
+ * \param prefix String to prepend to options.
+ * \param ctx The PetibmPODCtx structure to fill (passed by pointer).
+ */
+PetscErrorCode PetibmPODGetOptions(const char prefix[], PetibmPODCtx *ctx);
+
+
+PetscErrorCode PetibmPODCtxPrintf(
+	const std::string name, const PetibmPODCtx ctx);
+
+
+/*! Initializes the decomposition of a sequence of snapshots of a field.
+ *
+ * With `weighted`, the inner product is weighted with the volume (area in 2D)
+ * of the cell around each point, from the trapezoidal rule on the gridlines.
+ *
+ * \param ctx The options.
+ * \param grid The grid of the field (passed by reference).
+ * \param field The field (layout of the snapshots).
+ * \param size The number of snapshots.
+ * \param pod The decomposition to initialize (passed by reference).
+ */
+PetscErrorCode PetibmPODInitialize(
+	const PetibmPODCtx ctx, PetibmGrid &grid, const PetibmField field,
+	const PetscInt size, PetibmPOD &pod);
+
+
+/*! Accumulates the Gram matrix of the snapshots in blocked passes.
+ *
+ * Each pass holds a block of snapshots in memory, computes their inner
+ * products, then streams the following snapshots one at a time against the
+ * block; the inner products of a snapshot with the block are computed with
+ * one reduction.
+ * A snapshot is read once per pass and the memory held is that of block+2
+ * fields on each process.
+ *
+ * \param ctx The options.
+ * \param read The function reading a snapshot.
+ * \param field The field (layout of the snapshots).
+ * \param pod The decomposition (passed by reference).
+ */
+PetscErrorCode PetibmPODComputeGram(
+	const PetibmPODCtx ctx, const PetibmPODReadFunction &read,
+	const PetibmField field, PetibmPOD &pod);
+
+
+/*! Computes the eigenvalues and eigenvectors of the Gram matrix.
+ *
+ * With `subtract_mean`, the Gram matrix is centered first, which gives the
+ * inner products of the fluctuations around the mean without another pass
+ * over the snapshots.
+ * The eigenproblem (size x size) is solved with LAPACK on every process.
+ *
+ * \param ctx The options.
+ * \param pod The decomposition (passed by reference).
+ */
+PetscErrorCode PetibmPODSolve(const PetibmPODCtx ctx, PetibmPOD &pod);
+
+
+/*! Reconstructs the modes in streaming passes over the snapshots.
+ *
+ * The modes are computed by blocks (at most `block` modes per pass); mode k
+ * is the combination of the snapshots with the coefficients of eigenvector
+ * k, scaled to unit norm.
+ * The mean is removed implicitly: the coefficients of a mode of the centered
+ * Gram matrix sum to zero.
+ *
+ * \param ctx The options.
+ * \param read The function reading a snapshot.
+ * \param write The function writing a mode.
+ * \param field The field (layout of the snapshots).
+ * \param pod The decomposition (passed by reference).
+ */
+PetscErrorCode PetibmPODComputeModes(
+	const PetibmPODCtx ctx, const PetibmPODReadFunction &read,
+	const PetibmPODWriteFunction &write, const PetibmField field,
+	PetibmPOD &pod);
+
+
+/*! Writes the eigenvalues into an ASCII file.
+ *
+ * One row per eigenvalue: the index, the eigenvalue, its fraction of the
+ * total, and the cumulative fraction.
+ *
+ * \param filepath Path of the output file.
+ * \param pod The decomposition.
+ */
+PetscErrorCode PetibmPODWriteEigenvalues(
+	const std::string filepath, const PetibmPOD &pod);
+
+
+/*! Writes the temporal coefficients of the modes into an ASCII file.
+ *
+ * One row per snapshot: the time-step index followed by the projection of
+ * the snapshot on each mode.
+ *
+ * \param filepath Path of the output file.
+ * \param steps The time-step index of each snapshot.
+ * \param modes The number of modes.
+ * \param pod The decomposition.
+ */
+PetscErrorCode PetibmPODWriteCoefficients(
+	const std::string filepath, const std::vector<PetscInt> &steps,
+	const PetscInt modes, const PetibmPOD &pod);
+
+
+/*! Destroys a PetibmPOD structure.
+ *
+ * \param pod The decomposition (passed by reference).
+ */
+PetscErrorCode PetibmPODDestroy(PetibmPOD &pod);
@@ -0,0 +1,85 @@
+/*! Definition of the structure PetibmFieldPool and related functions.
+ * \file pool.h
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <petscsys.h>
+#include <petscdmda.h>
+
+
+/*! Structure holding the DMDA objects and work buffers shared between fields.
+ *
+ * Fields initialized through a pool share their DMDA object with any other
+ * field of the pool with the same layout (sizes, boundary types, stencil, and
+ * ownership ranges).
+ * They do not own a ghosted local vector; the local vector is borrowed from
+ * the work buffers of the pool only while a kernel needs it.
+ */
+struct PetibmFieldPool
+{
+	std::vector<DM> das;  /// DMDA objects, one per distinct layout
+	std::vector<PetscScalar *> buffers;  /// work buffers for local vectors
+	std::vector<PetscInt> sizes;  /// number of values in each work buffer
+	std::vector<PetscBool> used;  /// is the work buffer currently borrowed?
+	PetscInt64 bytes = 0,  /// number of bytes currently held on process
+	           peak = 0;  /// maximum number of bytes held on process
+}; // PetibmFieldPool
+
+
+/*! Gets a DMDA object from the pool with the same layout as the provided one.
+ *
+ * If the pool already holds a DMDA object with the same layout, the provided
+ * DMDA is destroyed and replaced by a new reference to the pooled one;
+ * otherwise, the provided DMDA is registered into the pool.
+ *
+ * \param pool The pool (passed by reference).
+ * \param da The DMDA object to share (passed by pointer).
+ */
+PetscErrorCode PetibmFieldPoolGetDM(PetibmFieldPool &pool, DM *da);
+
+
+/*! Borrows a work vector from the pool.
+ *
+ * The sequential vector wraps a work buffer of the pool with at least the
+ * requested number of values.
+ *
+ * \param pool The pool (passed by reference).
+ * \param n Number of values in the work vector.
+ * \param v The work vector (passed by pointer).
+ */
+PetscErrorCode PetibmFieldPoolGetWorkVec(
+	PetibmFieldPool &pool, const PetscInt n, Vec *v);
+
+
+/*! Returns a work vector to the pool.
+ *
+ * \param pool The pool (passed by reference).
+ * \param v The work vector to return (passed by pointer).
+ */
+PetscErrorCode PetibmFieldPoolRestoreWorkVec(PetibmFieldPool &pool, Vec *v);
+
+
+/*! Accounts for a number of bytes allocated (or freed if negative) on process.
+ *
+ * \param pool The pool (passed by reference).
+ * \param bytes Number of bytes.
+ */
+PetscErrorCode PetibmFieldPoolLogBytes(
+	PetibmFieldPool &pool, const PetscInt64 bytes);
+
+
+/*! Prints the number of layouts and the resident memory of the pool.
+ *
+ * \param pool The pool.
+ */
+PetscErrorCode PetibmFieldPoolView(const PetibmFieldPool &pool);
+
+
+/*! Destroys the DMDA objects and frees the work buffers of the pool.
+ *
+ * \param pool The pool (passed by reference).
+ */
+PetscErrorCode PetibmFieldPoolDestroy(PetibmFieldPool &pool);
@@ -0,0 +1,119 @@
+/*! Definition of the structure PetibmProbes and related functions.
+ * \file probes.h
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <petscsys.h>
+#include <petscvec.h>
+#include <petscdmda.h>
+
+#include "petibm-utilities/field.h"
+#include "petibm-utilities/grid.h"
+
+
+/*! Structure holding a set of probes located in a field.
+ *
+ * A probe is owned by the process owning the lower corner of the grid cell
+ * containing it; the values at the corners of the cells are gathered from
+ * the global vector of the field with a scatter built once.
+ */
+struct PetibmProbes
+{
+	PetscInt dim = 2,  /// dimension of the probes
+	         size = 0;  /// total number of probes
+	std::vector<PetscReal> points;  /// coordinates of all the probes
+	std::vector<PetscInt> ids;  /// indices of the probes owned by the process
+	std::vector<PetscReal> weights;  /// linear weights along each direction
+	std::vector<PetscReal> local,  /// values of the probes owned by the process
+	                       gathered,  /// values gathered process by process (on rank 0)
+	                       values;  /// values of all the probes (on rank 0)
+	std::vector<PetscInt> order;  /// indices of the gathered values (on rank 0)
+	std::vector<PetscMPIInt> counts,  /// number of probes per process (on rank 0)
+	                         displs;  /// offsets of the gathered values (on rank 0)
+	Vec corners = nullptr;  /// sequential vector with the cell-corner values
+	VecScatter scatter = nullptr;  /// scatter of the cell-corner values
+	MPI_Comm comm = MPI_COMM_NULL;  /// processes owning probes, and rank 0
+}; // PetibmProbes
+
+
+/*! Reads the coordinates of probes from an ASCII file.
+ *
+ * The file contains one probe per line (dim coordinates); empty lines and
+ * lines starting with `#` are ignored.
+ * Rank 0 reads the file and broadcasts the coordinates.
+ *
+ * \param filepath Path of the input file.
+ * \param dim Number of coordinates per probe.
+ * \param points The coordinates of the probes (passed by reference).
+ */
+PetscErrorCode PetibmProbesRead(
+	const std::string filepath, const PetscInt dim,
+	std::vector<PetscReal> &points);
+
+
+/*! Locates probes in a field and prepares their evaluation.
+ *
+ * Each process locates the probes within the cells whose lower corner it
+ * owns with a bracket search on its part of the gridlines, then stores the
+ * linear weights along each direction.
+ * The scatter of the cell-corner values and the communicator used to gather
+ * the values are created once; the cost of an evaluation then scales with the
+ * number of probes.
+ * Collective; probes outside the domain raise an error.
+ *
+ * \param grid The grid of the field (passed by reference).
+ * \param field The field to probe.
+ * \param points The coordinates of all the probes (same on all processes).
+ * \param probes The probes to initialize (passed by reference).
+ */
+PetscErrorCode PetibmProbesInitialize(
+	PetibmGrid &grid, const PetibmField field,
+	const std::vector<PetscReal> &points, PetibmProbes &probes);
+
+
+/*! Evaluates the probes with (bi/tri)-linear interpolation.
+ *
+ * The field should have the layout used to initialize the probes.
+ * The cell-corner values are scattered from the global vector, the processes
+ * owning probes interpolate them, and the values are gathered on rank 0.
+ *
+ * \param field The field to probe.
+ * \param probes The probes (passed by reference).
+ */
+PetscErrorCode PetibmProbesEvaluate(
+	const PetibmField field, PetibmProbes &probes);
+
+
+/*! Writes the header of an ASCII time-series file for the probes.
+ *
+ * The header lists the coordinates of the probes; the file is overwritten.
+ *
+ * \param filepath Path of the output file.
+ * \param probes The probes.
+ */
+PetscErrorCode PetibmProbesWriteHeader(
+	const std::string filepath, const PetibmProbes &probes);
+
+
+/*! Appends the values of the probes to an ASCII time-series file.
+ *
+ * One row per time step: the time-step index followed by one column per probe.
+ *
+ * \param filepath Path of the output file.
+ * \param step The time-step index.
+ * \param probes The probes.
+ */
+PetscErrorCode PetibmProbesWrite(
+	const std::string filepath, const PetscInt step,
+	const PetibmProbes &probes);
+
+
+/*! Destroys a PetibmProbes structure.
+ *
+ * \param probes The probes (passed by reference).
+ */
+PetscErrorCode PetibmProbesDestroy(PetibmProbes &probes);
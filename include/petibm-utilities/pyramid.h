@@ -0,0 +1,74 @@
+/*! Definition of the structure PetibmPyramid and related functions.
+ * \file pyramid.h
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <petscsys.h>
+#include <petscvec.h>
+#include <petscdmda.h>
+
+#include "petibm-utilities/field.h"
+#include "petibm-utilities/grid.h"
+
+
+/*! Structure holding the coarse levels of a multi-resolution pyramid.
+ *
+ * Level l has ceil(n/2) points where level l-1 has n points along each
+ * direction; a coarse point averages the (up to 2, 4, or 8) fine points of its
+ * block, and a coarse station is the mid-point of the fine stations.
+ * The coarse point i is owned by the process owning the fine point 2i.
+ */
+struct PetibmPyramid
+{
+	PetscInt dim = 3,  /// dimension of the field
+	         levels = 0;  /// number of coarse levels
+	DM fine = nullptr;  /// DMDA with the layout of the field and a box stencil
+	std::vector<DM> das;  /// DMDA objects of the coarse levels
+	std::vector<Vec> globals;  /// values of the coarse levels
+	std::vector<std::vector<PetscReal>> stations;  /// stations of each level and direction
+}; // PetibmPyramid
+
+
+/*! Initializes the coarse levels of a pyramid for a field layout.
+ *
+ * Collective; the DMDA objects of the coarse levels follow the decomposition
+ * of the field, and the coarsening stops before a process would own no point
+ * (the number of levels built can be smaller than requested).
+ * The gridlines can be sequential (all the stations) or distributed.
+ *
+ * \param grid The grid of the field.
+ * \param field The field (fine level).
+ * \param levels The number of coarse levels requested.
+ * \param pyramid The pyramid to initialize (passed by reference).
+ */
+PetscErrorCode PetibmPyramidInitialize(
+	const PetibmGrid grid, const PetibmField field, const PetscInt levels,
+	PetibmPyramid &pyramid);
+
+
+/*! Writes the coarse levels of a field into an HDF5 file.
+ *
+ * Each level is obtained by cell-averaging the previous one and is written,
+ * with its gridlines, in the group `<name>_lod<l>` of the file (datasets
+ * `<name>`, `x`, `y`, and `z`); the full-resolution field is left to
+ * PetibmFieldHDF5Write.
+ *
+ * \param filepath Path of the output file.
+ * \param name Name of the field.
+ * \param field The field (passed by reference).
+ * \param pyramid The pyramid (passed by reference).
+ */
+PetscErrorCode PetibmPyramidHDF5Write(
+	const std::string filepath, const std::string name,
+	PetibmField &field, PetibmPyramid &pyramid);
+
+
+/*! Destroys a PetibmPyramid structure.
+ *
+ * \param pyramid The pyramid (passed by reference).
+ */
+PetscErrorCode PetibmPyramidDestroy(PetibmPyramid &pyramid);
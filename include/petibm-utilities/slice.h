@@ -0,0 +1,130 @@
+/*! Definition of the structure PetibmSlice and related functions.
+ * \file slice.h
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <petscsys.h>
+#include <petscvec.h>
+#include <petscdmda.h>
+
+#include "petibm-utilities/field.h"
+#include "petibm-utilities/grid.h"
+
+
+/*! Structure holding information about a 2D slice.
+ */
+struct PetibmSliceCtx
+{
+	PetscInt direction = 2;  /// direction normal to the slice (0: x, 1: y, 2: z)
+	PetscReal value = 0.0;  /// coordinate of the slice along the normal direction
+	PetscInt min_points = 16384;  /// minimum number of slice points per process
+}; // PetibmSliceCtx
+
+
+/*! Structure holding a 2D slice of a 3D field.
+ *
+ * The slice lives on a sub-communicator sized to the number of points in the
+ * slice; the processes outside of it hold no part of the slice.
+ * The in-plane directions are ordered as in the 3D field (e.g., x and z for a
+ * slice normal to the y-direction) and become the x and y directions of the
+ * 2D field.
+ */
+struct PetibmSlice
+{
+	PetscInt direction = 2,  /// direction normal to the slice
+	         axes[2] = {0, 1};  /// in-plane directions
+	PetscInt n[3] = {0, 0, 0};  /// number of points of the 3D field
+	PetscInt index = 0,  /// index of the plane below the slice
+	         planes = 1;  /// number of planes to read (1 or 2)
+	PetscReal weight = 0.0;  /// linear weight of the plane above the slice
+	Vec stations[2] = {nullptr, nullptr};  /// stations along the in-plane directions
+	MPI_Comm comm = MPI_COMM_NULL;  /// processes holding the slice
+	PetibmField field;  /// the 2D field (on the sub-communicator)
+	std::vector<PetscReal> buffer;  /// values read from the bracketing planes
+}; // PetibmSlice
+
+
+/*! Gets options from command-line or config file.
+ *
+ * `-direction <x|y|z>`, `-value <coordinate>`, and `-min_points <n>` (minimum
+ * number of slice points per process, to size the sub-communicator).
+ *
+ * \param prefix String to prepend to options.
+ * \param ctx The PetibmSliceCtx structure to fill (passed by pointer).
+ */
+PetscErrorCode PetibmSliceGetOptions(
+	const char prefix[], PetibmSliceCtx *ctx);
+
+
+PetscErrorCode PetibmSliceCtxPrintf(
+	const std::string name, const PetibmSliceCtx ctx);
+
+
+/*! Initializes a slice of a 3D field.
+ *
+ * Collective on PETSC_COMM_WORLD.
+ * Reads the gridlines (with PetibmGridlineHDF5ReadShared), brackets the
+ * coordinate of the slice with the stations along the normal direction, and
+ * creates the 2D field over a sub-communicator with at most one process per
+ * `min_points` points of the slice.
+ *
+ * \param ctx The slice context.
+ * \param gridCtx The context of the grid of the 3D field.
+ * \param slice The slice to initialize (passed by reference).
+ */
+PetscErrorCode PetibmSliceInitialize(
+	const PetibmSliceCtx ctx, const PetibmGridCtx gridCtx, PetibmSlice &slice);
+
+
+/*! Reads a slice of a 3D field stored in HDF5 format.
+ *
+ * Collective on the sub-communicator of the slice (no-op on other processes).
+ * Each process reads the hyperslab of the bracketing plane(s) matching its
+ * part of the slice, then interpolates linearly between the two planes.
+ *
+ * \param filepath Path of the input file.
+ * \param name Name of the 3D field.
+ * \param slice The slice (passed by reference).
+ */
+PetscErrorCode PetibmSliceHDF5Read(
+	const std::string filepath, const std::string name, PetibmSlice &slice);
+
+
+/*! Writes the 2D field of a slice in HDF5 format.
+ *
+ * Collective on the sub-communicator of the slice (no-op on other processes).
+ *
+ * \param filepath Path of the output file.
+ * \param name Name of the 2D field.
+ * \param slice The slice.
+ */
+PetscErrorCode PetibmSliceHDF5Write(
+	const std::string filepath, const std::string name,
+	const PetibmSlice &slice);
+
+
+/*! Writes the 2D grid of a slice in HDF5 format.
+ *
+ * The stations along the in-plane directions are written as the x and y
+ * gridlines of the group, so that the 2D tools can read them.
+ *
+ * \param filepath Path of the output file.
+ * \param varname Name of the grid (group name in the HDF5 file).
+ * \param slice The slice.
+ */
+PetscErrorCode PetibmSliceGridHDF5Write(
+	const std::string filepath, const std::string varname,
+	const PetibmSlice &slice);
+
+
+/*! Destroys a PetibmSlice structure.
+ *
+ * Collective on PETSC_COMM_WORLD.
+ *
+ * \param slice The slice (passed by reference).
+ */
+PetscErrorCode PetibmSliceDestroy(PetibmSlice &slice);
@@ -0,0 +1,116 @@
+/*! Definition of the structure PetibmSpectrum and related functions.
+ * \file spectra.h
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <petscsys.h>
+#include <petscvec.h>
+#include <petscdmda.h>
+
+#include "petibm-utilities/fft.h"
+#include "petibm-utilities/field.h"
+
+
+/*! Structure holding the 1D energy spectrum of a field along a periodic
+ * direction.
+ *
+ * The values of the field are redistributed into pencils, complete lines
+ * along the direction, with a scatter built once (the transpose plan); each
+ * process transforms the pencils it holds.
+ */
+struct PetibmSpectrum
+{
+	PetscInt direction = 2,  /// index of the periodic direction
+	         n = 0,  /// number of points along the direction
+	         pencils = 0,  /// number of pencils on process
+	         total = 0,  /// total number of pencils
+	         count = 0;  /// number of spectra accumulated
+	PetscReal length = 0.0;  /// period along the direction
+	PetibmFFT fft;  /// plan of the real-to-complex transform
+	Vec lines = nullptr;  /// sequential vector with the pencils on process
+	VecScatter scatter = nullptr;  /// scatter of the pencils (transpose plan)
+	std::vector<PetscReal> energy,  /// spectrum of the last field
+	                       sum;  /// sum of the spectra accumulated
+}; // PetibmSpectrum
+
+
+/*! Initializes the spectrum along a periodic direction of a field.
+ *
+ * The pencils are split evenly between the processes and the scatter from
+ * the global vector of the field to the pencils is created once.
+ * Collective.
+ *
+ * \param field The field (scalar, periodic along the direction).
+ * \param direction Index of the periodic direction.
+ * \param length Period along the direction.
+ * \param spectrum The spectrum to initialize (passed by reference).
+ */
+PetscErrorCode PetibmSpectrumInitialize(
+	const PetibmField field, const PetscInt direction, const PetscReal length,
+	PetibmSpectrum &spectrum);
+
+
+/*! Computes the spectrum of a field and adds it to the accumulated ones.
+ *
+ * The pencils are scattered from the global vector of the field and
+ * transformed by batches on the threads of the process.
+ * The energy of wavenumber k (0 <= k <= n/2) is |X_k|^2/n^2, doubled when
+ * -k is another wavenumber, so that the energies sum to the mean of the
+ * squared values; it is averaged over the pencils (the other directions)
+ * without weights.
+ * The field should have the layout used to initialize the spectrum.
+ * Collective.
+ *
+ * \param field The field.
+ * \param spectrum The spectrum (passed by reference).
+ */
+PetscErrorCode PetibmSpectrumCompute(
+	const PetibmField field, PetibmSpectrum &spectrum);
+
+
+/*! Writes the header of an ASCII time-series file for the spectrum.
+ *
+ * The header lists the wavenumbers; the file is overwritten.
+ *
+ * \param filepath Path of the output file.
+ * \param spectrum The spectrum.
+ */
+PetscErrorCode PetibmSpectrumWriteHeader(
+	const std::string filepath, const PetibmSpectrum &spectrum);
+
+
+/*! Appends the spectrum of the last field to an ASCII time-series file.
+ *
+ * One row per time step: the time-step index followed by one column per
+ * wavenumber.
+ *
+ * \param filepath Path of the output file.
+ * \param step The time-step index.
+ * \param spectrum The spectrum.
+ */
+PetscErrorCode PetibmSpectrumWrite(
+	const std::string filepath, const PetscInt step,
+	const PetibmSpectrum &spectrum);
+
+
+/*! Writes the time-averaged spectrum into an ASCII file.
+ *
+ * One row per wavenumber: the index, the wavenumber 2 pi k / length, and the
+ * energy averaged over the spectra accumulated.
+ *
+ * \param filepath Path of the output file.
+ * \param spectrum The spectrum.
+ */
+PetscErrorCode PetibmSpectrumWriteMean(
+	const std::string filepath, const PetibmSpectrum &spectrum);
+
+
+/*! Destroys a PetibmSpectrum structure.
+ *
+ * \param spectrum The spectrum (passed by reference).
+ */
+PetscErrorCode PetibmSpectrumDestroy(PetibmSpectrum &spectrum);
@@ -0,0 +1,68 @@
+/*! Definition of the structure PetibmStreamFunction and related functions.
+ * \file streamfunction.h
+ */
+
+#pragma once
+
+#include <petscsys.h>
+#include <petscdmda.h>
+#include <petscksp.h>
+
+#include "petibm-utilities/field.h"
+#include "petibm-utilities/grid.h"
+
+
+/*! Structure holding the Poisson solver of the 2D streamfunction.
+ */
+struct PetibmStreamFunction
+{
+	KSP ksp = nullptr;  /// Krylov solver (CG preconditioned with multigrid)
+	Mat A = nullptr;  /// negative Laplacian operator, scaled by the cell areas
+	Vec area = nullptr,  /// area of the cell around each point
+	    rhs = nullptr;  /// right-hand side of the system
+	PetscInt levels = 0;  /// number of levels of the geometric multigrid
+}; // PetibmStreamFunction
+
+
+/*! Initializes the solver of the streamfunction on the DMDA of a field.
+ *
+ * The Laplacian is discretized on the stretched grid with a five-point
+ * stencil, multiplied by the area of the cell around each point so that the
+ * operator is symmetric positive definite; the streamfunction is zero on the
+ * non-periodic boundaries, one spacing (the spacing at that end) outside the
+ * first and last stations.
+ * The system is solved with CG preconditioned by geometric multigrid (PCMG),
+ * with the coarse levels obtained by coarsening the DMDA and Galerkin coarse
+ * operators; with fewer than 3 levels (the DMDA cannot be coarsened twice),
+ * algebraic multigrid (PCGAMG) is used instead.
+ * The number of levels is chosen from the sizes of the DMDA unless set with
+ * `-streamfunction_levels`; the solver accepts options with the prefix
+ * `streamfunction_`.
+ *
+ * \param grid The grid of the field (gridlines decomposed as the DMDA).
+ * \param da The DMDA of the field (2D, stencil width at least 1).
+ * \param solver The solver to initialize (passed by reference).
+ */
+PetscErrorCode PetibmStreamFunctionInitialize(
+	const PetibmGrid grid, const DM da, PetibmStreamFunction &solver);
+
+
+/*! Solves for the streamfunction, Laplacian(psi) = -wz.
+ *
+ * The values of psi on input are the initial guess: when solving the time
+ * steps in sequence, the streamfunction of a step seeds the solve of the
+ * next one.
+ *
+ * \param solver The solver.
+ * \param wz The vorticity field.
+ * \param psi The streamfunction (passed by reference).
+ */
+PetscErrorCode PetibmStreamFunctionSolve(
+	PetibmStreamFunction &solver, const PetibmField wz, PetibmField &psi);
+
+
+/*! Destroys a PetibmStreamFunction structure.
+ *
+ * \param solver The solver to destroy (passed by reference).
+ */
+PetscErrorCode PetibmStreamFunctionDestroy(PetibmStreamFunction &solver);
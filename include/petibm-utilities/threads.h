@@ -0,0 +1,83 @@
+/*! Definition of the functions related to the threads of a process.
+ * \file threads.h
+ */
+
+#pragma once
+
+#include <functional>
+
+#include <petscsys.h>
+#include <petscvec.h>
+
+
+/*! Starts the persistent pool of threads of the process.
+ *
+ * `-threads <n>` sets the number of threads per process (default 1: the
+ * kernels run on the calling thread only); `-threads_bind` pins each thread
+ * to one of the cores the process is allowed to run on (Linux only), which
+ * keeps the pages first touched by a thread local to its NUMA node.
+ * The threads wait on a condition variable between kernels.
+ */
+PetscErrorCode PetibmThreadsInitialize();
+
+
+/*! Stops and joins the threads of the pool.
+ */
+PetscErrorCode PetibmThreadsFinalize();
+
+
+/*! Gets the number of threads of the pool (the calling thread included).
+ *
+ * \param n The number of threads (passed by pointer).
+ */
+PetscErrorCode PetibmThreadsGetSize(PetscInt *n);
+
+
+/*! Runs a task on all the threads of the pool and waits for its completion.
+ *
+ * The calling thread runs the task as thread 0. The task is called with the
+ * index of the thread and the number of threads, and must not call PETSc or
+ * MPI.
+ *
+ * \param task The task.
+ */
+PetscErrorCode PetibmThreadsRun(
+	const std::function<void(const PetscInt, const PetscInt)> &task);
+
+
+/*! Gets the static slab of a thread in a range of indices.
+ *
+ * The range is split in contiguous slabs of nearly equal sizes, the same for
+ * every kernel, so that a thread works on the memory it first touched.
+ *
+ * \param begin First index of the range.
+ * \param end One past the last index of the range.
+ * \param t Index of the thread.
+ * \param n Number of threads.
+ * \param s First index of the slab (passed by pointer).
+ * \param e One past the last index of the slab (passed by pointer).
+ */
+void PetibmThreadsGetSlab(
+	const PetscInt begin, const PetscInt end, const PetscInt t, const PetscInt n,
+	PetscInt *s, PetscInt *e);
+
+
+/*! Touches an array for the first time by slabs of planes, one slab per thread.
+ *
+ * \param arr The array (not yet touched).
+ * \param planes Number of planes in the array.
+ * \param size Number of values per plane.
+ */
+PetscErrorCode PetibmThreadsTouch(
+	PetscScalar *arr, const PetscInt planes, const PetscInt size);
+
+
+/*! Replaces the storage of a vector by an array first touched by the threads.
+ *
+ * The vector is split in planes along its slowest dimension (z in 3D, y in
+ * 2D) and each thread first touches the planes of its slab.
+ * Nothing is done with a single thread.
+ *
+ * \param vec The vector (of a DMDA).
+ */
+PetscErrorCode PetibmThreadsFirstTouch(Vec vec);
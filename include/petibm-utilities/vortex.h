@@ -0,0 +1,45 @@
+/*! Definition of the functions to identify vortices (Q-criterion, lambda2).
+ * \file vortex.h
+ */
+
+#pragma once
+
+#include <petscsys.h>
+#include <petscdmda.h>
+
+#include "petibm-utilities/field.h"
+#include "petibm-utilities/grid.h"
+
+
+/*! Computes the Q-criterion, lambda2, and strain-rate magnitude at cell
+ * centers from the staggered 3D velocity field.
+ *
+ * The velocity-gradient tensor is assembled point-wise in a single sweep
+ * over the cells (normal derivatives on the faces of the cell, transverse
+ * derivatives with centered differences of the cell-centered velocities,
+ * one-sided at the non-periodic ends of the domain and wrapped through the
+ * ghost points on periodic directions), and never stored.
+ * The ghost points beyond the non-periodic boundaries hold the boundary
+ * values of the velocity components (see PetibmFieldSetBoundaryPoints).
+ * With S and W the symmetric and antisymmetric parts of the tensor:
+ * Q = (|W|^2 - |S|^2)/2, lambda2 is the second eigenvalue of S^2 + W^2
+ * (closed-form symmetric 3x3 eigenvalues), and the strain-rate magnitude is
+ * sqrt(2 S:S).
+ * Any of the output fields can be nullptr to skip it; the output fields
+ * should share the layout of the cell-centered grid.
+ *
+ * \param grid The cell-centered grid.
+ * \param gridux The grid for the velocity in the x-direction.
+ * \param griduy The grid for the velocity in the y-direction.
+ * \param griduz The grid for the velocity in the z-direction.
+ * \param ux The velocity field in the x-direction.
+ * \param uy The velocity field in the y-direction.
+ * \param uz The velocity field in the z-direction.
+ * \param q The Q-criterion field (passed by pointer).
+ * \param lambda2 The lambda2 field (passed by pointer).
+ * \param strain The strain-rate magnitude field (passed by pointer).
+ */
+PetscErrorCode PetibmVortexComputeFields(
+	const PetibmGrid grid, const PetibmGrid gridux, const PetibmGrid griduy,
+	const PetibmGrid griduz, PetibmField ux, PetibmField uy, PetibmField uz,
+	PetibmField *q, PetibmField *lambda2, PetibmField *strain);
@@ -4,13 +4,43 @@
 
 #pragma once
 
+#include <string>
+
 #include <petscsys.h>
 #include <petscdmda.h>
 
+#include "petibm-utilities/derivative.h"
 #include "petibm-utilities/field.h"
 #include "petibm-utilities/grid.h"
 
 
+/*! Structure holding the traversal options of the vorticity kernels.
+ */
+struct PetibmVorticityCtx
+{
+	PetscInt tile_j = 16,  /// number of rows per tile in the y-direction (0: no tiling)
+	         tile_k = 8,  /// number of planes per tile in the z-direction (0: no tiling)
+	         order = 2;  /// order of accuracy of the derivatives (2 or 4)
+	PetscBool flat = PETSC_TRUE;  /// compute row addresses instead of using DMDAVecGetArray tables
+}; // PetibmVorticityCtx
+
+
+/*! Gets options from command-line or config file.
+ *
+ * `-tile_j <n>` and `-tile_k <n>` (0: no tiling), `-flat <true|false>`,
+ * `-derivative_order <2|4>`.
+ *
+ * \param prefix String to prepend to options.
+ * \param ctx The PetibmVorticityCtx structure to fill (passed by pointer).
+ */
+PetscErrorCode PetibmVorticityGetOptions(
+	const char prefix[], PetibmVorticityCtx *ctx);
+
+
+PetscErrorCode PetibmVorticityCtxPrintf(
+	const std::string name, const PetibmVorticityCtx ctx);
+
+
 /*! Computes the gridlines for the vorticity in the z-direction.
  *
  * \param ux The grid for the x-velocity.
@@ -21,18 +51,38 @@ PetscErrorCode PetibmVorticityZComputeGrid(
 	const PetibmGrid ux, const PetibmGrid uy, PetibmGrid &wz);
 
 
-/*! Computes the vorticity in the z-direction.
+/*! Creates the derivative operators of the vorticity in the z-direction.
  *
- * First-order.
+ * Along a periodic direction (as many faces as cells), the stencils wrap
+ * across the ends of the gridline.
  *
+ * \param ctx The context (order of accuracy).
  * \param gridux The grid for the velocity in the x-direction.
  * \param griduy The grid for the velocity in the y-direction.
+ * \param gridwz The grid for the vorticity in the z-direction.
+ * \param dx The x-derivative of the y-velocity (passed by reference).
+ * \param dy The y-derivative of the x-velocity (passed by reference).
+ */
+PetscErrorCode PetibmVorticityZCreateOperators(
+	const PetibmVorticityCtx ctx, const PetibmGrid gridux,
+	const PetibmGrid griduy, const PetibmGrid gridwz,
+	PetibmDerivativeOperator &dx, PetibmDerivativeOperator &dy);
+
+
+/*! Computes the vorticity in the z-direction.
+ *
+ * The points are split between the threads of the process.
+ *
+ * \param ctx The context (tile sizes and indexing path).
+ * \param dx The x-derivative of the y-velocity.
+ * \param dy The y-derivative of the x-velocity.
  * \param ux The velocity field in the x-direction.
  * \param uy The velocity field in the y-direction.
  * \param wz The vorticity field in the z-direction (passed by reference).
  */
 PetscErrorCode PetibmVorticityZComputeField(
-	const PetibmGrid gridux, const PetibmGrid griduy,
+	const PetibmVorticityCtx ctx,
+	const PetibmDerivativeOperator dx, const PetibmDerivativeOperator dy,
 	const PetibmField ux, const PetibmField uy, PetibmField &wz);
 
 
@@ -46,16 +96,98 @@ PetscErrorCode PetibmVorticityXComputeGrid(
 	const PetibmGrid uy, const PetibmGrid uz, PetibmGrid &wx);
 
 
-/*! Computes the vorticity in the x-direction.
+/*! Creates the derivative operators of the vorticity in the x-direction.
  *
- * First-order.
+ * Along a periodic direction (as many faces as cells), the stencils wrap
+ * across the ends of the gridline.
  *
+ * \param ctx The context (order of accuracy).
  * \param griduy The grid for the velocity in the y-direction.
  * \param griduz The grid for the velocity in the z-direction.
+ * \param gridwx The grid for the vorticity in the x-direction.
+ * \param dy The y-derivative of the z-velocity (passed by reference).
+ * \param dz The z-derivative of the y-velocity (passed by reference).
+ */
+PetscErrorCode PetibmVorticityXCreateOperators(
+	const PetibmVorticityCtx ctx, const PetibmGrid griduy,
+	const PetibmGrid griduz, const PetibmGrid gridwx,
+	PetibmDerivativeOperator &dy, PetibmDerivativeOperator &dz);
+
+
+/*! Computes the vorticity in the x-direction.
+ *
+ * The points are split between the threads of the process.
+ *
+ * \param ctx The context (tile sizes and indexing path).
+ * \param dy The y-derivative of the z-velocity.
+ * \param dz The z-derivative of the y-velocity.
  * \param uy The velocity field in the y-direction.
  * \param uz The velocity field in the z-direction.
  * \param wx The vorticity field in the x-direction (passed by reference).
  */
 PetscErrorCode PetibmVorticityXComputeField(
-	const PetibmGrid griduy, const PetibmGrid griduz,
+	const PetibmVorticityCtx ctx,
+	const PetibmDerivativeOperator dy, const PetibmDerivativeOperator dz,
 	const PetibmField uy, const PetibmField uz, PetibmField &wx);
+
+
+/*! Reads the cell-centered and staggered gridlines of the 3D velocity.
+ *
+ * The grid of a velocity component has one station less along its direction
+ * if the direction is not periodic (the boundary face is not stored).
+ *
+ * \param filepath The path of the grid file.
+ * \param ctx The sizes of the cell-centered grid.
+ * \param fieldCtx The periodicity of the field.
+ * \param grid The cell-centered grid (passed by reference).
+ * \param gridux The grid of the x-velocity (passed by reference).
+ * \param griduy The grid of the y-velocity (passed by reference).
+ * \param griduz The grid of the z-velocity (passed by reference).
+ */
+PetscErrorCode PetibmVorticityReadGrids(
+	const std::string filepath, const PetibmGridCtx ctx,
+	const PetibmFieldCtx fieldCtx, PetibmGrid &grid, PetibmGrid &gridux,
+	PetibmGrid &griduy, PetibmGrid &griduz);
+
+
+/*! Creates the cell-centered 3D DMDA object (star stencil of width 1).
+ *
+ * \param ctx The sizes of the cell-centered grid.
+ * \param fieldCtx The periodicity of the field.
+ * \param da The DMDA object to create (passed by pointer).
+ */
+PetscErrorCode PetibmVorticityCreateDM(
+	const PetibmGridCtx ctx, const PetibmFieldCtx fieldCtx, DM *da);
+
+
+/*! Creates a 3D DMDA object staggered from the cell-centered one.
+ *
+ * The staggered DMDA has the processes and the ownership ranges of the
+ * cell-centered one, except along the flagged directions where it has one
+ * point less, removed from the last process.
+ *
+ * \param da The cell-centered DMDA object.
+ * \param less Directions with one point less.
+ * \param stencil The stencil type.
+ * \param s The stencil width.
+ * \param sda The staggered DMDA object to create (passed by pointer).
+ */
+PetscErrorCode PetibmVorticityCreateStaggeredDM(
+	const DM da, const PetscBool less[3], const DMDAStencilType stencil,
+	const PetscInt s, DM *sda);
+
+
+/*! Creates the 3D DMDA object of a velocity component.
+ *
+ * The component is staggered in its direction: if the direction is not
+ * periodic, the last face (on the boundary) is not stored.
+ *
+ * \param da The cell-centered DMDA object.
+ * \param d The direction of the component.
+ * \param stencil The stencil type.
+ * \param s The stencil width.
+ * \param dau The DMDA object to create (passed by pointer).
+ */
+PetscErrorCode PetibmVorticityCreateVelocityDM(
+	const DM da, const PetscInt d, const DMDAStencilType stencil,
+	const PetscInt s, DM *dau);
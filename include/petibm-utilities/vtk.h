@@ -0,0 +1,46 @@
+/*! Definition of the functions to write rectilinear VTK files.
+ * \file vtk.h
+ */
+
+#pragma once
+
+#include <string>
+
+#include <petscsys.h>
+#include <petscdmda.h>
+
+#include "petibm-utilities/field.h"
+#include "petibm-utilities/grid.h"
+
+
+/*! Writes the gridlines into parallel rectilinear VTK files.
+ *
+ * Collective; each process writes the piece `<filepath>_<rank>.vtr` with the
+ * stations of its part of the grid (raw binary appended data), and rank 0
+ * writes the index `<filepath>.pvtr`.
+ * The gridlines should be distributed (PetibmGridInitialize).
+ *
+ * \param filepath Path of the output files, without extension.
+ * \param grid The grid (passed by reference).
+ */
+PetscErrorCode PetibmGridVTKWrite(
+	const std::string filepath, PetibmGrid &grid);
+
+
+/*! Writes a field into parallel rectilinear VTK files.
+ *
+ * Collective; each process writes the piece `<filepath>_<rank>.vtr` with the
+ * stations and the field values of its local DMDA box (raw binary appended
+ * data), and rank 0 writes the index `<filepath>.pvtr`.
+ * Neighboring pieces share one layer of points, taken from the ghost values,
+ * so that the pieces tile the domain without gaps.
+ * The gridlines should be distributed with the layout of the field.
+ *
+ * \param filepath Path of the output files, without extension.
+ * \param name Name of the field.
+ * \param grid The grid of the field (passed by reference).
+ * \param field The field (passed by reference).
+ */
+PetscErrorCode PetibmFieldVTKWrite(
+	const std::string filepath, const std::string name,
+	PetibmGrid &grid, PetibmField &field);
@@ -0,0 +1,652 @@
+/*! Implementation of the functions for the PetibmArchive structure.
+ * \file archive.cpp
+ */
+
+#include <algorithm>
+#include <fstream>
+
+#include "petibm-utilities/archive.h"
+#include "petibm-utilities/misc.h"
+
+
+/*! Names of the chunk layouts of an archive.
+ */
+static const char *const PetibmArchiveLayouts[] = {"history", "slice"};
+
+
+/*! Gets options from command-line or config file.
+ *
+ * `-layout <history|slice>` and `-chunk_steps <n>`.
+ *
+ * \param prefix String to prepend to options.
+ * \param ctx The PetibmArchiveCtx structure to fill (passed by pointer).
+ */
+PetscErrorCode PetibmArchiveGetOptions(
+	const char prefix[], PetibmArchiveCtx *ctx)
+{
+	PetscErrorCode ierr;
+	char path[PETSC_MAX_PATH_LEN];
+	PetscBool found;
+
+	PetscFunctionBeginUser;
+
+	// get path of configuration file
+	ierr = PetscOptionsGetString(nullptr, prefix, "-config_file",
+	                             path, sizeof(path), &found); CHKERRQ(ierr);
+	if (found)
+	{
+		ierr = PetibmOptionsInsertFile(path); CHKERRQ(ierr);
+	}
+	// get chunk layout
+	ierr = PetscOptionsGetEList(nullptr, prefix, "-layout",
+	                            PetibmArchiveLayouts, 2,
+	                            &ctx->layout, &found); CHKERRQ(ierr);
+	// get number of records per chunk
+	ierr = PetscOptionsGetInt(nullptr, prefix, "-chunk_steps",
+	                          &ctx->chunk_steps, &found); CHKERRQ(ierr);
+	if (ctx->chunk_steps < 1)
+		SETERRQ(PETSC_COMM_WORLD, PETSC_ERR_ARG_OUTOFRANGE,
+		        "The number of records per chunk should be positive");
+
+	PetscFunctionReturn(0);
+} // PetibmArchiveGetOptions
+
+
+PetscErrorCode PetibmArchiveCtxPrintf(
+	const std::string name, const PetibmArchiveCtx ctx)
+{
+	PetscErrorCode ierr;
+
+	PetscFunctionBeginUser;
+
+	ierr = PetscPrintf(PETSC_COMM_WORLD, "+ %s:\n", name.c_str()); CHKERRQ(ierr);
+	ierr = PetscPrintf(PETSC_COMM_WORLD, "\t- layout: %s\n",
+	                   PetibmArchiveLayouts[ctx.layout]); CHKERRQ(ierr);
+	ierr = PetscPrintf(PETSC_COMM_WORLD, "\t- records per chunk: %d\n",
+	                   (ctx.layout == 0) ? ctx.chunk_steps : 1); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmArchiveCtxPrintf
+
+
+/*! HDF5 type matching PetscInt.
+ */
+static hid_t PetibmArchiveIntType()
+{
+	return (sizeof(PetscInt) == sizeof(long long)) ?
+	       H5T_NATIVE_LLONG : H5T_NATIVE_INT;
+} // PetibmArchiveIntType
+
+
+/*! HDF5 type matching PetscReal.
+ */
+static hid_t PetibmArchiveRealType()
+{
+	return (sizeof(PetscReal) == sizeof(double)) ?
+	       H5T_NATIVE_DOUBLE : H5T_NATIVE_FLOAT;
+} // PetibmArchiveRealType
+
+
+/*! Creates a transfer property list for collective I/O.
+ */
+static hid_t PetibmArchiveCreateTransfer()
+{
+	hid_t dxpl = H5Pcreate(H5P_DATASET_XFER);
+#if defined(H5_HAVE_PARALLEL)
+	H5Pset_dxpl_mpio(dxpl, H5FD_MPIO_COLLECTIVE);
+#endif
+	return dxpl;
+} // PetibmArchiveCreateTransfer
+
+
+/*! Reads a 1D dataset of the index (whole dataset on every process).
+ *
+ * \param file Identifier of the HDF5 file.
+ * \param name Name of the dataset.
+ * \param type HDF5 type of the values in memory.
+ * \param values The values (passed by reference).
+ */
+template <typename T>
+static PetscErrorCode PetibmArchiveIndexRead(
+	const hid_t file, const char name[], const hid_t type,
+	std::vector<T> &values)
+{
+	hid_t dset, fspace;
+	hsize_t n;
+	herr_t status;
+
+	PetscFunctionBeginUser;
+
+	dset = H5Dopen2(file, name, H5P_DEFAULT);
+	if (dset < 0)
+		SETERRQ(PETSC_COMM_SELF, PETSC_ERR_FILE_UNEXPECTED,
+		        "Cannot open the index of the archive");
+	fspace = H5Dget_space(dset);
+	H5Sget_simple_extent_dims(fspace, &n, nullptr);
+	H5Sclose(fspace);
+	values.resize(n);
+	status = (n > 0) ? H5Dread(dset, type, H5S_ALL, H5S_ALL, H5P_DEFAULT,
+	                           values.data()) : 0;
+	H5Dclose(dset);
+	if (status < 0)
+		SETERRQ(PETSC_COMM_SELF, PETSC_ERR_FILE_READ,
+		        "Cannot read the index of the archive");
+
+	PetscFunctionReturn(0);
+} // PetibmArchiveIndexRead
+
+
+/*! Appends an entry to a 1D dataset of the index (written by rank 0).
+ *
+ * \param file Identifier of the HDF5 file.
+ * \param name Name of the dataset.
+ * \param type HDF5 type of the value in memory.
+ * \param record Position of the entry.
+ * \param value Pointer to the value.
+ */
+static PetscErrorCode PetibmArchiveIndexWrite(
+	const hid_t file, const char name[], const hid_t type,
+	const hsize_t record, const void *value)
+{
+	PetscErrorCode ierr;
+	hid_t dset, fspace, mspace, dxpl;
+	hsize_t n = record + 1, one = 1;
+	herr_t status;
+	PetscMPIInt rank;
+
+	PetscFunctionBeginUser;
+
+	ierr = MPI_Comm_rank(PETSC_COMM_WORLD, &rank); CHKERRQ(ierr);
+	dset = H5Dopen2(file, name, H5P_DEFAULT);
+	if (dset < 0)
+		SETERRQ(PETSC_COMM_SELF, PETSC_ERR_FILE_UNEXPECTED,
+		        "Cannot open the index of the archive");
+	H5Dset_extent(dset, &n);
+	fspace = H5Dget_space(dset);
+	mspace = H5Screate_simple(1, &one, nullptr);
+	if (rank == 0)
+		H5Sselect_hyperslab(
+			fspace, H5S_SELECT_SET, &record, nullptr, &one, nullptr);
+	else
+	{
+		H5Sselect_none(fspace);
+		H5Sselect_none(mspace);
+	}
+	dxpl = PetibmArchiveCreateTransfer();
+	status = H5Dwrite(dset, type, mspace, fspace, dxpl, value);
+	H5Pclose(dxpl);
+	H5Sclose(mspace);
+	H5Sclose(fspace);
+	H5Dclose(dset);
+	if (status < 0)
+		SETERRQ(PETSC_COMM_SELF, PETSC_ERR_FILE_WRITE,
+		        "Cannot write the index of the archive");
+
+	PetscFunctionReturn(0);
+} // PetibmArchiveIndexWrite
+
+
+/*! Opens a time-series archive, creating the file if it does not exist.
+ *
+ * Collective on PETSC_COMM_WORLD; the time/step index of an existing archive
+ * is read on every process.
+ *
+ * \param filepath Path of the archive.
+ * \param ctx The archive context (layout of the datasets to create).
+ * \param archive The archive (passed by reference).
+ */
+PetscErrorCode PetibmArchiveOpen(
+	const std::string filepath, const PetibmArchiveCtx ctx,
+	PetibmArchive &archive)
+{
+	PetscErrorCode ierr;
+	PetscFileMode mode;
+	const char *names[2] = {"step", "time"};
+	const hid_t types[2] = {PetibmArchiveIntType(), PetibmArchiveRealType()};
+	hid_t dset, fspace, dcpl;
+	hsize_t zero = 0, chunk = 1024, unlimited = H5S_UNLIMITED;
+	PetscInt i;
+
+	PetscFunctionBeginUser;
+
+	archive.layout = ctx.layout;
+	archive.chunk_steps = ctx.chunk_steps;
+
+	std::ifstream infile(filepath.c_str());
+	mode = (infile.good()) ? FILE_MODE_APPEND : FILE_MODE_WRITE;
+	infile.close();
+	ierr = PetscViewerHDF5Open(PETSC_COMM_WORLD, filepath.c_str(), mode,
+	                           &archive.viewer); CHKERRQ(ierr);
+	ierr = PetscViewerHDF5GetFileId(archive.viewer, &archive.file); CHKERRQ(ierr);
+
+	// create the empty index of a new archive
+	for (i=0; i<2; i++)
+	{
+		if (H5Lexists(archive.file, names[i], H5P_DEFAULT) > 0)
+			continue;
+		fspace = H5Screate_simple(1, &zero, &unlimited);
+		dcpl = H5Pcreate(H5P_DATASET_CREATE);
+		H5Pset_chunk(dcpl, 1, &chunk);
+		dset = H5Dcreate2(archive.file, names[i], types[i], fspace,
+		                  H5P_DEFAULT, dcpl, H5P_DEFAULT);
+		H5Pclose(dcpl);
+		H5Sclose(fspace);
+		if (dset < 0)
+			SETERRQ(PETSC_COMM_SELF, PETSC_ERR_FILE_WRITE,
+			        "Cannot create the index of the archive");
+		H5Dclose(dset);
+	}
+	ierr = PetibmArchiveIndexRead(
+		archive.file, names[0], types[0], archive.steps); CHKERRQ(ierr);
+	ierr = PetibmArchiveIndexRead(
+		archive.file, names[1], types[1], archive.times); CHKERRQ(ierr);
+	if (archive.steps.size() != archive.times.size())
+		SETERRQ(PETSC_COMM_WORLD, PETSC_ERR_FILE_UNEXPECTED,
+		        "The step and time indices of the archive differ in size");
+
+	PetscFunctionReturn(0);
+} // PetibmArchiveOpen
+
+
+/*! Gets the record of a time step, appending it to the index if needed.
+ *
+ * Collective.
+ *
+ * \param archive The archive (passed by reference).
+ * \param step The time-step index.
+ * \param time The time of the step.
+ * \param record The record of the step (passed by pointer).
+ */
+PetscErrorCode PetibmArchiveSetStep(
+	PetibmArchive &archive, const PetscInt step, const PetscReal time,
+	PetscInt *record)
+{
+	PetscErrorCode ierr;
+
+	PetscFunctionBeginUser;
+
+	*record = std::find(archive.steps.begin(), archive.steps.end(), step)
+	          - archive.steps.begin();
+	if (*record < (PetscInt) archive.steps.size())
+		PetscFunctionReturn(0);
+	ierr = PetibmArchiveIndexWrite(archive.file, "step", PetibmArchiveIntType(),
+	                               *record, &step); CHKERRQ(ierr);
+	ierr = PetibmArchiveIndexWrite(archive.file, "time", PetibmArchiveRealType(),
+	                               *record, &time); CHKERRQ(ierr);
+	archive.steps.push_back(step);
+	archive.times.push_back(time);
+
+	PetscFunctionReturn(0);
+} // PetibmArchiveSetStep
+
+
+/*! Selects the block of the process in a record of a field dataset.
+ *
+ * \param da The DMDA object of the field.
+ * \param record The record.
+ * \param fspace The dataspace of the dataset.
+ * \param mspace The dataspace of the block in memory (passed by pointer).
+ */
+static PetscErrorCode PetibmArchiveSelectBlock(
+	const DM da, const PetscInt record, const hid_t fspace, hid_t *mspace)
+{
+	PetscErrorCode ierr;
+	PetscInt dim, xs, ys, zs, xm, ym, zm;
+	hsize_t start[4], count[4];
+	herr_t status;
+
+	PetscFunctionBeginUser;
+
+	ierr = DMDAGetInfo(da, &dim, nullptr, nullptr, nullptr,
+	                   nullptr, nullptr, nullptr, nullptr, nullptr,
+	                   nullptr, nullptr, nullptr, nullptr); CHKERRQ(ierr);
+	ierr = DMDAGetCorners(da, &xs, &ys, &zs, &xm, &ym, &zm); CHKERRQ(ierr);
+	// dimensions of the dataset are ordered (t, z, y, x)
+	start[0] = record;
+	count[0] = 1;
+	start[dim] = xs;
+	count[dim] = xm;
+	start[dim-1] = ys;
+	count[dim-1] = ym;
+	if (dim == 3)
+	{
+		start[1] = zs;
+		count[1] = zm;
+	}
+	status = H5Sselect_hyperslab(
+		fspace, H5S_SELECT_SET, start, nullptr, count, nullptr);
+	if (status < 0)
+		SETERRQ(PETSC_COMM_SELF, PETSC_ERR_LIB, "Cannot select the hyperslab");
+	*mspace = H5Screate_simple(dim+1, count, nullptr);
+
+	PetscFunctionReturn(0);
+} // PetibmArchiveSelectBlock
+
+
+/*! Closes the HDF5 handles of a field dataset that are open.
+ *
+ * \param dset The dataset (passed by pointer).
+ * \param fspace The dataspace of the dataset (passed by pointer).
+ * \param mspace The dataspace in memory (passed by pointer).
+ */
+static void PetibmArchiveRelease(hid_t *dset, hid_t *fspace, hid_t *mspace)
+{
+	if (*mspace >= 0)
+		H5Sclose(*mspace);
+	if (*fspace >= 0)
+		H5Sclose(*fspace);
+	if (*dset >= 0)
+		H5Dclose(*dset);
+	*dset = *fspace = *mspace = -1;
+} // PetibmArchiveRelease
+
+
+/*! Checks that a field has a single component.
+ *
+ * \param field The field.
+ */
+static PetscErrorCode PetibmArchiveCheckField(const PetibmField field)
+{
+	PetscErrorCode ierr;
+	PetscInt dof;
+
+	PetscFunctionBeginUser;
+
+	ierr = DMDAGetInfo(field.da, nullptr, nullptr, nullptr, nullptr,
+	                   nullptr, nullptr, nullptr, &dof, nullptr,
+	                   nullptr, nullptr, nullptr, nullptr); CHKERRQ(ierr);
+	if (dof != 1)
+		SETERRQ1(PETSC_COMM_WORLD, PETSC_ERR_SUP,
+		         "The archive only supports fields with a single component "
+		         "(not %D)", dof);
+
+	PetscFunctionReturn(0);
+} // PetibmArchiveCheckField
+
+
+/*! Writes a field into a record of the archive.
+ *
+ * Collective; the dataset `name` is created on first write and extended to
+ * the number of records of the index, then each process writes its block.
+ * The field should have a single component.
+ *
+ * \param archive The archive (passed by reference).
+ * \param name Name of the field.
+ * \param record The record to write.
+ * \param field The field.
+ */
+PetscErrorCode PetibmArchiveFieldWrite(
+	PetibmArchive &archive, const std::string name, const PetscInt record,
+	const PetibmField field)
+{
+	PetscErrorCode ierr = 0, code = 0;
+	PetscInt dim, M, N, P, d;
+	hid_t dset = -1, fspace = -1, mspace = -1, dcpl, dxpl;
+	hsize_t dims[4], maxdims[4], chunk[4], current[4];
+	herr_t status;
+	const PetscReal *arr;
+	const char *error = nullptr;
+
+	PetscFunctionBeginUser;
+
+	if (record < 0 or record >= (PetscInt) archive.steps.size())
+		SETERRQ(PETSC_COMM_WORLD, PETSC_ERR_ARG_OUTOFRANGE,
+		        "The record is not in the index of the archive");
+	ierr = PetibmArchiveCheckField(field); CHKERRQ(ierr);
+	ierr = DMDAGetInfo(field.da, &dim, &M, &N, &P,
+	                   nullptr, nullptr, nullptr, nullptr, nullptr,
+	                   nullptr, nullptr, nullptr, nullptr); CHKERRQ(ierr);
+	dims[0] = archive.steps.size();
+	maxdims[0] = H5S_UNLIMITED;
+	dims[dim] = maxdims[dim] = M;
+	dims[dim-1] = maxdims[dim-1] = N;
+	if (dim == 3)
+		dims[1] = maxdims[1] = P;
+
+	if (H5Lexists(archive.file, name.c_str(), H5P_DEFAULT) > 0)
+	{
+		dset = H5Dopen2(archive.file, name.c_str(), H5P_DEFAULT);
+		if (dset < 0)
+		{
+			code = PETSC_ERR_FILE_UNEXPECTED;
+			error = "Cannot open the dataset of the field";
+		}
+		else
+		{
+			fspace = H5Dget_space(dset);
+			if (H5Sget_simple_extent_ndims(fspace) != dim+1)
+			{
+				code = PETSC_ERR_FILE_UNEXPECTED;
+				error = "The dataset of the field does not match its dimension";
+			}
+			else
+			{
+				H5Sget_simple_extent_dims(fspace, current, nullptr);
+				for (d=1; d<=dim; d++)
+				{
+					if (current[d] != dims[d])
+					{
+						code = PETSC_ERR_FILE_UNEXPECTED;
+						error = "The dataset of the field does not match the grid";
+					}
+				}
+			}
+			H5Sclose(fspace);
+			fspace = -1;
+			if (!error and current[0] < dims[0])
+				H5Dset_extent(dset, dims);
+		}
+	}
+	else
+	{
+		// history: records x small tile; slice: single record x whole planes
+		if (archive.layout == 0)
+		{
+			chunk[0] = archive.chunk_steps;
+			for (d=1; d<=dim; d++)
+				chunk[d] = std::min<hsize_t>(dims[d], (dim == 3) ? 16 : 64);
+		}
+		else
+		{
+			chunk[0] = 1;
+			chunk[dim] = dims[dim];
+			chunk[dim-1] = dims[dim-1];
+			if (dim == 3)
+				chunk[1] = std::max<hsize_t>(1, std::min<hsize_t>(
+					dims[1], (1 << 20) / (dims[2] * dims[3])));
+		}
+		fspace = H5Screate_simple(dim+1, dims, maxdims);
+		dcpl = H5Pcreate(H5P_DATASET_CREATE);
+		H5Pset_chunk(dcpl, dim+1, chunk);
+		dset = H5Dcreate2(archive.file, name.c_str(), PetibmArchiveRealType(),
+		                  fspace, H5P_DEFAULT, dcpl, H5P_DEFAULT);
+		H5Pclose(dcpl);
+		H5Sclose(fspace);
+		fspace = -1;
+		if (dset < 0)
+		{
+			code = PETSC_ERR_FILE_WRITE;
+			error = "Cannot create the dataset of the field";
+		}
+	}
+
+	// the owned part of a DMDA global vector is the block, x running fastest
+	if (!error)
+	{
+		fspace = H5Dget_space(dset);
+		ierr = PetibmArchiveSelectBlock(field.da, record, fspace, &mspace);
+	}
+	if (!error and !ierr)
+		ierr = VecGetArrayRead(field.global, &arr);
+	if (!error and !ierr)
+	{
+		dxpl = PetibmArchiveCreateTransfer();
+		status = H5Dwrite(
+			dset, PetibmArchiveRealType(), mspace, fspace, dxpl, arr);
+		H5Pclose(dxpl);
+		ierr = VecRestoreArrayRead(field.global, &arr);
+		if (status < 0)
+		{
+			code = PETSC_ERR_FILE_WRITE;
+			error = "Cannot write the field into the archive";
+		}
+	}
+	// single exit: the handles are released before raising any error
+	PetibmArchiveRelease(&dset, &fspace, &mspace);
+	CHKERRQ(ierr);
+	if (error)
+		SETERRQ1(PETSC_COMM_SELF, code, "%s", error);
+
+	PetscFunctionReturn(0);
+} // PetibmArchiveFieldWrite
+
+
+/*! Reads a record of the archive into a field.
+ *
+ * Collective; each process reads its block.
+ * The field should have a single component.
+ *
+ * \param archive The archive (passed by reference).
+ * \param name Name of the field.
+ * \param record The record to read.
+ * \param field The field (passed by reference).
+ */
+PetscErrorCode PetibmArchiveFieldRead(
+	PetibmArchive &archive, const std::string name, const PetscInt record,
+	PetibmField &field)
+{
+	PetscErrorCode ierr = 0, code = 0;
+	hid_t dset = -1, fspace = -1, mspace = -1, dxpl;
+	herr_t status;
+	PetscReal *arr;
+	const char *error = nullptr;
+
+	PetscFunctionBeginUser;
+
+	if (record < 0 or record >= (PetscInt) archive.steps.size())
+		SETERRQ(PETSC_COMM_WORLD, PETSC_ERR_ARG_OUTOFRANGE,
+		        "The record is not in the index of the archive");
+	ierr = PetibmArchiveCheckField(field); CHKERRQ(ierr);
+	dset = H5Dopen2(archive.file, name.c_str(), H5P_DEFAULT);
+	if (dset < 0)
+	{
+		code = PETSC_ERR_FILE_UNEXPECTED;
+		error = "Cannot open the dataset of the field";
+	}
+	if (!error)
+	{
+		fspace = H5Dget_space(dset);
+		ierr = PetibmArchiveSelectBlock(field.da, record, fspace, &mspace);
+	}
+	if (!error and !ierr)
+		ierr = VecGetArray(field.global, &arr);
+	if (!error and !ierr)
+	{
+		dxpl = PetibmArchiveCreateTransfer();
+		status = H5Dread(
+			dset, PetibmArchiveRealType(), mspace, fspace, dxpl, arr);
+		H5Pclose(dxpl);
+		ierr = VecRestoreArray(field.global, &arr);
+		if (status < 0)
+		{
+			code = PETSC_ERR_FILE_READ;
+			error = "Cannot read the field from the archive";
+		}
+	}
+	// single exit: the handles are released before raising any error
+	PetibmArchiveRelease(&dset, &fspace, &mspace);
+	CHKERRQ(ierr);
+	if (error)
+		SETERRQ1(PETSC_COMM_SELF, code, "%s", error);
+
+	PetscFunctionReturn(0);
+} // PetibmArchiveFieldRead
+
+
+/*! Reads the time history of a field at a grid point.
+ *
+ * Collective; each process reads the history at its own point (indices
+ * ordered x, y, z) for all the records of the index.
+ * The points are checked on all processes before the collective read, so
+ * that an invalid point on one process raises the error on all of them.
+ *
+ * \param archive The archive (passed by reference).
+ * \param name Name of the field.
+ * \param index The indices of the grid point.
+ * \param values The values, one per record (passed by reference).
+ */
+PetscErrorCode PetibmArchiveHistoryRead(
+	PetibmArchive &archive, const std::string name, const PetscInt index[],
+	std::vector<PetscReal> &values)
+{
+	PetscErrorCode ierr;
+	hid_t dset = -1, fspace = -1, mspace = -1, dxpl;
+	hsize_t dims[4], start[4], count[4] = {1, 1, 1, 1};
+	herr_t status;
+	int ndims, d;
+	// 0: valid, 1: the dataset cannot be opened, 2: point outside the dataset
+	PetscMPIInt flag = 0;
+
+	PetscFunctionBeginUser;
+
+	dset = H5Dopen2(archive.file, name.c_str(), H5P_DEFAULT);
+	if (dset < 0)
+		flag = 1;
+	else
+	{
+		fspace = H5Dget_space(dset);
+		ndims = H5Sget_simple_extent_ndims(fspace);
+		H5Sget_simple_extent_dims(fspace, dims, nullptr);
+		start[0] = 0;
+		count[0] = std::min<hsize_t>(dims[0], archive.steps.size());
+		for (d=1; d<ndims; d++)
+		{
+			start[d] = index[ndims-1-d];
+			if (index[ndims-1-d] < 0 or start[d] >= dims[d])
+				flag = 2;
+		}
+	}
+	ierr = MPI_Allreduce(MPI_IN_PLACE, &flag, 1, MPI_INT, MPI_MAX,
+	                     PETSC_COMM_WORLD); CHKERRQ(ierr);
+	if (flag)
+	{
+		PetibmArchiveRelease(&dset, &fspace, &mspace);
+		if (flag == 1)
+			SETERRQ(PETSC_COMM_WORLD, PETSC_ERR_FILE_UNEXPECTED,
+			        "Cannot open the dataset of the field");
+		SETERRQ(PETSC_COMM_WORLD, PETSC_ERR_ARG_OUTOFRANGE,
+		        "The grid point is outside the dataset of the field");
+	}
+	values.assign(count[0], 0.0);
+	H5Sselect_hyperslab(fspace, H5S_SELECT_SET, start, nullptr, count, nullptr);
+	mspace = H5Screate_simple(1, count, nullptr);
+	dxpl = PetibmArchiveCreateTransfer();
+	status = H5Dread(
+		dset, PetibmArchiveRealType(), mspace, fspace, dxpl, values.data());
+	H5Pclose(dxpl);
+	PetibmArchiveRelease(&dset, &fspace, &mspace);
+	if (status < 0)
+		SETERRQ(PETSC_COMM_SELF, PETSC_ERR_FILE_READ,
+		        "Cannot read the time history from the archive");
+
+	PetscFunctionReturn(0);
+} // PetibmArchiveHistoryRead
+
+
+/*! Closes a time-series archive.
+ *
+ * \param archive The archive (passed by reference).
+ */
+PetscErrorCode PetibmArchiveClose(PetibmArchive &archive)
+{
+	PetscErrorCode ierr;
+
+	PetscFunctionBeginUser;
+
+	ierr = PetscViewerDestroy(&archive.viewer); CHKERRQ(ierr);
+	archive.file = -1;
+	archive.steps.clear();
+	archive.times.clear();
+
+	PetscFunctionReturn(0);
+} // PetibmArchiveClose
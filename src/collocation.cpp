@@ -0,0 +1,123 @@
+/*! Implementation of the functions to collocate the staggered velocity field.
+ * \file collocation.cpp
+ */
+
+#include "petibm-utilities/collocation.h"
+#include "petibm-utilities/threads.h"
+
+
+/*! Initializes the cell-centered velocity field, with interleaved components.
+ *
+ * The DMDA object has the sizes, boundary types, and ownership ranges of the
+ * cell-centered DMDA, 3 degrees of freedom (the components x, y, z of each
+ * point are contiguous), and no ghost points.
+ *
+ * \param da The cell-centered DMDA object (3D).
+ * \param pool The pool (passed by reference).
+ * \param u The velocity field to initialize (passed by reference).
+ */
+PetscErrorCode PetibmCollocationInitialize(
+	const DM da, PetibmFieldPool &pool, PetibmField &u)
+{
+	PetscErrorCode ierr;
+	PetscInt dim, M, N, P, m, n, p;
+	DMBoundaryType bx, by, bz;
+	DMDAStencilType stencil;
+	const PetscInt *lx, *ly, *lz;
+
+	PetscFunctionBeginUser;
+
+	ierr = DMDAGetInfo(da, &dim, &M, &N, &P, &m, &n, &p, nullptr, nullptr,
+	                   &bx, &by, &bz, &stencil); CHKERRQ(ierr);
+	if (dim != 3)
+		SETERRQ(PETSC_COMM_WORLD, PETSC_ERR_SUP,
+		        "Function only supports 3D fields");
+	ierr = DMDAGetOwnershipRanges(da, &lx, &ly, &lz); CHKERRQ(ierr);
+	ierr = DMDACreate3d(PETSC_COMM_WORLD, bx, by, bz, stencil,
+	                    M, N, P, m, n, p, 3, 0, lx, ly, lz,
+	                    &u.da); CHKERRQ(ierr);
+	ierr = DMSetFromOptions(u.da); CHKERRQ(ierr);
+	ierr = DMSetUp(u.da); CHKERRQ(ierr);
+	ierr = DMDASetFieldName(u.da, 0, "x"); CHKERRQ(ierr);
+	ierr = DMDASetFieldName(u.da, 1, "y"); CHKERRQ(ierr);
+	ierr = DMDASetFieldName(u.da, 2, "z"); CHKERRQ(ierr);
+	ierr = PetibmFieldInitialize(pool, u); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmCollocationInitialize
+
+
+/*! Averages the staggered 3D velocity field at cell centers.
+ *
+ * The components are on the faces of the cells (MAC staggering: ux on the
+ * x-faces, uy on the y-faces, uz on the z-faces, with the last face of a
+ * non-periodic direction on the boundary and not stored), so each component
+ * at a cell center is the mean of the two faces normal to it.
+ * The ghost points of the three components are exchanged together, and the
+ * three averages are done in a single sweep over the cells, on the threads
+ * of the process.
+ * The boundary faces of a non-periodic direction are not stored: their
+ * values are the external boundary values of the components (`bc_value`,
+ * set with PetibmFieldSetBoundaryPoints), applied when the local vectors are
+ * borrowed.
+ *
+ * \param ux The velocity field in the x-direction.
+ * \param uy The velocity field in the y-direction.
+ * \param uz The velocity field in the z-direction.
+ * \param u The cell-centered velocity field, from PetibmCollocationInitialize
+ *          (passed by reference).
+ */
+PetscErrorCode PetibmCollocationComputeField(
+	PetibmField ux, PetibmField uy, PetibmField uz, PetibmField &u)
+{
+	PetscErrorCode ierr;
+	DMDALocalInfo info;
+	PetibmField *velocity[3] = {&ux, &uy, &uz};
+	PetscReal ***ux_a, ***uy_a, ***uz_a, ****u_a;
+
+	PetscFunctionBeginUser;
+
+	ierr = DMDAGetLocalInfo(u.da, &info); CHKERRQ(ierr);
+	if (info.dim != 3 or info.dof != 3)
+		SETERRQ(PETSC_COMM_WORLD, PETSC_ERR_ARG_INCOMP,
+		        "The cell-centered velocity should be a 3D field with "
+		        "3 components");
+
+	ierr = PetibmFieldGetLocal(3, velocity); CHKERRQ(ierr);
+	ierr = DMDAVecGetArray(ux.da, ux.local, &ux_a); CHKERRQ(ierr);
+	ierr = DMDAVecGetArray(uy.da, uy.local, &uy_a); CHKERRQ(ierr);
+	ierr = DMDAVecGetArray(uz.da, uz.local, &uz_a); CHKERRQ(ierr);
+	ierr = DMDAVecGetArrayDOF(u.da, u.global, &u_a); CHKERRQ(ierr);
+
+	// static slabs along z, the components of a cell written together
+	ierr = PetibmThreadsRun([&](const PetscInt t, const PetscInt n)
+	{
+		PetscInt i, j, k, zs, ze;
+
+		PetibmThreadsGetSlab(info.zs, info.zs+info.zm, t, n, &zs, &ze);
+		for (k=zs; k<ze; k++)
+		{
+			for (j=info.ys; j<info.ys+info.ym; j++)
+			{
+				const PetscReal *uxr = ux_a[k][j],
+				                *uym = uy_a[k][j-1], *uyp = uy_a[k][j],
+				                *uzm = uz_a[k-1][j], *uzp = uz_a[k][j];
+				PetscReal **ur = u_a[k][j];
+				for (i=info.xs; i<info.xs+info.xm; i++)
+				{
+					ur[i][0] = 0.5*(uxr[i-1] + uxr[i]);
+					ur[i][1] = 0.5*(uym[i] + uyp[i]);
+					ur[i][2] = 0.5*(uzm[i] + uzp[i]);
+				}
+			}
+		}
+	}); CHKERRQ(ierr);
+
+	ierr = DMDAVecRestoreArrayDOF(u.da, u.global, &u_a); CHKERRQ(ierr);
+	ierr = DMDAVecRestoreArray(uz.da, uz.local, &uz_a); CHKERRQ(ierr);
+	ierr = DMDAVecRestoreArray(uy.da, uy.local, &uy_a); CHKERRQ(ierr);
+	ierr = DMDAVecRestoreArray(ux.da, ux.local, &ux_a); CHKERRQ(ierr);
+	ierr = PetibmFieldRestoreLocal(3, velocity); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmCollocationComputeField
@@ -0,0 +1,616 @@
+/*! Implementation of the functions for the PetibmComponents structure.
+ * \file components.cpp
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <utility>
+
+#include "petibm-utilities/components.h"
+#include "petibm-utilities/misc.h"
+
+
+// layout of the statistics of a component exchanged between the processes:
+// label, size, volume, volume-weighted sums of the coordinates (3), peak,
+// location of the peak (3)
+static const PetscInt RECORD = 10;
+
+
+/*! Gets options from command-line or config file.
+ *
+ * `-threshold <value>`, `-absolute <true|false>`, `-min_size <n>`.
+ *
+ * \param prefix String to prepend to options.
+ * \param ctx The PetibmComponentsCtx structure to fill (passed by pointer).
+ */
+PetscErrorCode PetibmComponentsGetOptions(
+	const char prefix[], PetibmComponentsCtx *ctx)
+{
+	PetscErrorCode ierr;
+	char path[PETSC_MAX_PATH_LEN];
+	PetscBool found;
+
+	PetscFunctionBeginUser;
+
+	// get path of configuration file
+	ierr = PetscOptionsGetString(nullptr, prefix, "-config_file",
+	                             path, sizeof(path), &found); CHKERRQ(ierr);
+	if (found)
+	{
+		ierr = PetibmOptionsInsertFile(path); CHKERRQ(ierr);
+	}
+	// get threshold of the mask
+	ierr = PetscOptionsGetReal(nullptr, prefix, "-threshold",
+	                           &ctx->threshold, &found); CHKERRQ(ierr);
+	// threshold the magnitude?
+	ierr = PetscOptionsGetBool(nullptr, prefix, "-absolute",
+	                           &ctx->absolute, &found); CHKERRQ(ierr);
+	// get minimum number of points of a component
+	ierr = PetscOptionsGetInt(nullptr, prefix, "-min_size",
+	                          &ctx->min_size, &found); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmComponentsGetOptions
+
+
+PetscErrorCode PetibmComponentsCtxPrintf(
+	const std::string name, const PetibmComponentsCtx ctx)
+{
+	PetscErrorCode ierr;
+
+	PetscFunctionBeginUser;
+
+	ierr = PetscPrintf(PETSC_COMM_WORLD, "+ %s:\n", name.c_str()); CHKERRQ(ierr);
+	ierr = PetscPrintf(PETSC_COMM_WORLD, "\t- threshold: %g\n",
+	                   ctx.threshold); CHKERRQ(ierr);
+	ierr = PetscPrintf(PETSC_COMM_WORLD, "\t- absolute: %s\n",
+	                   (ctx.absolute) ? "yes" : "no"); CHKERRQ(ierr);
+	ierr = PetscPrintf(PETSC_COMM_WORLD, "\t- minimum size: %d points\n",
+	                   ctx.min_size); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmComponentsCtxPrintf
+
+
+/*! Initializes the connected components of a field.
+ *
+ * \param field The field (scalar).
+ * \param comps The components to initialize (passed by reference).
+ */
+PetscErrorCode PetibmComponentsInitialize(
+	const PetibmField field, PetibmComponents &comps)
+{
+	PetscErrorCode ierr;
+	PetscInt dof;
+
+	PetscFunctionBeginUser;
+
+	ierr = DMDAGetInfo(field.da, nullptr, nullptr, nullptr, nullptr,
+	                   nullptr, nullptr, nullptr, &dof, nullptr,
+	                   nullptr, nullptr, nullptr, nullptr); CHKERRQ(ierr);
+	if (dof != 1)
+		SETERRQ(PETSC_COMM_WORLD, PETSC_ERR_SUP,
+		        "Function only supports scalar fields");
+	ierr = DMCreateGlobalVector(field.da, &comps.labels); CHKERRQ(ierr);
+	ierr = DMCreateLocalVector(field.da, &comps.local); CHKERRQ(ierr);
+	// the external ghost points are never in a component
+	ierr = VecSet(comps.local, -1.0); CHKERRQ(ierr);
+	comps.catalog.clear();
+	comps.count = 0;
+	comps.steps = 0;
+	comps.tracks = 0;
+	comps.iterations = 0;
+
+	PetscFunctionReturn(0);
+} // PetibmComponentsInitialize
+
+
+/*! Merges the statistics of a part of a component into another.
+ *
+ * \param in The record to merge.
+ * \param out The record to update.
+ * \param absolute Compare the magnitudes of the peaks?
+ */
+static void PetibmComponentsMerge(
+	const PetscReal *in, PetscReal *out, const PetscBool absolute)
+{
+	PetscInt r;
+
+	for (r=1; r<6; r++)
+		out[r] += in[r];
+	if ((absolute) ? PetscAbsReal(in[6]) > PetscAbsReal(out[6]) : in[6] > out[6])
+		for (r=6; r<RECORD; r++)
+			out[r] = in[r];
+} // PetibmComponentsMerge
+
+
+/*! Labels the connected components of the thresholded field and matches them
+ * with the components of the previous time step.
+ *
+ * The points on process are labeled with a union-find (face neighbors); the
+ * labels are then merged across the process boundaries by exchanging the
+ * ghost labels until no label changes.
+ * The statistics of each component are reduced on the process owning its
+ * label, components smaller than `min_size` are discarded, and the others
+ * are numbered consecutively.
+ * A component continues the track of the component of the previous time step
+ * it overlaps most, if it is the largest overlap of that component; otherwise
+ * it starts a new track.
+ * The centroids are not unwrapped across periodic boundaries.
+ * Collective.
+ *
+ * \param ctx The options.
+ * \param grid The grid of the field (passed by reference).
+ * \param field The field.
+ * \param comps The components (passed by reference).
+ */
+PetscErrorCode PetibmComponentsCompute(
+	const PetibmComponentsCtx ctx, PetibmGrid &grid, const PetibmField field,
+	PetibmComponents &comps)
+{
+	PetscErrorCode ierr;
+	DMDALocalInfo info;
+	PetscMPIInt size, rank, changed, r;
+	std::vector<PetscReal> wx, wy, wz(1, 1.0), records, received;
+	std::vector<PetscInt> parent;
+	std::vector<std::pair<PetscInt, PetscInt>> faces;
+	std::map<PetscInt, PetscInt> equivalent, ids;
+	std::map<PetscInt, PetscReal *> stats;
+	std::map<std::pair<PetscInt, PetscInt>, PetscReal> overlaps;
+	std::vector<PetscMPIInt> scounts, sdispls, rcounts, rdispls;
+	const PetscInt *ranges;
+	const PetscReal *values, *ghosts, *previous;
+	PetscReal *labels, *x, *y, *z = nullptr, dv, coords[3] = {0.0, 0.0, 0.0};
+	PetscInt i, j, k, p, n, d, first, kept, rstart;
+	PetscBool periodic[3];
+
+	PetscFunctionBeginUser;
+
+	ierr = MPI_Comm_size(PETSC_COMM_WORLD, &size); CHKERRQ(ierr);
+	ierr = MPI_Comm_rank(PETSC_COMM_WORLD, &rank); CHKERRQ(ierr);
+	ierr = DMDAGetLocalInfo(field.da, &info); CHKERRQ(ierr);
+	periodic[0] = (PetscBool) (info.bx == DM_BOUNDARY_PERIODIC);
+	periodic[1] = (PetscBool) (info.by == DM_BOUNDARY_PERIODIC);
+	periodic[2] = (PetscBool) (info.bz == DM_BOUNDARY_PERIODIC);
+	n = info.xm * info.ym * info.zm;
+	ierr = VecGetOwnershipRange(comps.labels, &rstart, nullptr); CHKERRQ(ierr);
+
+	// union-find of the points on process: the root of a set is its point
+	// with the smallest index
+	auto find = [&](PetscInt a) -> PetscInt
+	{
+		while (parent[a] != a)
+			a = parent[a] = parent[parent[a]];
+		return a;
+	};
+	auto unite = [&](const PetscInt a, const PetscInt b)
+	{
+		PetscInt ra = find(a), rb = find(b);
+		if (ra < rb)
+			parent[rb] = ra;
+		else if (rb < ra)
+			parent[ra] = rb;
+	};
+	auto ghost = [&](const PetscInt i, const PetscInt j, const PetscInt k)
+	{
+		return ((k-info.gzs)*info.gym + (j-info.gys))*info.gxm + (i-info.gxs);
+	};
+	auto outside = [&](const PetscInt l, const PetscInt m, const PetscInt dir)
+	{
+		return (!periodic[dir] and (l < 0 or l >= m));
+	};
+	parent.assign(n, -1);
+	ierr = VecGetArrayRead(field.global, &values); CHKERRQ(ierr);
+	for (p=0; p<n; p++)
+		if ((ctx.absolute) ? PetscAbsReal(values[p]) >= ctx.threshold
+		                   : values[p] >= ctx.threshold)
+			parent[p] = p;
+	for (k=0, p=0; k<info.zm; k++)
+		for (j=0; j<info.ym; j++)
+			for (i=0; i<info.xm; i++, p++)
+			{
+				if (parent[p] < 0)
+					continue;
+				if (i > 0 and parent[p-1] >= 0)
+					unite(p, p-1);
+				if (j > 0 and parent[p-info.xm] >= 0)
+					unite(p, p-info.xm);
+				if (k > 0 and parent[p-info.xm*info.ym] >= 0)
+					unite(p, p-info.xm*info.ym);
+				// pairs (point, ghost neighbor) across the process boundaries
+				const PetscInt gi = info.xs+i, gj = info.ys+j, gk = info.zs+k;
+				if (i == 0 and !outside(gi-1, info.mx, 0))
+					faces.push_back({p, ghost(gi-1, gj, gk)});
+				if (i == info.xm-1 and !outside(gi+1, info.mx, 0))
+					faces.push_back({p, ghost(gi+1, gj, gk)});
+				if (j == 0 and !outside(gj-1, info.my, 1))
+					faces.push_back({p, ghost(gi, gj-1, gk)});
+				if (j == info.ym-1 and !outside(gj+1, info.my, 1))
+					faces.push_back({p, ghost(gi, gj+1, gk)});
+				if (info.dim == 3)
+				{
+					if (k == 0 and !outside(gk-1, info.mz, 2))
+						faces.push_back({p, ghost(gi, gj, gk-1)});
+					if (k == info.zm-1 and !outside(gk+1, info.mz, 2))
+						faces.push_back({p, ghost(gi, gj, gk+1)});
+				}
+			}
+	// provisional labels: global index of the root
+	ierr = VecGetArray(comps.labels, &labels); CHKERRQ(ierr);
+	for (p=0; p<n; p++)
+		labels[p] = (parent[p] >= 0) ? rstart + find(p) : -1.0;
+	ierr = VecRestoreArray(comps.labels, &labels); CHKERRQ(ierr);
+
+	// merge the labels across the process boundaries: each exchange replaces
+	// the labels of the sets touching through a face with the smallest one
+	auto root = [&](PetscInt a) -> PetscInt
+	{
+		std::map<PetscInt, PetscInt>::iterator it;
+		while ((it = equivalent.find(a)) != equivalent.end())
+			a = it->second;
+		return a;
+	};
+	comps.iterations = 0;
+	do
+	{
+		ierr = DMGlobalToLocalBegin(
+			field.da, comps.labels, INSERT_VALUES, comps.local); CHKERRQ(ierr);
+		ierr = DMGlobalToLocalEnd(
+			field.da, comps.labels, INSERT_VALUES, comps.local); CHKERRQ(ierr);
+		ierr = VecGetArrayRead(comps.local, &ghosts); CHKERRQ(ierr);
+		ierr = VecGetArray(comps.labels, &labels); CHKERRQ(ierr);
+		equivalent.clear();
+		for (auto &face : faces)
+		{
+			if (ghosts[face.second] < 0.0)
+				continue;
+			PetscInt a = root((PetscInt) labels[face.first]),
+			         b = root((PetscInt) ghosts[face.second]);
+			if (a != b)
+				equivalent[PetscMax(a, b)] = PetscMin(a, b);
+		}
+		changed = 0;
+		if (!equivalent.empty())
+			for (p=0; p<n; p++)
+				if (labels[p] >= 0.0)
+				{
+					PetscInt a = root((PetscInt) labels[p]);
+					if (a != (PetscInt) labels[p])
+					{
+						labels[p] = a;
+						changed = 1;
+					}
+				}
+		ierr = VecRestoreArray(comps.labels, &labels); CHKERRQ(ierr);
+		ierr = VecRestoreArrayRead(comps.local, &ghosts); CHKERRQ(ierr);
+		ierr = MPI_Allreduce(MPI_IN_PLACE, &changed, 1, MPI_INT, MPI_MAX,
+		                     PETSC_COMM_WORLD); CHKERRQ(ierr);
+		comps.iterations++;
+	} while (changed);
+
+	// partial statistics of the components on process
+	ierr = PetibmGridlineGetWidths(grid.x, wx); CHKERRQ(ierr);
+	ierr = PetibmGridlineGetWidths(grid.y, wy); CHKERRQ(ierr);
+	ierr = DMDAVecGetArray(grid.x.da, grid.x.local, &x); CHKERRQ(ierr);
+	ierr = DMDAVecGetArray(grid.y.da, grid.y.local, &y); CHKERRQ(ierr);
+	if (info.dim == 3)
+	{
+		ierr = PetibmGridlineGetWidths(grid.z, wz); CHKERRQ(ierr);
+		ierr = DMDAVecGetArray(grid.z.da, grid.z.local, &z); CHKERRQ(ierr);
+	}
+	ierr = VecGetArray(comps.labels, &labels); CHKERRQ(ierr);
+	for (p=0; p<n; p++)
+		if (labels[p] >= 0.0)
+			stats[(PetscInt) labels[p]] = nullptr;
+	records.assign(RECORD*stats.size(), 0.0);
+	p = 0;
+	for (auto &s : stats)
+	{
+		s.second = &records[RECORD*(p++)];
+		s.second[0] = s.first;
+	}
+	for (k=0, p=0; k<info.zm; k++)
+		for (j=0; j<info.ym; j++)
+			for (i=0; i<info.xm; i++, p++)
+			{
+				if (labels[p] < 0.0)
+					continue;
+				PetscReal part[RECORD];
+				dv = wx[i] * wy[j] * wz[k];
+				coords[0] = x[info.xs+i];
+				coords[1] = y[info.ys+j];
+				coords[2] = (z) ? z[info.zs+k] : 0.0;
+				part[1] = 1.0;
+				part[2] = dv;
+				for (d=0; d<3; d++)
+				{
+					part[3+d] = coords[d] * dv;
+					part[7+d] = coords[d];
+				}
+				part[6] = values[p];
+				PetscReal *s = stats[(PetscInt) labels[p]];
+				if (s[1] == 0.0)
+					for (d=6; d<RECORD; d++)
+						s[d] = part[d];
+				PetibmComponentsMerge(part, s, ctx.absolute);
+			}
+	ierr = VecRestoreArray(comps.labels, &labels); CHKERRQ(ierr);
+	ierr = VecRestoreArrayRead(field.global, &values); CHKERRQ(ierr);
+	ierr = DMDAVecRestoreArray(grid.x.da, grid.x.local, &x); CHKERRQ(ierr);
+	ierr = DMDAVecRestoreArray(grid.y.da, grid.y.local, &y); CHKERRQ(ierr);
+	if (info.dim == 3)
+	{
+		ierr = DMDAVecRestoreArray(grid.z.da, grid.z.local, &z); CHKERRQ(ierr);
+	}
+
+	// send the partial statistics to the process owning the label
+	// (the records are sorted by label, hence by destination)
+	ierr = VecGetOwnershipRanges(comps.labels, &ranges); CHKERRQ(ierr);
+	scounts.assign(size, 0);
+	sdispls.assign(size, 0);
+	rcounts.assign(size, 0);
+	rdispls.assign(size, 0);
+	for (auto &s : stats)
+		scounts[std::upper_bound(ranges, ranges+size+1, s.first)-ranges-1] += RECORD;
+	ierr = MPI_Alltoall(scounts.data(), 1, MPI_INT, rcounts.data(), 1, MPI_INT,
+	                    PETSC_COMM_WORLD); CHKERRQ(ierr);
+	for (r=1; r<size; r++)
+	{
+		sdispls[r] = sdispls[r-1] + scounts[r-1];
+		rdispls[r] = rdispls[r-1] + rcounts[r-1];
+	}
+	received.resize(rdispls[size-1] + rcounts[size-1]);
+	ierr = MPI_Alltoallv(records.data(), scounts.data(), sdispls.data(),
+	                     MPIU_REAL, received.data(), rcounts.data(),
+	                     rdispls.data(), MPIU_REAL,
+	                     PETSC_COMM_WORLD); CHKERRQ(ierr);
+
+	// merge the parts on the owner and number the components kept
+	std::map<PetscInt, std::vector<PetscReal>> owned;
+	for (p=0; p<(PetscInt) received.size(); p+=RECORD)
+	{
+		auto it = owned.find((PetscInt) received[p]);
+		if (it == owned.end())
+			owned[(PetscInt) received[p]].assign(&received[p], &received[p]+RECORD);
+		else
+			PetibmComponentsMerge(&received[p], it->second.data(), ctx.absolute);
+	}
+	kept = 0;
+	for (auto &o : owned)
+		if (o.second[1] >= ctx.min_size)
+			kept++;
+	ierr = MPI_Scan(&kept, &first, 1, MPIU_INT, MPI_SUM,
+	                PETSC_COMM_WORLD); CHKERRQ(ierr);
+	first -= kept;
+	ierr = MPI_Allreduce(&kept, &comps.count, 1, MPIU_INT, MPI_SUM,
+	                     PETSC_COMM_WORLD); CHKERRQ(ierr);
+	std::vector<PetscReal> catalog;
+	for (auto &o : owned)
+		if (o.second[1] >= ctx.min_size)
+		{
+			ids[o.first] = first + catalog.size()/RECORD;
+			catalog.insert(catalog.end(), o.second.begin(), o.second.end());
+		}
+
+	// reply with the new index of each label received (-1: discarded)
+	std::vector<PetscReal> replies(received.size()/RECORD), answers(stats.size());
+	for (p=0; p<(PetscInt) replies.size(); p++)
+	{
+		auto it = ids.find((PetscInt) received[RECORD*p]);
+		replies[p] = (it == ids.end()) ? -1.0 : it->second;
+	}
+	for (r=0; r<size; r++)
+	{
+		scounts[r] /= RECORD;
+		sdispls[r] /= RECORD;
+		rcounts[r] /= RECORD;
+		rdispls[r] /= RECORD;
+	}
+	ierr = MPI_Alltoallv(replies.data(), rcounts.data(), rdispls.data(),
+	                     MPIU_REAL, answers.data(), scounts.data(),
+	                     sdispls.data(), MPIU_REAL,
+	                     PETSC_COMM_WORLD); CHKERRQ(ierr);
+	ids.clear();
+	p = 0;
+	for (auto &s : stats)
+		ids[s.first] = (PetscInt) answers[p++];
+	ierr = VecGetArray(comps.labels, &labels); CHKERRQ(ierr);
+	for (p=0; p<n; p++)
+		if (labels[p] >= 0.0)
+			labels[p] = ids[(PetscInt) labels[p]];
+
+	// volumes shared with the components of the previous time step
+	if (comps.previous)
+	{
+		ierr = VecGetArrayRead(comps.previous, &previous); CHKERRQ(ierr);
+		for (k=0, p=0; k<info.zm; k++)
+			for (j=0; j<info.ym; j++)
+				for (i=0; i<info.xm; i++, p++)
+					if (labels[p] >= 0.0 and previous[p] >= 0.0)
+						overlaps[{(PetscInt) previous[p], (PetscInt) labels[p]}] +=
+							wx[i] * wy[j] * wz[k];
+		ierr = VecRestoreArrayRead(comps.previous, &previous); CHKERRQ(ierr);
+	}
+	ierr = VecRestoreArray(comps.labels, &labels); CHKERRQ(ierr);
+	records.clear();
+	for (auto &o : overlaps)
+	{
+		records.push_back(o.first.first);
+		records.push_back(o.first.second);
+		records.push_back(o.second);
+	}
+
+	// gather the catalog and the overlaps on rank 0
+	auto gather = [&](std::vector<PetscReal> &local,
+	                  std::vector<PetscReal> &all) -> PetscErrorCode
+	{
+		PetscErrorCode ierr;
+		PetscMPIInt count = local.size(), q;
+		PetscFunctionBeginUser;
+		ierr = MPI_Gather(&count, 1, MPI_INT, rcounts.data(), 1, MPI_INT, 0,
+		                  PETSC_COMM_WORLD); CHKERRQ(ierr);
+		if (rank == 0)
+		{
+			for (q=1; q<size; q++)
+				rdispls[q] = rdispls[q-1] + rcounts[q-1];
+			all.resize(rdispls[size-1] + rcounts[size-1]);
+		}
+		ierr = MPI_Gatherv(local.data(), count, MPIU_REAL, all.data(),
+		                   rcounts.data(), rdispls.data(), MPIU_REAL, 0,
+		                   PETSC_COMM_WORLD); CHKERRQ(ierr);
+		PetscFunctionReturn(0);
+	};
+	rdispls.assign(size, 0);
+	ierr = gather(catalog, received); CHKERRQ(ierr);
+	std::vector<PetscReal> pairs;
+	ierr = gather(records, pairs); CHKERRQ(ierr);
+
+	// match the components with those of the previous time step
+	if (rank == 0)
+	{
+		std::vector<PetibmComponent> last(comps.count);
+		std::vector<PetscInt> heirs(comps.catalog.size(), -1);
+		overlaps.clear();
+		for (p=0; p<(PetscInt) pairs.size(); p+=3)
+			overlaps[{(PetscInt) pairs[p], (PetscInt) pairs[p+1]}] += pairs[p+2];
+		for (p=0; p<comps.count; p++)
+		{
+			const PetscReal *s = &received[RECORD*p];
+			PetibmComponent &c = last[p];
+			c.id = p;
+			c.size = (PetscInt) s[1];
+			c.volume = s[2];
+			for (d=0; d<3; d++)
+			{
+				c.centroid[d] = s[3+d] / s[2];
+				c.location[d] = s[7+d];
+			}
+			c.peak = s[6];
+		}
+		for (auto &o : overlaps)
+		{
+			PetibmComponent &c = last[o.first.second];
+			if (o.second > c.overlap)
+			{
+				c.parent = o.first.first;
+				c.overlap = o.second;
+			}
+		}
+		// a component continues the track of its parent if it is the largest
+		// of the components choosing that parent
+		for (auto &c : last)
+			if (c.parent >= 0 and (heirs[c.parent] < 0 or
+			                       c.overlap > last[heirs[c.parent]].overlap))
+				heirs[c.parent] = c.id;
+		for (auto &c : last)
+			c.track = (c.parent >= 0 and heirs[c.parent] == c.id) ?
+			          comps.catalog[c.parent].track : comps.tracks++;
+		comps.catalog.swap(last);
+	}
+	ierr = MPI_Bcast(&comps.tracks, 1, MPIU_INT, 0,
+	                 PETSC_COMM_WORLD); CHKERRQ(ierr);
+
+	// keep the labels to match the components of the next time step
+	if (!comps.previous)
+	{
+		ierr = VecDuplicate(comps.labels, &comps.previous); CHKERRQ(ierr);
+	}
+	ierr = VecCopy(comps.labels, comps.previous); CHKERRQ(ierr);
+	comps.steps++;
+
+	PetscFunctionReturn(0);
+} // PetibmComponentsCompute
+
+
+/*! Writes the header of an ASCII catalog file; the file is overwritten.
+ *
+ * \param filepath Path of the output file.
+ * \param ctx The options.
+ */
+PetscErrorCode PetibmComponentsWriteHeader(
+	const std::string filepath, const PetibmComponentsCtx ctx)
+{
+	PetscErrorCode ierr;
+	PetscMPIInt rank;
+
+	PetscFunctionBeginUser;
+
+	ierr = MPI_Comm_rank(PETSC_COMM_WORLD, &rank); CHKERRQ(ierr);
+	if (rank != 0)
+		PetscFunctionReturn(0);
+	std::ofstream outfile(filepath.c_str(), std::ios::trunc);
+	if (!outfile.good())
+		SETERRQ(PETSC_COMM_SELF, PETSC_ERR_FILE_OPEN,
+		        "Cannot open the catalog file of the components");
+	outfile << "# threshold: " << ctx.threshold
+	        << ", absolute: " << ((ctx.absolute) ? "yes" : "no")
+	        << ", minimum size: " << ctx.min_size << "\n";
+	outfile << "# time-step, id, track, parent, points, volume, "
+	        << "centroid (x, y, z), peak, location (x, y, z), overlap\n";
+
+	PetscFunctionReturn(0);
+} // PetibmComponentsWriteHeader
+
+
+/*! Appends the catalog of the last time step to an ASCII file.
+ *
+ * One row per component: the time-step index, the index of the component,
+ * its track, its parent, the number of points, the volume, the centroid, the
+ * peak value and its location, and the overlap with the parent.
+ *
+ * \param filepath Path of the output file.
+ * \param step The time-step index.
+ * \param comps The components.
+ */
+PetscErrorCode PetibmComponentsWrite(
+	const std::string filepath, const PetscInt step,
+	const PetibmComponents &comps)
+{
+	PetscErrorCode ierr;
+	PetscMPIInt rank;
+
+	PetscFunctionBeginUser;
+
+	ierr = MPI_Comm_rank(PETSC_COMM_WORLD, &rank); CHKERRQ(ierr);
+	if (rank != 0)
+		PetscFunctionReturn(0);
+	std::ofstream outfile(filepath.c_str(), std::ios::app);
+	if (!outfile.good())
+		SETERRQ(PETSC_COMM_SELF, PETSC_ERR_FILE_OPEN,
+		        "Cannot open the catalog file of the components");
+	outfile << std::scientific << std::setprecision(10);
+	for (auto &c : comps.catalog)
+	{
+		outfile << step << " " << c.id << " " << c.track << " " << c.parent
+		        << " " << c.size << " " << c.volume;
+		for (auto value : c.centroid)
+			outfile << " " << value;
+		outfile << " " << c.peak;
+		for (auto value : c.location)
+			outfile << " " << value;
+		outfile << " " << c.overlap << "\n";
+	}
+
+	PetscFunctionReturn(0);
+} // PetibmComponentsWrite
+
+
+/*! Destroys a PetibmComponents structure.
+ *
+ * \param comps The components (passed by reference).
+ */
+PetscErrorCode PetibmComponentsDestroy(PetibmComponents &comps)
+{
+	PetscErrorCode ierr;
+
+	PetscFunctionBeginUser;
+
+	ierr = VecDestroy(&comps.labels); CHKERRQ(ierr);
+	ierr = VecDestroy(&comps.local); CHKERRQ(ierr);
+	ierr = VecDestroy(&comps.previous); CHKERRQ(ierr);
+	comps.catalog.clear();
+
+	PetscFunctionReturn(0);
+} // PetibmComponentsDestroy
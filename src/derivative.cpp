@@ -0,0 +1,152 @@
+/*! Implementation of the functions for the PetibmDerivativeOperator structure.
+ * \file derivative.cpp
+ */
+
+#include "petibm-utilities/derivative.h"
+
+
+/*! Gets a station of a gridline, wrapped by the period or extrapolated
+ * beyond its ends.
+ *
+ * \param x The stations of the gridline.
+ * \param m Number of stations (at least 2).
+ * \param period Period of the gridline (0: not periodic).
+ * \param p Index of the station (any integer).
+ */
+static inline PetscReal PetibmDerivativeStation(
+	const PetscReal *x, const PetscInt m, const PetscReal period,
+	const PetscInt p)
+{
+	if (period > 0.0)
+	{
+		PetscInt q = (p >= 0) ? p/m : -((m-1-p)/m);
+		return x[p - q*m] + q * period;
+	}
+	if (p < 0)
+		return x[0] + p * (x[1] - x[0]);
+	if (p >= m)
+		return x[m-1] + (p - m + 1) * (x[m-1] - x[m-2]);
+	return x[p];
+} // PetibmDerivativeStation
+
+
+/*! Computes the weights of the first derivative at a point from the values
+ * at given stations (derivative of the Lagrange interpolating polynomial).
+ *
+ * \param e The point where the derivative is evaluated.
+ * \param s The stations.
+ * \param w Number of stations.
+ * \param c The weights (passed by pointer).
+ */
+static void PetibmDerivativeWeights(
+	const PetscReal e, const PetscReal *s, const PetscInt w, PetscReal *c)
+{
+	PetscInt j, m, l;
+	PetscReal term;
+
+	for (j=0; j<w; j++)
+	{
+		c[j] = 0.0;
+		for (m=0; m<w; m++)
+		{
+			if (m == j)
+				continue;
+			term = 1.0 / (s[j] - s[m]);
+			for (l=0; l<w; l++)
+				if (l != j and l != m)
+					term *= (e - s[l]) / (s[j] - s[l]);
+			c[j] += term;
+		}
+	}
+} // PetibmDerivativeWeights
+
+
+/*! Creates the first-derivative operator of a gridline.
+ *
+ * The derivative is evaluated midway between two consecutive stations.
+ * At second order, the stencil holds these two stations (inverse spacing);
+ * at fourth order, it also holds the next station on each side (weights of
+ * the derivative of the Lagrange polynomial on the stretched stations) and
+ * falls back to second order where it would leave the gridline.
+ * On a periodic gridline, the stations beyond the ends are those of the other
+ * end shifted by the period, and the fourth-order stencil is used everywhere;
+ * otherwise, they are extrapolated with the spacing at that end.
+ * The fields the operator is applied to need ghost points `width/2` deep.
+ *
+ * \param stations Sequential vector with all the stations of the gridline.
+ * \param n Number of output indices.
+ * \param order Order of accuracy (2 or 4).
+ * \param stagger Location of the output relative to the stations.
+ * \param period Period of the gridline (0: not periodic).
+ * \param op The operator to create (passed by reference).
+ */
+PetscErrorCode PetibmDerivativeOperatorCreate(
+	const Vec stations, const PetscInt n, const PetscInt order,
+	const PetibmDerivativeStaggering stagger, const PetscReal period,
+	PetibmDerivativeOperator &op)
+{
+	PetscErrorCode ierr;
+	const PetscReal *x;
+	PetscReal s[4], *c;
+	PetscInt m, i, p, l;
+
+	PetscFunctionBeginUser;
+
+	if (order != 2 and order != 4)
+		SETERRQ1(PETSC_COMM_SELF, PETSC_ERR_ARG_OUTOFRANGE,
+		         "The order of the derivative should be 2 or 4 (got %D)", order);
+	ierr = VecGetSize(stations, &m); CHKERRQ(ierr);
+	if (m < 2)
+		SETERRQ(PETSC_COMM_SELF, PETSC_ERR_ARG_SIZ,
+		        "The gridline should have at least 2 stations");
+
+	op.order = order;
+	op.width = order;
+	op.offset = (stagger == PETIBM_DERIVATIVE_BACKWARD) ? -order/2 : 1-order/2;
+	op.size = n;
+	ierr = PetscMalloc1(n*op.width, &op.coeffs); CHKERRQ(ierr);
+
+	ierr = VecGetArrayRead(stations, &x); CHKERRQ(ierr);
+	for (i=0; i<n; i++)
+	{
+		c = op.coeffs + (PetscInt64) i * op.width;
+		// first station of the stencil
+		p = i + op.offset;
+		if (op.width == 4 and (period > 0.0 or (p >= 0 and p+3 < m)))
+		{
+			for (l=0; l<4; l++)
+				s[l] = PetibmDerivativeStation(x, m, period, p+l);
+			PetibmDerivativeWeights(0.5 * (s[1] + s[2]), s, 4, c);
+		}
+		else
+		{
+			// second order: the two central stations only
+			p += op.width/2 - 1;
+			for (l=0; l<op.width; l++)
+				c[l] = 0.0;
+			c[op.width/2] = 1.0 / (PetibmDerivativeStation(x, m, period, p+1) -
+			                       PetibmDerivativeStation(x, m, period, p));
+			c[op.width/2-1] = -c[op.width/2];
+		}
+	}
+	ierr = VecRestoreArrayRead(stations, &x); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmDerivativeOperatorCreate
+
+
+/*! Destroys a PetibmDerivativeOperator structure.
+ *
+ * \param op The operator to destroy (passed by reference).
+ */
+PetscErrorCode PetibmDerivativeOperatorDestroy(PetibmDerivativeOperator &op)
+{
+	PetscErrorCode ierr;
+
+	PetscFunctionBeginUser;
+
+	ierr = PetscFree(op.coeffs); CHKERRQ(ierr);
+	op.size = 0;
+
+	PetscFunctionReturn(0);
+} // PetibmDerivativeOperatorDestroy
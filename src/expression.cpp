@@ -0,0 +1,166 @@
+/*! Implementation of the registry of quantities computed from expressions.
+ * \file expression.cpp
+ */
+
+#include <map>
+
+#include "petibm-utilities/expression.h"
+
+
+/*! Checks that the inputs required by a quantity are set.
+ *
+ * \param name Name of the quantity.
+ * \param args The inputs.
+ * \param u Components of the velocity required.
+ * \param d Derivative operators required.
+ */
+static PetscErrorCode PetibmQuantityCheckArgs(
+	const std::string name, const PetibmQuantityArgs &args,
+	const std::vector<PetscInt> &u, const std::vector<PetscInt> &d)
+{
+	PetscFunctionBeginUser;
+
+	for (PetscInt c : u)
+		if (args.u[c] == nullptr)
+			SETERRQ2(PETSC_COMM_WORLD, PETSC_ERR_ARG_NULL,
+			         "Quantity %s needs velocity component %D",
+			         name.c_str(), c);
+	for (PetscInt c : d)
+		if (args.d[c] == nullptr)
+			SETERRQ2(PETSC_COMM_WORLD, PETSC_ERR_ARG_NULL,
+			         "Quantity %s needs the derivative operator along axis %D",
+			         name.c_str(), c);
+
+	PetscFunctionReturn(0);
+} // PetibmQuantityCheckArgs
+
+
+/*! Gets the registry of quantities, filled with the default ones.
+ */
+static std::map<std::string, PetibmQuantityFunction> &PetibmQuantityRegistry()
+{
+	static std::map<std::string, PetibmQuantityFunction> registry;
+	static bool filled = false;
+
+	// default quantities, registered before any other
+	if (filled)
+		return registry;
+	filled = true;
+	registry["wx"] = [](const PetibmQuantityArgs &args, PetibmField &out)
+		-> PetscErrorCode
+	{
+		PetscErrorCode ierr;
+		PetscFunctionBeginUser;
+		ierr = PetibmQuantityCheckArgs(
+			"wx", args, {1, 2}, {1, 2}); CHKERRQ(ierr);
+		PetibmExprField v(*args.u[1]), w(*args.u[2]);
+		auto dy = PetibmExprDy(*args.d[1]);
+		auto dz = PetibmExprDz(*args.d[2]);
+		ierr = PetibmExpressionEvaluate(dy(w) - dz(v), out); CHKERRQ(ierr);
+		PetscFunctionReturn(0);
+	};
+	registry["wy"] = [](const PetibmQuantityArgs &args, PetibmField &out)
+		-> PetscErrorCode
+	{
+		PetscErrorCode ierr;
+		PetscFunctionBeginUser;
+		ierr = PetibmQuantityCheckArgs(
+			"wy", args, {0, 2}, {0, 2}); CHKERRQ(ierr);
+		PetibmExprField u(*args.u[0]), w(*args.u[2]);
+		auto dx = PetibmExprDx(*args.d[0]);
+		auto dz = PetibmExprDz(*args.d[2]);
+		ierr = PetibmExpressionEvaluate(dz(u) - dx(w), out); CHKERRQ(ierr);
+		PetscFunctionReturn(0);
+	};
+	registry["wz"] = [](const PetibmQuantityArgs &args, PetibmField &out)
+		-> PetscErrorCode
+	{
+		PetscErrorCode ierr;
+		PetscFunctionBeginUser;
+		ierr = PetibmQuantityCheckArgs(
+			"wz", args, {0, 1}, {0, 1}); CHKERRQ(ierr);
+		PetibmExprField u(*args.u[0]), v(*args.u[1]);
+		auto dx = PetibmExprDx(*args.d[0]);
+		auto dy = PetibmExprDy(*args.d[1]);
+		ierr = PetibmExpressionEvaluate(dx(v) - dy(u), out); CHKERRQ(ierr);
+		PetscFunctionReturn(0);
+	};
+	registry["divergence"] = [](const PetibmQuantityArgs &args, PetibmField &out)
+		-> PetscErrorCode
+	{
+		PetscErrorCode ierr;
+		PetscInt dim;
+		PetscFunctionBeginUser;
+		ierr = DMDAGetInfo(out.da, &dim, nullptr, nullptr, nullptr, nullptr,
+		                   nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+		                   nullptr, nullptr); CHKERRQ(ierr);
+		if (dim == 2)
+		{
+			ierr = PetibmQuantityCheckArgs(
+				"divergence", args, {0, 1}, {0, 1}); CHKERRQ(ierr);
+			PetibmExprField u(*args.u[0]), v(*args.u[1]);
+			auto dx = PetibmExprDx(*args.d[0]);
+			auto dy = PetibmExprDy(*args.d[1]);
+			ierr = PetibmExpressionEvaluate(dx(u) + dy(v), out); CHKERRQ(ierr);
+		}
+		else
+		{
+			ierr = PetibmQuantityCheckArgs(
+				"divergence", args, {0, 1, 2}, {0, 1, 2}); CHKERRQ(ierr);
+			PetibmExprField u(*args.u[0]), v(*args.u[1]), w(*args.u[2]);
+			auto dx = PetibmExprDx(*args.d[0]);
+			auto dy = PetibmExprDy(*args.d[1]);
+			auto dz = PetibmExprDz(*args.d[2]);
+			ierr = PetibmExpressionEvaluate(
+				dx(u) + dy(v) + dz(w), out); CHKERRQ(ierr);
+		}
+		PetscFunctionReturn(0);
+	};
+
+	return registry;
+} // PetibmQuantityRegistry
+
+
+/*! Registers a quantity under a name (replacing a previous one, if any).
+ *
+ * The function usually evaluates an expression on the inputs with
+ * PetibmExpressionEvaluate, so that a new quantity needs no loop of its own.
+ * The quantities `wx`, `wy`, `wz` (vorticity components) and `divergence`
+ * are registered by default (see PetibmQuantityArgs for their operators).
+ *
+ * \param name Name of the quantity.
+ * \param function The function computing it.
+ */
+PetscErrorCode PetibmQuantityRegister(
+	const std::string name, const PetibmQuantityFunction function)
+{
+	PetscFunctionBeginUser;
+
+	PetibmQuantityRegistry()[name] = function;
+
+	PetscFunctionReturn(0);
+} // PetibmQuantityRegister
+
+
+/*! Computes a registered quantity.
+ *
+ * \param name Name of the quantity.
+ * \param args The inputs.
+ * \param out The field to compute (passed by reference).
+ */
+PetscErrorCode PetibmQuantityCompute(
+	const std::string name, const PetibmQuantityArgs &args, PetibmField &out)
+{
+	PetscErrorCode ierr;
+	std::map<std::string, PetibmQuantityFunction> &registry =
+		PetibmQuantityRegistry();
+
+	PetscFunctionBeginUser;
+
+	if (registry.find(name) == registry.end())
+		SETERRQ1(PETSC_COMM_WORLD, PETSC_ERR_ARG_UNKNOWN_TYPE,
+		         "Unknown quantity %s", name.c_str());
+	ierr = registry[name](args, out); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmQuantityCompute
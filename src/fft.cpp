@@ -0,0 +1,179 @@
+/*! Implementation of the functions for the PetibmFFT structure.
+ * \file fft.cpp
+ */
+
+#include <algorithm>
+
+#include "petibm-utilities/fft.h"
+
+
+typedef std::complex<PetscReal> PetibmComplex;
+
+
+/*! Initializes the plan of the transform of real sequences of a given length.
+ *
+ * \param n Length of the real sequences.
+ * \param fft The plan to initialize (passed by reference).
+ */
+PetscErrorCode PetibmFFTInitialize(const PetscInt n, PetibmFFT &fft)
+{
+	PetscInt r, p, k, maxradix = 1;
+
+	PetscFunctionBeginUser;
+
+	if (n < 1)
+		SETERRQ1(PETSC_COMM_SELF, PETSC_ERR_ARG_OUTOFRANGE,
+		         "Invalid length of the transform (%D)", n);
+	fft.n = n;
+	fft.m = (n % 2 == 0) ? n / 2 : n;
+	// prime factors, smallest first
+	fft.factors.clear();
+	for (r=fft.m, p=2; r > 1; )
+	{
+		if (r % p == 0)
+		{
+			fft.factors.push_back(p);
+			maxradix = std::max(maxradix, p);
+			r /= p;
+		}
+		else
+			p = (p*p > r) ? r : p+1;
+	}
+	fft.twiddles.resize(fft.m);
+	for (k=0; k<fft.m; k++)
+		fft.twiddles[k] = std::polar<PetscReal>(1.0, -2.0*PETSC_PI*k/fft.m);
+	fft.rotations.resize(n/2+1);
+	for (k=0; k<=n/2; k++)
+		fft.rotations[k] = std::polar<PetscReal>(1.0, -2.0*PETSC_PI*k/n);
+	// packed input, complex coefficients, and scratch of the butterflies
+	fft.worksize = 2*fft.m + maxradix;
+
+	PetscFunctionReturn(0);
+} // PetibmFFTInitialize
+
+
+/*! Combines p transforms of length m into one of length p*m.
+ *
+ * \param fft The plan.
+ * \param out The p transforms, one after the other (overwritten).
+ * \param fstride Stride in the roots of unity.
+ * \param p The radix.
+ * \param m Length of the transforms to combine.
+ * \param scratch Work array (p values).
+ */
+static void PetibmFFTButterfly(
+	const PetibmFFT &fft, PetibmComplex *out, const PetscInt fstride,
+	const PetscInt p, const PetscInt m, PetibmComplex *scratch)
+{
+	const PetibmComplex *tw = fft.twiddles.data();
+	PetscInt u, q, q1, k, t;
+
+	if (p == 2)
+	{
+		for (u=0; u<m; u++)
+		{
+			const PetibmComplex v = out[u+m] * tw[u*fstride];
+			out[u+m] = out[u] - v;
+			out[u] += v;
+		}
+		return;
+	}
+	for (u=0; u<m; u++)
+	{
+		for (q1=0, k=u; q1<p; q1++, k+=m)
+			scratch[q1] = out[k];
+		for (q1=0, k=u; q1<p; q1++, k+=m)
+		{
+			out[k] = scratch[0];
+			for (q=1, t=0; q<p; q++)
+			{
+				t += fstride*k;
+				if (t >= fft.m)
+					t -= fft.m;
+				out[k] += scratch[q] * tw[t];
+			}
+		}
+	}
+} // PetibmFFTButterfly
+
+
+/*! Computes recursively the complex transform of a strided sequence.
+ *
+ * \param fft The plan.
+ * \param out The transform (contiguous).
+ * \param in The sequence.
+ * \param fstride Stride in the sequence.
+ * \param factor Index of the radix of this stage.
+ * \param scratch Work array of the butterflies.
+ */
+static void PetibmFFTWork(
+	const PetibmFFT &fft, PetibmComplex *out, const PetibmComplex *in,
+	const PetscInt fstride, const PetscInt factor, PetibmComplex *scratch)
+{
+	const PetscInt p = fft.factors[factor],
+	               m = fft.m / (fstride * p);
+	PetscInt q;
+
+	if (m == 1)
+	{
+		for (q=0; q<p; q++)
+			out[q] = in[q*fstride];
+	}
+	else
+	{
+		for (q=0; q<p; q++)
+			PetibmFFTWork(fft, out+q*m, in+q*fstride, fstride*p, factor+1, scratch);
+	}
+	PetibmFFTButterfly(fft, out, fstride, p, m, scratch);
+} // PetibmFFTWork
+
+
+/*! Transforms a real sequence.
+ *
+ * The n/2+1 non-redundant coefficients X[k] = sum_j x[j] exp(-2 i pi j k / n)
+ * are computed. Thread-safe (no PETSc or MPI call): each thread passes its own
+ * work array.
+ *
+ * \param fft The plan.
+ * \param in The real sequence (n values).
+ * \param out The coefficients (n/2+1 values).
+ * \param work Work array (fft.worksize values).
+ */
+void PetibmFFTExecute(
+	const PetibmFFT &fft, const PetscReal *in,
+	PetibmComplex *out, PetibmComplex *work)
+{
+	PetibmComplex *z = work, *Z = work + fft.m, *scratch = work + 2*fft.m;
+	PetscInt j, k;
+
+	if (fft.n == 1)
+	{
+		out[0] = in[0];
+		return;
+	}
+	if (fft.m == fft.n)
+	{
+		for (j=0; j<fft.n; j++)
+			z[j] = in[j];
+		PetibmFFTWork(fft, Z, z, 1, 0, scratch);
+		for (k=0; k<=fft.n/2; k++)
+			out[k] = Z[k];
+		return;
+	}
+	// even length: transform of the packed sequence, then unpacking
+	for (j=0; j<fft.m; j++)
+		z[j] = PetibmComplex(in[2*j], in[2*j+1]);
+	if (fft.m == 1)
+		Z[0] = z[0];
+	else
+		PetibmFFTWork(fft, Z, z, 1, 0, scratch);
+	for (k=0; k<=fft.m; k++)
+	{
+		const PetibmComplex a = Z[k % fft.m],
+		                    b = std::conj(Z[(fft.m - k) % fft.m]);
+		// even part and odd part of the real sequence
+		const PetibmComplex even = 0.5 * (a + b),
+		                    odd = PetibmComplex(0.0, -0.5) * (a - b);
+		out[k] = even + fft.rotations[k] * odd;
+	}
+} // PetibmFFTExecute
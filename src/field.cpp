@@ -8,8 +8,10 @@
 
 #include <petscviewerhdf5.h>
 
+#include "petibm-utilities/array.h"
 #include "petibm-utilities/field.h"
 #include "petibm-utilities/misc.h"
+#include "petibm-utilities/threads.h"
 
 
 /*! Gets options from command-line or config file.
@@ -31,8 +33,7 @@ PetscErrorCode PetibmFieldGetOptions(
 	                             path, sizeof(path), &found); CHKERRQ(ierr);
 	if (found)
 	{
-		ierr = PetscOptionsInsertFile(
-			PETSC_COMM_WORLD, nullptr, path, PETSC_FALSE); CHKERRQ(ierr);
+		ierr = PetibmOptionsInsertFile(path); CHKERRQ(ierr);
 	}
 	// get path of file containing field values
 	ierr = PetscOptionsGetString(nullptr, prefix, "-path", ctx->path,
@@ -76,18 +77,16 @@ PetscErrorCode PetibmFieldCtxPrintf(
 } // PetibmFieldCtxPrintf
 
 
-/*! Initializes a PetibmField structure based on the grid.
+/*! Creates the DMDA object of a field based on the grid.
  *
- * Creates the DMDA object and local and global vectors associated with it.
- * Creates the vectors based on the DMDA object.
  * The decomposition of the field follows the decomposition of the provided grid.
  *
  * \param ctx The context.
  * \param grid The grid used a reference for domain decomposition of the field.
- * \param field The field to initialize (passed by reference).
+ * \param da The DMDA object to create (passed by pointer).
  */
-PetscErrorCode PetibmFieldInitialize(
-	const PetibmFieldCtx ctx, const PetibmGrid grid, PetibmField &field)
+static PetscErrorCode PetibmFieldCreateDMDA(
+	const PetibmFieldCtx ctx, const PetibmGrid grid, DM *da)
 {
   PetscErrorCode ierr;
   PetscInt M, N, P, m, n, p;
@@ -140,7 +139,7 @@ PetscErrorCode PetibmFieldInitialize(
 		                    m, n, p,
 		                    1, 1,
 		                    lx, ly, lz,
-		                    &field.da); CHKERRQ(ierr);
+		                    da); CHKERRQ(ierr);
 	}
 	else
 	{
@@ -152,15 +151,36 @@ PetscErrorCode PetibmFieldInitialize(
 		                    m, n,
 		                    1, 1,
 		                    lx, ly,
-		                    &field.da); CHKERRQ(ierr);
+		                    da); CHKERRQ(ierr);
 	}
-	ierr = DMSetFromOptions(field.da); CHKERRQ(ierr);
-	ierr = DMSetUp(field.da); CHKERRQ(ierr);
-
-  ierr = DMCreateGlobalVector(field.da, &field.global); CHKERRQ(ierr);
-  ierr = DMCreateLocalVector(field.da, &field.local); CHKERRQ(ierr);
+	ierr = DMSetFromOptions(*da); CHKERRQ(ierr);
+	ierr = DMSetUp(*da); CHKERRQ(ierr);
 
   PetscFunctionReturn(0);
+} // PetibmFieldCreateDMDA
+
+
+/*! Initializes a PetibmField structure based on the grid.
+ *
+ * Creates the DMDA object and local and global vectors associated with it.
+ * Creates the vectors based on the DMDA object.
+ * The decomposition of the field follows the decomposition of the provided grid.
+ *
+ * \param ctx The context.
+ * \param grid The grid used a reference for domain decomposition of the field.
+ * \param field The field to initialize (passed by reference).
+ */
+PetscErrorCode PetibmFieldInitialize(
+	const PetibmFieldCtx ctx, const PetibmGrid grid, PetibmField &field)
+{
+	PetscErrorCode ierr;
+
+	PetscFunctionBeginUser;
+
+	ierr = PetibmFieldCreateDMDA(ctx, grid, &field.da); CHKERRQ(ierr);
+	ierr = PetibmFieldInitialize(field.da, field); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
 } // PetibmFieldInitialize
 
 
@@ -179,13 +199,121 @@ PetscErrorCode PetibmFieldInitialize(const DM da, PetibmField &field)
 
 	field.da = da;
 	ierr = DMCreateGlobalVector(da, &field.global); CHKERRQ(ierr);
-	ierr = DMCreateLocalVector(da, &field.local); CHKERRQ(ierr);	
+	ierr = PetibmThreadsFirstTouch(field.global); CHKERRQ(ierr);
+	ierr = DMCreateLocalVector(da, &field.local); CHKERRQ(ierr);
+	ierr = PetibmThreadsFirstTouch(field.local); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmFieldInitialize
+
+
+/*! Initializes a PetibmField structure based on the grid, through a pool.
+ *
+ * The DMDA object is shared with the fields of the pool that have the same
+ * layout. Only the global vector is created; the local vector is borrowed
+ * from the pool with PetibmFieldGetLocal.
+ *
+ * \param ctx The context.
+ * \param grid The grid used a reference for domain decomposition of the field.
+ * \param pool The pool (passed by reference).
+ * \param field The field to initialize (passed by reference).
+ */
+PetscErrorCode PetibmFieldInitialize(
+	const PetibmFieldCtx ctx, const PetibmGrid grid,
+	PetibmFieldPool &pool, PetibmField &field)
+{
+	PetscErrorCode ierr;
+
+	PetscFunctionBeginUser;
+
+	ierr = PetibmFieldCreateDMDA(ctx, grid, &field.da); CHKERRQ(ierr);
+	ierr = PetibmFieldInitialize(pool, field); CHKERRQ(ierr);
 
 	PetscFunctionReturn(0);
 } // PetibmFieldInitialize
 
 
+/*! Initializes a PetibmField structure with a DMDA object already set, through
+ * a pool.
+ *
+ * If the pool holds a DMDA object with the same layout, the DMDA of the field
+ * is destroyed and replaced by the pooled one.
+ * Only the global vector is created; the local vector is borrowed from the
+ * pool with PetibmFieldGetLocal.
+ *
+ * \param pool The pool (passed by reference).
+ * \param field The field to initialize (passed by reference).
+ */
+PetscErrorCode PetibmFieldInitialize(PetibmFieldPool &pool, PetibmField &field)
+{
+	PetscErrorCode ierr;
+	PetscInt n;
+
+	PetscFunctionBeginUser;
+
+	ierr = PetibmFieldPoolGetDM(pool, &field.da); CHKERRQ(ierr);
+	ierr = DMCreateGlobalVector(field.da, &field.global); CHKERRQ(ierr);
+	ierr = PetibmThreadsFirstTouch(field.global); CHKERRQ(ierr);
+	ierr = VecGetLocalSize(field.global, &n); CHKERRQ(ierr);
+	ierr = PetibmFieldPoolLogBytes(
+		pool, (PetscInt64) n * sizeof(PetscScalar)); CHKERRQ(ierr);
+	field.local = nullptr;
+	field.pool = &pool;
+
+	PetscFunctionReturn(0);
+} // PetibmFieldInitialize
+
+
+/*! Sets the value at the external boundary ghost points of a local array.
+ *
+ * For each non-periodic direction, the ghost planes outside the domain (as
+ * many as the stencil width) are filled across the whole ghosted extent of
+ * the other directions.
+ *
+ * \param info Local information of the DMDA.
+ * \param value The value on the external boundaries.
+ * \param arr The values of the ghosted local vector (passed by reference).
+ */
+template <PetscInt dim, typename T>
+static void PetibmFieldSetBoundaryPointsKernel(
+	const DMDALocalInfo &info, const T value, PetibmArray<dim, T> &arr)
+{
+	const DMBoundaryType types[3] = {info.bx, info.by, info.bz};
+	const PetscInt starts[3] = {info.xs, info.ys, info.zs},
+	               ends[3] = {info.xs+info.xm, info.ys+info.ym, info.zs+info.zm},
+	               gstarts[3] = {info.gxs, info.gys, info.gzs},
+	               gends[3] = {info.gxs+info.gxm, info.gys+info.gym,
+	                           info.gzs+info.gzm},
+	               sizes[3] = {info.mx, info.my, info.mz};
+	PetscInt lo[3], hi[3], d, side, i, j, k;
+
+	for (d=0; d<dim; d++)
+	{
+		if (types[d] == DM_BOUNDARY_PERIODIC)
+			continue;
+		for (side=0; side<2; side++)
+		{
+			if ((side == 0) ? (starts[d] != 0) : (ends[d] != sizes[d]))
+				continue;
+			lo[0] = info.gxs; hi[0] = info.gxs+info.gxm;
+			lo[1] = info.gys; hi[1] = info.gys+info.gym;
+			lo[2] = info.gzs; hi[2] = info.gzs+info.gzm;
+			// every layer of ghost points beyond the boundary
+			lo[d] = (side == 0) ? gstarts[d] : sizes[d];
+			hi[d] = (side == 0) ? 0 : gends[d];
+			for (k=lo[2]; k<hi[2]; k++)
+				for (j=lo[1]; j<hi[1]; j++)
+					for (i=lo[0]; i<hi[0]; i++)
+						arr(k, j, i) = value;
+		}
+	}
+} // PetibmFieldSetBoundaryPointsKernel
+
+
 /*! Sets the value at external boundary points.
+ *
+ * The value is kept with the field and applied every time the local vector is
+ * obtained with PetibmFieldGetLocal.
  *
  * \param value The value on the external boundaries.
  * \param field The field to modify (passed by reference).
@@ -195,73 +323,28 @@ PetscErrorCode PetibmFieldSetBoundaryPoints(
 {
 	PetscErrorCode ierr;
 	DMDALocalInfo info;
-	PetscInt i, j, k;
 
 	PetscFunctionBeginUser;
 
+	field.bc_value = value;
+	// the value will be applied once a local vector is borrowed
+	if (field.local == nullptr)
+		PetscFunctionReturn(0);
+
 	ierr = DMDAGetLocalInfo(field.da, &info); CHKERRQ(ierr);
 	if (info.dim == 2)
 	{
-		PetscReal **arr;
-		ierr = DMDAVecGetArray(field.da, field.local, &arr); CHKERRQ(ierr);
-		if (info.bx != DM_BOUNDARY_PERIODIC)
-		{
-			if (info.xs == 0)
-				for (j=info.gys; j<info.gys+info.gym; j++)
-					arr[j][-1] = value;
-			if (info.xs+info.xm == info.mx)
-				for (j=info.gys; j<info.gys+info.gym; j++)
-					arr[j][info.mx] = value;
-		}
-		if (info.by != DM_BOUNDARY_PERIODIC)
-		{
-			if (info.ys == 0)
-				for (i=info.gxs; i<info.gxs+info.gxm; i++)
-					arr[-1][i] = value;
-			if (info.ys+info.ym == info.my)
-				for (i=info.gxs; i<info.gxs+info.gxm; i++)
-					arr[info.my][i] = value;
-		}
-		ierr = DMDAVecRestoreArray(field.da, field.local, &arr); CHKERRQ(ierr);
+		PetibmArray<2, PetscReal> arr;
+		ierr = PetibmArrayGet(field.da, field.local, arr); CHKERRQ(ierr);
+		PetibmFieldSetBoundaryPointsKernel(info, value, arr);
+		ierr = PetibmArrayRestore(field.da, field.local, arr); CHKERRQ(ierr);
 	}
 	else if (info.dim == 3)
 	{
-		PetscReal ***arr;
-		ierr = DMDAVecGetArray(field.da, field.local, &arr); CHKERRQ(ierr);
-		if (info.bx != DM_BOUNDARY_PERIODIC)
-		{
-			if (info.xs == 0)
-				for (k=info.gzs; k<info.gzs+info.gzm; k++)
-					for (j=info.gys; j<info.gys+info.gym; j++)
-						arr[k][j][-1] = value;
-			if (info.xs+info.xm == info.mx)
-				for (k=info.gzs; k<info.gzs+info.gzm; k++)
-					for (j=info.gys; j<info.gys+info.gym; j++)
-						arr[k][j][info.mx] = value;
-		}
-		if (info.by != DM_BOUNDARY_PERIODIC)
-		{
-			if (info.ys == 0)
-				for (k=info.gzs; k<info.gzs+info.gzm; k++)
-					for (i=info.gxs; i<info.gxs+info.gxm; i++)
-						arr[k][-1][i] = value;
-			if (info.ys+info.ym == info.my)
-				for (k=info.gzs; k<info.gzs+info.gzm; k++)
-					for (i=info.gxs; i<info.gxs+info.gxm; i++)
-						arr[k][info.my][i] = value;
-		}
-		if (info.bz != DM_BOUNDARY_PERIODIC)
-		{
-			if (info.zs == 0)
-				for (j=info.gys; j<info.gys+info.gym; j++)
-					for (i=info.gxs; i<info.gxs+info.gxm; i++)
-						arr[-1][j][i] = value;
-			if (info.zs+info.zm == info.mz)
-				for (j=info.gys; j<info.gys+info.gym; j++)
-					for (i=info.gxs; i<info.gxs+info.gxm; i++)
-						arr[info.mz][j][i] = value;
-		}
-		ierr = DMDAVecRestoreArray(field.da, field.local, &arr); CHKERRQ(ierr);
+		PetibmArray<3, PetscReal> arr;
+		ierr = PetibmArrayGet(field.da, field.local, arr); CHKERRQ(ierr);
+		PetibmFieldSetBoundaryPointsKernel(info, value, arr);
+		ierr = PetibmArrayRestore(field.da, field.local, arr); CHKERRQ(ierr);
 	}
 	else
 		SETERRQ(PETSC_COMM_WORLD, PETSC_ERR_SUP,
@@ -290,6 +373,128 @@ PetscErrorCode PetibmFieldGlobalToLocal(PetibmField &field)
 } // PetibmFieldGlobalToLocal
 
 
+/*! Gets the local vector of a field, filled with the global values and the
+ * value at external boundary points.
+ *
+ * If the field belongs to a pool, the local vector is borrowed from the pool
+ * and should be returned with PetibmFieldRestoreLocal.
+ *
+ * \param field The field to work on (passed by reference).
+ */
+PetscErrorCode PetibmFieldGetLocal(PetibmField &field)
+{
+	PetscErrorCode ierr;
+	DMDALocalInfo info;
+
+	PetscFunctionBeginUser;
+
+	if (field.pool != nullptr)
+	{
+		if (field.local != nullptr)
+			SETERRQ(PETSC_COMM_SELF, PETSC_ERR_ARG_WRONGSTATE,
+			        "Local vector of the field already borrowed");
+		ierr = DMDAGetLocalInfo(field.da, &info); CHKERRQ(ierr);
+		ierr = PetibmFieldPoolGetWorkVec(
+			*field.pool, info.gxm*info.gym*info.gzm*info.dof,
+			&field.local); CHKERRQ(ierr);
+	}
+	ierr = PetibmFieldGlobalToLocal(field); CHKERRQ(ierr);
+	ierr = PetibmFieldSetBoundaryPoints(field.bc_value, field); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmFieldGetLocal
+
+
+/*! Restores the local vector of a field obtained with PetibmFieldGetLocal.
+ *
+ * \param field The field to work on (passed by reference).
+ */
+PetscErrorCode PetibmFieldRestoreLocal(PetibmField &field)
+{
+	PetscErrorCode ierr;
+
+	PetscFunctionBeginUser;
+
+	if (field.pool != nullptr)
+	{
+		ierr = PetibmFieldPoolRestoreWorkVec(
+			*field.pool, &field.local); CHKERRQ(ierr);
+	}
+
+	PetscFunctionReturn(0);
+} // PetibmFieldRestoreLocal
+
+
+/*! Gets the local vectors of several fields in a single ghost exchange.
+ *
+ * The scatters of all the fields are started before any of them is
+ * completed, so that the messages to the neighbors travel together; the
+ * local vectors are then handled as with PetibmFieldGetLocal.
+ *
+ * \param n Number of fields.
+ * \param fields The fields to work on.
+ */
+PetscErrorCode PetibmFieldGetLocal(const PetscInt n, PetibmField *fields[])
+{
+	PetscErrorCode ierr;
+	DMDALocalInfo info;
+	PetscInt f;
+
+	PetscFunctionBeginUser;
+
+	for (f=0; f<n; f++)
+	{
+		PetibmField &field = *fields[f];
+		if (field.pool != nullptr)
+		{
+			if (field.local != nullptr)
+				SETERRQ(PETSC_COMM_SELF, PETSC_ERR_ARG_WRONGSTATE,
+				        "Local vector of the field already borrowed");
+			ierr = DMDAGetLocalInfo(field.da, &info); CHKERRQ(ierr);
+			ierr = PetibmFieldPoolGetWorkVec(
+				*field.pool, info.gxm*info.gym*info.gzm*info.dof,
+				&field.local); CHKERRQ(ierr);
+		}
+	}
+	for (f=0; f<n; f++)
+	{
+		ierr = DMGlobalToLocalBegin(fields[f]->da, fields[f]->global,
+		                            INSERT_VALUES, fields[f]->local); CHKERRQ(ierr);
+	}
+	for (f=0; f<n; f++)
+	{
+		ierr = DMGlobalToLocalEnd(fields[f]->da, fields[f]->global,
+		                          INSERT_VALUES, fields[f]->local); CHKERRQ(ierr);
+		ierr = PetibmFieldSetBoundaryPoints(
+			fields[f]->bc_value, *fields[f]); CHKERRQ(ierr);
+	}
+
+	PetscFunctionReturn(0);
+} // PetibmFieldGetLocal
+
+
+/*! Restores the local vectors of several fields obtained with
+ * PetibmFieldGetLocal.
+ *
+ * \param n Number of fields.
+ * \param fields The fields to work on.
+ */
+PetscErrorCode PetibmFieldRestoreLocal(const PetscInt n, PetibmField *fields[])
+{
+	PetscErrorCode ierr;
+	PetscInt f;
+
+	PetscFunctionBeginUser;
+
+	for (f=0; f<n; f++)
+	{
+		ierr = PetibmFieldRestoreLocal(*fields[f]); CHKERRQ(ierr);
+	}
+
+	PetscFunctionReturn(0);
+} // PetibmFieldRestoreLocal
+
+
 /*! Destroys the PETSc objects of a PetibmField structure.
  *
  * \param field The PetibmField structure (passed by reference).
@@ -297,9 +502,20 @@ PetscErrorCode PetibmFieldGlobalToLocal(PetibmField &field)
 PetscErrorCode PetibmFieldDestroy(PetibmField &field)
 {
 	PetscErrorCode ierr;
+	PetscInt n;
 
 	PetscFunctionBeginUser;
 
+	if (field.pool != nullptr)
+	{
+		ierr = VecGetLocalSize(field.global, &n); CHKERRQ(ierr);
+		ierr = PetibmFieldPoolLogBytes(
+			*field.pool, -(PetscInt64) n * sizeof(PetscScalar)); CHKERRQ(ierr);
+		if (field.local != nullptr)
+		{
+			ierr = PetibmFieldRestoreLocal(field); CHKERRQ(ierr);
+		}
+	}
 	ierr = VecDestroy(&field.global); CHKERRQ(ierr);
 	ierr = VecDestroy(&field.local); CHKERRQ(ierr);
 	ierr = DMDestroy(&field.da); CHKERRQ(ierr);
@@ -365,6 +581,35 @@ PetscErrorCode PetibmFieldHDF5Read(
 } // PetibmFieldHDF5Read
 
 
+/*! Opens a binary viewer configured from the options database.
+ *
+ * `-viewer_binary_mpiio` switches to collective MPI-IO (each process reads or
+ * writes its part at its offset) instead of funneling the values through
+ * rank 0, and `-viewer_binary_skip_info` skips the `.info` file.
+ *
+ * \param comm MPI communicator of the field.
+ * \param filepath Path of the file.
+ * \param mode File mode.
+ * \param viewer The viewer (passed by pointer).
+ */
+static PetscErrorCode PetibmFieldBinaryViewerOpen(
+	const MPI_Comm comm, const std::string filepath, const PetscFileMode mode,
+	PetscViewer *viewer)
+{
+	PetscErrorCode ierr;
+
+	PetscFunctionBeginUser;
+
+	ierr = PetscViewerCreate(comm, viewer); CHKERRQ(ierr);
+	ierr = PetscViewerSetType(*viewer, PETSCVIEWERBINARY); CHKERRQ(ierr);
+	ierr = PetscViewerFileSetMode(*viewer, mode); CHKERRQ(ierr);
+	ierr = PetscViewerSetFromOptions(*viewer); CHKERRQ(ierr);
+	ierr = PetscViewerFileSetName(*viewer, filepath.c_str()); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmFieldBinaryViewerOpen
+
+
 /*! Reads the field values stored in binary format from file.
  *
  * \param filepath Path of the input file.
@@ -375,16 +620,16 @@ PetscErrorCode PetibmFieldBinaryRead(
 	const std::string filepath, const std::string name, PetibmField &field)
 {
 	PetscErrorCode ierr;
+	MPI_Comm comm;
 	PetscViewer viewer;
 
 	PetscFunctionBeginUser;
 
 	ierr = PetscObjectSetName(
 		(PetscObject) field.global, name.c_str()); CHKERRQ(ierr);
-	ierr = PetscViewerCreate(PETSC_COMM_WORLD, &viewer); CHKERRQ(ierr); 
-	ierr = PetscViewerSetType(viewer, PETSCVIEWERBINARY); CHKERRQ(ierr);
-	ierr = PetscViewerFileSetMode(viewer, FILE_MODE_READ); CHKERRQ(ierr);
-	ierr = PetscViewerFileSetName(viewer, filepath.c_str()); CHKERRQ(ierr);
+	ierr = PetscObjectGetComm((PetscObject) field.global, &comm); CHKERRQ(ierr);
+	ierr = PetibmFieldBinaryViewerOpen(
+		comm, filepath, FILE_MODE_READ, &viewer); CHKERRQ(ierr);
 	ierr = VecLoad(field.global, viewer); CHKERRQ(ierr);
 	ierr = PetscViewerDestroy(&viewer); CHKERRQ(ierr);
 
@@ -434,16 +679,16 @@ PetscErrorCode PetibmFieldBinaryWrite(
 	const std::string filepath, const std::string name, const PetibmField field)
 {
 	PetscErrorCode ierr;
+	MPI_Comm comm;
 	PetscViewer viewer;
 
 	PetscFunctionBeginUser;
 
 	ierr = PetscObjectSetName(
 		(PetscObject) field.global, name.c_str()); CHKERRQ(ierr);
-	ierr = PetscViewerCreate(PETSC_COMM_WORLD, &viewer); CHKERRQ(ierr); 
-	ierr = PetscViewerSetType(viewer, PETSCVIEWERBINARY); CHKERRQ(ierr);
-	ierr = PetscViewerFileSetMode(viewer, FILE_MODE_WRITE); CHKERRQ(ierr);
-	ierr = PetscViewerFileSetName(viewer, filepath.c_str()); CHKERRQ(ierr);
+	ierr = PetscObjectGetComm((PetscObject) field.global, &comm); CHKERRQ(ierr);
+	ierr = PetibmFieldBinaryViewerOpen(
+		comm, filepath, FILE_MODE_WRITE, &viewer); CHKERRQ(ierr);
 	ierr = VecView(field.global, viewer); CHKERRQ(ierr);
 	ierr = PetscViewerDestroy(&viewer); CHKERRQ(ierr);
 
@@ -451,172 +696,378 @@ PetscErrorCode PetibmFieldBinaryWrite(
 } // PetibmFieldBinaryWrite
 
 
-/*! Interpolates field A associated with grid A onto grid B.
+/*! Gets the decomposition header of a field in native layout.
  *
- * \param gridA The grid to interpolate from.
- * \param fieldA The field to interpolate.
- * \param gridB The grid to interpolate on.
- * \param fieldB The resulting interpolated field (passed by reference).
+ * Identifier, dimension, number of points in each direction, number of
+ * components per point, number of processes in each direction, then the
+ * ownership ranges along x, y, and z (the padding that follows in the file is
+ * not part of it).
+ *
+ * \param da The DMDA object of the field.
+ * \param header The header (passed by reference).
  */
-PetscErrorCode PetibmFieldInterpolate(
-	PetibmGrid gridA, PetibmField fieldA, PetibmGrid gridB, PetibmField &fieldB)
+static PetscErrorCode PetibmFieldNativeGetHeader(
+	const DM da, std::vector<PetscInt> &header)
 {
 	PetscErrorCode ierr;
+	PetscInt dim, M, N, P, dof, m, n, p;
+	const PetscInt *lx, *ly, *lz;
 
 	PetscFunctionBeginUser;
 
-	if (gridA.dim == 2)
+	ierr = DMDAGetInfo(da, &dim, &M, &N, &P, &m, &n, &p, &dof,
+	                   nullptr, nullptr, nullptr, nullptr,
+	                   nullptr); CHKERRQ(ierr);
+	ierr = DMDAGetOwnershipRanges(da, &lx, &ly, &lz); CHKERRQ(ierr);
+	header = {PetibmFieldNativeClassId, dim, M, N, P, dof, m, n, p};
+	header.insert(header.end(), lx, lx + m);
+	header.insert(header.end(), ly, ly + n);
+	if (dim == 3)
+		header.insert(header.end(), lz, lz + p);
+	else
+		header.push_back(1);
+
+	PetscFunctionReturn(0);
+} // PetibmFieldNativeGetHeader
+
+
+/*! Gets the natural indices of a range of values stored in native layout.
+ *
+ * The components of a point are contiguous, both in the blocks and in the
+ * natural ordering.
+ *
+ * \param header The header of the file.
+ * \param rstart Index of the first value.
+ * \param rend Index after the last value.
+ * \param indices The natural indices (passed by reference).
+ */
+static void PetibmFieldNativeGetNaturalIndices(
+	const std::vector<PetscInt> &header, const PetscInt rstart,
+	const PetscInt rend, std::vector<PetscInt> &indices)
+{
+	const PetscInt M = header[2], N = header[3], dof = header[5],
+	               m = header[6], n = header[7], p = header[8];
+	const PetscInt *lx = &header[9], *ly = lx + m, *lz = ly + n;
+	PetscInt pi, pj, pk, xs, ys, zs, start = 0, size, g, local;
+
+	indices.clear();
+	indices.reserve(rend - rstart);
+	// blocks are stored in rank order, x-direction running fastest
+	for (pk=0, zs=0; pk<p; zs+=lz[pk], pk++)
+		for (pj=0, ys=0; pj<n; ys+=ly[pj], pj++)
+			for (pi=0, xs=0; pi<m; xs+=lx[pi], pi++)
+			{
+				size = lx[pi] * ly[pj] * lz[pk] * dof;
+				for (g=PetscMax(start, rstart); g<PetscMin(start+size, rend); g++)
+				{
+					local = (g - start) / dof;
+					indices.push_back(
+						dof * ((xs + local % lx[pi]) +
+						       M * ((ys + (local / lx[pi]) % ly[pj]) +
+						            N * (zs + local / (lx[pi] * ly[pj])))) +
+						(g - start) % dof);
+				}
+				start += size;
+			}
+} // PetibmFieldNativeGetNaturalIndices
+
+
+/*! Reads the field values stored in native (decomposition) layout from file.
+ *
+ * When the decomposition of the field matches the header of the file, each
+ * process loads its block directly; otherwise, the blocks are loaded as
+ * stored and scattered to the decomposition of the field.
+ *
+ * \param filepath Path of the input file.
+ * \param name The name of the field.
+ * \param field The PetibmField structure (passed by reference).
+ */
+PetscErrorCode PetibmFieldNativeRead(
+	const std::string filepath, const std::string name, PetibmField &field)
+{
+	PetscErrorCode ierr;
+	MPI_Comm comm;
+	PetscViewer viewer;
+	std::vector<PetscInt> header, stored(9), indices;
+	Vec block;
+	PetscReal *arr;
+	PetscInt nlocal, rstart, rend, d, npad;
+	AO ao;
+	IS isfrom, isto;
+	VecScatter scatter;
+
+	PetscFunctionBeginUser;
+
+	ierr = PetibmFieldNativeGetHeader(field.da, header); CHKERRQ(ierr);
+	ierr = PetscObjectGetComm((PetscObject) field.global, &comm); CHKERRQ(ierr);
+	ierr = PetibmFieldBinaryViewerOpen(
+		comm, filepath, FILE_MODE_READ, &viewer); CHKERRQ(ierr);
+	ierr = PetscViewerBinaryRead(
+		viewer, stored.data(), 9, nullptr, PETSC_INT); CHKERRQ(ierr);
+	if (stored[0] != PetibmFieldNativeClassId)
 	{
-		ierr = PetibmFieldInterpolate2D(
-			gridA, fieldA, gridB, fieldB); CHKERRQ(ierr);
+		ierr = PetscViewerDestroy(&viewer); CHKERRQ(ierr);
+		SETERRQ(comm, PETSC_ERR_FILE_UNEXPECTED,
+		        "The file is not in native layout");
 	}
-	else if (gridA.dim == 3)
+	// dimension, number of points, and number of components
+	for (d=1; d<6; d++)
 	{
-		ierr = PetibmFieldInterpolate3D(
-			gridA, fieldA, gridB, fieldB); CHKERRQ(ierr);
+		if (stored[d] != header[d])
+		{
+			ierr = PetscViewerDestroy(&viewer); CHKERRQ(ierr);
+			SETERRQ(comm, PETSC_ERR_FILE_UNEXPECTED,
+			        "The field in the file does not match the grid");
+		}
+	}
+	stored.resize(9 + stored[6] + stored[7] + stored[8]);
+	ierr = PetscViewerBinaryRead(viewer, &stored[9], stored.size() - 9,
+	                             nullptr, PETSC_INT); CHKERRQ(ierr);
+	ierr = PetscViewerBinaryRead(
+		viewer, &npad, 1, nullptr, PETSC_INT); CHKERRQ(ierr);
+	if (npad > 0)
+	{
+		std::vector<PetscInt> pad(npad);
+		ierr = PetscViewerBinaryRead(
+			viewer, pad.data(), npad, nullptr, PETSC_INT); CHKERRQ(ierr);
+	}
+
+	if (stored == header)
+	{
+		// same decomposition: each process loads its block in place
+		ierr = VecGetLocalSize(field.global, &nlocal); CHKERRQ(ierr);
+		ierr = VecGetArray(field.global, &arr); CHKERRQ(ierr);
+		ierr = VecCreateMPIWithArray(comm, 1, nlocal, PETSC_DECIDE,
+		                             arr, &block); CHKERRQ(ierr);
+		ierr = PetscObjectSetName((PetscObject) block, name.c_str()); CHKERRQ(ierr);
+		ierr = VecLoad(block, viewer); CHKERRQ(ierr);
+		ierr = VecDestroy(&block); CHKERRQ(ierr);
+		ierr = VecRestoreArray(field.global, &arr); CHKERRQ(ierr);
 	}
 	else
-		SETERRQ(PETSC_COMM_WORLD, PETSC_ERR_SUP,
-		        "Function only supports 2D or 3D fields");
+	{
+		// other decomposition: load the blocks as stored, then redistribute
+		ierr = VecCreate(comm, &block); CHKERRQ(ierr);
+		ierr = PetscObjectSetName((PetscObject) block, name.c_str()); CHKERRQ(ierr);
+		ierr = VecLoad(block, viewer); CHKERRQ(ierr);
+		ierr = VecGetOwnershipRange(block, &rstart, &rend); CHKERRQ(ierr);
+		PetibmFieldNativeGetNaturalIndices(stored, rstart, rend, indices);
+		ierr = DMDAGetAO(field.da, &ao); CHKERRQ(ierr);
+		ierr = AOApplicationToPetsc(ao, indices.size(), indices.data()); CHKERRQ(ierr);
+		ierr = ISCreateStride(comm, rend - rstart, rstart, 1,
+		                      &isfrom); CHKERRQ(ierr);
+		ierr = ISCreateGeneral(comm, indices.size(), indices.data(),
+		                       PETSC_USE_POINTER, &isto); CHKERRQ(ierr);
+		ierr = VecScatterCreate(
+			block, isfrom, field.global, isto, &scatter); CHKERRQ(ierr);
+		ierr = VecScatterBegin(scatter, block, field.global,
+		                       INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
+		ierr = VecScatterEnd(scatter, block, field.global,
+		                     INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
+		ierr = VecScatterDestroy(&scatter); CHKERRQ(ierr);
+		ierr = ISDestroy(&isto); CHKERRQ(ierr);
+		ierr = ISDestroy(&isfrom); CHKERRQ(ierr);
+		ierr = VecDestroy(&block); CHKERRQ(ierr);
+	}
+	ierr = PetscViewerDestroy(&viewer); CHKERRQ(ierr);
 
 	PetscFunctionReturn(0);
-} // PetibmFieldInterpolate
+} // PetibmFieldNativeRead
 
 
-/*! Interpolates a 2D field A associated with grid A onto grid B.
+/*! Writes the field values into file in native (decomposition) layout.
  *
- * Performs bi-linear interpolation.
+ * The file holds a small header with the decomposition of the field (number
+ * of points, components, and processes, ownership ranges), then the blocks of
+ * the processes in rank order; no redistribution to natural ordering is done.
+ * `-native_alignment <bytes>` pads the header so that the values start at a
+ * multiple of the given number of bytes (e.g., the stripe size of the file
+ * system) for the collective MPI-IO writes (`-viewer_binary_mpiio`).
+ *
+ * \param filepath Path of the output file.
+ * \param name Name of the field.
+ * \param field PetibmField structure.
+ */
+PetscErrorCode PetibmFieldNativeWrite(
+	const std::string filepath, const std::string name, const PetibmField field)
+{
+	PetscErrorCode ierr;
+	MPI_Comm comm;
+	PetscViewer viewer;
+	std::vector<PetscInt> header;
+	Vec block;
+	const PetscReal *arr;
+	PetscInt nlocal, alignment = 0, offset;
+	PetscBool found;
+
+	PetscFunctionBeginUser;
+
+	ierr = PetscObjectGetComm((PetscObject) field.global, &comm); CHKERRQ(ierr);
+	ierr = PetibmFieldNativeGetHeader(field.da, header); CHKERRQ(ierr);
+	// pad the header so that the values (after the classid and size written
+	// with the vector) start at an aligned offset
+	ierr = PetscOptionsGetInt(nullptr, nullptr, "-native_alignment",
+	                          &alignment, &found); CHKERRQ(ierr);
+	header.push_back(0);
+	if (alignment > 0)
+	{
+		if (alignment % sizeof(PetscInt) != 0)
+			SETERRQ(comm, PETSC_ERR_ARG_OUTOFRANGE,
+			        "The alignment should be a multiple of the integer size");
+		offset = (header.size() + 2) * sizeof(PetscInt);
+		header.back() = ((alignment - offset % alignment) % alignment) /
+		                sizeof(PetscInt);
+		header.resize(header.size() + header.back(), 0);
+	}
+	ierr = PetibmFieldBinaryViewerOpen(
+		comm, filepath, FILE_MODE_WRITE, &viewer); CHKERRQ(ierr);
+	ierr = PetscViewerBinaryWrite(viewer, header.data(), header.size(),
+	                              PETSC_INT, PETSC_FALSE); CHKERRQ(ierr);
+	// without DMDA attached, the vector is written in PETSc (block) ordering
+	ierr = VecGetLocalSize(field.global, &nlocal); CHKERRQ(ierr);
+	ierr = VecGetArrayRead(field.global, &arr); CHKERRQ(ierr);
+	ierr = VecCreateMPIWithArray(comm, 1, nlocal, PETSC_DECIDE,
+	                             arr, &block); CHKERRQ(ierr);
+	ierr = PetscObjectSetName((PetscObject) block, name.c_str()); CHKERRQ(ierr);
+	ierr = VecView(block, viewer); CHKERRQ(ierr);
+	ierr = VecDestroy(&block); CHKERRQ(ierr);
+	ierr = VecRestoreArrayRead(field.global, &arr); CHKERRQ(ierr);
+	ierr = PetscViewerDestroy(&viewer); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmFieldNativeWrite
+
+
+/*! Interpolates a field A associated with grid A onto grid B.
+ *
+ * Performs multi-linear interpolation (bi-linear in 2D, tri-linear in 3D):
+ * the loops over the directions and over the 2^dim surrounding values have
+ * bounds known at compile time.
+ * The points are split between the threads by static slabs.
  *
  * \param gridA The grid to interpolate from.
  * \param fieldA The field to interpolate.
  * \param gridB The grid to interpolate on.
  * \param fieldB The resulting interpolated field (passed by reference).
  */
-PetscErrorCode PetibmFieldInterpolate2D(
+template <PetscInt dim, typename T>
+static PetscErrorCode PetibmFieldInterpolateKernel(
 	PetibmGrid gridA, PetibmField fieldA, PetibmGrid gridB, PetibmField &fieldB)
 {
 	PetscErrorCode ierr;
 	DMDALocalInfo info;
-	PetscInt i, j, I, J;
-	PetscReal *xA, *yA, *xB, *yB;
-	PetscReal **vA, **vB;
-	PetscReal v1, v2;
-	std::vector<PetscInt> Iv, Jv;
+	PetibmGridline *linesA[3] = {&gridA.x, &gridA.y, &gridA.z},
+	               *linesB[3] = {&gridB.x, &gridB.y, &gridB.z};
+	std::vector<PetscInt> neighbors[3];
+	PetscReal *cA[3], *cB[3];
+	PetibmArray<dim, T> vA, vB;
+	PetscInt d;
 
 	PetscFunctionBeginUser;
 
-	ierr = PetibmFieldGlobalToLocal(fieldA); CHKERRQ(ierr);
+	ierr = PetibmFieldGetLocal(fieldA); CHKERRQ(ierr);
 	ierr = PetibmGridGlobalToLocal(gridA); CHKERRQ(ierr);
 	ierr = PetibmGridGlobalToLocal(gridB); CHKERRQ(ierr);
 
-	ierr = PetibmGetNeighbors1D(gridB.x, gridA.x, Iv); CHKERRQ(ierr);
-	ierr = PetibmGetNeighbors1D(gridB.y, gridA.y, Jv); CHKERRQ(ierr);
-
-	ierr = DMDAVecGetArray(fieldA.da, fieldA.local, &vA); CHKERRQ(ierr);
-	ierr = DMDAVecGetArray(fieldB.da, fieldB.global, &vB); CHKERRQ(ierr);
-	ierr = DMDAVecGetArray(gridA.x.da, gridA.x.local, &xA); CHKERRQ(ierr);
-	ierr = DMDAVecGetArray(gridA.y.da, gridA.y.local, &yA); CHKERRQ(ierr);
-	ierr = DMDAVecGetArray(gridB.x.da, gridB.x.local, &xB); CHKERRQ(ierr);
-	ierr = DMDAVecGetArray(gridB.y.da, gridB.y.local, &yB); CHKERRQ(ierr);
+	for (d=0; d<dim; d++)
+	{
+		ierr = PetibmGetNeighbors1D(
+			*linesB[d], *linesA[d], neighbors[d]); CHKERRQ(ierr);
+		ierr = DMDAVecGetArray(
+			linesA[d]->da, linesA[d]->local, cA+d); CHKERRQ(ierr);
+		ierr = DMDAVecGetArray(
+			linesB[d]->da, linesB[d]->local, cB+d); CHKERRQ(ierr);
+	}
+	ierr = PetibmArrayGet(fieldA.da, fieldA.local, vA); CHKERRQ(ierr);
+	ierr = PetibmArrayGet(fieldB.da, fieldB.global, vB); CHKERRQ(ierr);
 	ierr = DMDAGetLocalInfo(fieldB.da, &info); CHKERRQ(ierr);
-	for (j=info.ys; j<info.ys+info.ym; j++)
+	// static slabs along the slowest dimension (z in 3D, y in 2D)
+	ierr = PetibmThreadsRun([&](const PetscInt t, const PetscInt nt)
 	{
-		J = Jv[j-info.ys];
-		for (i=info.xs; i<info.xs+info.xm;i++)
+		const PetscInt starts[3] = {info.xs, info.ys, info.zs};
+		PetscInt lo[3] = {info.xs, info.ys, info.zs},
+		         hi[3] = {info.xs+info.xm, info.ys+info.ym, info.zs+info.zm},
+		         i, j, k, c, d, index[3], n[3] = {0, 0, 0};
+		PetscReal w[3][2], h, weight;
+		T v;
+
+		PetibmThreadsGetSlab(
+			starts[dim-1], hi[dim-1], t, nt, lo+dim-1, hi+dim-1);
+		for (k=lo[2]; k<hi[2]; k++)
 		{
-			I = Iv[i-info.xs];
-			v1 = ((xA[I+1] - xB[i]) / (xA[I+1] - xA[I]) * vA[J][I] +
-			      (xB[i] - xA[I]) / (xA[I+1] - xA[I]) * vA[J][I+1]);
-			v2 = ((xA[I+1] - xB[i]) / (xA[I+1] - xA[I]) * vA[J+1][I] +
-			      (xB[i] - xA[I]) / (xA[I+1] - xA[I]) * vA[J+1][I+1]);
-			vB[j][i] = ((yA[J+1] - yB[j]) / (yA[J+1] - yA[J]) * v1 +
-			            (yB[j] - yA[J]) / (yA[J+1] - yA[J]) * v2);
+			index[2] = k;
+			for (j=lo[1]; j<hi[1]; j++)
+			{
+				index[1] = j;
+				for (i=lo[0]; i<hi[0]; i++)
+				{
+					index[0] = i;
+					// weights of the two bracketing stations in each direction
+					for (d=0; d<dim; d++)
+					{
+						n[d] = neighbors[d][index[d]-starts[d]];
+						h = cA[d][n[d]+1] - cA[d][n[d]];
+						w[d][0] = (cA[d][n[d]+1] - cB[d][index[d]]) / h;
+						w[d][1] = (cB[d][index[d]] - cA[d][n[d]]) / h;
+					}
+					v = 0.0;
+					for (c=0; c<(1<<dim); c++)
+					{
+						weight = 1.0;
+						for (d=0; d<dim; d++)
+							weight *= w[d][(c>>d)&1];
+						v += weight *
+						     vA(n[2]+((c>>2)&1), n[1]+((c>>1)&1), n[0]+(c&1));
+					}
+					vB(k, j, i) = v;
+				}
+			}
 		}
+	}); CHKERRQ(ierr);
+	for (d=0; d<dim; d++)
+	{
+		ierr = DMDAVecRestoreArray(
+			linesA[d]->da, linesA[d]->local, cA+d); CHKERRQ(ierr);
+		ierr = DMDAVecRestoreArray(
+			linesB[d]->da, linesB[d]->local, cB+d); CHKERRQ(ierr);
 	}
-	ierr = DMDAVecRestoreArray(gridA.x.da, gridA.x.local, &xA); CHKERRQ(ierr);
-	ierr = DMDAVecRestoreArray(gridA.y.da, gridA.y.local, &yA); CHKERRQ(ierr);
-	ierr = DMDAVecRestoreArray(gridB.x.da, gridB.x.local, &xB); CHKERRQ(ierr);
-	ierr = DMDAVecRestoreArray(gridB.y.da, gridB.y.local, &yB); CHKERRQ(ierr);
-	ierr = DMDAVecRestoreArray(fieldA.da, fieldA.local, &vA); CHKERRQ(ierr);
-	ierr = DMDAVecRestoreArray(fieldB.da, fieldB.global, &vB); CHKERRQ(ierr);
+	ierr = PetibmArrayRestore(fieldA.da, fieldA.local, vA); CHKERRQ(ierr);
+	ierr = PetibmArrayRestore(fieldB.da, fieldB.global, vB); CHKERRQ(ierr);
+	ierr = PetibmFieldRestoreLocal(fieldA); CHKERRQ(ierr);
 
 	PetscFunctionReturn(0);
-} // PetibmFieldInterpolate2D
+} // PetibmFieldInterpolateKernel
 
 
-/*! Interpolates a 3D field A associated with grid A onto grid B.
+/*! Interpolates field A associated with grid A onto grid B.
  *
- * Performs tri-linear interpolation.
+ * Dispatches to the interpolation kernel specialized for the dimension.
  *
  * \param gridA The grid to interpolate from.
  * \param fieldA The field to interpolate.
  * \param gridB The grid to interpolate on.
  * \param fieldB The resulting interpolated field (passed by reference).
  */
-PetscErrorCode PetibmFieldInterpolate3D(
+PetscErrorCode PetibmFieldInterpolate(
 	PetibmGrid gridA, PetibmField fieldA, PetibmGrid gridB, PetibmField &fieldB)
 {
 	PetscErrorCode ierr;
-	DMDALocalInfo info;
-	PetscInt i, j, k, I, J, K;
-	PetscReal *xA, *yA, *zA, *xB, *yB, *zB;
-	PetscReal ***vA, ***vB;
-	PetscReal v1, v2, v3, v4, v12, v34;
-	std::vector<PetscInt> Iv, Jv, Kv;
 
 	PetscFunctionBeginUser;
 
-	ierr = PetibmFieldGlobalToLocal(fieldA); CHKERRQ(ierr);
-	ierr = PetibmGridGlobalToLocal(gridA); CHKERRQ(ierr);
-	ierr = PetibmGridGlobalToLocal(gridB); CHKERRQ(ierr);
-
-	ierr = PetibmGetNeighbors1D(gridB.x, gridA.x, Iv); CHKERRQ(ierr);
-	ierr = PetibmGetNeighbors1D(gridB.y, gridA.y, Jv); CHKERRQ(ierr);
-	ierr = PetibmGetNeighbors1D(gridB.z, gridA.z, Kv); CHKERRQ(ierr);
-
-	ierr = DMDAVecGetArray(fieldA.da, fieldA.local, &vA); CHKERRQ(ierr);
-	ierr = DMDAVecGetArray(fieldB.da, fieldB.global, &vB); CHKERRQ(ierr);
-	ierr = DMDAVecGetArray(gridA.x.da, gridA.x.local, &xA); CHKERRQ(ierr);
-	ierr = DMDAVecGetArray(gridA.y.da, gridA.y.local, &yA); CHKERRQ(ierr);
-	ierr = DMDAVecGetArray(gridA.z.da, gridA.z.local, &zA); CHKERRQ(ierr);
-	ierr = DMDAVecGetArray(gridB.x.da, gridB.x.local, &xB); CHKERRQ(ierr);
-	ierr = DMDAVecGetArray(gridB.y.da, gridB.y.local, &yB); CHKERRQ(ierr);
-	ierr = DMDAVecGetArray(gridB.z.da, gridB.z.local, &zB); CHKERRQ(ierr);
-	ierr = DMDAGetLocalInfo(fieldB.da, &info); CHKERRQ(ierr);
-	for (k=info.zs; k<info.zs+info.zm; k++)
+	if (gridA.dim == 2)
 	{
-		K = Kv[k-info.zs];
-		for (j=info.ys; j<info.ys+info.ym; j++)
-		{
-			J = Jv[j-info.ys];
-			for (i=info.xs; i<info.xs+info.xm;i++)
-			{
-				I = Iv[i-info.xs];
-				v1 = ((xA[I+1] - xB[i]) / (xA[I+1] - xA[I]) * vA[K][J][I] +
-				      (xB[i] - xA[I]) / (xA[I+1] - xA[I]) * vA[K][J][I+1]);
-				v2 = ((xA[I+1] - xB[i]) / (xA[I+1] - xA[I]) * vA[K][J+1][I] +
-				      (xB[i] - xA[I]) / (xA[I+1] - xA[I]) * vA[K][J+1][I+1]);
-				v3 = ((xA[I+1] - xB[i]) / (xA[I+1] - xA[I]) * vA[K+1][J][I] +
-				      (xB[i] - xA[I]) / (xA[I+1] - xA[I]) * vA[K+1][J][I+1]);
-				v4 = ((xA[I+1] - xB[i]) / (xA[I+1] - xA[I]) * vA[K+1][J+1][I] +
-				      (xB[i] - xA[I]) / (xA[I+1] - xA[I]) * vA[K+1][J+1][I+1]);
-				v12 = ((yA[J+1] - yB[j]) / (yA[J+1] - yA[J]) * v1 +
-				       (yB[j] - yA[J]) / (yA[J+1] - yA[J]) * v2);
-				v34 = ((yA[J+1] - yB[j]) / (yA[J+1] - yA[J]) * v3 +
-				       (yB[j] - yA[J]) / (yA[J+1] - yA[J]) * v4);
-				vB[k][j][i] = ((zA[K+1] - zB[k]) / (zA[K+1] - zA[K]) * v12 +
-				               (zB[k] - zA[K]) / (zA[K+1] - zA[K]) * v34);
-			}
-		}
+		ierr = PetibmFieldInterpolateKernel<2, PetscReal>(
+			gridA, fieldA, gridB, fieldB); CHKERRQ(ierr);
 	}
-	ierr = DMDAVecRestoreArray(gridA.x.da, gridA.x.local, &xA); CHKERRQ(ierr);
-	ierr = DMDAVecRestoreArray(gridA.y.da, gridA.y.local, &yA); CHKERRQ(ierr);
-	ierr = DMDAVecRestoreArray(gridA.z.da, gridA.z.local, &zA); CHKERRQ(ierr);
-	ierr = DMDAVecRestoreArray(gridB.x.da, gridB.x.local, &xB); CHKERRQ(ierr);
-	ierr = DMDAVecRestoreArray(gridB.y.da, gridB.y.local, &yB); CHKERRQ(ierr);
-	ierr = DMDAVecRestoreArray(gridB.z.da, gridB.z.local, &zA); CHKERRQ(ierr);
-	ierr = DMDAVecRestoreArray(fieldA.da, fieldA.local, &vA); CHKERRQ(ierr);
-	ierr = DMDAVecRestoreArray(fieldB.da, fieldB.global, &vB); CHKERRQ(ierr);
+	else if (gridA.dim == 3)
+	{
+		ierr = PetibmFieldInterpolateKernel<3, PetscReal>(
+			gridA, fieldA, gridB, fieldB); CHKERRQ(ierr);
+	}
+	else
+		SETERRQ(PETSC_COMM_WORLD, PETSC_ERR_SUP,
+		        "Function only supports 2D or 3D fields");
 
 	PetscFunctionReturn(0);
-} // PetibmFieldInterpolate3D
+} // PetibmFieldInterpolate
@@ -2,9 +2,12 @@
  * \file grid.cpp
  */
 
+#include <algorithm>
+
 #include <petscviewerhdf5.h>
 
 #include "petibm-utilities/grid.h"
+#include "petibm-utilities/info.h"
 #include "petibm-utilities/misc.h"
 
 
@@ -32,8 +35,7 @@ PetscErrorCode PetibmGridGetOptions(
 	}
 	if (found)
 	{
-		ierr = PetscOptionsInsertFile(
-			PETSC_COMM_WORLD, nullptr, path, PETSC_FALSE); CHKERRQ(ierr);
+		ierr = PetibmOptionsInsertFile(path); CHKERRQ(ierr);
 	}
 	// get path of the file with the gridline stations
 	ierr = PetscOptionsGetString(nullptr, prefix, "-path", ctx->path,
@@ -107,11 +109,114 @@ PetscErrorCode PetibmGridCtxPrintf(
 } // PetibmGridCtxPrintf
 
 
+/*! Fills the number of points missing from the context with the sizes of
+ * the gridlines stored in a file.
+ *
+ * Collective on PETSC_COMM_WORLD; sizes already set (greater than 0) are kept
+ * and a gridline absent from the file (e.g., `z` in 2D) leaves its size unset.
+ *
+ * \param filepath Path of the file with the gridline stations.
+ * \param name Name of the grid.
+ * \param ctx The PetibmGridCtx structure to fill (passed by pointer).
+ */
+PetscErrorCode PetibmGridCtxDetectSizes(
+	const std::string filepath, const std::string name, PetibmGridCtx *ctx)
+{
+	PetscErrorCode ierr;
+	std::vector<PetscInt> shape;
+	PetscInt *sizes[3] = {&ctx->nx, &ctx->ny, &ctx->nz};
+	const char *directions[3] = {"x", "y", "z"};
+
+	PetscFunctionBeginUser;
+
+	if (filepath.empty())
+		PetscFunctionReturn(0);
+	for (PetscInt d=0; d<3; d++)
+	{
+		if (*sizes[d] > 0)
+			continue;
+		ierr = PetibmInfoHDF5GetShape(
+			filepath, name+"/"+directions[d], shape); CHKERRQ(ierr);
+		if (shape.size() == 1)
+			*sizes[d] = shape[0];
+	}
+
+	PetscFunctionReturn(0);
+} // PetibmGridCtxDetectSizes
+
+
+/*! Creates a gridline distributed over the processes sharing a color.
+ *
+ * The processes of PETSC_COMM_WORLD with the same color are gathered in a
+ * sub-communicator, ordered by key, over which the 1D DMDA is created.
+ *
+ * \param color Color of the process (processes on the same gridline).
+ * \param key Rank of the process along the gridline.
+ * \param M Number of stations along the gridline.
+ * \param lx Number of stations owned by each process along the gridline.
+ * \param periodic Is the gridline periodic?
+ * \param line The gridline to create (passed by reference).
+ */
+static PetscErrorCode PetibmGridlineCreate(
+	const PetscMPIInt color, const PetscMPIInt key,
+	const PetscInt M, const PetscInt lx[], const PetscBool periodic,
+	PetibmGridline &line)
+{
+	PetscErrorCode ierr;
+	MPI_Comm comm;
+
+	PetscFunctionBeginUser;
+
+	ierr = MPI_Comm_split(PETSC_COMM_WORLD, color, key, &comm); CHKERRQ(ierr);
+	ierr = DMDACreate1d(comm,
+	                    (periodic) ? DM_BOUNDARY_PERIODIC : DM_BOUNDARY_GHOSTED,
+	                    M, 1, 1, lx, &line.da); CHKERRQ(ierr);
+	ierr = DMSetUp(line.da); CHKERRQ(ierr);
+	// the DMDA holds a duplicate of the communicator
+	ierr = MPI_Comm_free(&comm); CHKERRQ(ierr);
+	ierr = DMCreateGlobalVector(line.da, &line.coords); CHKERRQ(ierr);
+	ierr = DMCreateLocalVector(line.da, &line.local); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmGridlineCreate
+
+
+/*! Copies the stations owned by the process from a sequential vector.
+ *
+ * \param stations Sequential vector with all the stations along the gridline.
+ * \param line The gridline to fill (passed by reference).
+ */
+static PetscErrorCode PetibmGridlineCopyOwned(
+	const Vec stations, PetibmGridline &line)
+{
+	PetscErrorCode ierr;
+	PetscInt xs, xm, i;
+	PetscReal *arr;
+	const PetscReal *c;
+
+	PetscFunctionBeginUser;
+
+	ierr = DMDAGetCorners(
+		line.da, &xs, nullptr, nullptr, &xm, nullptr, nullptr); CHKERRQ(ierr);
+	ierr = VecGetArrayRead(stations, &c); CHKERRQ(ierr);
+	ierr = VecGetArray(line.coords, &arr); CHKERRQ(ierr);
+	for (i=0; i<xm; i++)
+		arr[i] = c[xs+i];
+	ierr = VecRestoreArray(line.coords, &arr); CHKERRQ(ierr);
+	ierr = VecRestoreArrayRead(stations, &c); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmGridlineCopyOwned
+
+
 /*! Initializes the grid based on the context.
  *
  * Creates a 1D DMDA object for each direction and creates the local global
  * vectors associated with each DMDA.
- * The domain is decomposed along the y-direction only.
+ * The gridlines follow the decomposition of a field DMDA of the same size:
+ * each gridline is distributed over the processes that share the same
+ * location along the other directions, and each process holds only the
+ * stations it owns plus ghosts.
  *
  * \param ctx The grid context.
  * \param grid The grid to initialize (passed by reference).
@@ -120,38 +225,94 @@ PetscErrorCode PetibmGridInitialize(
 	const PetibmGridCtx ctx, PetibmGrid &grid)
 {
 	PetscErrorCode ierr;
+	const PetscBool periodic[3] = {PETSC_FALSE, PETSC_FALSE, PETSC_FALSE};
+
+	PetscFunctionBeginUser;
+
+	ierr = PetibmGridInitialize(ctx, periodic, grid); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmGridInitialize
+
+
+/*! Initializes the grid based on the context and the periodicity of the
+ * fields.
+ *
+ * As PetibmGridInitialize(ctx, grid), with periodic gridline DMDAs along the
+ * periodic directions of the fields (the ghost stations are then wrapped and
+ * the external boundary points are not set).
+ *
+ * \param ctx The grid context.
+ * \param periodic Periodicity of the fields in each direction.
+ * \param grid The grid to initialize (passed by reference).
+ */
+PetscErrorCode PetibmGridInitialize(
+	const PetibmGridCtx ctx, const PetscBool periodic[], PetibmGrid &grid)
+{
+	PetscErrorCode ierr;
+	DM da;
+	PetscInt m, n, p;
+	const PetscInt *lx, *ly, *lz;
+	PetscMPIInt rank, i, j, k;
 
 	PetscFunctionBeginUser;
 
+	ierr = MPI_Comm_rank(PETSC_COMM_WORLD, &rank); CHKERRQ(ierr);
+
+	// create a temporary DMDA to get the decomposition of the fields
+	if (ctx.nz > 0)
+	{
+		ierr = DMDACreate3d(PETSC_COMM_WORLD,
+		                    DM_BOUNDARY_GHOSTED, DM_BOUNDARY_GHOSTED,
+		                    DM_BOUNDARY_GHOSTED,
+		                    DMDA_STENCIL_BOX,
+		                    ctx.nx, ctx.ny, ctx.nz,
+		                    PETSC_DECIDE, PETSC_DECIDE, PETSC_DECIDE,
+		                    1, 1, nullptr, nullptr, nullptr,
+		                    &da); CHKERRQ(ierr);
+	}
+	else
+	{
+		ierr = DMDACreate2d(PETSC_COMM_WORLD,
+		                    DM_BOUNDARY_GHOSTED, DM_BOUNDARY_GHOSTED,
+		                    DMDA_STENCIL_BOX,
+		                    ctx.nx, ctx.ny,
+		                    PETSC_DECIDE, PETSC_DECIDE,
+		                    1, 1, nullptr, nullptr,
+		                    &da); CHKERRQ(ierr);
+	}
+	ierr = DMSetFromOptions(da); CHKERRQ(ierr);
+	ierr = DMSetUp(da); CHKERRQ(ierr);
+	ierr = DMDAGetInfo(da,
+	                   nullptr,
+	                   nullptr, nullptr, nullptr,
+	                   &m, &n, &p,
+	                   nullptr, nullptr,
+	                   nullptr, nullptr, nullptr,
+	                   nullptr); CHKERRQ(ierr);
+	ierr = DMDAGetOwnershipRanges(da, &lx, &ly, &lz); CHKERRQ(ierr);
+
+	// location of the process in the DMDA process grid (x varies fastest)
+	i = rank % m;
+	j = (rank / m) % n;
+	k = rank / (m * n);
+
 	// gridline in x-direction
-	ierr = DMDACreate1d(PETSC_COMM_SELF,
-	                    DM_BOUNDARY_GHOSTED, ctx.nx, 1, 1, nullptr,
-	                    &grid.x.da); CHKERRQ(ierr);
-	ierr = DMSetFromOptions(grid.x.da); CHKERRQ(ierr);
-	ierr = DMSetUp(grid.x.da); CHKERRQ(ierr);
-	ierr = DMCreateGlobalVector(grid.x.da, &grid.x.coords); CHKERRQ(ierr);
-	ierr = DMCreateLocalVector(grid.x.da, &grid.x.local); CHKERRQ(ierr);
+	ierr = PetibmGridlineCreate(
+		j + n*k, i, ctx.nx, lx, periodic[0], grid.x); CHKERRQ(ierr);
 	// gridline in y-direction
-	ierr = DMDACreate1d(PETSC_COMM_WORLD,
-	                    DM_BOUNDARY_GHOSTED, ctx.ny, 1, 1, nullptr,
-	                    &grid.y.da); CHKERRQ(ierr);
-	ierr = DMSetFromOptions(grid.y.da); CHKERRQ(ierr);
-	ierr = DMSetUp(grid.y.da); CHKERRQ(ierr);
-	ierr = DMCreateGlobalVector(grid.y.da, &grid.y.coords); CHKERRQ(ierr);
-	ierr = DMCreateLocalVector(grid.y.da, &grid.y.local); CHKERRQ(ierr);
+	ierr = PetibmGridlineCreate(
+		i + m*k, j, ctx.ny, ly, periodic[1], grid.y); CHKERRQ(ierr);
 	if (ctx.nz > 0)
 	{
 		grid.dim = 3;
 		// gridline in z-direction
-		ierr = DMDACreate1d(PETSC_COMM_SELF,
-		                    DM_BOUNDARY_GHOSTED, ctx.nz, 1, 1, nullptr,
-		                    &grid.z.da); CHKERRQ(ierr);
-		ierr = DMSetFromOptions(grid.z.da); CHKERRQ(ierr);
-		ierr = DMSetUp(grid.z.da); CHKERRQ(ierr);
-		ierr = DMCreateGlobalVector(grid.z.da, &grid.z.coords); CHKERRQ(ierr);
-		ierr = DMCreateLocalVector(grid.z.da, &grid.z.local); CHKERRQ(ierr);
+		ierr = PetibmGridlineCreate(
+			i + m*j, k, ctx.nz, lz, periodic[2], grid.z); CHKERRQ(ierr);
 	}
 
+	ierr = DMDestroy(&da); CHKERRQ(ierr);
+
 	PetscFunctionReturn(0);
 } // PetibmGridInitialize
 
@@ -160,8 +321,8 @@ PetscErrorCode PetibmGridInitialize(
  *
  * Creates a 1D DMDA objects for each direction and creates the local and global
  * vectors associated with each DMDA.
- * The coordinates are provided as an array of sequential vectors, each vectors
- * containing the stations along a gridline.
+ * The coordinates are provided as an array of vectors, each vectors containing
+ * the stations along a gridline (see PetibmGridlineInitialize).
  * The decomposition followed the decomposition of a reference grid so that
  * physically closed points are located on the same process.
  *
@@ -192,11 +353,16 @@ PetscErrorCode PetibmGridInitialize(
  * gridline.
  *
  * Creates a 1D DMDA object for the direction and creates the local and global
- * vectors associated with it.
- * The coordinates are provided as a sequential vector containing the stations
- * along the gridline.
+ * vectors associated with it; the stations are copied into the global vector.
+ * The coordinates are provided either as a sequential vector containing all
+ * the stations along the gridline, or as a vector distributed over the
+ * communicator of the reference gridline (any layout).
  * The decomposition followed the decomposition of a reference gridline so that
- * physically closed points are located on the same process.
+ * physically closed points are located on the same process: the ownership
+ * ranges are obtained by a distributed binary search of the last station
+ * owned by each process of the reference gridline (a process owning no
+ * station ends where the previous one ends).
+ * The boundary type is the one of the reference gridline.
  *
  * \param other The gridline used as a reference.
  * \param coords The stations along the direction.
@@ -206,64 +372,103 @@ PetscErrorCode PetibmGridlineInitialize(
 	PetibmGridline other, const Vec coords, PetibmGridline &line)
 {
 	PetscErrorCode ierr;
-	PetscInt *lx;
-	PetscInt M, m;
-	DMBoundaryType b;
-	DMDALocalInfo info;
-	PetscMPIInt rank, size;
+	MPI_Comm comm, ccomm;
+	PetscMPIInt size, csize, result;
+	PetscInt M, n, r, xs, xm;
+	PetscInt *lx, *below;
+	PetscReal last = PETSC_MIN_REAL, *bounds, *arr;
+	const PetscReal *c;
+	DMBoundaryType bType;
 
 	PetscFunctionBeginUser;
 
-	ierr = MPI_Comm_rank(PETSC_COMM_WORLD, &rank); CHKERRQ(ierr);
-	ierr = MPI_Comm_size(PETSC_COMM_WORLD, &size); CHKERRQ(ierr);
+	ierr = PetscObjectGetComm((PetscObject) other.da, &comm); CHKERRQ(ierr);
+	ierr = DMDAGetInfo(other.da, nullptr, nullptr, nullptr, nullptr,
+	                   nullptr, nullptr, nullptr, nullptr, nullptr,
+	                   &bType, nullptr, nullptr, nullptr); CHKERRQ(ierr);
+	ierr = MPI_Comm_size(comm, &size); CHKERRQ(ierr);
+	ierr = PetscObjectGetComm((PetscObject) coords, &ccomm); CHKERRQ(ierr);
+	ierr = MPI_Comm_size(ccomm, &csize); CHKERRQ(ierr);
+	if (csize > 1)
+	{
+		ierr = MPI_Comm_compare(comm, ccomm, &result); CHKERRQ(ierr);
+		if (result == MPI_UNEQUAL)
+			SETERRQ(PETSC_COMM_WORLD, PETSC_ERR_ARG_INCOMP,
+			        "Stations should be sequential or distributed over the "
+			        "communicator of the reference gridline");
+	}
 
 	// get number of coordinates
 	ierr = VecGetSize(coords, &M); CHKERRQ(ierr);
 
-	// get info from other (model) 1D DMDA
-	ierr = DMDAGetInfo(other.da,
-	                   nullptr,
-	                   nullptr, nullptr, nullptr,
-	                   &m, nullptr, nullptr,
-	                   nullptr, nullptr,
-	                   &b, nullptr, nullptr,
-	                   nullptr); CHKERRQ(ierr);
-	ierr = PetscMalloc(m*sizeof(*lx), &lx); CHKERRQ(ierr);
-	if (m == 1)
+	// gather the last station owned by each process of the reference gridline
+	ierr = DMDAGetCorners(
+		other.da, &xs, nullptr, nullptr, &xm, nullptr, nullptr); CHKERRQ(ierr);
+	if (xm > 0)
 	{
-		lx[0] = M;
-		ierr = DMDACreate1d(
-			PETSC_COMM_SELF, b, M, 1, 1, nullptr, &line.da); CHKERRQ(ierr);
-		ierr = DMSetFromOptions(line.da); CHKERRQ(ierr);
-		ierr = DMSetUp(line.da); CHKERRQ(ierr);
+		ierr = VecGetArray(other.coords, &arr); CHKERRQ(ierr);
+		last = arr[xm-1];
+		ierr = VecRestoreArray(other.coords, &arr); CHKERRQ(ierr);
 	}
-	else if (m == size)
-	{	
-		ierr = DMDAGetLocalInfo(other.da, &info); CHKERRQ(ierr);
-		PetscReal *arr;
-		ierr = PetibmGridlineGlobalToLocal(other); CHKERRQ(ierr);
-		ierr = DMDAVecGetArray(other.da, other.local, &arr); CHKERRQ(ierr);
-		PetscReal start = arr[info.gxs],
-		          end = arr[info.xs+info.xm-1];
-		if (info.xs+info.xm == info.mx)
-			end = arr[info.xs+info.xm];
-		ierr = PetibmGetNumPoints1D(coords, start, end, lx+rank); CHKERRQ(ierr);
-		ierr = DMDAVecRestoreArray(other.da, other.coords, &arr); CHKERRQ(ierr);
-		ierr = MPI_Allgather(MPI_IN_PLACE, 1, MPIU_INT,
-		                     lx, 1, MPIU_INT, PETSC_COMM_WORLD); CHKERRQ(ierr);
-		ierr = DMDACreate1d(
-			PETSC_COMM_WORLD, b, M, 1, 1, lx, &line.da); CHKERRQ(ierr);
-		ierr = DMSetFromOptions(line.da); CHKERRQ(ierr);
-		ierr = DMSetUp(line.da); CHKERRQ(ierr);
+	ierr = PetscMalloc1(size, &bounds); CHKERRQ(ierr);
+	ierr = MPI_Allgather(&last, 1, MPIU_REAL,
+	                     bounds, 1, MPIU_REAL, comm); CHKERRQ(ierr);
+	// a process owning no station ends where the previous one ends
+	for (r=1; r<size; r++)
+		bounds[r] = PetscMax(bounds[r], bounds[r-1]);
+
+	// count the stations strictly below each boundary between processes:
+	// binary search on the stations held by the process, then sum over the
+	// processes holding a chunk of the gridline
+	ierr = PetscMalloc1(size, &below); CHKERRQ(ierr);
+	ierr = VecGetLocalSize(coords, &n); CHKERRQ(ierr);
+	ierr = VecGetArrayRead(coords, &c); CHKERRQ(ierr);
+	for (r=0; r<size-1; r++)
+		below[r] = std::lower_bound(c, c+n, bounds[r]) - c;
+	ierr = VecRestoreArrayRead(coords, &c); CHKERRQ(ierr);
+	if (csize > 1)
+	{
+		ierr = MPI_Allreduce(MPI_IN_PLACE, below, size-1, MPIU_INT, MPI_SUM,
+		                     comm); CHKERRQ(ierr);
 	}
-	else
-		SETERRQ(PETSC_COMM_WORLD, PETSC_ERR_SUP,
-		        "Function only supports with 1 or comm's size");
+	below[size-1] = M;
+
+	// create the gridline with the same distribution as the reference
+	ierr = PetscMalloc1(size, &lx); CHKERRQ(ierr);
+	lx[0] = below[0];
+	for (r=1; r<size; r++)
+		lx[r] = below[r] - below[r-1];
+	ierr = DMDACreate1d(comm, bType, M, 1, 1, lx, &line.da); CHKERRQ(ierr);
+	ierr = DMSetUp(line.da); CHKERRQ(ierr);
 	ierr = PetscFree(lx); CHKERRQ(ierr);
+	ierr = PetscFree(below); CHKERRQ(ierr);
+	ierr = PetscFree(bounds); CHKERRQ(ierr);
 
 	ierr = DMCreateGlobalVector(line.da, &line.coords); CHKERRQ(ierr);
 	ierr = DMCreateLocalVector(line.da, &line.local); CHKERRQ(ierr);
 
+	// copy the stations owned by the process
+	if (csize == 1)
+	{
+		ierr = PetibmGridlineCopyOwned(coords, line); CHKERRQ(ierr);
+	}
+	else
+	{
+		IS is;
+		VecScatter scatter;
+		ierr = DMDAGetCorners(
+			line.da, &xs, nullptr, nullptr, &xm, nullptr, nullptr); CHKERRQ(ierr);
+		ierr = ISCreateStride(comm, xm, xs, 1, &is); CHKERRQ(ierr);
+		ierr = VecScatterCreate(
+			coords, is, line.coords, is, &scatter); CHKERRQ(ierr);
+		ierr = VecScatterBegin(scatter, coords, line.coords,
+		                       INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
+		ierr = VecScatterEnd(scatter, coords, line.coords,
+		                     INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
+		ierr = VecScatterDestroy(&scatter); CHKERRQ(ierr);
+		ierr = ISDestroy(&is); CHKERRQ(ierr);
+	}
+
 	PetscFunctionReturn(0);
 } // PetibmGridlineInitialize
 
@@ -296,6 +501,8 @@ PetscErrorCode PetibmGridSetBoundaryPoints(
 
 
 /*! Sets the starting end ending points for a gridline.
+ *
+ * Nothing is done on a periodic gridline (the ghost stations are wrapped).
  *
  * \param start The starting point.
  * \param end The ending point.
@@ -311,6 +518,9 @@ PetscErrorCode PetibmGridlineSetBoundaryPoints(
 	PetscFunctionBeginUser;
 
 	ierr = DMDAGetLocalInfo(line.da, &info); CHKERRQ(ierr);
+	// the ghost stations of a periodic gridline are wrapped
+	if (info.bx == DM_BOUNDARY_PERIODIC)
+		PetscFunctionReturn(0);
 	ierr = PetibmGridlineGlobalToLocal(line); CHKERRQ(ierr);
 	ierr = DMDAVecGetArray(line.da, line.local, &arr); CHKERRQ(ierr);
 	if (info.xs == 0)
@@ -363,6 +573,60 @@ PetscErrorCode PetibmGridlineGlobalToLocal(PetibmGridline &line)
 } // PetibmGridlineGlobalToLocal
 
 
+/*! Gets the widths of the cells around the stations of a gridline on process.
+ *
+ * Trapezoidal rule: half the distance between the neighboring stations,
+ * and half the distance to the single neighbor at the ends of the gridline.
+ * On a periodic gridline, the station beyond an end is one mean end spacing
+ * away (as in PetibmStreamFunction), so that the end cells get full widths.
+ * Collective on the communicator of the gridline.
+ *
+ * \param line The gridline to work on (passed by reference).
+ * \param widths The widths of the stations on process (passed by reference).
+ */
+PetscErrorCode PetibmGridlineGetWidths(
+	PetibmGridline &line, std::vector<PetscReal> &widths)
+{
+	PetscErrorCode ierr;
+	MPI_Comm comm;
+	DMDALocalInfo info;
+	DMBoundaryType bType;
+	PetscReal *x, h[2] = {0.0, 0.0}, hs[2] = {0.0, 0.0}, lo, hi;
+	PetscInt i;
+
+	PetscFunctionBeginUser;
+
+	ierr = DMDAGetLocalInfo(line.da, &info); CHKERRQ(ierr);
+	ierr = DMDAGetInfo(line.da, nullptr, nullptr, nullptr, nullptr,
+	                   nullptr, nullptr, nullptr, nullptr, nullptr,
+	                   &bType, nullptr, nullptr, nullptr); CHKERRQ(ierr);
+	ierr = PetibmGridlineGlobalToLocal(line); CHKERRQ(ierr);
+	widths.resize(info.xm);
+	ierr = DMDAVecGetArray(line.da, line.local, &x); CHKERRQ(ierr);
+	// mean spacing at the ends of a periodic gridline
+	if (bType == DM_BOUNDARY_PERIODIC and info.mx > 1)
+	{
+		if (info.xs == 0)
+			h[0] = x[1] - x[0];
+		if (info.xs+info.xm == info.mx)
+			h[1] = x[info.mx-1] - x[info.mx-2];
+		ierr = PetscObjectGetComm((PetscObject) line.da, &comm); CHKERRQ(ierr);
+		ierr = MPI_Allreduce(
+			h, hs, 2, MPIU_REAL, MPI_MAX, comm); CHKERRQ(ierr);
+		hs[0] = hs[1] = 0.5 * (hs[0] + hs[1]);
+	}
+	for (i=info.xs; i<info.xs+info.xm; i++)
+	{
+		lo = (i > 0) ? x[i-1] : x[0] - hs[0];
+		hi = (i < info.mx-1) ? x[i+1] : x[info.mx-1] + hs[1];
+		widths[i-info.xs] = (info.mx > 1) ? 0.5*(hi - lo) : 1.0;
+	}
+	ierr = DMDAVecRestoreArray(line.da, line.local, &x); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmGridlineGetWidths
+
+
 /*! Destroys a PetibmGrid structure.
  *
  * \param grid The PetibmGrid structure to destroy (passed by reference).
@@ -374,7 +638,7 @@ PetscErrorCode PetibmGridDestroy(PetibmGrid &grid)
 	PetscFunctionBeginUser;
 
 	ierr = PetibmGridlineDestroy(grid.x); CHKERRQ(ierr);
-	ierr = PetibmGridlineDestroy(grid.x); CHKERRQ(ierr);
+	ierr = PetibmGridlineDestroy(grid.y); CHKERRQ(ierr);
 	if (grid.dim == 3)
 	{
 		ierr = PetibmGridlineDestroy(grid.z); CHKERRQ(ierr);
@@ -402,9 +666,61 @@ PetscErrorCode PetibmGridlineDestroy(PetibmGridline &line)
 } // PetibmGridlineDestroy
 
 
+/*! Modes to read the replicated gridline stations (option `-replicated_read`).
+ *
+ * - `rank`: every process reads the file;
+ * - `root`: rank 0 reads the file and broadcasts the stations to one process
+ *   per node;
+ * - `node`: one process per node reads the file.
+ */
+static const char *const PetibmReplicatedReadModes[] = {"rank", "root", "node"};
+
+
+/*! Gets the mode to read replicated stations from the options database.
+ *
+ * \param mode Index of the mode in PetibmReplicatedReadModes (passed by pointer).
+ */
+static PetscErrorCode PetibmGetReplicatedReadMode(PetscInt *mode)
+{
+	PetscErrorCode ierr;
+	PetscBool found;
+
+	PetscFunctionBeginUser;
+
+	*mode = 0;
+	ierr = PetscOptionsGetEList(nullptr, nullptr, "-replicated_read",
+	                            PetibmReplicatedReadModes, 3,
+	                            mode, &found); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmGetReplicatedReadMode
+
+
+/*! Frees the shared-memory window holding replicated stations.
+ *
+ * \param ctx Pointer to the MPI window.
+ */
+static PetscErrorCode PetibmGridlineWindowDestroy(void *ctx)
+{
+	PetscErrorCode ierr;
+	MPI_Win *win = (MPI_Win *) ctx;
+
+	PetscFunctionBeginUser;
+
+	ierr = MPI_Win_free(win); CHKERRQ(ierr);
+	ierr = PetscFree(win); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmGridlineWindowDestroy
+
+
 /*! Reads the gridlines from file.
  *
  * The gridlines should be stored in HDF5 format in the same file.
+ * Unless `-replicated_read rank`, the stations are read once (per node or on
+ * rank 0) with PetibmGridlineHDF5ReadShared and each process copies the
+ * stations it owns; otherwise, each copy of a gridline is read over its own
+ * communicator.
  *
  * \param filepath Path of the input file.
  * \param varname Name of variable (group name in the HDF5).
@@ -414,27 +730,38 @@ PetscErrorCode PetibmGridHDF5Read(
 	const std::string filepath, const std::string varname, PetibmGrid &grid)
 {
 	PetscErrorCode ierr;
-	PetscViewer viewer;
+	PetscInt mode;
 
 	PetscFunctionBeginUser;
 
-	ierr = PetscViewerHDF5Open(
-		PETSC_COMM_SELF, filepath.c_str(), FILE_MODE_READ, &viewer); CHKERRQ(ierr);
-	ierr = PetscViewerHDF5PushGroup(viewer, varname.c_str()); CHKERRQ(ierr);
-	// read x-stations
-	ierr = PetscObjectSetName((PetscObject) grid.x.coords, "x"); CHKERRQ(ierr);
-	ierr = VecLoad(grid.x.coords, viewer); CHKERRQ(ierr);
-	// read y-stations
-	ierr = PetscObjectSetName((PetscObject) grid.y.coords, "y"); CHKERRQ(ierr);
-	ierr = VecLoad(grid.y.coords, viewer); CHKERRQ(ierr);
-	if (grid.dim == 3)
+	ierr = PetibmGetReplicatedReadMode(&mode); CHKERRQ(ierr);
+	if (mode > 0)
 	{
-		// read z-stations
-		ierr = PetscObjectSetName((PetscObject) grid.z.coords, "z"); CHKERRQ(ierr);
-		ierr = VecLoad(grid.z.coords, viewer); CHKERRQ(ierr);
+		PetibmGridline *lines[3] = {&grid.x, &grid.y, &grid.z};
+		const char *names[3] = {"x", "y", "z"};
+		for (PetscInt d=0; d<grid.dim; d++)
+		{
+			Vec stations;
+			PetscInt M;
+			ierr = VecGetSize(lines[d]->coords, &M); CHKERRQ(ierr);
+			ierr = PetibmGridlineHDF5ReadShared(
+				filepath, varname, names[d], M, &stations); CHKERRQ(ierr);
+			ierr = PetibmGridlineCopyOwned(stations, *lines[d]); CHKERRQ(ierr);
+			ierr = VecDestroy(&stations); CHKERRQ(ierr);
+		}
+		PetscFunctionReturn(0);
 	}
 
-	ierr = PetscViewerDestroy(&viewer); CHKERRQ(ierr);
+	// each copy of a gridline is read over its own communicator
+	ierr = PetibmGridlineHDF5Read(
+		filepath, varname, "x", grid.x.coords); CHKERRQ(ierr);
+	ierr = PetibmGridlineHDF5Read(
+		filepath, varname, "y", grid.y.coords); CHKERRQ(ierr);
+	if (grid.dim == 3)
+	{
+		ierr = PetibmGridlineHDF5Read(
+			filepath, varname, "z", grid.z.coords); CHKERRQ(ierr);
+	}
 
 	PetscFunctionReturn(0);
 } // PetibmGridHDF5Read
@@ -443,11 +770,13 @@ PetscErrorCode PetibmGridHDF5Read(
 /*! Reads the gridline stations from a file.
  *
  * The stations along the gridline should be stored in HDF5 format.
+ * Collective on the communicator of the vector.
  *
  * \param filepath The path of the input file.
  * \param varname The name of the variable.
  * \param name The name of the gridline (the direction).
- * \param line The sequential vector to fill (passed by reference).
+ * \param line The vector to fill, sequential or distributed (passed by
+ *        reference).
  */
 PetscErrorCode PetibmGridlineHDF5Read(
 	const std::string filepath, const std::string varname,
@@ -458,8 +787,9 @@ PetscErrorCode PetibmGridlineHDF5Read(
 
 	PetscFunctionBeginUser;
 
-	ierr = PetscViewerHDF5Open(
-		PETSC_COMM_SELF, filepath.c_str(), FILE_MODE_READ, &viewer); CHKERRQ(ierr);
+	ierr = PetscViewerHDF5Open(PetscObjectComm((PetscObject) line),
+	                           filepath.c_str(), FILE_MODE_READ,
+	                           &viewer); CHKERRQ(ierr);
 	ierr = PetscViewerHDF5PushGroup(viewer, varname.c_str()); CHKERRQ(ierr);
 	ierr = PetscObjectSetName(
 		(PetscObject) line, name.c_str()); CHKERRQ(ierr);
@@ -470,7 +800,169 @@ PetscErrorCode PetibmGridlineHDF5Read(
 } // PetibmGridlineHDF5Read
 
 
+/*! Creates a sequential vector with the gridline stations read from a file.
+ *
+ * Collective on PETSC_COMM_WORLD.
+ * The mode is set with the option `-replicated_read <rank|root|node>`
+ * (default: `rank`, every process reads the file).
+ * With `root` (or `node`), rank 0 (or one process per node) reads the file;
+ * the stations are broadcast to one process per node and held in a node-local
+ * MPI-3 shared-memory window that backs the vector of every process on the
+ * node.
+ * If the read or the broadcast fails, every process falls back to reading
+ * the file.
+ * The vector should be considered read-only; destroying it (on all processes)
+ * frees the window.
+ *
+ * \param filepath The path of the input file.
+ * \param varname The name of the variable.
+ * \param name The name of the gridline (the direction).
+ * \param n The number of stations along the gridline.
+ * \param line The sequential vector to create (passed by pointer).
+ */
+PetscErrorCode PetibmGridlineHDF5ReadShared(
+	const std::string filepath, const std::string varname,
+	const std::string name, const PetscInt n, Vec *line)
+{
+	PetscErrorCode ierr;
+	PetscInt mode;
+	PetscMPIInt rank, nodeRank, disp, status = 0, failed;
+	MPI_Comm nodeComm, leaderComm;
+	MPI_Win *win;
+	MPI_Aint size;
+	PetscReal *base;
+	PetscContainer container;
+
+	PetscFunctionBeginUser;
+
+	ierr = PetibmGetReplicatedReadMode(&mode); CHKERRQ(ierr);
+	if (mode == 0)
+	{
+		ierr = VecCreateSeq(PETSC_COMM_SELF, n, line); CHKERRQ(ierr);
+		ierr = PetibmGridlineHDF5Read(
+			filepath, varname, name, *line); CHKERRQ(ierr);
+		PetscFunctionReturn(0);
+	}
+
+	// processes on the same node, and one process (leader) per node
+	ierr = MPI_Comm_rank(PETSC_COMM_WORLD, &rank); CHKERRQ(ierr);
+	ierr = MPI_Comm_split_type(PETSC_COMM_WORLD, MPI_COMM_TYPE_SHARED, rank,
+	                           MPI_INFO_NULL, &nodeComm); CHKERRQ(ierr);
+	ierr = MPI_Comm_rank(nodeComm, &nodeRank); CHKERRQ(ierr);
+	ierr = MPI_Comm_split(PETSC_COMM_WORLD,
+	                      (nodeRank == 0) ? 0 : MPI_UNDEFINED, rank,
+	                      &leaderComm); CHKERRQ(ierr);
+
+	// the leader allocates the stations in the node-local window
+	ierr = PetscNew(&win); CHKERRQ(ierr);
+	ierr = MPI_Win_allocate_shared(
+		(nodeRank == 0) ? n*sizeof(PetscReal) : 0, sizeof(PetscReal),
+		MPI_INFO_NULL, nodeComm, &base, win); CHKERRQ(ierr);
+	ierr = MPI_Win_shared_query(*win, 0, &size, &disp, &base); CHKERRQ(ierr);
+	ierr = MPI_Win_fence(0, *win); CHKERRQ(ierr);
+
+	if (nodeRank == 0)
+	{
+		// read the file (rank 0 only, or every leader), errors are returned
+		if (mode == 2 or rank == 0)
+		{
+			Vec v;
+			ierr = VecCreateSeqWithArray(
+				PETSC_COMM_SELF, 1, n, base, &v); CHKERRQ(ierr);
+			ierr = PetscPushErrorHandler(
+				PetscReturnErrorHandler, nullptr); CHKERRQ(ierr);
+			status = PetibmGridlineHDF5Read(filepath, varname, name, v);
+			ierr = PetscPopErrorHandler(); CHKERRQ(ierr);
+			ierr = VecDestroy(&v); CHKERRQ(ierr);
+		}
+		// broadcast the stations from rank 0 to the other leaders
+		if (mode == 1)
+		{
+			ierr = MPI_Comm_set_errhandler(
+				leaderComm, MPI_ERRORS_RETURN); CHKERRQ(ierr);
+			ierr = MPI_Bcast(&status, 1, MPI_INT, 0, leaderComm); CHKERRQ(ierr);
+			if (!status)
+				status = MPI_Bcast(base, n, MPIU_REAL, 0, leaderComm);
+		}
+		ierr = MPI_Comm_free(&leaderComm); CHKERRQ(ierr);
+	}
+	ierr = MPI_Win_fence(0, *win); CHKERRQ(ierr);
+	ierr = MPI_Comm_free(&nodeComm); CHKERRQ(ierr);
+
+	ierr = MPI_Allreduce(&status, &failed, 1, MPI_INT, MPI_MAX,
+	                     PETSC_COMM_WORLD); CHKERRQ(ierr);
+	if (failed)
+	{
+		ierr = PetscInfo(nullptr, "Replicated read failed; "
+		                 "falling back to reads on every process\n"); CHKERRQ(ierr);
+		ierr = PetibmGridlineWindowDestroy(win); CHKERRQ(ierr);
+		ierr = VecCreateSeq(PETSC_COMM_SELF, n, line); CHKERRQ(ierr);
+		ierr = PetibmGridlineHDF5Read(
+			filepath, varname, name, *line); CHKERRQ(ierr);
+		PetscFunctionReturn(0);
+	}
+
+	// the vector keeps the window alive until it is destroyed
+	ierr = VecCreateSeqWithArray(
+		PETSC_COMM_SELF, 1, n, base, line); CHKERRQ(ierr);
+	ierr = PetscObjectSetName((PetscObject) *line, name.c_str()); CHKERRQ(ierr);
+	ierr = PetscContainerCreate(PETSC_COMM_SELF, &container); CHKERRQ(ierr);
+	ierr = PetscContainerSetPointer(container, win); CHKERRQ(ierr);
+	ierr = PetscContainerSetUserDestroy(
+		container, PetibmGridlineWindowDestroy); CHKERRQ(ierr);
+	ierr = PetscObjectCompose(
+		(PetscObject) *line, "window", (PetscObject) container); CHKERRQ(ierr);
+	ierr = PetscContainerDestroy(&container); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmGridlineHDF5ReadShared
+
+
+/*! Writes the stations of a gridline into a file in HDF5 format.
+ *
+ * Collective on PETSC_COMM_WORLD: only the copy of the gridline held by
+ * rank 0 is written, over the communicator of its vector; the file is
+ * closed before the function returns on any process.
+ *
+ * \param filepath Path of the output file.
+ * \param varname Name of the grid.
+ * \param name The name of the gridline (the direction).
+ * \param line The stations, sequential or distributed.
+ */
+static PetscErrorCode PetibmGridlineHDF5Write(
+	const std::string filepath, const std::string varname,
+	const std::string name, const Vec line)
+{
+	PetscErrorCode ierr;
+	MPI_Comm comm = PetscObjectComm((PetscObject) line);
+	PetscViewer viewer;
+	PetscMPIInt rank, root;
+
+	PetscFunctionBeginUser;
+
+	ierr = MPI_Comm_rank(PETSC_COMM_WORLD, &rank); CHKERRQ(ierr);
+	root = (rank == 0);
+	ierr = MPI_Allreduce(
+		MPI_IN_PLACE, &root, 1, MPI_INT, MPI_MAX, comm); CHKERRQ(ierr);
+	if (root)
+	{
+		ierr = PetscViewerHDF5Open(
+			comm, filepath.c_str(), FILE_MODE_APPEND, &viewer); CHKERRQ(ierr);
+		ierr = PetscViewerHDF5PushGroup(viewer, varname.c_str()); CHKERRQ(ierr);
+		ierr = PetscObjectSetName((PetscObject) line, name.c_str()); CHKERRQ(ierr);
+		ierr = VecView(line, viewer); CHKERRQ(ierr);
+		ierr = PetscViewerDestroy(&viewer); CHKERRQ(ierr);
+	}
+	ierr = MPI_Barrier(PETSC_COMM_WORLD); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmGridlineHDF5Write
+
+
 /*! Writes the gridlines into file in HDF5 format.
+ *
+ * Collective on PETSC_COMM_WORLD: only the copy of each gridline held by
+ * rank 0 is written, over the communicator of its vector.
  *
  * \param filepath Path of the output file.
  * \param varname Name of the grid.
@@ -480,27 +972,18 @@ PetscErrorCode PetibmGridHDF5Write(
 	const std::string filepath, const std::string varname, const PetibmGrid grid)
 {
 	PetscErrorCode ierr;
-	PetscViewer viewer;
 
 	PetscFunctionBeginUser;
 
-	ierr = PetscViewerHDF5Open(
-		PETSC_COMM_SELF, filepath.c_str(), FILE_MODE_APPEND, &viewer); CHKERRQ(ierr);
-	ierr = PetscViewerHDF5PushGroup(viewer, varname.c_str()); CHKERRQ(ierr);
-	// write x-stations
-	ierr = PetscObjectSetName((PetscObject) grid.x.coords, "x"); CHKERRQ(ierr);
-	ierr = VecView(grid.x.coords, viewer); CHKERRQ(ierr);
-	// write y-stations
-	ierr = PetscObjectSetName((PetscObject) grid.y.coords, "y"); CHKERRQ(ierr);
-	ierr = VecView(grid.y.coords, viewer); CHKERRQ(ierr);
+	ierr = PetibmGridlineHDF5Write(
+		filepath, varname, "x", grid.x.coords); CHKERRQ(ierr);
+	ierr = PetibmGridlineHDF5Write(
+		filepath, varname, "y", grid.y.coords); CHKERRQ(ierr);
 	if (grid.dim == 3)
 	{
-		// write z-stations
-		ierr = PetscObjectSetName((PetscObject) grid.z.coords, "z"); CHKERRQ(ierr);
-		ierr = VecView(grid.z.coords, viewer); CHKERRQ(ierr);
+		ierr = PetibmGridlineHDF5Write(
+			filepath, varname, "z", grid.z.coords); CHKERRQ(ierr);
 	}
 
-	ierr = PetscViewerDestroy(&viewer); CHKERRQ(ierr);
-
 	PetscFunctionReturn(0);
 } // PetibmGridHDF5Write
@@ -0,0 +1,480 @@
+/*! Implementation of the functions to render 2D fields into images.
+ * \file image.cpp
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+
+#include "petibm-utilities/image.h"
+#include "petibm-utilities/misc.h"
+
+
+/*! Names of the colormaps.
+ */
+static const char *const PetibmImageColormaps[] = {
+	"gray", "viridis", "coolwarm", "jet"};
+
+
+/*! Names of the image formats (also used as file extensions).
+ */
+static const char *const PetibmImageFormats[] = {"ppm", "png"};
+
+
+/*! Colors of the colormaps, uniformly spaced between the lower and upper ends.
+ */
+static const unsigned char PetibmColormapGray[][3] = {
+	{0, 0, 0}, {255, 255, 255}};
+static const unsigned char PetibmColormapViridis[][3] = {
+	{68, 1, 84}, {71, 44, 122}, {59, 81, 139}, {44, 113, 142}, {33, 144, 141},
+	{39, 173, 129}, {92, 200, 99}, {170, 220, 50}, {253, 231, 37}};
+static const unsigned char PetibmColormapCoolwarm[][3] = {
+	{59, 76, 192}, {221, 221, 221}, {180, 4, 38}};
+static const unsigned char PetibmColormapJet[][3] = {
+	{0, 0, 128}, {0, 0, 255}, {0, 128, 255}, {0, 255, 255}, {128, 255, 128},
+	{255, 255, 0}, {255, 128, 0}, {255, 0, 0}, {128, 0, 0}};
+static const struct
+{
+	const unsigned char (*colors)[3];
+	PetscInt n;
+} PetibmColormapTables[] = {
+	{PetibmColormapGray, 2}, {PetibmColormapViridis, 9},
+	{PetibmColormapCoolwarm, 3}, {PetibmColormapJet, 9}};
+
+
+/*! Gets options from command-line or config file.
+ *
+ * `-colormap <gray|viridis|coolwarm|jet>`, `-format <ppm|png>`,
+ * `-width <pixels>`, `-min <value>`, and `-max <value>`.
+ *
+ * \param prefix String to prepend to options.
+ * \param ctx The PetibmImageCtx structure to fill (passed by pointer).
+ */
+PetscErrorCode PetibmImageGetOptions(
+	const char prefix[], PetibmImageCtx *ctx)
+{
+	PetscErrorCode ierr;
+	char path[PETSC_MAX_PATH_LEN];
+	PetscBool found;
+
+	PetscFunctionBeginUser;
+
+	// get path of configuration file
+	ierr = PetscOptionsGetString(nullptr, prefix, "-config_file",
+	                             path, sizeof(path), &found); CHKERRQ(ierr);
+	if (found)
+	{
+		ierr = PetibmOptionsInsertFile(path); CHKERRQ(ierr);
+	}
+	// get colormap
+	ierr = PetscOptionsGetEList(nullptr, prefix, "-colormap",
+	                            PetibmImageColormaps, 4,
+	                            &ctx->colormap, &found); CHKERRQ(ierr);
+	// get image format
+	ierr = PetscOptionsGetEList(nullptr, prefix, "-format",
+	                            PetibmImageFormats, 2,
+	                            &ctx->format, &found); CHKERRQ(ierr);
+	// get width of the image
+	ierr = PetscOptionsGetInt(
+		nullptr, prefix, "-width", &ctx->width, &found); CHKERRQ(ierr);
+	// get range of values
+	ierr = PetscOptionsGetReal(
+		nullptr, prefix, "-min", &ctx->min, &found); CHKERRQ(ierr);
+	ierr = PetscOptionsGetReal(
+		nullptr, prefix, "-max", &ctx->max, &found); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmImageGetOptions
+
+
+/*! Gets the file extension of the image format.
+ *
+ * \param ctx The image context.
+ * \param extension The extension, without the dot (passed by pointer).
+ */
+PetscErrorCode PetibmImageGetExtension(
+	const PetibmImageCtx ctx, std::string *extension)
+{
+	PetscFunctionBeginUser;
+
+	*extension = PetibmImageFormats[ctx.format];
+
+	PetscFunctionReturn(0);
+} // PetibmImageGetExtension
+
+
+/*! Gets the range of pixels whose center lies in the part of a gridline owned
+ * by the process.
+ *
+ * The process owns the coordinates in [s[xs], s[xs+xm]), or up to the last
+ * station included if it owns the end of the gridline.
+ * The coordinate of the center of pixel p is start + (p + 0.5) * step.
+ *
+ * \param s All the stations along the gridline.
+ * \param M Number of stations.
+ * \param xs Index of the first station owned by the process.
+ * \param xm Number of stations owned by the process.
+ * \param start Coordinate of the edge of the first pixel.
+ * \param step Size of a pixel (negative if coordinates decrease with the index).
+ * \param n Number of pixels.
+ * \param p0 First pixel owned (passed by pointer).
+ * \param p1 One past the last pixel owned (passed by pointer).
+ */
+static PetscErrorCode PetibmImagePixelRange(
+	const PetscReal *s, const PetscInt M, const PetscInt xs, const PetscInt xm,
+	const PetscReal start, const PetscReal step, const PetscInt n,
+	PetscInt *p0, PetscInt *p1)
+{
+	PetscInt p, end = PetscMin(xs + xm, M - 1);
+	PetscReal c;
+	PetscBool owned;
+
+	PetscFunctionBeginUser;
+
+	*p0 = *p1 = 0;
+	for (p=0; p<n; p++)
+	{
+		c = PetscMin(PetscMax(start + (p + 0.5) * step, s[0]), s[M-1]);
+		owned = (PetscBool) (s[xs] <= c and
+		                     (c < s[end] or (end == M - 1 and c == s[end])));
+		if (owned and *p1 == *p0)
+			*p0 = p;
+		if (owned)
+			*p1 = p + 1;
+	}
+
+	PetscFunctionReturn(0);
+} // PetibmImagePixelRange
+
+
+/*! Renders a colormapped image of a 2D field.
+ *
+ * Collective on the communicator of the field.
+ * The pixels are uniformly distributed over the domain covered by the
+ * stations (the height follows the aspect ratio of the domain) and the field
+ * is interpolated bi-linearly at their centers.
+ * Each process rasterizes the pixels whose center lies in the part of the
+ * domain it owns (a rectangle of pixels); the rectangles are composited on
+ * the first process.
+ *
+ * \param ctx The image context.
+ * \param field The 2D field to render (passed by reference).
+ * \param stations Sequential vectors with all the stations in the x- and y-directions.
+ * \param image The image (passed by reference).
+ */
+PetscErrorCode PetibmImageRender(
+	const PetibmImageCtx ctx, PetibmField &field, const Vec stations[],
+	PetibmImage &image)
+{
+	PetscErrorCode ierr;
+	MPI_Comm comm;
+	PetscMPIInt rank, size, r, count;
+	PetscInt M, N, xs, ys, xm, ym, endx, endy, rect[4], p, q, I, J, k, c;
+	const PetscReal *x, *y;
+	PetscReal **v, dx, dy, cx, cy, wx, wy, value, vmin, vmax, t;
+	std::vector<unsigned char> rgb, gathered;
+	std::vector<PetscInt> rects;
+	std::vector<PetscMPIInt> counts, displs;
+	const unsigned char (*colors)[3] = PetibmColormapTables[ctx.colormap].colors;
+	const PetscInt ncolors = PetibmColormapTables[ctx.colormap].n;
+
+	PetscFunctionBeginUser;
+
+	ierr = PetscObjectGetComm((PetscObject) field.da, &comm); CHKERRQ(ierr);
+	ierr = MPI_Comm_rank(comm, &rank); CHKERRQ(ierr);
+	ierr = MPI_Comm_size(comm, &size); CHKERRQ(ierr);
+	ierr = DMDAGetInfo(field.da,
+	                   nullptr,
+	                   &M, &N, nullptr,
+	                   nullptr, nullptr, nullptr,
+	                   nullptr, nullptr,
+	                   nullptr, nullptr, nullptr,
+	                   nullptr); CHKERRQ(ierr);
+	ierr = DMDAGetCorners(
+		field.da, &xs, &ys, nullptr, &xm, &ym, nullptr); CHKERRQ(ierr);
+	endx = PetscMin(xs + xm, M - 1);
+	endy = PetscMin(ys + ym, N - 1);
+
+	// range of values mapped onto the colormap
+	vmin = ctx.min;
+	vmax = ctx.max;
+	if (vmin == vmax)
+	{
+		ierr = VecMin(field.global, nullptr, &vmin); CHKERRQ(ierr);
+		ierr = VecMax(field.global, nullptr, &vmax); CHKERRQ(ierr);
+	}
+	if (vmin == vmax)
+		vmax = vmin + 1.0;
+
+	// size of the image and pixels owned by the process (top row first)
+	ierr = VecGetArrayRead(stations[0], &x); CHKERRQ(ierr);
+	ierr = VecGetArrayRead(stations[1], &y); CHKERRQ(ierr);
+	image.width = (ctx.width > 0) ? ctx.width : M;
+	image.height = PetscMax(1, (PetscInt) std::round(
+		image.width * (y[N-1] - y[0]) / (x[M-1] - x[0])));
+	dx = (x[M-1] - x[0]) / image.width;
+	dy = -(y[N-1] - y[0]) / image.height;
+	ierr = PetibmImagePixelRange(x, M, xs, xm, x[0], dx, image.width,
+	                             &rect[0], &rect[1]); CHKERRQ(ierr);
+	ierr = PetibmImagePixelRange(y, N, ys, ym, y[N-1], dy, image.height,
+	                             &rect[2], &rect[3]); CHKERRQ(ierr);
+
+	// rasterize the pixels owned by the process
+	rgb.resize(3 * (rect[1] - rect[0]) * (rect[3] - rect[2]));
+	ierr = PetibmFieldGetLocal(field); CHKERRQ(ierr);
+	ierr = DMDAVecGetArray(field.da, field.local, &v); CHKERRQ(ierr);
+	k = 0;
+	for (q=rect[2]; q<rect[3]; q++)
+	{
+		cy = PetscMin(PetscMax(y[N-1] + (q + 0.5) * dy, y[0]), y[N-1]);
+		J = std::upper_bound(y + ys, y + endy, cy) - y - 1;
+		wy = (cy - y[J]) / (y[J+1] - y[J]);
+		for (p=rect[0]; p<rect[1]; p++)
+		{
+			cx = PetscMin(PetscMax(x[0] + (p + 0.5) * dx, x[0]), x[M-1]);
+			I = std::upper_bound(x + xs, x + endx, cx) - x - 1;
+			wx = (cx - x[I]) / (x[I+1] - x[I]);
+			value = ((1.0 - wy) * ((1.0 - wx) * v[J][I] + wx * v[J][I+1]) +
+			         wy * ((1.0 - wx) * v[J+1][I] + wx * v[J+1][I+1]));
+			// position in the colormap (NaN mapped to the lower end)
+			t = (value - vmin) / (vmax - vmin) * (ncolors - 1);
+			t = (t > 0.0) ? PetscMin(t, (PetscReal) (ncolors - 1)) : 0.0;
+			I = PetscMin((PetscInt) t, ncolors - 2);
+			t -= I;
+			for (c=0; c<3; c++)
+				rgb[k++] = (unsigned char) std::lround(
+					(1.0 - t) * colors[I][c] + t * colors[I+1][c]);
+		}
+	}
+	ierr = DMDAVecRestoreArray(field.da, field.local, &v); CHKERRQ(ierr);
+	ierr = PetibmFieldRestoreLocal(field); CHKERRQ(ierr);
+	ierr = VecRestoreArrayRead(stations[0], &x); CHKERRQ(ierr);
+	ierr = VecRestoreArrayRead(stations[1], &y); CHKERRQ(ierr);
+
+	// composite the rectangles of pixels on the first process
+	image.owner = (PetscBool) (rank == 0);
+	if (image.owner)
+	{
+		rects.resize(4 * size);
+		counts.resize(size);
+		displs.resize(size);
+	}
+	ierr = MPI_Gather(rect, 4, MPIU_INT, rects.data(), 4, MPIU_INT,
+	                  0, comm); CHKERRQ(ierr);
+	for (r=0, count=0; r<(PetscMPIInt) counts.size(); r++)
+	{
+		counts[r] = 3 * ((rects[4*r+1] - rects[4*r]) *
+		                 (rects[4*r+3] - rects[4*r+2]));
+		displs[r] = count;
+		count += counts[r];
+	}
+	if (image.owner)
+		gathered.resize(count);
+	ierr = MPI_Gatherv(rgb.data(), rgb.size(), MPI_UNSIGNED_CHAR,
+	                   gathered.data(), counts.data(), displs.data(),
+	                   MPI_UNSIGNED_CHAR, 0, comm); CHKERRQ(ierr);
+	if (!image.owner)
+	{
+		image.pixels.clear();
+		PetscFunctionReturn(0);
+	}
+	image.pixels.assign(3 * image.width * image.height, 0);
+	for (r=0; r<size; r++)
+	{
+		k = displs[r];
+		for (q=rects[4*r+2]; q<rects[4*r+3]; q++)
+		{
+			c = 3 * (rects[4*r+1] - rects[4*r]);
+			std::copy(gathered.begin() + k, gathered.begin() + k + c,
+			          image.pixels.begin() + 3 * (q * image.width + rects[4*r]));
+			k += c;
+		}
+	}
+
+	PetscFunctionReturn(0);
+} // PetibmImageRender
+
+
+/*! Writes an image into a file.
+ *
+ * Nothing is done on the processes that do not hold the pixels.
+ *
+ * \param filepath Path of the output file.
+ * \param ctx The image context (to get the format).
+ * \param image The image.
+ */
+PetscErrorCode PetibmImageWrite(
+	const std::string filepath, const PetibmImageCtx ctx,
+	const PetibmImage &image)
+{
+	PetscErrorCode ierr;
+
+	PetscFunctionBeginUser;
+
+	if (ctx.format == 1)
+	{
+		ierr = PetibmImagePNGWrite(filepath, image); CHKERRQ(ierr);
+	}
+	else
+	{
+		ierr = PetibmImagePPMWrite(filepath, image); CHKERRQ(ierr);
+	}
+
+	PetscFunctionReturn(0);
+} // PetibmImageWrite
+
+
+/*! Writes an image into a binary PPM file (P6).
+ *
+ * \param filepath Path of the output file.
+ * \param image The image.
+ */
+PetscErrorCode PetibmImagePPMWrite(
+	const std::string filepath, const PetibmImage &image)
+{
+	PetscFunctionBeginUser;
+
+	if (!image.owner)
+		PetscFunctionReturn(0);
+	std::ofstream outfile(filepath.c_str(), std::ios::binary);
+	if (!outfile.good())
+		SETERRQ(PETSC_COMM_SELF, PETSC_ERR_FILE_OPEN, "Cannot open the image file");
+	outfile << "P6\n" << image.width << " " << image.height << "\n255\n";
+	outfile.write((const char *) image.pixels.data(), image.pixels.size());
+
+	PetscFunctionReturn(0);
+} // PetibmImagePPMWrite
+
+
+/*! Updates the CRC-32 (as defined for PNG chunks) with a sequence of bytes.
+ *
+ * \param crc The CRC to update.
+ * \param data The bytes.
+ * \param n Number of bytes.
+ */
+static uint32_t PetibmPNGCrc(
+	uint32_t crc, const unsigned char *data, const std::size_t n)
+{
+	static uint32_t table[256];
+	static bool ready = false;
+	uint32_t c;
+
+	if (!ready)
+	{
+		for (uint32_t i=0; i<256; i++)
+		{
+			c = i;
+			for (int b=0; b<8; b++)
+				c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+			table[i] = c;
+		}
+		ready = true;
+	}
+	for (std::size_t i=0; i<n; i++)
+		crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+
+	return crc;
+} // PetibmPNGCrc
+
+
+/*! Appends a 32-bit unsigned integer in big-endian order.
+ *
+ * \param value The integer.
+ * \param bytes The sequence of bytes (passed by reference).
+ */
+static void PetibmPNGPush32(
+	const uint32_t value, std::vector<unsigned char> &bytes)
+{
+	for (int s=24; s>=0; s-=8)
+		bytes.push_back((value >> s) & 0xff);
+} // PetibmPNGPush32
+
+
+/*! Writes a PNG chunk (length, type, data, and CRC).
+ *
+ * \param outfile The output stream (passed by reference).
+ * \param type The type of the chunk (4 characters).
+ * \param data The data of the chunk.
+ */
+static void PetibmPNGWriteChunk(
+	std::ofstream &outfile, const char type[],
+	const std::vector<unsigned char> &data)
+{
+	std::vector<unsigned char> bytes;
+
+	PetibmPNGPush32(data.size(), bytes);
+	bytes.insert(bytes.end(), type, type + 4);
+	bytes.insert(bytes.end(), data.begin(), data.end());
+	PetibmPNGPush32(
+		PetibmPNGCrc(0xffffffffu, &bytes[4], bytes.size() - 4) ^ 0xffffffffu,
+		bytes);
+	outfile.write((const char *) bytes.data(), bytes.size());
+} // PetibmPNGWriteChunk
+
+
+/*! Writes an image into a PNG file.
+ *
+ * The encoder is self-contained: the zlib stream is made of stored
+ * (uncompressed) deflate blocks.
+ *
+ * \param filepath Path of the output file.
+ * \param image The image.
+ */
+PetscErrorCode PetibmImagePNGWrite(
+	const std::string filepath, const PetibmImage &image)
+{
+	const unsigned char signature[] = {137, 80, 78, 71, 13, 10, 26, 10};
+	const std::size_t rowSize = 3 * image.width;
+	std::vector<unsigned char> header, raw, stream;
+	std::size_t i, n;
+	uint32_t a = 1, b = 0;
+
+	PetscFunctionBeginUser;
+
+	if (!image.owner)
+		PetscFunctionReturn(0);
+	std::ofstream outfile(filepath.c_str(), std::ios::binary);
+	if (!outfile.good())
+		SETERRQ(PETSC_COMM_SELF, PETSC_ERR_FILE_OPEN, "Cannot open the image file");
+	outfile.write((const char *) signature, sizeof(signature));
+
+	// header: 8-bit RGB, no interlacing
+	PetibmPNGPush32(image.width, header);
+	PetibmPNGPush32(image.height, header);
+	header.insert(header.end(), {8, 2, 0, 0, 0});
+	PetibmPNGWriteChunk(outfile, "IHDR", header);
+
+	// scanlines, each preceded by the filter type (none)
+	raw.reserve((rowSize + 1) * image.height);
+	for (i=0; i<(std::size_t) image.height; i++)
+	{
+		raw.push_back(0);
+		raw.insert(raw.end(), image.pixels.begin() + i * rowSize,
+		           image.pixels.begin() + (i + 1) * rowSize);
+	}
+	// zlib stream with stored blocks of at most 65535 bytes
+	stream.reserve(raw.size() + 5 * (raw.size() / 65535 + 1) + 6);
+	stream.push_back(0x78);
+	stream.push_back(0x01);
+	for (i=0; i<raw.size(); i+=n)
+	{
+		n = std::min<std::size_t>(65535, raw.size() - i);
+		stream.push_back((i + n == raw.size()) ? 1 : 0);
+		stream.push_back(n & 0xff);
+		stream.push_back((n >> 8) & 0xff);
+		stream.push_back(~n & 0xff);
+		stream.push_back((~n >> 8) & 0xff);
+		stream.insert(stream.end(), raw.begin() + i, raw.begin() + i + n);
+	}
+	for (auto byte : raw)
+	{
+		a = (a + byte) % 65521;
+		b = (b + a) % 65521;
+	}
+	PetibmPNGPush32((b << 16) | a, stream);
+	PetibmPNGWriteChunk(outfile, "IDAT", stream);
+	PetibmPNGWriteChunk(outfile, "IEND", std::vector<unsigned char>());
+
+	PetscFunctionReturn(0);
+} // PetibmImagePNGWrite
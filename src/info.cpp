@@ -0,0 +1,482 @@
+/*! Implementation of the functions to inspect the metadata of files.
+ * \file info.cpp
+ */
+
+#include <fstream>
+#include <sstream>
+
+#include <petscvec.h>
+#include <petscviewerhdf5.h>
+
+#include "petibm-utilities/field.h"
+#include "petibm-utilities/info.h"
+
+
+/*! Broadcasts the metadata of datasets from rank 0.
+ *
+ * The metadata are packed as one line per dataset (name, type, shape, chunk).
+ *
+ * \param datasets The metadata (passed by reference).
+ */
+static PetscErrorCode PetibmInfoBcast(std::vector<PetibmDatasetInfo> &datasets)
+{
+	PetscErrorCode ierr;
+	std::string packed, line;
+	PetscMPIInt rank, length;
+	PetscInt n, v;
+
+	PetscFunctionBeginUser;
+
+	ierr = MPI_Comm_rank(PETSC_COMM_WORLD, &rank); CHKERRQ(ierr);
+	if (rank == 0)
+	{
+		std::ostringstream ss;
+		for (auto &info : datasets)
+		{
+			ss << info.name << "\t" << info.type << "\t" << info.shape.size();
+			for (auto &s : info.shape)
+				ss << " " << s;
+			ss << "\t" << info.chunk.size();
+			for (auto &c : info.chunk)
+				ss << " " << c;
+			ss << "\n";
+		}
+		packed = ss.str();
+	}
+	length = packed.size();
+	ierr = MPI_Bcast(&length, 1, MPI_INT, 0, PETSC_COMM_WORLD); CHKERRQ(ierr);
+	packed.resize(length);
+	ierr = MPI_Bcast(&packed[0], length, MPI_CHAR, 0, PETSC_COMM_WORLD); CHKERRQ(ierr);
+	if (rank == 0)
+		PetscFunctionReturn(0);
+
+	datasets.clear();
+	std::istringstream ss(packed);
+	while (std::getline(ss, line))
+	{
+		PetibmDatasetInfo info;
+		std::istringstream ls(line);
+		std::getline(ls, info.name, '\t');
+		std::getline(ls, info.type, '\t');
+		ls >> n;
+		for (; n>0 and ls >> v; n--)
+			info.shape.push_back(v);
+		ls >> n;
+		for (; n>0 and ls >> v; n--)
+			info.chunk.push_back(v);
+		datasets.push_back(info);
+	}
+
+	PetscFunctionReturn(0);
+} // PetibmInfoBcast
+
+
+/*! Describes the type of the values of a dataset (e.g., float64, int32).
+ *
+ * \param dset Identifier of the dataset.
+ */
+static std::string PetibmInfoHDF5Type(const hid_t dset)
+{
+	hid_t type = H5Dget_type(dset);
+	std::string kind;
+
+	switch (H5Tget_class(type))
+	{
+		case H5T_FLOAT:
+			kind = "float";
+			break;
+		case H5T_INTEGER:
+			kind = (H5Tget_sign(type) == H5T_SGN_NONE) ? "uint" : "int";
+			break;
+		case H5T_STRING:
+			kind = "string";
+			break;
+		default:
+			kind = "other";
+	}
+	kind += std::to_string(8 * H5Tget_size(type));
+	H5Tclose(type);
+
+	return kind;
+} // PetibmInfoHDF5Type
+
+
+/*! Collects the metadata of a dataset (callback of H5Lvisit).
+ *
+ * \param group Identifier of the group holding the link.
+ * \param name Path of the link relative to the group visited.
+ * \param data Pointer to the vector of metadata.
+ */
+static herr_t PetibmInfoHDF5Visit(
+	hid_t group, const char *name, const H5L_info_t *, void *data)
+{
+	std::vector<PetibmDatasetInfo> *datasets =
+		static_cast<std::vector<PetibmDatasetInfo> *>(data);
+	PetibmDatasetInfo dataset;
+	hid_t obj, space, dcpl;
+	hsize_t dims[H5S_MAX_RANK];
+	int ndims, d;
+
+	obj = H5Oopen(group, name, H5P_DEFAULT);
+	if (obj < 0)
+		return 0;
+	if (H5Iget_type(obj) != H5I_DATASET)
+	{
+		H5Oclose(obj);
+		return 0;
+	}
+	dataset.name = name;
+	dataset.type = PetibmInfoHDF5Type(obj);
+	space = H5Dget_space(obj);
+	ndims = H5Sget_simple_extent_ndims(space);
+	H5Sget_simple_extent_dims(space, dims, nullptr);
+	for (d=0; d<ndims; d++)
+		dataset.shape.push_back(dims[d]);
+	H5Sclose(space);
+	dcpl = H5Dget_create_plist(obj);
+	if (H5Pget_layout(dcpl) == H5D_CHUNKED)
+	{
+		ndims = H5Pget_chunk(dcpl, H5S_MAX_RANK, dims);
+		for (d=0; d<ndims; d++)
+			dataset.chunk.push_back(dims[d]);
+	}
+	H5Pclose(dcpl);
+	H5Oclose(obj);
+	datasets->push_back(dataset);
+
+	return 0;
+} // PetibmInfoHDF5Visit
+
+
+/*! Gets the shape of a dataset in an HDF5 file, without reading the values.
+ *
+ * Collective on PETSC_COMM_WORLD; rank 0 reads the header and broadcasts the
+ * shape, which is left empty if the file or the dataset does not exist.
+ *
+ * \param filepath Path of the file.
+ * \param name Path of the dataset in the file.
+ * \param shape The shape, slowest dimension first (passed by reference).
+ */
+PetscErrorCode PetibmInfoHDF5GetShape(
+	const std::string filepath, const std::string name,
+	std::vector<PetscInt> &shape)
+{
+	PetscErrorCode ierr;
+	PetscMPIInt rank;
+	PetscInt ndims = 0, d;
+	hid_t file, dset, space;
+	hsize_t dims[H5S_MAX_RANK];
+	size_t pos;
+
+	PetscFunctionBeginUser;
+
+	ierr = MPI_Comm_rank(PETSC_COMM_WORLD, &rank); CHKERRQ(ierr);
+	shape.clear();
+	if (rank == 0 and std::ifstream(filepath.c_str()).good())
+	{
+		file = H5Fopen(filepath.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+		// every group along the path should exist for the link to be checked
+		for (pos=name.find('/', 1); file >= 0 and pos != std::string::npos;
+		     pos=name.find('/', pos+1))
+			if (H5Lexists(file, name.substr(0, pos).c_str(), H5P_DEFAULT) <= 0)
+				break;
+		if (file >= 0 and pos == std::string::npos and
+		    H5Lexists(file, name.c_str(), H5P_DEFAULT) > 0)
+		{
+			dset = H5Dopen2(file, name.c_str(), H5P_DEFAULT);
+			space = H5Dget_space(dset);
+			ndims = H5Sget_simple_extent_ndims(space);
+			H5Sget_simple_extent_dims(space, dims, nullptr);
+			for (d=0; d<ndims; d++)
+				shape.push_back(dims[d]);
+			H5Sclose(space);
+			H5Dclose(dset);
+		}
+		if (file >= 0)
+			H5Fclose(file);
+	}
+	ierr = MPI_Bcast(&ndims, 1, MPIU_INT, 0, PETSC_COMM_WORLD); CHKERRQ(ierr);
+	shape.resize(ndims);
+	ierr = MPI_Bcast(
+		shape.data(), ndims, MPIU_INT, 0, PETSC_COMM_WORLD); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmInfoHDF5GetShape
+
+
+/*! Computes the range of a dataset from a subset of its indices, in parallel.
+ *
+ * The indices selected along the first dimension are split among the
+ * processes, which read their hyperslab collectively.
+ *
+ * \param file Identifier of the HDF5 file (opened on PETSC_COMM_WORLD).
+ * \param sample Stride of the indices read along the first dimension.
+ * \param dataset The metadata of the dataset (passed by reference).
+ */
+static PetscErrorCode PetibmInfoHDF5Range(
+	const hid_t file, const PetscInt sample, PetibmDatasetInfo &dataset)
+{
+	PetscErrorCode ierr;
+	PetscMPIInt rank, size;
+	PetscInt nsel, first, count, d;
+	PetscReal range[2] = {PETSC_MAX_REAL, PETSC_MAX_REAL};
+	std::vector<PetscReal> values;
+	hid_t dset, fspace, mspace, dxpl,
+	      mtype = (sizeof(PetscReal) == sizeof(double)) ?
+	              H5T_NATIVE_DOUBLE : H5T_NATIVE_FLOAT;
+	hsize_t start[H5S_MAX_RANK], stride[H5S_MAX_RANK], counts[H5S_MAX_RANK],
+	        nvalues = 1;
+	herr_t status;
+
+	PetscFunctionBeginUser;
+
+	if (dataset.type.compare(0, 5, "float") != 0 and
+	    dataset.type.compare(0, 3, "int") != 0 and
+	    dataset.type.compare(0, 4, "uint") != 0)
+		PetscFunctionReturn(0);
+	ierr = MPI_Comm_rank(PETSC_COMM_WORLD, &rank); CHKERRQ(ierr);
+	ierr = MPI_Comm_size(PETSC_COMM_WORLD, &size); CHKERRQ(ierr);
+
+	dset = H5Dopen2(file, dataset.name.c_str(), H5P_DEFAULT);
+	if (dset < 0)
+		SETERRQ(PETSC_COMM_SELF, PETSC_ERR_FILE_UNEXPECTED,
+		        "Cannot open the dataset");
+	fspace = H5Dget_space(dset);
+	if (dataset.shape.empty())
+	{
+		// scalar dataset: read by rank 0 only
+		nvalues = (rank == 0) ? 1 : 0;
+		if (rank != 0)
+			H5Sselect_none(fspace);
+		mspace = H5Screate_simple(1, &nvalues, nullptr);
+	}
+	else
+	{
+		// indices 0, sample, 2*sample, ... along the first dimension
+		nsel = (dataset.shape[0] + sample - 1) / sample;
+		count = nsel / size + ((rank < nsel % size) ? 1 : 0);
+		first = rank * (nsel / size) + PetscMin(rank, nsel % size);
+		start[0] = first * sample;
+		stride[0] = sample;
+		counts[0] = count;
+		nvalues = count;
+		for (d=1; d<(PetscInt) dataset.shape.size(); d++)
+		{
+			start[d] = 0;
+			stride[d] = 1;
+			counts[d] = dataset.shape[d];
+			nvalues *= counts[d];
+		}
+		if (count > 0)
+			H5Sselect_hyperslab(
+				fspace, H5S_SELECT_SET, start, stride, counts, nullptr);
+		else
+			H5Sselect_none(fspace);
+		mspace = H5Screate_simple(1, &nvalues, nullptr);
+	}
+	values.resize(nvalues);
+	dxpl = H5Pcreate(H5P_DATASET_XFER);
+#if defined(H5_HAVE_PARALLEL)
+	H5Pset_dxpl_mpio(dxpl, H5FD_MPIO_COLLECTIVE);
+#endif
+	status = H5Dread(dset, mtype, mspace, fspace, dxpl, values.data());
+	H5Pclose(dxpl);
+	H5Sclose(mspace);
+	H5Sclose(fspace);
+	H5Dclose(dset);
+	if (status < 0)
+		SETERRQ(PETSC_COMM_SELF, PETSC_ERR_FILE_READ, "Cannot read the dataset");
+
+	// minimum and (negated) maximum reduced together
+	for (auto &v : values)
+	{
+		range[0] = PetscMin(range[0], v);
+		range[1] = PetscMin(range[1], -v);
+	}
+	ierr = MPI_Allreduce(MPI_IN_PLACE, range, 2, MPIU_REAL, MPI_MIN,
+	                     PETSC_COMM_WORLD); CHKERRQ(ierr);
+	dataset.min = range[0];
+	dataset.max = -range[1];
+	dataset.ranged = PETSC_TRUE;
+
+	PetscFunctionReturn(0);
+} // PetibmInfoHDF5Range
+
+
+/*! Gets the metadata of all the datasets of an HDF5 file.
+ *
+ * Collective on PETSC_COMM_WORLD; rank 0 walks the headers and broadcasts
+ * them.
+ * With `sample` greater than 0, the range of the values of each dataset is
+ * computed from every `sample`-th index along its first dimension, the
+ * selected indices being read in parallel (hyperslab per process).
+ *
+ * \param filepath Path of the file.
+ * \param sample Stride of the indices read along the first dimension (0: no range).
+ * \param datasets The metadata of the datasets (passed by reference).
+ */
+PetscErrorCode PetibmInfoHDF5Read(
+	const std::string filepath, const PetscInt sample,
+	std::vector<PetibmDatasetInfo> &datasets)
+{
+	PetscErrorCode ierr;
+	PetscMPIInt rank;
+	PetscViewer viewer;
+	hid_t file;
+
+	PetscFunctionBeginUser;
+
+	ierr = MPI_Comm_rank(PETSC_COMM_WORLD, &rank); CHKERRQ(ierr);
+	datasets.clear();
+	if (rank == 0)
+	{
+		file = H5Fopen(filepath.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+		if (file >= 0)
+		{
+			H5Lvisit(file, H5_INDEX_NAME, H5_ITER_INC,
+			         PetibmInfoHDF5Visit, &datasets);
+			H5Fclose(file);
+		}
+	}
+	ierr = PetibmInfoBcast(datasets); CHKERRQ(ierr);
+	if (sample <= 0 or datasets.empty())
+		PetscFunctionReturn(0);
+
+	ierr = PetscViewerHDF5Open(PETSC_COMM_WORLD, filepath.c_str(),
+	                           FILE_MODE_READ, &viewer); CHKERRQ(ierr);
+	ierr = PetscViewerHDF5GetFileId(viewer, &file); CHKERRQ(ierr);
+	for (auto &dataset : datasets)
+	{
+		ierr = PetibmInfoHDF5Range(file, sample, dataset); CHKERRQ(ierr);
+	}
+	ierr = PetscViewerDestroy(&viewer); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmInfoHDF5Read
+
+
+/*! Gets the metadata of the vector stored in a PETSc binary file.
+ *
+ * Collective on PETSC_COMM_WORLD; rank 0 reads the header (and the
+ * decomposition header of a file in native layout, which gives the shape).
+ * With `range`, the vector is loaded in parallel to compute its range.
+ *
+ * \param filepath Path of the file.
+ * \param range Compute the range of the values?
+ * \param datasets The metadata of the vector (passed by reference).
+ */
+PetscErrorCode PetibmInfoBinaryRead(
+	const std::string filepath, const PetscBool range,
+	std::vector<PetibmDatasetInfo> &datasets)
+{
+	PetscErrorCode ierr;
+	PetscViewer viewer;
+	PetibmDatasetInfo dataset;
+	std::vector<PetscInt> header(9);
+	PetscInt classid, npad = 0, nskip = 0, d;
+	Vec vec;
+
+	PetscFunctionBeginUser;
+
+	ierr = PetscViewerBinaryOpen(PETSC_COMM_WORLD, filepath.c_str(),
+	                             FILE_MODE_READ, &viewer); CHKERRQ(ierr);
+	ierr = PetscViewerBinaryRead(
+		viewer, &classid, 1, nullptr, PETSC_INT); CHKERRQ(ierr);
+	dataset.name = "vector";
+	if (classid == PetibmFieldNativeClassId)
+	{
+		// decomposition header: dimension, points, components, processes,
+		// ranges, padding
+		ierr = PetscViewerBinaryRead(
+			viewer, &header[1], 8, nullptr, PETSC_INT); CHKERRQ(ierr);
+		header.resize(9 + header[6] + header[7] + header[8]);
+		ierr = PetscViewerBinaryRead(viewer, &header[9], header.size() - 9,
+		                             nullptr, PETSC_INT); CHKERRQ(ierr);
+		ierr = PetscViewerBinaryRead(
+			viewer, &npad, 1, nullptr, PETSC_INT); CHKERRQ(ierr);
+		if (npad > 0)
+		{
+			std::vector<PetscInt> pad(npad);
+			ierr = PetscViewerBinaryRead(
+				viewer, pad.data(), npad, nullptr, PETSC_INT); CHKERRQ(ierr);
+		}
+		nskip = header.size() + 1 + npad;
+		for (d=header[1]; d>0; d--)
+			dataset.shape.push_back(header[1+d]);
+		// the components of a point are contiguous
+		if (header[5] > 1)
+			dataset.shape.push_back(header[5]);
+		dataset.name = "native";
+		ierr = PetscViewerBinaryRead(
+			viewer, &classid, 1, nullptr, PETSC_INT); CHKERRQ(ierr);
+	}
+	if (classid != VEC_FILE_CLASSID)
+		SETERRQ(PETSC_COMM_WORLD, PETSC_ERR_FILE_UNEXPECTED,
+		        "The file does not hold a PETSc vector");
+	ierr = PetscViewerBinaryRead(
+		viewer, &header[0], 1, nullptr, PETSC_INT); CHKERRQ(ierr);
+	if (dataset.shape.empty())
+		dataset.shape.push_back(header[0]);
+	dataset.type = std::string("float") + std::to_string(8 * sizeof(PetscReal));
+	ierr = PetscViewerDestroy(&viewer); CHKERRQ(ierr);
+
+	if (range)
+	{
+		ierr = PetscViewerBinaryOpen(PETSC_COMM_WORLD, filepath.c_str(),
+		                             FILE_MODE_READ, &viewer); CHKERRQ(ierr);
+		if (nskip > 0)
+		{
+			std::vector<PetscInt> skip(nskip);
+			ierr = PetscViewerBinaryRead(
+				viewer, skip.data(), nskip, nullptr, PETSC_INT); CHKERRQ(ierr);
+		}
+		ierr = VecCreate(PETSC_COMM_WORLD, &vec); CHKERRQ(ierr);
+		ierr = VecLoad(vec, viewer); CHKERRQ(ierr);
+		ierr = VecMin(vec, nullptr, &dataset.min); CHKERRQ(ierr);
+		ierr = VecMax(vec, nullptr, &dataset.max); CHKERRQ(ierr);
+		dataset.ranged = PETSC_TRUE;
+		ierr = VecDestroy(&vec); CHKERRQ(ierr);
+		ierr = PetscViewerDestroy(&viewer); CHKERRQ(ierr);
+	}
+	datasets.assign(1, dataset);
+
+	PetscFunctionReturn(0);
+} // PetibmInfoBinaryRead
+
+
+/*! Prints the metadata of datasets.
+ *
+ * \param filepath Path of the file.
+ * \param datasets The metadata of the datasets.
+ */
+PetscErrorCode PetibmInfoPrintf(
+	const std::string filepath, const std::vector<PetibmDatasetInfo> &datasets)
+{
+	PetscErrorCode ierr;
+
+	PetscFunctionBeginUser;
+
+	ierr = PetscPrintf(
+		PETSC_COMM_WORLD, "+ %s:\n", filepath.c_str()); CHKERRQ(ierr);
+	for (auto &info : datasets)
+	{
+		std::ostringstream ss;
+		ss << "\t- " << info.name << ": " << info.type << " (";
+		for (size_t d=0; d<info.shape.size(); d++)
+			ss << ((d > 0) ? ", " : "") << info.shape[d];
+		ss << ")";
+		if (!info.chunk.empty())
+		{
+			ss << ", chunks (";
+			for (size_t d=0; d<info.chunk.size(); d++)
+				ss << ((d > 0) ? ", " : "") << info.chunk[d];
+			ss << ")";
+		}
+		if (info.ranged)
+			ss << ", range [" << info.min << ", " << info.max << "]";
+		ierr = PetscPrintf(
+			PETSC_COMM_WORLD, "%s\n", ss.str().c_str()); CHKERRQ(ierr);
+	}
+
+	PetscFunctionReturn(0);
+} // PetibmInfoPrintf
@@ -0,0 +1,357 @@
+/*! Implementation of the functions for the PetibmIsoSurface structure.
+ * \file isosurface.cpp
+ */
+
+#include <cstring>
+
+#include "petibm-utilities/isosurface.h"
+
+
+/*! Corners of each edge of a cell.
+ *
+ * The corner c of a cell is located at (c & 1, (c >> 1) & 1, (c >> 2) & 1);
+ * edge e is along the direction e / 4, starting from its first corner.
+ */
+static const PetscInt PetibmCubeEdges[12][2] = {
+	{0, 1}, {2, 3}, {4, 5}, {6, 7},  // x-edges
+	{0, 2}, {1, 3}, {4, 6}, {5, 7},  // y-edges
+	{0, 4}, {1, 5}, {2, 6}, {3, 7}};  // z-edges
+
+
+/*! Corners of each face of a cell, counter-clockwise seen from outside.
+ */
+static const PetscInt PetibmCubeFaces[6][4] = {
+	{0, 4, 6, 2}, {1, 3, 7, 5},  // x-faces
+	{0, 1, 5, 4}, {2, 6, 7, 3},  // y-faces
+	{0, 2, 3, 1}, {4, 5, 7, 6}};  // z-faces
+
+
+/*! Returns the index of the edge joining two corners of a cell.
+ *
+ * \param a First corner.
+ * \param b Second corner.
+ */
+static PetscInt PetibmCubeEdge(const PetscInt a, const PetscInt b)
+{
+	for (PetscInt e=0; e<12; e++)
+		if ((PetibmCubeEdges[e][0] == a and PetibmCubeEdges[e][1] == b) or
+		    (PetibmCubeEdges[e][0] == b and PetibmCubeEdges[e][1] == a))
+			return e;
+	return -1;
+} // PetibmCubeEdge
+
+
+/*! Builds the triangles (as triplets of cell edges) for each of the 256 cases.
+ *
+ * On each face, every run of inside corners (along the counter-clockwise
+ * walk) is cut by a segment from the edge where the walk exits the run to the
+ * edge where it enters it; ambiguous faces therefore separate the inside
+ * corners, the same way for both cells sharing the face.
+ * The segments form closed, consistently oriented loops that are
+ * triangulated as fans.
+ *
+ * \param table The triangles for each case (passed by reference).
+ */
+static void PetibmMarchingCubesBuildTable(std::vector<PetscInt> table[256])
+{
+	for (PetscInt code=0; code<256; code++)
+	{
+		PetscInt next[12];
+		PetscBool visited[12];
+		for (PetscInt e=0; e<12; e++)
+		{
+			next[e] = -1;
+			visited[e] = PETSC_FALSE;
+		}
+		for (PetscInt f=0; f<6; f++)
+		{
+			const PetscInt *c = PetibmCubeFaces[f];
+			for (PetscInt q=0; q<4; q++)
+			{
+				const PetscBool in = (PetscBool) ((code >> c[q]) & 1),
+				                prevIn = (PetscBool) ((code >> c[(q+3)%4]) & 1);
+				// start of a run of inside corners
+				if (!in or prevIn)
+					continue;
+				const PetscInt enter = PetibmCubeEdge(c[(q+3)%4], c[q]);
+				PetscInt r = q;
+				while ((code >> c[(r+1)%4]) & 1)
+					r = (r+1)%4;
+				const PetscInt exit = PetibmCubeEdge(c[r], c[(r+1)%4]);
+				next[exit] = enter;
+			}
+		}
+		for (PetscInt e=0; e<12; e++)
+		{
+			if (next[e] < 0 or visited[e])
+				continue;
+			std::vector<PetscInt> loop;
+			for (PetscInt v=e; !visited[v]; v=next[v])
+			{
+				visited[v] = PETSC_TRUE;
+				loop.push_back(v);
+			}
+			for (std::size_t t=1; t+1<loop.size(); t++)
+			{
+				table[code].push_back(loop[0]);
+				table[code].push_back(loop[t]);
+				table[code].push_back(loop[t+1]);
+			}
+		}
+	}
+} // PetibmMarchingCubesBuildTable
+
+
+/*! Extracts an isosurface of a 3D field with marching cubes.
+ *
+ * Each process polygonizes the cells whose lower corner it owns, using the
+ * ghost values of the field; the vertex indices are exchanged through a
+ * ghosted DMDA with the layout of the field.
+ * The gridlines of the grid should be distributed (PetibmGridInitialize).
+ * The triangles are oriented consistently, and the surface is closed
+ * wherever it does not cross the external boundaries of the domain.
+ *
+ * \param grid The grid of the field (passed by reference).
+ * \param field The field (passed by reference).
+ * \param value The iso-value.
+ * \param surf The isosurface (passed by reference).
+ */
+PetscErrorCode PetibmIsoSurfaceCompute(
+	PetibmGrid &grid, PetibmField &field, const PetscReal value,
+	PetibmIsoSurface &surf)
+{
+	PetscErrorCode ierr;
+	static std::vector<PetscInt> table[256];
+	static PetscBool built = PETSC_FALSE;
+	DMDALocalInfo info;
+	PetscReal ***f, ****id, *x, *y, *z;
+	PetscInt i, j, k, d, c, nv = 0, end;
+	MPI_Comm comm;
+
+	PetscFunctionBeginUser;
+
+	if (!built)
+	{
+		PetibmMarchingCubesBuildTable(table);
+		built = PETSC_TRUE;
+	}
+
+	ierr = DMDAGetLocalInfo(field.da, &info); CHKERRQ(ierr);
+	if (info.dim != 3)
+		SETERRQ(PETSC_COMM_WORLD, PETSC_ERR_SUP,
+		        "Function only supports 3D fields");
+	ierr = PetscObjectGetComm((PetscObject) field.da, &comm); CHKERRQ(ierr);
+
+	// DMDA holding the index of the vertex on each edge (one per direction)
+	if (!surf.da)
+	{
+		PetscInt m, n, p;
+		DMBoundaryType bx, by, bz;
+		const PetscInt *lx, *ly, *lz;
+		ierr = DMDAGetInfo(field.da,
+		                   nullptr,
+		                   nullptr, nullptr, nullptr,
+		                   &m, &n, &p,
+		                   nullptr, nullptr,
+		                   &bx, &by, &bz,
+		                   nullptr); CHKERRQ(ierr);
+		ierr = DMDAGetOwnershipRanges(field.da, &lx, &ly, &lz); CHKERRQ(ierr);
+		ierr = DMDACreate3d(comm,
+		                    bx, by, bz,
+		                    DMDA_STENCIL_BOX,
+		                    info.mx, info.my, info.mz, m, n, p,
+		                    3, 1, lx, ly, lz,
+		                    &surf.da); CHKERRQ(ierr);
+		ierr = DMSetUp(surf.da); CHKERRQ(ierr);
+		ierr = DMCreateGlobalVector(surf.da, &surf.global); CHKERRQ(ierr);
+		ierr = DMCreateLocalVector(surf.da, &surf.local); CHKERRQ(ierr);
+	}
+	surf.points.clear();
+	surf.triangles.clear();
+
+	ierr = PetibmFieldGetLocal(field); CHKERRQ(ierr);
+	ierr = PetibmGridGlobalToLocal(grid); CHKERRQ(ierr);
+	ierr = DMDAVecGetArray(field.da, field.local, &f); CHKERRQ(ierr);
+	ierr = DMDAVecGetArray(grid.x.da, grid.x.local, &x); CHKERRQ(ierr);
+	ierr = DMDAVecGetArray(grid.y.da, grid.y.local, &y); CHKERRQ(ierr);
+	ierr = DMDAVecGetArray(grid.z.da, grid.z.local, &z); CHKERRQ(ierr);
+
+	// create a vertex on each crossed edge whose lower node is on process
+	ierr = DMDAVecGetArrayDOF(surf.da, surf.global, &id); CHKERRQ(ierr);
+	for (k=info.zs; k<info.zs+info.zm; k++)
+	{
+		for (j=info.ys; j<info.ys+info.ym; j++)
+		{
+			for (i=info.xs; i<info.xs+info.xm; i++)
+			{
+				for (d=0; d<3; d++)
+				{
+					const PetscInt ii = i + (d == 0),
+					               jj = j + (d == 1),
+					               kk = k + (d == 2);
+					id[k][j][i][d] = -1.0;
+					if (ii == info.mx or jj == info.my or kk == info.mz)
+						continue;
+					const PetscReal f0 = f[k][j][i], f1 = f[kk][jj][ii];
+					if ((f0 > value) == (f1 > value))
+						continue;
+					const PetscReal t = (value - f0)/(f1 - f0);
+					surf.points.push_back(x[i] + t*(x[ii] - x[i]));
+					surf.points.push_back(y[j] + t*(y[jj] - y[j]));
+					surf.points.push_back(z[k] + t*(z[kk] - z[k]));
+					id[k][j][i][d] = nv++;
+				}
+			}
+		}
+	}
+	ierr = MPI_Scan(&nv, &end, 1, MPIU_INT, MPI_SUM, comm); CHKERRQ(ierr);
+	surf.start = end - nv;
+	ierr = MPI_Allreduce(&nv, &surf.size, 1, MPIU_INT, MPI_SUM,
+	                     comm); CHKERRQ(ierr);
+	for (k=info.zs; k<info.zs+info.zm; k++)
+		for (j=info.ys; j<info.ys+info.ym; j++)
+			for (i=info.xs; i<info.xs+info.xm; i++)
+				for (d=0; d<3; d++)
+					if (id[k][j][i][d] >= 0.0)
+						id[k][j][i][d] += surf.start;
+	ierr = DMDAVecRestoreArrayDOF(surf.da, surf.global, &id); CHKERRQ(ierr);
+
+	// get the indices of the vertices owned by the neighbors
+	ierr = DMGlobalToLocalBegin(
+		surf.da, surf.global, INSERT_VALUES, surf.local); CHKERRQ(ierr);
+	ierr = DMGlobalToLocalEnd(
+		surf.da, surf.global, INSERT_VALUES, surf.local); CHKERRQ(ierr);
+
+	// triangulate the cells whose lower corner is on process
+	ierr = DMDAVecGetArrayDOF(surf.da, surf.local, &id); CHKERRQ(ierr);
+	for (k=info.zs; k<PetscMin(info.zs+info.zm, info.mz-1); k++)
+	{
+		for (j=info.ys; j<PetscMin(info.ys+info.ym, info.my-1); j++)
+		{
+			for (i=info.xs; i<PetscMin(info.xs+info.xm, info.mx-1); i++)
+			{
+				PetscInt code = 0;
+				for (c=0; c<8; c++)
+					if (f[k+((c>>2)&1)][j+((c>>1)&1)][i+(c&1)] > value)
+						code |= 1 << c;
+				for (auto e : table[code])
+				{
+					const PetscInt a = PetibmCubeEdges[e][0];
+					surf.triangles.push_back((PetscInt)
+						id[k+((a>>2)&1)][j+((a>>1)&1)][i+(a&1)][e/4]);
+				}
+			}
+		}
+	}
+	ierr = DMDAVecRestoreArrayDOF(surf.da, surf.local, &id); CHKERRQ(ierr);
+
+	ierr = DMDAVecRestoreArray(grid.z.da, grid.z.local, &z); CHKERRQ(ierr);
+	ierr = DMDAVecRestoreArray(grid.y.da, grid.y.local, &y); CHKERRQ(ierr);
+	ierr = DMDAVecRestoreArray(grid.x.da, grid.x.local, &x); CHKERRQ(ierr);
+	ierr = DMDAVecRestoreArray(field.da, field.local, &f); CHKERRQ(ierr);
+	ierr = PetibmFieldRestoreLocal(field); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmIsoSurfaceCompute
+
+
+/*! Writes the isosurface into a binary PLY file.
+ *
+ * Collective; the processes write their vertices and triangles at their
+ * offsets in the same file with MPI-IO.
+ *
+ * \param filepath Path of the output file.
+ * \param surf The isosurface.
+ */
+PetscErrorCode PetibmIsoSurfacePLYWrite(
+	const std::string filepath, const PetibmIsoSurface &surf)
+{
+	PetscErrorCode ierr;
+	MPI_Comm comm;
+	MPI_File fh;
+	PetscMPIInt rank;
+	PetscInt nt = surf.triangles.size()/3, ntStart, ntTotal;
+	const int one = 1;
+	const std::size_t faceBytes = sizeof(unsigned char) + 3*sizeof(int);
+	std::vector<char> faces(nt*faceBytes);
+	char header[512];
+	MPI_Offset offset;
+
+	PetscFunctionBeginUser;
+
+	ierr = PetscObjectGetComm((PetscObject) surf.da, &comm); CHKERRQ(ierr);
+	ierr = MPI_Comm_rank(comm, &rank); CHKERRQ(ierr);
+	ierr = MPI_Scan(&nt, &ntStart, 1, MPIU_INT, MPI_SUM, comm); CHKERRQ(ierr);
+	ntStart -= nt;
+	ierr = MPI_Allreduce(&nt, &ntTotal, 1, MPIU_INT, MPI_SUM,
+	                     comm); CHKERRQ(ierr);
+
+	// the data are written with the byte order of the machine
+	ierr = PetscSNPrintf(header, sizeof(header),
+	                     "ply\n"
+	                     "format %s 1.0\n"
+	                     "element vertex %d\n"
+	                     "property float x\n"
+	                     "property float y\n"
+	                     "property float z\n"
+	                     "element face %d\n"
+	                     "property list uchar int vertex_indices\n"
+	                     "end_header\n",
+	                     (*(const char *) &one) ? "binary_little_endian"
+	                                            : "binary_big_endian",
+	                     surf.size, ntTotal); CHKERRQ(ierr);
+
+	// pack the triangles as PLY lists
+	for (PetscInt t=0; t<nt; t++)
+	{
+		char *ptr = faces.data() + t*faceBytes;
+		const unsigned char count = 3;
+		std::memcpy(ptr, &count, sizeof(count));
+		for (PetscInt v=0; v<3; v++)
+		{
+			const int index = surf.triangles[3*t+v];
+			std::memcpy(ptr + sizeof(count) + v*sizeof(int), &index, sizeof(int));
+		}
+	}
+
+	ierr = MPI_File_open(comm, filepath.c_str(),
+	                     MPI_MODE_CREATE | MPI_MODE_WRONLY,
+	                     MPI_INFO_NULL, &fh); CHKERRQ(ierr);
+	ierr = MPI_File_set_size(fh, 0); CHKERRQ(ierr);
+	if (rank == 0)
+	{
+		ierr = MPI_File_write_at(fh, 0, header, std::strlen(header), MPI_CHAR,
+		                         MPI_STATUS_IGNORE); CHKERRQ(ierr);
+	}
+	offset = std::strlen(header) + (MPI_Offset) surf.start*3*sizeof(float);
+	ierr = MPI_File_write_at_all(fh, offset, surf.points.data(),
+	                             surf.points.size(), MPI_FLOAT,
+	                             MPI_STATUS_IGNORE); CHKERRQ(ierr);
+	offset = std::strlen(header) + (MPI_Offset) surf.size*3*sizeof(float)
+	       + (MPI_Offset) ntStart*faceBytes;
+	ierr = MPI_File_write_at_all(fh, offset, faces.data(), faces.size(),
+	                             MPI_BYTE, MPI_STATUS_IGNORE); CHKERRQ(ierr);
+	ierr = MPI_File_close(&fh); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmIsoSurfacePLYWrite
+
+
+/*! Destroys a PetibmIsoSurface structure.
+ *
+ * \param surf The isosurface (passed by reference).
+ */
+PetscErrorCode PetibmIsoSurfaceDestroy(PetibmIsoSurface &surf)
+{
+	PetscErrorCode ierr;
+
+	PetscFunctionBeginUser;
+
+	surf.points.clear();
+	surf.triangles.clear();
+	ierr = VecDestroy(&surf.global); CHKERRQ(ierr);
+	ierr = VecDestroy(&surf.local); CHKERRQ(ierr);
+	ierr = DMDestroy(&surf.da); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmIsoSurfaceDestroy
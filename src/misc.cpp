@@ -2,6 +2,8 @@
  * \file misc.cpp
  */
 
+#include <set>
+
 #include "petibm-utilities/misc.h"
 
 
@@ -28,6 +30,31 @@ PetscErrorCode PetibmGetDirectory(std::string *directory)
 } // PetibmGetDirectory
 
 
+/*! Inserts a configuration file into the options database, once.
+ *
+ * PETSc reads the file on rank 0 and broadcasts its content; a file already
+ * inserted (e.g., shared by the grid, field, and time-step options) is not
+ * read again.
+ *
+ * \param path Path of the configuration file.
+ */
+PetscErrorCode PetibmOptionsInsertFile(const std::string path)
+{
+	PetscErrorCode ierr;
+	static std::set<std::string> inserted;
+
+	PetscFunctionBeginUser;
+
+	if (inserted.count(path))
+		PetscFunctionReturn(0);
+	ierr = PetscOptionsInsertFile(
+		PETSC_COMM_WORLD, nullptr, path.c_str(), PETSC_FALSE); CHKERRQ(ierr);
+	inserted.insert(path);
+
+	PetscFunctionReturn(0);
+} // PetibmOptionsInsertFile
+
+
 /*! Counts the number of points within provided boundaries.
  *
  * \param x The sequential vector containing the points.
@@ -0,0 +1,464 @@
+/*! Implementation of the functions for the PetibmPOD structure.
+ * \file pod.cpp
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+#include <petscblaslapack.h>
+
+#include "petibm-utilities/misc.h"
+#include "petibm-utilities/pod.h"
+
+
+/*! Gets options from command-line or config file.
+ *
+ * `-block <n>`, `-modes <n>`, `-subtract_mean <true|false>`,
+ * `-weighted <true|false>`.
+ *
+ * \param prefix String to prepend to options.
+ * \param ctx The PetibmPODCtx structure to fill (passed by pointer).
+ */
+PetscErrorCode PetibmPODGetOptions(const char prefix[], PetibmPODCtx *ctx)
+{
+	PetscErrorCode ierr;
+	char path[PETSC_MAX_PATH_LEN];
+	PetscBool found;
+
+	PetscFunctionBeginUser;
+
+	// get path of configuration file
+	ierr = PetscOptionsGetString(nullptr, prefix, "-config_file",
+	                             path, sizeof(path), &found); CHKERRQ(ierr);
+	if (found)
+	{
+		ierr = PetibmOptionsInsertFile(path); CHKERRQ(ierr);
+	}
+	// get number of snapshots held in memory
+	ierr = PetscOptionsGetInt(nullptr, prefix, "-block",
+	                          &ctx->block, &found); CHKERRQ(ierr);
+	if (ctx->block < 1)
+		SETERRQ(PETSC_COMM_WORLD, PETSC_ERR_ARG_OUTOFRANGE,
+		        "The block should hold at least one snapshot");
+	// get number of modes to reconstruct
+	ierr = PetscOptionsGetInt(nullptr, prefix, "-modes",
+	                          &ctx->modes, &found); CHKERRQ(ierr);
+	// decompose the fluctuations?
+	ierr = PetscOptionsGetBool(nullptr, prefix, "-subtract_mean",
+	                           &ctx->subtract_mean, &found); CHKERRQ(ierr);
+	// weight the inner product?
+	ierr = PetscOptionsGetBool(nullptr, prefix, "-weighted",
+	                           &ctx->weighted, &found); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmPODGetOptions
+
+
+PetscErrorCode PetibmPODCtxPrintf(
+	const std::string name, const PetibmPODCtx ctx)
+{
+	PetscErrorCode ierr;
+
+	PetscFunctionBeginUser;
+
+	ierr = PetscPrintf(PETSC_COMM_WORLD, "+ %s:\n", name.c_str()); CHKERRQ(ierr);
+	ierr = PetscPrintf(PETSC_COMM_WORLD, "\t- block: %d snapshots\n",
+	                   ctx.block); CHKERRQ(ierr);
+	ierr = PetscPrintf(PETSC_COMM_WORLD, "\t- modes: %d\n",
+	                   ctx.modes); CHKERRQ(ierr);
+	ierr = PetscPrintf(PETSC_COMM_WORLD, "\t- subtract mean: %s\n",
+	                   (ctx.subtract_mean) ? "yes" : "no"); CHKERRQ(ierr);
+	ierr = PetscPrintf(PETSC_COMM_WORLD, "\t- weighted: %s\n",
+	                   (ctx.weighted) ? "yes" : "no"); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmPODCtxPrintf
+
+
+/*! Initializes the decomposition of a sequence of snapshots of a field.
+ *
+ * With `weighted`, the inner product is weighted with the volume (area in 2D)
+ * of the cell around each point, from the trapezoidal rule on the gridlines.
+ *
+ * \param ctx The options.
+ * \param grid The grid of the field (passed by reference).
+ * \param field The field (layout of the snapshots).
+ * \param size The number of snapshots.
+ * \param pod The decomposition to initialize (passed by reference).
+ */
+PetscErrorCode PetibmPODInitialize(
+	const PetibmPODCtx ctx, PetibmGrid &grid, const PetibmField field,
+	const PetscInt size, PetibmPOD &pod)
+{
+	PetscErrorCode ierr;
+	DMDALocalInfo info;
+	std::vector<PetscReal> wx, wy, wz(1, 1.0);
+	PetscReal *w;
+	PetscInt i, j, k, c, p = 0;
+
+	PetscFunctionBeginUser;
+
+	pod.size = size;
+	pod.reads = 0;
+	pod.gram.assign(size*size, 0.0);
+	if (!ctx.weighted)
+		PetscFunctionReturn(0);
+
+	ierr = DMDAGetLocalInfo(field.da, &info); CHKERRQ(ierr);
+	ierr = PetibmGridlineGetWidths(grid.x, wx); CHKERRQ(ierr);
+	ierr = PetibmGridlineGetWidths(grid.y, wy); CHKERRQ(ierr);
+	if (info.dim == 3)
+	{
+		ierr = PetibmGridlineGetWidths(grid.z, wz); CHKERRQ(ierr);
+	}
+	ierr = VecDuplicate(field.global, &pod.weights); CHKERRQ(ierr);
+	ierr = VecGetArray(pod.weights, &w); CHKERRQ(ierr);
+	for (k=0; k<info.zm; k++)
+		for (j=0; j<info.ym; j++)
+			for (i=0; i<info.xm; i++)
+				for (c=0; c<info.dof; c++)
+					w[p++] = wx[i] * wy[j] * wz[k];
+	ierr = VecRestoreArray(pod.weights, &w); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmPODInitialize
+
+
+/*! Reads a snapshot into a vector.
+ *
+ * \param read The function reading a snapshot.
+ * \param field The field (layout of the snapshots).
+ * \param s Index of the snapshot.
+ * \param v The vector to fill.
+ * \param pod The decomposition (passed by reference).
+ */
+static PetscErrorCode PetibmPODRead(
+	const PetibmPODReadFunction &read, const PetibmField field,
+	const PetscInt s, Vec v, PetibmPOD &pod)
+{
+	PetscErrorCode ierr;
+	PetibmField snapshot = field;
+
+	PetscFunctionBeginUser;
+
+	snapshot.global = v;
+	ierr = read(s, snapshot); CHKERRQ(ierr);
+	pod.reads++;
+
+	PetscFunctionReturn(0);
+} // PetibmPODRead
+
+
+/*! Accumulates the Gram matrix of the snapshots in blocked passes.
+ *
+ * Each pass holds a block of snapshots in memory, computes their inner
+ * products, then streams the following snapshots one at a time against the
+ * block; the inner products of a snapshot with the block are computed with
+ * one reduction.
+ * A snapshot is read once per pass and the memory held is that of block+2
+ * fields on each process.
+ *
+ * \param ctx The options.
+ * \param read The function reading a snapshot.
+ * \param field The field (layout of the snapshots).
+ * \param pod The decomposition (passed by reference).
+ */
+PetscErrorCode PetibmPODComputeGram(
+	const PetibmPODCtx ctx, const PetibmPODReadFunction &read,
+	const PetibmField field, PetibmPOD &pod)
+{
+	PetscErrorCode ierr;
+	const PetscInt N = pod.size, b = PetscMin(ctx.block, N);
+	Vec *block, stream, weighted;
+	std::vector<PetscScalar> dots(b);
+	PetscInt first, nb, i, j, s;
+
+	PetscFunctionBeginUser;
+
+	if (N == 0)
+		PetscFunctionReturn(0);
+	ierr = VecDuplicateVecs(field.global, b, &block); CHKERRQ(ierr);
+	ierr = VecDuplicate(field.global, &stream); CHKERRQ(ierr);
+	ierr = VecDuplicate(field.global, &weighted); CHKERRQ(ierr);
+
+	for (first=0; first<N; first+=b)
+	{
+		nb = PetscMin(b, N-first);
+		// inner products within the block
+		for (i=0; i<nb; i++)
+		{
+			ierr = PetibmPODRead(
+				read, field, first+i, block[i], pod); CHKERRQ(ierr);
+			if (pod.weights)
+			{
+				ierr = VecPointwiseMult(
+					weighted, pod.weights, block[i]); CHKERRQ(ierr);
+			}
+			ierr = VecMDot((pod.weights) ? weighted : block[i], i+1, block,
+			               dots.data()); CHKERRQ(ierr);
+			for (j=0; j<=i; j++)
+				pod.gram[(first+i)*N+first+j] =
+				pod.gram[(first+j)*N+first+i] = PetscRealPart(dots[j]);
+		}
+		// inner products of the following snapshots with the block
+		for (s=first+nb; s<N; s++)
+		{
+			ierr = PetibmPODRead(read, field, s, stream, pod); CHKERRQ(ierr);
+			if (pod.weights)
+			{
+				ierr = VecPointwiseMult(
+					weighted, pod.weights, stream); CHKERRQ(ierr);
+			}
+			ierr = VecMDot((pod.weights) ? weighted : stream, nb, block,
+			               dots.data()); CHKERRQ(ierr);
+			for (j=0; j<nb; j++)
+				pod.gram[s*N+first+j] =
+				pod.gram[(first+j)*N+s] = PetscRealPart(dots[j]);
+		}
+	}
+
+	ierr = VecDestroy(&weighted); CHKERRQ(ierr);
+	ierr = VecDestroy(&stream); CHKERRQ(ierr);
+	ierr = VecDestroyVecs(b, &block); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmPODComputeGram
+
+
+/*! Computes the eigenvalues and eigenvectors of the Gram matrix.
+ *
+ * With `subtract_mean`, the Gram matrix is centered first, which gives the
+ * inner products of the fluctuations around the mean without another pass
+ * over the snapshots.
+ * The eigenproblem (size x size) is solved with LAPACK on every process.
+ *
+ * \param ctx The options.
+ * \param pod The decomposition (passed by reference).
+ */
+PetscErrorCode PetibmPODSolve(const PetibmPODCtx ctx, PetibmPOD &pod)
+{
+	PetscErrorCode ierr;
+	const PetscInt N = pod.size;
+	std::vector<PetscScalar> a(pod.gram.begin(), pod.gram.end()), work;
+	std::vector<PetscReal> w(N), rows(N, 0.0);
+	PetscReal total = 0.0;
+	PetscBLASInt n, lwork, info;
+	PetscInt i, j, k;
+
+	PetscFunctionBeginUser;
+
+	if (N == 0)
+		PetscFunctionReturn(0);
+	// inner products of the fluctuations: (I - 1/N) G (I - 1/N)
+	if (ctx.subtract_mean)
+	{
+		for (i=0; i<N; i++)
+		{
+			for (j=0; j<N; j++)
+				rows[i] += pod.gram[i*N+j] / N;
+			total += rows[i] / N;
+		}
+		for (i=0; i<N; i++)
+			for (j=0; j<N; j++)
+				a[i*N+j] = pod.gram[i*N+j] - rows[i] - rows[j] + total;
+	}
+
+	ierr = PetscBLASIntCast(N, &n); CHKERRQ(ierr);
+	lwork = 3*n;
+	work.resize(lwork);
+	PetscStackCallBLAS("LAPACKsyev", LAPACKsyev_("V", "U", &n, a.data(), &n,
+	                                             w.data(), work.data(),
+	                                             &lwork, &info));
+	if (info != 0)
+		SETERRQ1(PETSC_COMM_SELF, PETSC_ERR_LIB,
+		         "Eigenproblem of the Gram matrix failed (info %d)", (int) info);
+
+	// decreasing eigenvalues; eigenvector k is stored after eigenvector k-1
+	pod.eigenvalues.resize(N);
+	pod.eigenvectors.resize(N*N);
+	for (k=0; k<N; k++)
+	{
+		pod.eigenvalues[k] = w[N-1-k];
+		for (i=0; i<N; i++)
+			pod.eigenvectors[k*N+i] = PetscRealPart(a[(N-1-k)*N+i]);
+	}
+
+	PetscFunctionReturn(0);
+} // PetibmPODSolve
+
+
+/*! Reconstructs the modes in streaming passes over the snapshots.
+ *
+ * The modes are computed by blocks (at most `block` modes per pass); mode k
+ * is the combination of the snapshots with the coefficients of eigenvector
+ * k, scaled to unit norm.
+ * The mean is removed implicitly: the coefficients of a mode of the centered
+ * Gram matrix sum to zero.
+ *
+ * \param ctx The options.
+ * \param read The function reading a snapshot.
+ * \param write The function writing a mode.
+ * \param field The field (layout of the snapshots).
+ * \param pod The decomposition (passed by reference).
+ */
+PetscErrorCode PetibmPODComputeModes(
+	const PetibmPODCtx ctx, const PetibmPODReadFunction &read,
+	const PetibmPODWriteFunction &write, const PetibmField field,
+	PetibmPOD &pod)
+{
+	PetscErrorCode ierr;
+	const PetscInt N = pod.size;
+	const PetscReal tol = PETSC_SQRT_MACHINE_EPSILON *
+		((N > 0) ? PetscAbsReal(pod.eigenvalues[0]) : 0.0);
+	PetibmField mode = field;
+	Vec *block, stream;
+	PetscInt modes = 0, b, first, nb, j, s;
+
+	PetscFunctionBeginUser;
+
+	// modes with a non-zero energy only
+	while (modes < PetscMin(ctx.modes, N) and pod.eigenvalues[modes] > tol)
+		modes++;
+	if (modes == 0)
+		PetscFunctionReturn(0);
+	b = PetscMin(ctx.block, modes);
+	ierr = VecDuplicateVecs(field.global, b, &block); CHKERRQ(ierr);
+	ierr = VecDuplicate(field.global, &stream); CHKERRQ(ierr);
+
+	for (first=0; first<modes; first+=b)
+	{
+		nb = PetscMin(b, modes-first);
+		for (j=0; j<nb; j++)
+		{
+			ierr = VecSet(block[j], 0.0); CHKERRQ(ierr);
+		}
+		for (s=0; s<N; s++)
+		{
+			ierr = PetibmPODRead(read, field, s, stream, pod); CHKERRQ(ierr);
+			for (j=0; j<nb; j++)
+			{
+				ierr = VecAXPY(block[j],
+				               pod.eigenvectors[(first+j)*N+s] /
+				               PetscSqrtReal(pod.eigenvalues[first+j]),
+				               stream); CHKERRQ(ierr);
+			}
+		}
+		for (j=0; j<nb; j++)
+		{
+			mode.global = block[j];
+			ierr = write(first+j, mode); CHKERRQ(ierr);
+		}
+	}
+
+	ierr = VecDestroy(&stream); CHKERRQ(ierr);
+	ierr = VecDestroyVecs(b, &block); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmPODComputeModes
+
+
+/*! Writes the eigenvalues into an ASCII file.
+ *
+ * One row per eigenvalue: the index, the eigenvalue, its fraction of the
+ * total, and the cumulative fraction.
+ *
+ * \param filepath Path of the output file.
+ * \param pod The decomposition.
+ */
+PetscErrorCode PetibmPODWriteEigenvalues(
+	const std::string filepath, const PetibmPOD &pod)
+{
+	PetscErrorCode ierr;
+	PetscMPIInt rank;
+	PetscReal total = 0.0, cumulative = 0.0;
+	PetscInt k;
+
+	PetscFunctionBeginUser;
+
+	ierr = MPI_Comm_rank(PETSC_COMM_WORLD, &rank); CHKERRQ(ierr);
+	if (rank != 0)
+		PetscFunctionReturn(0);
+	std::ofstream outfile(filepath.c_str(), std::ios::trunc);
+	if (!outfile.good())
+		SETERRQ(PETSC_COMM_SELF, PETSC_ERR_FILE_OPEN,
+		        "Cannot open the file of the eigenvalues");
+	for (auto value : pod.eigenvalues)
+		total += PetscMax(value, 0.0);
+	outfile << "# snapshots: " << pod.size << "\n";
+	outfile << "# index, eigenvalue, fraction, cumulative fraction\n";
+	outfile << std::scientific << std::setprecision(10);
+	for (k=0; k<(PetscInt) pod.eigenvalues.size(); k++)
+	{
+		const PetscReal value = PetscMax(pod.eigenvalues[k], 0.0);
+		cumulative += value;
+		outfile << k << " " << pod.eigenvalues[k] << " "
+		        << ((total > 0.0) ? value / total : 0.0) << " "
+		        << ((total > 0.0) ? cumulative / total : 0.0) << "\n";
+	}
+
+	PetscFunctionReturn(0);
+} // PetibmPODWriteEigenvalues
+
+
+/*! Writes the temporal coefficients of the modes into an ASCII file.
+ *
+ * One row per snapshot: the time-step index followed by the projection of
+ * the snapshot on each mode.
+ *
+ * \param filepath Path of the output file.
+ * \param steps The time-step index of each snapshot.
+ * \param modes The number of modes.
+ * \param pod The decomposition.
+ */
+PetscErrorCode PetibmPODWriteCoefficients(
+	const std::string filepath, const std::vector<PetscInt> &steps,
+	const PetscInt modes, const PetibmPOD &pod)
+{
+	PetscErrorCode ierr;
+	const PetscInt N = pod.size, nm = PetscMin(modes, N);
+	PetscMPIInt rank;
+	PetscInt s, k;
+
+	PetscFunctionBeginUser;
+
+	ierr = MPI_Comm_rank(PETSC_COMM_WORLD, &rank); CHKERRQ(ierr);
+	if (rank != 0)
+		PetscFunctionReturn(0);
+	std::ofstream outfile(filepath.c_str(), std::ios::trunc);
+	if (!outfile.good())
+		SETERRQ(PETSC_COMM_SELF, PETSC_ERR_FILE_OPEN,
+		        "Cannot open the file of the temporal coefficients");
+	outfile << "# time-step, then one column per mode\n";
+	outfile << std::scientific << std::setprecision(10);
+	for (s=0; s<N; s++)
+	{
+		outfile << steps[s];
+		// projection on mode k: sqrt(lambda_k) times eigenvector k
+		for (k=0; k<nm; k++)
+			outfile << " " << PetscSqrtReal(PetscMax(pod.eigenvalues[k], 0.0)) *
+			                  pod.eigenvectors[k*N+s];
+		outfile << "\n";
+	}
+
+	PetscFunctionReturn(0);
+} // PetibmPODWriteCoefficients
+
+
+/*! Destroys a PetibmPOD structure.
+ *
+ * \param pod The decomposition (passed by reference).
+ */
+PetscErrorCode PetibmPODDestroy(PetibmPOD &pod)
+{
+	PetscErrorCode ierr;
+
+	PetscFunctionBeginUser;
+
+	ierr = VecDestroy(&pod.weights); CHKERRQ(ierr);
+	pod.gram.clear();
+	pod.eigenvalues.clear();
+	pod.eigenvectors.clear();
+
+	PetscFunctionReturn(0);
+} // PetibmPODDestroy
@@ -0,0 +1,275 @@
+/*! Implementation of the functions for the PetibmFieldPool structure.
+ * \file pool.cpp
+ */
+
+#include "petibm-utilities/pool.h"
+#include "petibm-utilities/threads.h"
+
+
+/*! Checks if two DMDA objects have the same layout.
+ *
+ * \param da1 The first DMDA object.
+ * \param da2 The second DMDA object.
+ * \param same PETSC_TRUE if the layouts are identical (passed by pointer).
+ */
+static PetscErrorCode PetibmFieldPoolSameLayout(
+	const DM da1, const DM da2, PetscBool *same)
+{
+	PetscErrorCode ierr;
+	PetscInt dim[2], M[2], N[2], P[2], m[2], n[2], p[2], dof[2], s[2];
+	DMBoundaryType bx[2], by[2], bz[2];
+	DMDAStencilType st[2];
+	const PetscInt *lx[2], *ly[2], *lz[2];
+	const DM das[2] = {da1, da2};
+	PetscInt i, d;
+
+	PetscFunctionBeginUser;
+
+	*same = PETSC_FALSE;
+	for (d=0; d<2; d++)
+	{
+		ierr = DMDAGetInfo(das[d],
+		                   &dim[d],
+		                   &M[d], &N[d], &P[d],
+		                   &m[d], &n[d], &p[d],
+		                   &dof[d], &s[d],
+		                   &bx[d], &by[d], &bz[d],
+		                   &st[d]); CHKERRQ(ierr);
+		ierr = DMDAGetOwnershipRanges(
+			das[d], &lx[d], &ly[d], &lz[d]); CHKERRQ(ierr);
+	}
+	if (dim[0] != dim[1] or dof[0] != dof[1] or s[0] != s[1] or st[0] != st[1])
+		PetscFunctionReturn(0);
+	if (M[0] != M[1] or N[0] != N[1] or P[0] != P[1])
+		PetscFunctionReturn(0);
+	if (m[0] != m[1] or n[0] != n[1] or p[0] != p[1])
+		PetscFunctionReturn(0);
+	if (bx[0] != bx[1] or by[0] != by[1] or bz[0] != bz[1])
+		PetscFunctionReturn(0);
+	for (i=0; i<m[0]; i++)
+		if (lx[0][i] != lx[1][i])
+			PetscFunctionReturn(0);
+	if (dim[0] > 1)
+		for (i=0; i<n[0]; i++)
+			if (ly[0][i] != ly[1][i])
+				PetscFunctionReturn(0);
+	if (dim[0] > 2)
+		for (i=0; i<p[0]; i++)
+			if (lz[0][i] != lz[1][i])
+				PetscFunctionReturn(0);
+	*same = PETSC_TRUE;
+
+	PetscFunctionReturn(0);
+} // PetibmFieldPoolSameLayout
+
+
+/*! Gets a DMDA object from the pool with the same layout as the provided one.
+ *
+ * If the pool already holds a DMDA object with the same layout, the provided
+ * DMDA is destroyed and replaced by a new reference to the pooled one;
+ * otherwise, the provided DMDA is registered into the pool.
+ *
+ * \param pool The pool (passed by reference).
+ * \param da The DMDA object to share (passed by pointer).
+ */
+PetscErrorCode PetibmFieldPoolGetDM(PetibmFieldPool &pool, DM *da)
+{
+	PetscErrorCode ierr;
+	PetscBool same;
+
+	PetscFunctionBeginUser;
+
+	for (auto pooled : pool.das)
+	{
+		// the field shares the DMDA: it holds its own reference
+		if (pooled == *da)
+		{
+			ierr = PetscObjectReference((PetscObject) pooled); CHKERRQ(ierr);
+			PetscFunctionReturn(0);
+		}
+		ierr = PetibmFieldPoolSameLayout(pooled, *da, &same); CHKERRQ(ierr);
+		if (same)
+		{
+			ierr = DMDestroy(da); CHKERRQ(ierr);
+			ierr = PetscObjectReference((PetscObject) pooled); CHKERRQ(ierr);
+			*da = pooled;
+			PetscFunctionReturn(0);
+		}
+	}
+	ierr = PetscObjectReference((PetscObject) *da); CHKERRQ(ierr);
+	pool.das.push_back(*da);
+
+	PetscFunctionReturn(0);
+} // PetibmFieldPoolGetDM
+
+
+/*! Borrows a work vector from the pool.
+ *
+ * The sequential vector wraps a work buffer of the pool with at least the
+ * requested number of values.
+ *
+ * \param pool The pool (passed by reference).
+ * \param n Number of values in the work vector.
+ * \param v The work vector (passed by pointer).
+ */
+PetscErrorCode PetibmFieldPoolGetWorkVec(
+	PetibmFieldPool &pool, const PetscInt n, Vec *v)
+{
+	PetscErrorCode ierr;
+	PetscInt b, best = -1, smaller = -1;
+	PetscScalar *buffer;
+
+	PetscFunctionBeginUser;
+
+	// look for the smallest free buffer large enough
+	for (b=0; b<(PetscInt) pool.buffers.size(); b++)
+	{
+		if (pool.used[b])
+			continue;
+		if (pool.sizes[b] >= n)
+		{
+			if (best < 0 or pool.sizes[b] < pool.sizes[best])
+				best = b;
+		}
+		else if (smaller < 0 or pool.sizes[b] > pool.sizes[smaller])
+			smaller = b;
+	}
+	if (best < 0)
+	{
+		// release a free buffer that is too small before allocating a new one
+		if (smaller >= 0)
+		{
+			ierr = PetibmFieldPoolLogBytes(
+				pool, -(PetscInt64) pool.sizes[smaller] * sizeof(PetscScalar));
+			CHKERRQ(ierr);
+			ierr = PetscFree(pool.buffers[smaller]); CHKERRQ(ierr);
+			pool.buffers.erase(pool.buffers.begin() + smaller);
+			pool.sizes.erase(pool.sizes.begin() + smaller);
+			pool.used.erase(pool.used.begin() + smaller);
+		}
+		ierr = PetscMalloc(n*sizeof(*buffer), &buffer); CHKERRQ(ierr);
+		// first touched by the threads, which work on the same slabs
+		ierr = PetibmThreadsTouch(buffer, n, 1); CHKERRQ(ierr);
+		ierr = PetibmFieldPoolLogBytes(
+			pool, (PetscInt64) n * sizeof(PetscScalar)); CHKERRQ(ierr);
+		pool.buffers.push_back(buffer);
+		pool.sizes.push_back(n);
+		pool.used.push_back(PETSC_FALSE);
+		best = pool.buffers.size() - 1;
+	}
+	pool.used[best] = PETSC_TRUE;
+	ierr = VecCreateSeqWithArray(
+		PETSC_COMM_SELF, 1, n, pool.buffers[best], v); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmFieldPoolGetWorkVec
+
+
+/*! Returns a work vector to the pool.
+ *
+ * \param pool The pool (passed by reference).
+ * \param v The work vector to return (passed by pointer).
+ */
+PetscErrorCode PetibmFieldPoolRestoreWorkVec(PetibmFieldPool &pool, Vec *v)
+{
+	PetscErrorCode ierr;
+	PetscScalar *arr;
+	PetscInt b;
+
+	PetscFunctionBeginUser;
+
+	ierr = VecGetArray(*v, &arr); CHKERRQ(ierr);
+	for (b=0; b<(PetscInt) pool.buffers.size(); b++)
+		if (pool.buffers[b] == arr)
+			break;
+	ierr = VecRestoreArray(*v, &arr); CHKERRQ(ierr);
+	if (b == (PetscInt) pool.buffers.size())
+		SETERRQ(PETSC_COMM_SELF, PETSC_ERR_ARG_WRONG,
+		        "Vector was not borrowed from the pool");
+	pool.used[b] = PETSC_FALSE;
+	ierr = VecDestroy(v); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmFieldPoolRestoreWorkVec
+
+
+/*! Accounts for a number of bytes allocated (or freed if negative) on process.
+ *
+ * \param pool The pool (passed by reference).
+ * \param bytes Number of bytes.
+ */
+PetscErrorCode PetibmFieldPoolLogBytes(
+	PetibmFieldPool &pool, const PetscInt64 bytes)
+{
+	PetscFunctionBeginUser;
+
+	pool.bytes += bytes;
+	pool.peak = PetscMax(pool.peak, pool.bytes);
+
+	PetscFunctionReturn(0);
+} // PetibmFieldPoolLogBytes
+
+
+/*! Prints the number of layouts and the resident memory of the pool.
+ *
+ * \param pool The pool.
+ */
+PetscErrorCode PetibmFieldPoolView(const PetibmFieldPool &pool)
+{
+	PetscErrorCode ierr;
+	PetscInt64 bytes[2] = {pool.bytes, pool.peak},
+	           maxBytes[2], sumBytes[2];
+
+	PetscFunctionBeginUser;
+
+	ierr = MPI_Reduce(bytes, maxBytes, 2, MPIU_INT64, MPI_MAX,
+	                  0, PETSC_COMM_WORLD); CHKERRQ(ierr);
+	ierr = MPI_Reduce(bytes, sumBytes, 2, MPIU_INT64, MPI_SUM,
+	                  0, PETSC_COMM_WORLD); CHKERRQ(ierr);
+	ierr = PetscPrintf(PETSC_COMM_WORLD, "+ Field pool:\n"); CHKERRQ(ierr);
+	ierr = PetscPrintf(PETSC_COMM_WORLD, "\t- layouts: %d\n",
+	                   (PetscInt) pool.das.size()); CHKERRQ(ierr);
+	ierr = PetscPrintf(PETSC_COMM_WORLD, "\t- work buffers: %d\n",
+	                   (PetscInt) pool.buffers.size()); CHKERRQ(ierr);
+	ierr = PetscPrintf(PETSC_COMM_WORLD,
+	                   "\t- resident bytes: %lld (max/process: %lld)\n",
+	                   (long long) sumBytes[0],
+	                   (long long) maxBytes[0]); CHKERRQ(ierr);
+	ierr = PetscPrintf(PETSC_COMM_WORLD,
+	                   "\t- peak resident bytes: %lld (max/process: %lld)\n",
+	                   (long long) sumBytes[1],
+	                   (long long) maxBytes[1]); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmFieldPoolView
+
+
+/*! Destroys the DMDA objects and frees the work buffers of the pool.
+ *
+ * \param pool The pool (passed by reference).
+ */
+PetscErrorCode PetibmFieldPoolDestroy(PetibmFieldPool &pool)
+{
+	PetscErrorCode ierr;
+
+	PetscFunctionBeginUser;
+
+	for (auto &da : pool.das)
+	{
+		ierr = DMDestroy(&da); CHKERRQ(ierr);
+	}
+	pool.das.clear();
+	for (std::size_t b=0; b<pool.buffers.size(); b++)
+	{
+		if (pool.used[b])
+			SETERRQ(PETSC_COMM_SELF, PETSC_ERR_ARG_WRONGSTATE,
+			        "Work vector still borrowed from the pool");
+		pool.bytes -= pool.sizes[b] * sizeof(PetscScalar);
+		ierr = PetscFree(pool.buffers[b]); CHKERRQ(ierr);
+	}
+	pool.buffers.clear();
+	pool.sizes.clear();
+	pool.used.clear();
+
+	PetscFunctionReturn(0);
+} // PetibmFieldPoolDestroy
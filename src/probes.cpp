@@ -0,0 +1,382 @@
+/*! Implementation of the functions for the PetibmProbes structure.
+ * \file probes.cpp
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include "petibm-utilities/probes.h"
+
+
+/*! Reads the coordinates of probes from an ASCII file.
+ *
+ * The file contains one probe per line (dim coordinates); empty lines and
+ * lines starting with `#` are ignored.
+ * Rank 0 reads the file and broadcasts the coordinates.
+ *
+ * \param filepath Path of the input file.
+ * \param dim Number of coordinates per probe.
+ * \param points The coordinates of the probes (passed by reference).
+ */
+PetscErrorCode PetibmProbesRead(
+	const std::string filepath, const PetscInt dim,
+	std::vector<PetscReal> &points)
+{
+	PetscErrorCode ierr;
+	PetscMPIInt rank;
+	PetscInt n = 0, d;
+	PetscReal value;
+
+	PetscFunctionBeginUser;
+
+	ierr = MPI_Comm_rank(PETSC_COMM_WORLD, &rank); CHKERRQ(ierr);
+	points.clear();
+	if (rank == 0)
+	{
+		std::ifstream infile(filepath.c_str());
+		std::string line;
+		if (!infile.good())
+			n = -1;
+		while (n >= 0 and std::getline(infile, line))
+		{
+			std::istringstream iss(line);
+			if (!(iss >> std::ws) or iss.eof() or iss.peek() == '#')
+				continue;
+			for (d=0; d<dim; d++)
+			{
+				if (!(iss >> value))
+					break;
+				points.push_back(value);
+			}
+			n = (d == dim) ? n + 1 : -2;
+		}
+	}
+	// broadcast the status first so that all processes fail together
+	ierr = MPI_Bcast(&n, 1, MPIU_INT, 0, PETSC_COMM_WORLD); CHKERRQ(ierr);
+	if (n == -1)
+		SETERRQ(PETSC_COMM_WORLD, PETSC_ERR_FILE_OPEN,
+		        "Cannot open the file with the probes");
+	if (n == -2)
+		SETERRQ1(PETSC_COMM_WORLD, PETSC_ERR_FILE_UNEXPECTED,
+		         "Each probe should have %D coordinates", dim);
+	points.resize(n*dim);
+	ierr = MPI_Bcast(
+		points.data(), n*dim, MPIU_REAL, 0, PETSC_COMM_WORLD); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmProbesRead
+
+
+/*! Brackets a coordinate with the stations of a gridline on process.
+ *
+ * The process holds the coordinates in [x[xs], x[xs+xm]), or up to the last
+ * station included if it owns the end of the gridline, so that a coordinate
+ * is bracketed by a single process along the gridline.
+ *
+ * \param info Local information of the gridline DMDA.
+ * \param x The stations on process (ghosted array).
+ * \param p The coordinate.
+ * \param I Global index of the station below the coordinate (passed by pointer).
+ * \param w Linear weight of the station above (passed by pointer).
+ * \param owned PETSC_TRUE if the process brackets the coordinate (passed by pointer).
+ */
+static PetscErrorCode PetibmProbesBracket(
+	const DMDALocalInfo info, const PetscReal *x, const PetscReal p,
+	PetscInt *I, PetscReal *w, PetscBool *owned)
+{
+	PetscInt last = info.mx - 1,
+	         end = PetscMin(info.xs + info.xm, last);
+
+	PetscFunctionBeginUser;
+
+	*owned = PETSC_FALSE;
+	if (p < x[info.xs] or p > x[end] or (p == x[end] and end != last))
+		PetscFunctionReturn(0);
+	*I = std::upper_bound(x + info.xs, x + end, p) - x - 1;
+	*w = (p - x[*I]) / (x[*I+1] - x[*I]);
+	*owned = PETSC_TRUE;
+
+	PetscFunctionReturn(0);
+} // PetibmProbesBracket
+
+
+/*! Locates probes in a field and prepares their evaluation.
+ *
+ * Each process locates the probes within the cells whose lower corner it
+ * owns with a bracket search on its part of the gridlines, then stores the
+ * linear weights along each direction.
+ * The scatter of the cell-corner values and the communicator used to gather
+ * the values are created once; the cost of an evaluation then scales with the
+ * number of probes.
+ * Collective; probes outside the domain raise an error.
+ *
+ * \param grid The grid of the field (passed by reference).
+ * \param field The field to probe.
+ * \param points The coordinates of all the probes (same on all processes).
+ * \param probes The probes to initialize (passed by reference).
+ */
+PetscErrorCode PetibmProbesInitialize(
+	PetibmGrid &grid, const PetibmField field,
+	const std::vector<PetscReal> &points, PetibmProbes &probes)
+{
+	PetscErrorCode ierr;
+	const PetibmGridline *lines[3] = {&grid.x, &grid.y, &grid.z};
+	DMDALocalInfo linfo[3], info;
+	PetscReal *x[3], w[3];
+	PetscInt n, p, d, c, nc, IJK[3], idx;
+	PetscBool owned;
+	std::vector<PetscInt> count, indices;
+	ISLocalToGlobalMapping ltog;
+	IS is;
+	PetscMPIInt rank, size, r, nlocal;
+
+	PetscFunctionBeginUser;
+
+	probes.dim = grid.dim;
+	probes.points = points;
+	probes.size = n = points.size() / grid.dim;
+	nc = 1 << grid.dim;
+	ierr = PetibmGridGlobalToLocal(grid); CHKERRQ(ierr);
+	ierr = DMDAGetLocalInfo(field.da, &info); CHKERRQ(ierr);
+	for (d=0; d<grid.dim; d++)
+	{
+		ierr = DMDAGetLocalInfo(lines[d]->da, &linfo[d]); CHKERRQ(ierr);
+		ierr = DMDAVecGetArray(
+			lines[d]->da, lines[d]->local, &x[d]); CHKERRQ(ierr);
+	}
+
+	// locate the probes bracketed by the process along all directions
+	count.assign(n, 0);
+	for (p=0; p<n; p++)
+	{
+		for (d=0, owned=PETSC_TRUE; d<grid.dim and owned; d++)
+		{
+			ierr = PetibmProbesBracket(linfo[d], x[d], points[p*grid.dim+d],
+			                           &IJK[d], &w[d], &owned); CHKERRQ(ierr);
+		}
+		if (!owned)
+			continue;
+		count[p] = 1;
+		probes.ids.push_back(p);
+		probes.weights.insert(probes.weights.end(), w, w+grid.dim);
+		// local (ghosted) indices of the cell corners; bit d: upper in direction d
+		for (c=0; c<nc; c++)
+		{
+			idx = IJK[0] + (c & 1) - info.gxs +
+			      info.gxm * (IJK[1] + ((c >> 1) & 1) - info.gys);
+			if (grid.dim == 3)
+				idx += info.gxm * info.gym * (IJK[2] + ((c >> 2) & 1) - info.gzs);
+			indices.push_back(idx);
+		}
+	}
+	for (d=0; d<grid.dim; d++)
+	{
+		ierr = DMDAVecRestoreArray(
+			lines[d]->da, lines[d]->local, &x[d]); CHKERRQ(ierr);
+	}
+	ierr = MPI_Allreduce(MPI_IN_PLACE, count.data(), n, MPIU_INT, MPI_SUM,
+	                     PETSC_COMM_WORLD); CHKERRQ(ierr);
+	for (p=0; p<n; p++)
+		if (count[p] != 1)
+			SETERRQ1(PETSC_COMM_WORLD, PETSC_ERR_ARG_OUTOFRANGE,
+			         "Probe %D is outside the domain", p);
+
+	// scatter of the cell-corner values from the global vector of the field
+	nlocal = probes.ids.size();
+	ierr = DMGetLocalToGlobalMapping(field.da, &ltog); CHKERRQ(ierr);
+	ierr = ISLocalToGlobalMappingApply(ltog, indices.size(), indices.data(),
+	                                   indices.data()); CHKERRQ(ierr);
+	ierr = ISCreateGeneral(PETSC_COMM_SELF, indices.size(), indices.data(),
+	                       PETSC_COPY_VALUES, &is); CHKERRQ(ierr);
+	ierr = VecCreateSeq(
+		PETSC_COMM_SELF, indices.size(), &probes.corners); CHKERRQ(ierr);
+	ierr = VecScatterCreate(
+		field.global, is, probes.corners, nullptr, &probes.scatter); CHKERRQ(ierr);
+	ierr = ISDestroy(&is); CHKERRQ(ierr);
+	probes.local.resize(nlocal);
+
+	// the values are gathered on rank 0 over the processes owning probes
+	ierr = MPI_Comm_rank(PETSC_COMM_WORLD, &rank); CHKERRQ(ierr);
+	ierr = MPI_Comm_split(PETSC_COMM_WORLD,
+	                      (nlocal > 0 or rank == 0) ? 0 : MPI_UNDEFINED,
+	                      rank, &probes.comm); CHKERRQ(ierr);
+	if (probes.comm == MPI_COMM_NULL)
+		PetscFunctionReturn(0);
+	ierr = MPI_Comm_size(probes.comm, &size); CHKERRQ(ierr);
+	if (rank == 0)
+	{
+		probes.counts.resize(size);
+		probes.displs.resize(size);
+		probes.order.resize(n);
+		probes.gathered.resize(n);
+		probes.values.resize(n);
+	}
+	ierr = MPI_Gather(&nlocal, 1, MPI_INT, probes.counts.data(), 1, MPI_INT,
+	                  0, probes.comm); CHKERRQ(ierr);
+	for (r=1; r<(PetscMPIInt) probes.displs.size(); r++)
+		probes.displs[r] = probes.displs[r-1] + probes.counts[r-1];
+	ierr = MPI_Gatherv(probes.ids.data(), nlocal, MPIU_INT,
+	                   probes.order.data(), probes.counts.data(),
+	                   probes.displs.data(), MPIU_INT,
+	                   0, probes.comm); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmProbesInitialize
+
+
+/*! Evaluates the probes with (bi/tri)-linear interpolation.
+ *
+ * The field should have the layout used to initialize the probes.
+ * The cell-corner values are scattered from the global vector, the processes
+ * owning probes interpolate them, and the values are gathered on rank 0.
+ *
+ * \param field The field to probe.
+ * \param probes The probes (passed by reference).
+ */
+PetscErrorCode PetibmProbesEvaluate(
+	const PetibmField field, PetibmProbes &probes)
+{
+	PetscErrorCode ierr;
+	const PetscReal *v, *w;
+	PetscInt p, c, d, nc = 1 << probes.dim;
+	PetscReal coeff;
+	PetscMPIInt rank;
+
+	PetscFunctionBeginUser;
+
+	ierr = VecScatterBegin(probes.scatter, field.global, probes.corners,
+	                       INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
+	ierr = VecScatterEnd(probes.scatter, field.global, probes.corners,
+	                     INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
+	if (probes.comm == MPI_COMM_NULL)
+		PetscFunctionReturn(0);
+
+	ierr = VecGetArrayRead(probes.corners, &v); CHKERRQ(ierr);
+	for (p=0; p<(PetscInt) probes.ids.size(); p++)
+	{
+		w = &probes.weights[p*probes.dim];
+		probes.local[p] = 0.0;
+		for (c=0; c<nc; c++)
+		{
+			coeff = 1.0;
+			for (d=0; d<probes.dim; d++)
+				coeff *= ((c >> d) & 1) ? w[d] : 1.0 - w[d];
+			probes.local[p] += coeff * v[p*nc+c];
+		}
+	}
+	ierr = VecRestoreArrayRead(probes.corners, &v); CHKERRQ(ierr);
+
+	ierr = MPI_Gatherv(probes.local.data(), probes.local.size(), MPIU_REAL,
+	                   probes.gathered.data(), probes.counts.data(),
+	                   probes.displs.data(), MPIU_REAL,
+	                   0, probes.comm); CHKERRQ(ierr);
+	ierr = MPI_Comm_rank(probes.comm, &rank); CHKERRQ(ierr);
+	if (rank == 0)
+		for (p=0; p<probes.size; p++)
+			probes.values[probes.order[p]] = probes.gathered[p];
+
+	PetscFunctionReturn(0);
+} // PetibmProbesEvaluate
+
+
+/*! Writes the header of an ASCII time-series file for the probes.
+ *
+ * The header lists the coordinates of the probes; the file is overwritten.
+ *
+ * \param filepath Path of the output file.
+ * \param probes The probes.
+ */
+PetscErrorCode PetibmProbesWriteHeader(
+	const std::string filepath, const PetibmProbes &probes)
+{
+	PetscErrorCode ierr;
+	PetscMPIInt rank;
+	PetscInt p, d;
+
+	PetscFunctionBeginUser;
+
+	ierr = MPI_Comm_rank(PETSC_COMM_WORLD, &rank); CHKERRQ(ierr);
+	if (rank != 0)
+		PetscFunctionReturn(0);
+	std::ofstream outfile(filepath.c_str(), std::ios::trunc);
+	if (!outfile.good())
+		SETERRQ(PETSC_COMM_SELF, PETSC_ERR_FILE_OPEN,
+		        "Cannot open the time-series file of the probes");
+	outfile << "# probes: " << probes.size << "\n";
+	for (p=0; p<probes.size; p++)
+	{
+		outfile << "# " << p << ":";
+		for (d=0; d<probes.dim; d++)
+			outfile << " " << probes.points[p*probes.dim+d];
+		outfile << "\n";
+	}
+	outfile << "# time-step, then one column per probe\n";
+
+	PetscFunctionReturn(0);
+} // PetibmProbesWriteHeader
+
+
+/*! Appends the values of the probes to an ASCII time-series file.
+ *
+ * One row per time step: the time-step index followed by one column per probe.
+ *
+ * \param filepath Path of the output file.
+ * \param step The time-step index.
+ * \param probes The probes.
+ */
+PetscErrorCode PetibmProbesWrite(
+	const std::string filepath, const PetscInt step,
+	const PetibmProbes &probes)
+{
+	PetscErrorCode ierr;
+	PetscMPIInt rank;
+
+	PetscFunctionBeginUser;
+
+	ierr = MPI_Comm_rank(PETSC_COMM_WORLD, &rank); CHKERRQ(ierr);
+	if (rank != 0)
+		PetscFunctionReturn(0);
+	std::ofstream outfile(filepath.c_str(), std::ios::app);
+	if (!outfile.good())
+		SETERRQ(PETSC_COMM_SELF, PETSC_ERR_FILE_OPEN,
+		        "Cannot open the time-series file of the probes");
+	outfile << step << std::scientific << std::setprecision(10);
+	for (auto value : probes.values)
+		outfile << " " << value;
+	outfile << "\n";
+
+	PetscFunctionReturn(0);
+} // PetibmProbesWrite
+
+
+/*! Destroys a PetibmProbes structure.
+ *
+ * \param probes The probes (passed by reference).
+ */
+PetscErrorCode PetibmProbesDestroy(PetibmProbes &probes)
+{
+	PetscErrorCode ierr;
+
+	PetscFunctionBeginUser;
+
+	ierr = VecScatterDestroy(&probes.scatter); CHKERRQ(ierr);
+	ierr = VecDestroy(&probes.corners); CHKERRQ(ierr);
+	if (probes.comm != MPI_COMM_NULL)
+	{
+		ierr = MPI_Comm_free(&probes.comm); CHKERRQ(ierr);
+	}
+	probes.points.clear();
+	probes.ids.clear();
+	probes.weights.clear();
+	probes.local.clear();
+	probes.gathered.clear();
+	probes.values.clear();
+	probes.order.clear();
+	probes.counts.clear();
+	probes.displs.clear();
+	probes.size = 0;
+
+	PetscFunctionReturn(0);
+} // PetibmProbesDestroy
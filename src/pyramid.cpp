@@ -0,0 +1,366 @@
+/*! Implementation of the functions for the PetibmPyramid structure.
+ * \file pyramid.cpp
+ */
+
+#include <fstream>
+
+#include <petscviewerhdf5.h>
+
+#include "petibm-utilities/pyramid.h"
+
+
+/*! Gathers all the stations of a gridline on every process.
+ *
+ * \param coords The vector with the stations (sequential or distributed).
+ * \param stations The stations (passed by reference).
+ */
+static PetscErrorCode PetibmPyramidGetStations(
+	const Vec coords, std::vector<PetscReal> &stations)
+{
+	PetscErrorCode ierr;
+	VecScatter scatter;
+	Vec all;
+	const PetscReal *arr;
+	PetscInt n;
+
+	PetscFunctionBeginUser;
+
+	ierr = VecScatterCreateToAll(coords, &scatter, &all); CHKERRQ(ierr);
+	ierr = VecScatterBegin(
+		scatter, coords, all, INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
+	ierr = VecScatterEnd(
+		scatter, coords, all, INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
+	ierr = VecGetSize(all, &n); CHKERRQ(ierr);
+	ierr = VecGetArrayRead(all, &arr); CHKERRQ(ierr);
+	stations.assign(arr, arr + n);
+	ierr = VecRestoreArrayRead(all, &arr); CHKERRQ(ierr);
+	ierr = VecScatterDestroy(&scatter); CHKERRQ(ierr);
+	ierr = VecDestroy(&all); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmPyramidGetStations
+
+
+/*! Creates a DMDA object with a box stencil and given ownership ranges.
+ *
+ * \param dim Dimension of the DMDA.
+ * \param M Number of points in each direction.
+ * \param procs Number of processes in each direction.
+ * \param ranges Number of points owned by the processes in each direction.
+ * \param da The DMDA object (passed by pointer).
+ */
+static PetscErrorCode PetibmPyramidCreateDMDA(
+	const PetscInt dim, const PetscInt M[], const PetscInt procs[],
+	const PetscInt *const ranges[], DM *da)
+{
+	PetscErrorCode ierr;
+
+	PetscFunctionBeginUser;
+
+	if (dim == 3)
+	{
+		ierr = DMDACreate3d(PETSC_COMM_WORLD,
+		                    DM_BOUNDARY_GHOSTED, DM_BOUNDARY_GHOSTED,
+		                    DM_BOUNDARY_GHOSTED,
+		                    DMDA_STENCIL_BOX,
+		                    M[0], M[1], M[2],
+		                    procs[0], procs[1], procs[2],
+		                    1, 1,
+		                    ranges[0], ranges[1], ranges[2],
+		                    da); CHKERRQ(ierr);
+	}
+	else
+	{
+		ierr = DMDACreate2d(PETSC_COMM_WORLD,
+		                    DM_BOUNDARY_GHOSTED, DM_BOUNDARY_GHOSTED,
+		                    DMDA_STENCIL_BOX,
+		                    M[0], M[1],
+		                    procs[0], procs[1],
+		                    1, 1,
+		                    ranges[0], ranges[1],
+		                    da); CHKERRQ(ierr);
+	}
+	ierr = DMSetUp(*da); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmPyramidCreateDMDA
+
+
+/*! Initializes the coarse levels of a pyramid for a field layout.
+ *
+ * Collective; the DMDA objects of the coarse levels follow the decomposition
+ * of the field, and the coarsening stops before a process would own no point
+ * (the number of levels built can be smaller than requested).
+ * The gridlines can be sequential (all the stations) or distributed.
+ *
+ * \param grid The grid of the field.
+ * \param field The field (fine level).
+ * \param levels The number of coarse levels requested.
+ * \param pyramid The pyramid to initialize (passed by reference).
+ */
+PetscErrorCode PetibmPyramidInitialize(
+	const PetibmGrid grid, const PetibmField field, const PetscInt levels,
+	PetibmPyramid &pyramid)
+{
+	PetscErrorCode ierr;
+	const Vec coords[3] = {grid.x.coords, grid.y.coords, grid.z.coords};
+	DM fine, coarse;
+	Vec global;
+	PetscInt M[3] = {1, 1, 1}, procs[3] = {1, 1, 1}, Mc[3] = {1, 1, 1},
+	         l, d, i, start;
+	const PetscInt *ranges[3];
+	std::vector<PetscInt> lc[3];
+	PetscBool coarsenable;
+
+	PetscFunctionBeginUser;
+
+	ierr = DMDAGetInfo(field.da,
+	                   &pyramid.dim,
+	                   nullptr, nullptr, nullptr,
+	                   nullptr, nullptr, nullptr,
+	                   nullptr, nullptr,
+	                   nullptr, nullptr, nullptr,
+	                   nullptr); CHKERRQ(ierr);
+	pyramid.stations.resize(3);
+	for (d=0; d<pyramid.dim; d++)
+	{
+		ierr = PetibmPyramidGetStations(
+			coords[d], pyramid.stations[d]); CHKERRQ(ierr);
+	}
+
+	fine = field.da;
+	for (l=1; l<=levels; l++)
+	{
+		ierr = DMDAGetInfo(fine,
+		                   nullptr,
+		                   &M[0], &M[1], &M[2],
+		                   &procs[0], &procs[1], &procs[2],
+		                   nullptr, nullptr,
+		                   nullptr, nullptr, nullptr,
+		                   nullptr); CHKERRQ(ierr);
+		ierr = DMDAGetOwnershipRanges(
+			fine, &ranges[0], &ranges[1], &ranges[2]); CHKERRQ(ierr);
+		if (l == 1)
+		{
+			// the blocks need the corner ghost points: box stencil on the field layout
+			ierr = PetibmPyramidCreateDMDA(pyramid.dim, M, procs, ranges,
+			                               &pyramid.fine); CHKERRQ(ierr);
+		}
+		// coarse point i is owned by the process owning fine point 2i
+		coarsenable = PETSC_TRUE;
+		for (d=0; d<pyramid.dim; d++)
+		{
+			Mc[d] = (M[d] + 1) / 2;
+			lc[d].resize(procs[d]);
+			for (i=0, start=0; i<procs[d]; start+=ranges[d][i], i++)
+			{
+				lc[d][i] = (start + ranges[d][i] + 1) / 2 - (start + 1) / 2;
+				if (lc[d][i] == 0)
+					coarsenable = PETSC_FALSE;
+			}
+			if (Mc[d] < 2)
+				coarsenable = PETSC_FALSE;
+		}
+		if (!coarsenable)
+			break;
+		for (d=0; d<pyramid.dim; d++)
+			ranges[d] = lc[d].data();
+		ierr = PetibmPyramidCreateDMDA(
+			pyramid.dim, Mc, procs, ranges, &coarse); CHKERRQ(ierr);
+		ierr = DMCreateGlobalVector(coarse, &global); CHKERRQ(ierr);
+		pyramid.das.push_back(coarse);
+		pyramid.globals.push_back(global);
+		// coarse stations: mid-points of the fine stations of each block
+		for (d=0; d<pyramid.dim; d++)
+		{
+			const std::vector<PetscReal> &s = pyramid.stations[3*(l-1)+d];
+			std::vector<PetscReal> sc(Mc[d]);
+			for (i=0; i<Mc[d]; i++)
+				sc[i] = (2*i+1 < M[d]) ? 0.5 * (s[2*i] + s[2*i+1]) : s[2*i];
+			pyramid.stations.push_back(sc);
+		}
+		for (d=pyramid.dim; d<3; d++)
+			pyramid.stations.push_back(std::vector<PetscReal>());
+		fine = coarse;
+	}
+	pyramid.levels = pyramid.das.size();
+
+	PetscFunctionReturn(0);
+} // PetibmPyramidInitialize
+
+
+/*! Averages the blocks of fine points into the coarse points on process.
+ *
+ * \param fine DMDA object of the fine level.
+ * \param local Local (ghosted) vector of the fine level.
+ * \param coarse DMDA object of the coarse level.
+ * \param global Global vector of the coarse level (passed by pointer).
+ */
+static PetscErrorCode PetibmPyramidRestrict(
+	const DM fine, const Vec local, const DM coarse, Vec *global)
+{
+	PetscErrorCode ierr;
+	DMDALocalInfo info, infoc;
+	PetscInt i, j, k, a, b, c, count;
+	PetscReal sum, **f2, **c2, ***f3, ***c3;
+
+	PetscFunctionBeginUser;
+
+	ierr = DMDAGetLocalInfo(fine, &info); CHKERRQ(ierr);
+	ierr = DMDAGetLocalInfo(coarse, &infoc); CHKERRQ(ierr);
+	if (info.dim == 3)
+	{
+		ierr = DMDAVecGetArray(fine, local, &f3); CHKERRQ(ierr);
+		ierr = DMDAVecGetArray(coarse, *global, &c3); CHKERRQ(ierr);
+		for (k=infoc.zs; k<infoc.zs+infoc.zm; k++)
+			for (j=infoc.ys; j<infoc.ys+infoc.ym; j++)
+				for (i=infoc.xs; i<infoc.xs+infoc.xm; i++)
+				{
+					sum = 0.0;
+					count = 0;
+					for (c=2*k; c<PetscMin(2*k+2, info.mz); c++)
+						for (b=2*j; b<PetscMin(2*j+2, info.my); b++)
+							for (a=2*i; a<PetscMin(2*i+2, info.mx); a++, count++)
+								sum += f3[c][b][a];
+					c3[k][j][i] = sum / count;
+				}
+		ierr = DMDAVecRestoreArray(fine, local, &f3); CHKERRQ(ierr);
+		ierr = DMDAVecRestoreArray(coarse, *global, &c3); CHKERRQ(ierr);
+	}
+	else
+	{
+		ierr = DMDAVecGetArray(fine, local, &f2); CHKERRQ(ierr);
+		ierr = DMDAVecGetArray(coarse, *global, &c2); CHKERRQ(ierr);
+		for (j=infoc.ys; j<infoc.ys+infoc.ym; j++)
+			for (i=infoc.xs; i<infoc.xs+infoc.xm; i++)
+			{
+				sum = 0.0;
+				count = 0;
+				for (b=2*j; b<PetscMin(2*j+2, info.my); b++)
+					for (a=2*i; a<PetscMin(2*i+2, info.mx); a++, count++)
+						sum += f2[b][a];
+				c2[j][i] = sum / count;
+			}
+		ierr = DMDAVecRestoreArray(fine, local, &f2); CHKERRQ(ierr);
+		ierr = DMDAVecRestoreArray(coarse, *global, &c2); CHKERRQ(ierr);
+	}
+
+	PetscFunctionReturn(0);
+} // PetibmPyramidRestrict
+
+
+/*! Writes the coarse levels of a field into an HDF5 file.
+ *
+ * Each level is obtained by cell-averaging the previous one and is written,
+ * with its gridlines, in the group `<name>_lod<l>` of the file (datasets
+ * `<name>`, `x`, `y`, and `z`); the full-resolution field is left to
+ * PetibmFieldHDF5Write.
+ *
+ * \param filepath Path of the output file.
+ * \param name Name of the field.
+ * \param field The field (passed by reference).
+ * \param pyramid The pyramid (passed by reference).
+ */
+PetscErrorCode PetibmPyramidHDF5Write(
+	const std::string filepath, const std::string name,
+	PetibmField &field, PetibmPyramid &pyramid)
+{
+	PetscErrorCode ierr;
+	const char *dirs[3] = {"x", "y", "z"};
+	PetscViewer viewer;
+	PetscFileMode mode;
+	DM fine;
+	Vec global, local, stations;
+	PetscInt l, d;
+	PetscMPIInt rank;
+
+	PetscFunctionBeginUser;
+
+	if (pyramid.levels == 0)
+		PetscFunctionReturn(0);
+
+	std::ifstream infile(filepath.c_str());
+	mode = (infile.good()) ? FILE_MODE_APPEND : FILE_MODE_WRITE;
+	infile.close();
+
+	// restrict level by level and write the values collectively
+	ierr = PetscViewerHDF5Open(
+		PETSC_COMM_WORLD, filepath.c_str(), mode, &viewer); CHKERRQ(ierr);
+	for (l=1; l<=pyramid.levels; l++)
+	{
+		fine = (l == 1) ? pyramid.fine : pyramid.das[l-2];
+		global = (l == 1) ? field.global : pyramid.globals[l-2];
+		ierr = DMGetLocalVector(fine, &local); CHKERRQ(ierr);
+		ierr = DMGlobalToLocalBegin(
+			fine, global, INSERT_VALUES, local); CHKERRQ(ierr);
+		ierr = DMGlobalToLocalEnd(
+			fine, global, INSERT_VALUES, local); CHKERRQ(ierr);
+		ierr = PetibmPyramidRestrict(fine, local, pyramid.das[l-1],
+		                             &pyramid.globals[l-1]); CHKERRQ(ierr);
+		ierr = DMRestoreLocalVector(fine, &local); CHKERRQ(ierr);
+		ierr = PetscViewerHDF5PushGroup(
+			viewer, (name+"_lod"+std::to_string(l)).c_str()); CHKERRQ(ierr);
+		ierr = PetscObjectSetName(
+			(PetscObject) pyramid.globals[l-1], name.c_str()); CHKERRQ(ierr);
+		ierr = VecView(pyramid.globals[l-1], viewer); CHKERRQ(ierr);
+		ierr = PetscViewerHDF5PopGroup(viewer); CHKERRQ(ierr);
+	}
+	ierr = PetscViewerDestroy(&viewer); CHKERRQ(ierr);
+
+	// coarse gridlines written by rank 0 once the file is closed
+	ierr = MPI_Comm_rank(PETSC_COMM_WORLD, &rank); CHKERRQ(ierr);
+	if (rank == 0)
+	{
+		ierr = PetscViewerHDF5Open(
+			PETSC_COMM_SELF, filepath.c_str(), FILE_MODE_APPEND,
+			&viewer); CHKERRQ(ierr);
+		for (l=1; l<=pyramid.levels; l++)
+		{
+			ierr = PetscViewerHDF5PushGroup(
+				viewer, (name+"_lod"+std::to_string(l)).c_str()); CHKERRQ(ierr);
+			for (d=0; d<pyramid.dim; d++)
+			{
+				std::vector<PetscReal> &s = pyramid.stations[3*l+d];
+				ierr = VecCreateSeqWithArray(PETSC_COMM_SELF, 1, s.size(),
+				                             s.data(), &stations); CHKERRQ(ierr);
+				ierr = PetscObjectSetName(
+					(PetscObject) stations, dirs[d]); CHKERRQ(ierr);
+				ierr = VecView(stations, viewer); CHKERRQ(ierr);
+				ierr = VecDestroy(&stations); CHKERRQ(ierr);
+			}
+			ierr = PetscViewerHDF5PopGroup(viewer); CHKERRQ(ierr);
+		}
+		ierr = PetscViewerDestroy(&viewer); CHKERRQ(ierr);
+	}
+	ierr = MPI_Barrier(PETSC_COMM_WORLD); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmPyramidHDF5Write
+
+
+/*! Destroys a PetibmPyramid structure.
+ *
+ * \param pyramid The pyramid (passed by reference).
+ */
+PetscErrorCode PetibmPyramidDestroy(PetibmPyramid &pyramid)
+{
+	PetscErrorCode ierr;
+
+	PetscFunctionBeginUser;
+
+	for (auto &global : pyramid.globals)
+	{
+		ierr = VecDestroy(&global); CHKERRQ(ierr);
+	}
+	for (auto &da : pyramid.das)
+	{
+		ierr = DMDestroy(&da); CHKERRQ(ierr);
+	}
+	ierr = DMDestroy(&pyramid.fine); CHKERRQ(ierr);
+	pyramid.globals.clear();
+	pyramid.das.clear();
+	pyramid.stations.clear();
+	pyramid.levels = 0;
+
+	PetscFunctionReturn(0);
+} // PetibmPyramidDestroy
@@ -0,0 +1,391 @@
+/*! Implementation of the functions for the PetibmSlice structure.
+ * \file slice.cpp
+ */
+
+#include <algorithm>
+#include <fstream>
+
+#include <petscviewerhdf5.h>
+
+#include "petibm-utilities/slice.h"
+#include "petibm-utilities/misc.h"
+
+
+/*! Names of the directions normal to a slice.
+ */
+static const char *const PetibmSliceDirections[] = {"x", "y", "z"};
+
+
+/*! Gets options from command-line or config file.
+ *
+ * `-direction <x|y|z>`, `-value <coordinate>`, and `-min_points <n>` (minimum
+ * number of slice points per process, to size the sub-communicator).
+ *
+ * \param prefix String to prepend to options.
+ * \param ctx The PetibmSliceCtx structure to fill (passed by pointer).
+ */
+PetscErrorCode PetibmSliceGetOptions(
+	const char prefix[], PetibmSliceCtx *ctx)
+{
+	PetscErrorCode ierr;
+	char path[PETSC_MAX_PATH_LEN];
+	PetscBool found;
+
+	PetscFunctionBeginUser;
+
+	// get path of configuration file
+	ierr = PetscOptionsGetString(nullptr, prefix, "-config_file",
+	                             path, sizeof(path), &found); CHKERRQ(ierr);
+	if (found)
+	{
+		ierr = PetibmOptionsInsertFile(path); CHKERRQ(ierr);
+	}
+	// get direction normal to the slice
+	ierr = PetscOptionsGetEList(nullptr, prefix, "-direction",
+	                            PetibmSliceDirections, 3,
+	                            &ctx->direction, &found); CHKERRQ(ierr);
+	// get coordinate of the slice
+	ierr = PetscOptionsGetReal(
+		nullptr, prefix, "-value", &ctx->value, &found); CHKERRQ(ierr);
+	// get minimum number of points per process
+	ierr = PetscOptionsGetInt(
+		nullptr, prefix, "-min_points", &ctx->min_points, &found); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmSliceGetOptions
+
+
+PetscErrorCode PetibmSliceCtxPrintf(
+	const std::string name, const PetibmSliceCtx ctx)
+{
+	PetscErrorCode ierr;
+
+	PetscFunctionBeginUser;
+
+	ierr = PetscPrintf(PETSC_COMM_WORLD, "+ %s:\n", name.c_str()); CHKERRQ(ierr);
+	ierr = PetscPrintf(PETSC_COMM_WORLD, "\t- %s = %g\n",
+	                   PetibmSliceDirections[ctx.direction],
+	                   ctx.value); CHKERRQ(ierr);
+	ierr = PetscPrintf(PETSC_COMM_WORLD, "\t- minimum points per process: %d\n",
+	                   ctx.min_points); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmSliceCtxPrintf
+
+
+/*! Initializes a slice of a 3D field.
+ *
+ * Collective on PETSC_COMM_WORLD.
+ * Reads the gridlines (with PetibmGridlineHDF5ReadShared), brackets the
+ * coordinate of the slice with the stations along the normal direction, and
+ * creates the 2D field over a sub-communicator with at most one process per
+ * `min_points` points of the slice.
+ *
+ * \param ctx The slice context.
+ * \param gridCtx The context of the grid of the 3D field.
+ * \param slice The slice to initialize (passed by reference).
+ */
+PetscErrorCode PetibmSliceInitialize(
+	const PetibmSliceCtx ctx, const PetibmGridCtx gridCtx, PetibmSlice &slice)
+{
+	PetscErrorCode ierr;
+	Vec normal;
+	const PetscReal *x;
+	PetscInt d, a, npoints, nprocs;
+	PetscMPIInt rank, size;
+	DM da;
+
+	PetscFunctionBeginUser;
+
+	if (gridCtx.nz <= 0)
+		SETERRQ(PETSC_COMM_WORLD, PETSC_ERR_SUP,
+		        "Slices are only extracted from 3D fields");
+	slice.direction = ctx.direction;
+	slice.n[0] = gridCtx.nx;
+	slice.n[1] = gridCtx.ny;
+	slice.n[2] = gridCtx.nz;
+	for (d=0, a=0; d<3; d++)
+		if (d != slice.direction)
+			slice.axes[a++] = d;
+
+	// read the stations and bracket the coordinate of the slice
+	ierr = PetibmGridlineHDF5ReadShared(
+		gridCtx.path, gridCtx.name, PetibmSliceDirections[slice.direction],
+		slice.n[slice.direction], &normal); CHKERRQ(ierr);
+	for (a=0; a<2; a++)
+	{
+		ierr = PetibmGridlineHDF5ReadShared(
+			gridCtx.path, gridCtx.name, PetibmSliceDirections[slice.axes[a]],
+			slice.n[slice.axes[a]], &slice.stations[a]); CHKERRQ(ierr);
+	}
+	ierr = VecGetArrayRead(normal, &x); CHKERRQ(ierr);
+	d = slice.n[slice.direction];
+	if (ctx.value < x[0] or ctx.value > x[d-1])
+	{
+		ierr = VecRestoreArrayRead(normal, &x); CHKERRQ(ierr);
+		SETERRQ(PETSC_COMM_WORLD, PETSC_ERR_ARG_OUTOFRANGE,
+		        "The slice is outside the domain");
+	}
+	slice.index = std::lower_bound(x, x+d, ctx.value) - x;
+	if (x[slice.index] == ctx.value)
+	{
+		// the slice lies on a plane: read a single plane
+		slice.planes = 1;
+		slice.weight = 0.0;
+	}
+	else
+	{
+		slice.index--;
+		slice.planes = 2;
+		slice.weight = ((ctx.value - x[slice.index]) /
+		                (x[slice.index+1] - x[slice.index]));
+	}
+	ierr = VecRestoreArrayRead(normal, &x); CHKERRQ(ierr);
+	ierr = VecDestroy(&normal); CHKERRQ(ierr);
+
+	// sub-communicator sized to the number of points in the slice
+	ierr = MPI_Comm_rank(PETSC_COMM_WORLD, &rank); CHKERRQ(ierr);
+	ierr = MPI_Comm_size(PETSC_COMM_WORLD, &size); CHKERRQ(ierr);
+	npoints = slice.n[slice.axes[0]] * slice.n[slice.axes[1]];
+	nprocs = PetscMax(1, PetscMin(size, npoints / PetscMax(1, ctx.min_points)));
+	ierr = MPI_Comm_split(PETSC_COMM_WORLD, (rank < nprocs) ? 0 : MPI_UNDEFINED,
+	                      rank, &slice.comm); CHKERRQ(ierr);
+	if (slice.comm == MPI_COMM_NULL)
+		PetscFunctionReturn(0);
+
+	// create the 2D field over the sub-communicator
+	ierr = DMDACreate2d(slice.comm,
+	                    DM_BOUNDARY_GHOSTED, DM_BOUNDARY_GHOSTED,
+	                    DMDA_STENCIL_BOX,
+	                    slice.n[slice.axes[0]], slice.n[slice.axes[1]],
+	                    PETSC_DECIDE, PETSC_DECIDE,
+	                    1, 1,
+	                    nullptr, nullptr,
+	                    &da); CHKERRQ(ierr);
+	ierr = DMSetUp(da); CHKERRQ(ierr);
+	ierr = PetibmFieldInitialize(da, slice.field); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmSliceInitialize
+
+
+/*! Reads a slice of a 3D field stored in HDF5 format.
+ *
+ * Collective on the sub-communicator of the slice (no-op on other processes).
+ * Each process reads the hyperslab of the bracketing plane(s) matching its
+ * part of the slice, then interpolates linearly between the two planes.
+ *
+ * \param filepath Path of the input file.
+ * \param name Name of the 3D field.
+ * \param slice The slice (passed by reference).
+ */
+PetscErrorCode PetibmSliceHDF5Read(
+	const std::string filepath, const std::string name, PetibmSlice &slice)
+{
+	PetscErrorCode ierr;
+	PetscViewer viewer;
+	hid_t file, dset, fspace, mspace, dxpl,
+	      mtype = (sizeof(PetscReal) == sizeof(double)) ?
+	              H5T_NATIVE_DOUBLE : H5T_NATIVE_FLOAT;
+	hsize_t dims[3], start[3], count[3], stride[3];
+	herr_t status;
+	PetscInt xs, ys, xm, ym, i, j, idx;
+	PetscReal **arr;
+	// dimensions of the dataset are ordered (z, y, x)
+	const PetscInt fd = 2 - slice.direction,
+	               fa = 2 - slice.axes[0],
+	               fb = 2 - slice.axes[1];
+
+	PetscFunctionBeginUser;
+
+	if (slice.comm == MPI_COMM_NULL)
+		PetscFunctionReturn(0);
+
+	// hyperslab of the process: its part of the slice in the bracketing planes
+	ierr = DMDAGetCorners(
+		slice.field.da, &xs, &ys, nullptr, &xm, &ym, nullptr); CHKERRQ(ierr);
+	start[fd] = slice.index;
+	count[fd] = slice.planes;
+	start[fa] = xs;
+	count[fa] = xm;
+	start[fb] = ys;
+	count[fb] = ym;
+	stride[2] = 1;
+	stride[1] = count[2];
+	stride[0] = count[2] * count[1];
+	slice.buffer.resize(count[0] * count[1] * count[2]);
+
+	ierr = PetscViewerHDF5Open(
+		slice.comm, filepath.c_str(), FILE_MODE_READ, &viewer); CHKERRQ(ierr);
+	ierr = PetscViewerHDF5GetFileId(viewer, &file); CHKERRQ(ierr);
+	dset = H5Dopen2(file, name.c_str(), H5P_DEFAULT);
+	if (dset < 0)
+	{
+		ierr = PetscViewerDestroy(&viewer); CHKERRQ(ierr);
+		SETERRQ(PETSC_COMM_SELF, PETSC_ERR_FILE_UNEXPECTED,
+		        "Cannot open the dataset of the field");
+	}
+	fspace = H5Dget_space(dset);
+	// release the dataset, its dataspace and the viewer (on error or done)
+	auto release = [&]() -> PetscErrorCode
+	{
+		H5Sclose(fspace);
+		H5Dclose(dset);
+		return PetscViewerDestroy(&viewer);
+	};
+	if (H5Sget_simple_extent_ndims(fspace) != 3)
+	{
+		ierr = release(); CHKERRQ(ierr);
+		SETERRQ(PETSC_COMM_SELF, PETSC_ERR_FILE_UNEXPECTED,
+		        "The dataset of the field is not 3D");
+	}
+	H5Sget_simple_extent_dims(fspace, dims, nullptr);
+	for (i=0; i<3; i++)
+		if ((PetscInt) dims[2-i] != slice.n[i])
+		{
+			ierr = release(); CHKERRQ(ierr);
+			SETERRQ(PETSC_COMM_SELF, PETSC_ERR_FILE_UNEXPECTED,
+			        "The dataset of the field does not match the grid");
+		}
+	status = H5Sselect_hyperslab(
+		fspace, H5S_SELECT_SET, start, nullptr, count, nullptr);
+	if (status < 0)
+	{
+		ierr = release(); CHKERRQ(ierr);
+		SETERRQ(PETSC_COMM_SELF, PETSC_ERR_LIB, "Cannot select the hyperslab");
+	}
+	mspace = H5Screate_simple(3, count, nullptr);
+	dxpl = H5Pcreate(H5P_DATASET_XFER);
+#if defined(H5_HAVE_PARALLEL)
+	H5Pset_dxpl_mpio(dxpl, H5FD_MPIO_COLLECTIVE);
+#endif
+	status = H5Dread(dset, mtype, mspace, fspace, dxpl, slice.buffer.data());
+	H5Pclose(dxpl);
+	H5Sclose(mspace);
+	ierr = release(); CHKERRQ(ierr);
+	if (status < 0)
+		SETERRQ(PETSC_COMM_SELF, PETSC_ERR_FILE_READ,
+		        "Cannot read the hyperslab of the field");
+
+	// interpolate between the bracketing planes
+	ierr = DMDAVecGetArray(slice.field.da, slice.field.global, &arr); CHKERRQ(ierr);
+	for (j=0; j<ym; j++)
+	{
+		for (i=0; i<xm; i++)
+		{
+			idx = i * stride[fa] + j * stride[fb];
+			arr[ys+j][xs+i] = slice.buffer[idx];
+			if (slice.planes == 2)
+				arr[ys+j][xs+i] = ((1.0 - slice.weight) * slice.buffer[idx] +
+				                   slice.weight * slice.buffer[idx+stride[fd]]);
+		}
+	}
+	ierr = DMDAVecRestoreArray(
+		slice.field.da, slice.field.global, &arr); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmSliceHDF5Read
+
+
+/*! Writes the 2D field of a slice in HDF5 format.
+ *
+ * Collective on the sub-communicator of the slice (no-op on other processes).
+ *
+ * \param filepath Path of the output file.
+ * \param name Name of the 2D field.
+ * \param slice The slice.
+ */
+PetscErrorCode PetibmSliceHDF5Write(
+	const std::string filepath, const std::string name,
+	const PetibmSlice &slice)
+{
+	PetscErrorCode ierr;
+	PetscViewer viewer;
+	PetscFileMode mode;
+
+	PetscFunctionBeginUser;
+
+	if (slice.comm == MPI_COMM_NULL)
+		PetscFunctionReturn(0);
+
+	std::ifstream infile(filepath.c_str());
+	mode = (infile.good()) ? FILE_MODE_APPEND : FILE_MODE_WRITE;
+	infile.close();
+
+	ierr = PetscObjectSetName(
+		(PetscObject) slice.field.global, name.c_str()); CHKERRQ(ierr);
+	ierr = PetscViewerHDF5Open(
+		slice.comm, filepath.c_str(), mode, &viewer); CHKERRQ(ierr);
+	ierr = VecView(slice.field.global, viewer); CHKERRQ(ierr);
+	ierr = PetscViewerDestroy(&viewer); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmSliceHDF5Write
+
+
+/*! Writes the 2D grid of a slice in HDF5 format.
+ *
+ * The stations along the in-plane directions are written as the x and y
+ * gridlines of the group, so that the 2D tools can read them.
+ *
+ * \param filepath Path of the output file.
+ * \param varname Name of the grid (group name in the HDF5 file).
+ * \param slice The slice.
+ */
+PetscErrorCode PetibmSliceGridHDF5Write(
+	const std::string filepath, const std::string varname,
+	const PetibmSlice &slice)
+{
+	PetscErrorCode ierr;
+	PetscViewer viewer;
+	PetscFileMode mode;
+	PetscMPIInt rank;
+
+	PetscFunctionBeginUser;
+
+	ierr = MPI_Comm_rank(PETSC_COMM_WORLD, &rank); CHKERRQ(ierr);
+	if (rank != 0)
+		PetscFunctionReturn(0);
+
+	std::ifstream infile(filepath.c_str());
+	mode = (infile.good()) ? FILE_MODE_APPEND : FILE_MODE_WRITE;
+	infile.close();
+
+	ierr = PetscViewerHDF5Open(
+		PETSC_COMM_SELF, filepath.c_str(), mode, &viewer); CHKERRQ(ierr);
+	ierr = PetscViewerHDF5PushGroup(viewer, varname.c_str()); CHKERRQ(ierr);
+	ierr = PetscObjectSetName(
+		(PetscObject) slice.stations[0], "x"); CHKERRQ(ierr);
+	ierr = VecView(slice.stations[0], viewer); CHKERRQ(ierr);
+	ierr = PetscObjectSetName(
+		(PetscObject) slice.stations[1], "y"); CHKERRQ(ierr);
+	ierr = VecView(slice.stations[1], viewer); CHKERRQ(ierr);
+	ierr = PetscViewerDestroy(&viewer); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmSliceGridHDF5Write
+
+
+/*! Destroys a PetibmSlice structure.
+ *
+ * Collective on PETSC_COMM_WORLD.
+ *
+ * \param slice The slice (passed by reference).
+ */
+PetscErrorCode PetibmSliceDestroy(PetibmSlice &slice)
+{
+	PetscErrorCode ierr;
+
+	PetscFunctionBeginUser;
+
+	ierr = VecDestroy(&slice.stations[0]); CHKERRQ(ierr);
+	ierr = VecDestroy(&slice.stations[1]); CHKERRQ(ierr);
+	if (slice.comm != MPI_COMM_NULL)
+	{
+		ierr = PetibmFieldDestroy(slice.field); CHKERRQ(ierr);
+		ierr = MPI_Comm_free(&slice.comm); CHKERRQ(ierr);
+	}
+	slice.buffer.clear();
+
+	PetscFunctionReturn(0);
+} // PetibmSliceDestroy
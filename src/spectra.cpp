@@ -0,0 +1,287 @@
+/*! Implementation of the functions for the PetibmSpectrum structure.
+ * \file spectra.cpp
+ */
+
+#include <fstream>
+#include <iomanip>
+
+#include "petibm-utilities/spectra.h"
+#include "petibm-utilities/threads.h"
+
+
+/*! Initializes the spectrum along a periodic direction of a field.
+ *
+ * The pencils are split evenly between the processes and the scatter from
+ * the global vector of the field to the pencils is created once.
+ * Collective.
+ *
+ * \param field The field (scalar, periodic along the direction).
+ * \param direction Index of the periodic direction.
+ * \param length Period along the direction.
+ * \param spectrum The spectrum to initialize (passed by reference).
+ */
+PetscErrorCode PetibmSpectrumInitialize(
+	const PetibmField field, const PetscInt direction, const PetscReal length,
+	PetibmSpectrum &spectrum)
+{
+	PetscErrorCode ierr;
+	PetscInt dim, dof, sizes[3] = {1, 1, 1}, other[2] = {0, 0},
+	         idx[3] = {0, 0, 0}, first, p, l, d, o;
+	DMBoundaryType bTypes[3];
+	std::vector<PetscInt> indices;
+	AO ao;
+	IS is;
+
+	PetscFunctionBeginUser;
+
+	ierr = DMDAGetInfo(field.da, &dim, sizes, sizes+1, sizes+2,
+	                   nullptr, nullptr, nullptr, &dof, nullptr,
+	                   bTypes, bTypes+1, bTypes+2, nullptr); CHKERRQ(ierr);
+	if (dof != 1)
+		SETERRQ(PETSC_COMM_WORLD, PETSC_ERR_SUP,
+		        "Function only supports scalar fields");
+	if (direction < 0 or direction >= dim)
+		SETERRQ1(PETSC_COMM_WORLD, PETSC_ERR_ARG_OUTOFRANGE,
+		         "Invalid direction %D", direction);
+	if (bTypes[direction] != DM_BOUNDARY_PERIODIC)
+		SETERRQ1(PETSC_COMM_WORLD, PETSC_ERR_ARG_INCOMP,
+		         "The field should be periodic in direction %D", direction);
+	if (dim == 2)
+		sizes[2] = 1;
+	for (d=0, o=0; d<3; d++)
+		if (d != direction)
+			other[o++] = d;
+	spectrum.direction = direction;
+	spectrum.length = length;
+	spectrum.n = sizes[direction];
+	spectrum.total = sizes[other[0]] * sizes[other[1]];
+	spectrum.pencils = PETSC_DECIDE;
+	ierr = PetscSplitOwnership(PETSC_COMM_WORLD, &spectrum.pencils,
+	                           &spectrum.total); CHKERRQ(ierr);
+	ierr = MPI_Scan(&spectrum.pencils, &first, 1, MPIU_INT, MPI_SUM,
+	                PETSC_COMM_WORLD); CHKERRQ(ierr);
+	first -= spectrum.pencils;
+
+	// natural indices of the pencils on process, contiguous along the direction
+	indices.resize(spectrum.pencils * spectrum.n);
+	for (p=0; p<spectrum.pencils; p++)
+	{
+		idx[other[0]] = (first + p) % sizes[other[0]];
+		idx[other[1]] = (first + p) / sizes[other[0]];
+		for (l=0; l<spectrum.n; l++)
+		{
+			idx[direction] = l;
+			indices[p*spectrum.n+l] = idx[0] + sizes[0]*(idx[1] + sizes[1]*idx[2]);
+		}
+	}
+	ierr = DMDAGetAO(field.da, &ao); CHKERRQ(ierr);
+	ierr = AOApplicationToPetsc(
+		ao, indices.size(), indices.data()); CHKERRQ(ierr);
+	ierr = ISCreateGeneral(PETSC_COMM_SELF, indices.size(), indices.data(),
+	                       PETSC_COPY_VALUES, &is); CHKERRQ(ierr);
+	ierr = VecCreateSeq(
+		PETSC_COMM_SELF, indices.size(), &spectrum.lines); CHKERRQ(ierr);
+	ierr = VecScatterCreate(
+		field.global, is, spectrum.lines, nullptr, &spectrum.scatter); CHKERRQ(ierr);
+	ierr = ISDestroy(&is); CHKERRQ(ierr);
+
+	ierr = PetibmFFTInitialize(spectrum.n, spectrum.fft); CHKERRQ(ierr);
+	spectrum.energy.assign(spectrum.n/2+1, 0.0);
+	spectrum.sum.assign(spectrum.n/2+1, 0.0);
+	spectrum.count = 0;
+
+	PetscFunctionReturn(0);
+} // PetibmSpectrumInitialize
+
+
+/*! Computes the spectrum of a field and adds it to the accumulated ones.
+ *
+ * The pencils are scattered from the global vector of the field and
+ * transformed by batches on the threads of the process.
+ * The energy of wavenumber k (0 <= k <= n/2) is |X_k|^2/n^2, doubled when
+ * -k is another wavenumber, so that the energies sum to the mean of the
+ * squared values; it is averaged over the pencils (the other directions)
+ * without weights.
+ * The field should have the layout used to initialize the spectrum.
+ * Collective.
+ *
+ * \param field The field.
+ * \param spectrum The spectrum (passed by reference).
+ */
+PetscErrorCode PetibmSpectrumCompute(
+	const PetibmField field, PetibmSpectrum &spectrum)
+{
+	PetscErrorCode ierr;
+	const PetscInt n = spectrum.n, nk = n/2+1;
+	const PetscReal *lines;
+	std::vector<PetscReal> partial;
+	std::vector<std::complex<PetscReal>> work;
+	PetscInt threads, r, k;
+
+	PetscFunctionBeginUser;
+
+	ierr = VecScatterBegin(spectrum.scatter, field.global, spectrum.lines,
+	                       INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
+	ierr = VecScatterEnd(spectrum.scatter, field.global, spectrum.lines,
+	                     INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
+
+	// one sum per thread, and one work array per thread
+	ierr = PetibmThreadsGetSize(&threads); CHKERRQ(ierr);
+	partial.assign(threads*nk, 0.0);
+	work.resize(threads*(spectrum.fft.worksize + nk));
+	ierr = VecGetArrayRead(spectrum.lines, &lines); CHKERRQ(ierr);
+	ierr = PetibmThreadsRun([&](const PetscInt t, const PetscInt nt)
+	{
+		std::complex<PetscReal> *w = &work[t*(spectrum.fft.worksize + nk)],
+		                        *X = w + spectrum.fft.worksize;
+		PetscReal *e = &partial[t*nk];
+		PetscInt s, f, p, k;
+
+		PetibmThreadsGetSlab(0, spectrum.pencils, t, nt, &s, &f);
+		for (p=s; p<f; p++)
+		{
+			PetibmFFTExecute(spectrum.fft, lines + p*n, X, w);
+			for (k=0; k<nk; k++)
+				e[k] += ((k == 0 or 2*k == n) ? 1.0 : 2.0) * std::norm(X[k]);
+		}
+	}); CHKERRQ(ierr);
+	ierr = VecRestoreArrayRead(spectrum.lines, &lines); CHKERRQ(ierr);
+
+	for (k=0; k<nk; k++)
+	{
+		spectrum.energy[k] = 0.0;
+		for (r=0; r<threads; r++)
+			spectrum.energy[k] += partial[r*nk+k];
+	}
+	ierr = MPI_Allreduce(MPI_IN_PLACE, spectrum.energy.data(), nk, MPIU_REAL,
+	                     MPI_SUM, PETSC_COMM_WORLD); CHKERRQ(ierr);
+	for (k=0; k<nk; k++)
+	{
+		spectrum.energy[k] /= (PetscReal) spectrum.total * n * n;
+		spectrum.sum[k] += spectrum.energy[k];
+	}
+	spectrum.count++;
+
+	PetscFunctionReturn(0);
+} // PetibmSpectrumCompute
+
+
+/*! Writes the header of an ASCII time-series file for the spectrum.
+ *
+ * The header lists the wavenumbers; the file is overwritten.
+ *
+ * \param filepath Path of the output file.
+ * \param spectrum The spectrum.
+ */
+PetscErrorCode PetibmSpectrumWriteHeader(
+	const std::string filepath, const PetibmSpectrum &spectrum)
+{
+	PetscErrorCode ierr;
+	PetscMPIInt rank;
+	PetscInt k;
+
+	PetscFunctionBeginUser;
+
+	ierr = MPI_Comm_rank(PETSC_COMM_WORLD, &rank); CHKERRQ(ierr);
+	if (rank != 0)
+		PetscFunctionReturn(0);
+	std::ofstream outfile(filepath.c_str(), std::ios::trunc);
+	if (!outfile.good())
+		SETERRQ(PETSC_COMM_SELF, PETSC_ERR_FILE_OPEN,
+		        "Cannot open the time-series file of the spectrum");
+	outfile << "# direction: " << spectrum.direction
+	        << ", points: " << spectrum.n
+	        << ", period: " << spectrum.length << "\n";
+	for (k=0; k<(PetscInt) spectrum.energy.size(); k++)
+		outfile << "# " << k << ": "
+		        << 2.0*PETSC_PI*k/spectrum.length << "\n";
+	outfile << "# time-step, then one column per wavenumber\n";
+
+	PetscFunctionReturn(0);
+} // PetibmSpectrumWriteHeader
+
+
+/*! Appends the spectrum of the last field to an ASCII time-series file.
+ *
+ * One row per time step: the time-step index followed by one column per
+ * wavenumber.
+ *
+ * \param filepath Path of the output file.
+ * \param step The time-step index.
+ * \param spectrum The spectrum.
+ */
+PetscErrorCode PetibmSpectrumWrite(
+	const std::string filepath, const PetscInt step,
+	const PetibmSpectrum &spectrum)
+{
+	PetscErrorCode ierr;
+	PetscMPIInt rank;
+
+	PetscFunctionBeginUser;
+
+	ierr = MPI_Comm_rank(PETSC_COMM_WORLD, &rank); CHKERRQ(ierr);
+	if (rank != 0)
+		PetscFunctionReturn(0);
+	std::ofstream outfile(filepath.c_str(), std::ios::app);
+	if (!outfile.good())
+		SETERRQ(PETSC_COMM_SELF, PETSC_ERR_FILE_OPEN,
+		        "Cannot open the time-series file of the spectrum");
+	outfile << step << std::scientific << std::setprecision(10);
+	for (auto value : spectrum.energy)
+		outfile << " " << value;
+	outfile << "\n";
+
+	PetscFunctionReturn(0);
+} // PetibmSpectrumWrite
+
+
+/*! Writes the time-averaged spectrum into an ASCII file.
+ *
+ * One row per wavenumber: the index, the wavenumber 2 pi k / length, and the
+ * energy averaged over the spectra accumulated.
+ *
+ * \param filepath Path of the output file.
+ * \param spectrum The spectrum.
+ */
+PetscErrorCode PetibmSpectrumWriteMean(
+	const std::string filepath, const PetibmSpectrum &spectrum)
+{
+	PetscErrorCode ierr;
+	PetscMPIInt rank;
+	PetscInt k;
+
+	PetscFunctionBeginUser;
+
+	ierr = MPI_Comm_rank(PETSC_COMM_WORLD, &rank); CHKERRQ(ierr);
+	if (rank != 0)
+		PetscFunctionReturn(0);
+	std::ofstream outfile(filepath.c_str(), std::ios::trunc);
+	if (!outfile.good())
+		SETERRQ(PETSC_COMM_SELF, PETSC_ERR_FILE_OPEN,
+		        "Cannot open the file of the mean spectrum");
+	outfile << "# time steps: " << spectrum.count << "\n";
+	outfile << "# index, wavenumber, energy\n";
+	outfile << std::scientific << std::setprecision(10);
+	for (k=0; k<(PetscInt) spectrum.sum.size(); k++)
+		outfile << k << " " << 2.0*PETSC_PI*k/spectrum.length << " "
+		        << spectrum.sum[k] / PetscMax(spectrum.count, 1) << "\n";
+
+	PetscFunctionReturn(0);
+} // PetibmSpectrumWriteMean
+
+
+/*! Destroys a PetibmSpectrum structure.
+ *
+ * \param spectrum The spectrum (passed by reference).
+ */
+PetscErrorCode PetibmSpectrumDestroy(PetibmSpectrum &spectrum)
+{
+	PetscErrorCode ierr;
+
+	PetscFunctionBeginUser;
+
+	ierr = VecScatterDestroy(&spectrum.scatter); CHKERRQ(ierr);
+	ierr = VecDestroy(&spectrum.lines); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmSpectrumDestroy
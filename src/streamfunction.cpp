@@ -0,0 +1,286 @@
+/*! Implementation of the functions for the PetibmStreamFunction structure.
+ * \file streamfunction.cpp
+ */
+
+#include <vector>
+
+#include "petibm-utilities/streamfunction.h"
+
+
+/*! Gets the stations of a gridline around the points owned by the process.
+ *
+ * `x[0]` is the station xs-1 and `x[xm+1]` the station xs+xm.
+ * Beyond an end of the gridline, the station is one end spacing away; with
+ * periodicity, both ends use the mean of the end spacings so that the
+ * operator stays symmetric.
+ *
+ * \param line The gridline (decomposed as the DMDA of the field).
+ * \param periodic Is the field periodic along the gridline?
+ * \param xs First index owned by the process.
+ * \param xm Number of indices owned by the process.
+ * \param x The stations (passed by reference).
+ */
+static PetscErrorCode PetibmStreamFunctionStations(
+	PetibmGridline line, const PetscBool periodic,
+	const PetscInt xs, const PetscInt xm, std::vector<PetscReal> &x)
+{
+	PetscErrorCode ierr;
+	DMDALocalInfo info;
+	PetscReal *arr, h[2] = {0.0, 0.0}, hs[2];
+	PetscInt i;
+
+	PetscFunctionBeginUser;
+
+	ierr = DMDAGetLocalInfo(line.da, &info); CHKERRQ(ierr);
+	if (info.xs != xs or info.xm != xm)
+		SETERRQ(PETSC_COMM_SELF, PETSC_ERR_ARG_INCOMP,
+		        "The gridlines should be decomposed as the DMDA of the field");
+	if (info.mx < 2)
+		SETERRQ(PETSC_COMM_WORLD, PETSC_ERR_ARG_SIZ,
+		        "The gridlines should have at least 2 stations");
+	ierr = PetibmGridlineGlobalToLocal(line); CHKERRQ(ierr);
+	ierr = DMDAVecGetArray(line.da, line.local, &arr); CHKERRQ(ierr);
+	// spacings at both ends of the gridline
+	if (xs == 0)
+		h[0] = arr[1] - arr[0];
+	if (xs+xm == info.mx)
+		h[1] = arr[info.mx-1] - arr[info.mx-2];
+	ierr = MPI_Allreduce(
+		h, hs, 2, MPIU_REAL, MPI_MAX, PETSC_COMM_WORLD); CHKERRQ(ierr);
+	if (periodic)
+		hs[0] = hs[1] = 0.5 * (hs[0] + hs[1]);
+	x.resize(xm+2);
+	for (i=xs-1; i<=xs+xm; i++)
+	{
+		if (i < 0)
+			x[i-xs+1] = arr[0] - hs[0];
+		else if (i >= info.mx)
+			x[i-xs+1] = arr[info.mx-1] + hs[1];
+		else
+			x[i-xs+1] = arr[i];
+	}
+	ierr = DMDAVecRestoreArray(line.da, line.local, &arr); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmStreamFunctionStations
+
+
+/*! Gets the number of times a direction of a DMDA can be coarsened by 2.
+ *
+ * \param M Number of points in the direction.
+ * \param m Number of processes in the direction.
+ * \param periodic Is the direction periodic?
+ */
+static PetscInt PetibmStreamFunctionCoarsenings(
+	PetscInt M, const PetscInt m, const PetscBool periodic)
+{
+	PetscInt count = 0, Mc;
+
+	while (true)
+	{
+		// the interpolation needs an integer ratio between the levels
+		if (periodic and M % 2 != 0)
+			break;
+		if (!periodic and (M-1) % 2 != 0)
+			break;
+		Mc = (periodic) ? M / 2 : (M-1) / 2 + 1;
+		if (Mc < PetscMax(3, 2*m))
+			break;
+		M = Mc;
+		count++;
+	}
+	return count;
+} // PetibmStreamFunctionCoarsenings
+
+
+/*! Initializes the solver of the streamfunction on the DMDA of a field.
+ *
+ * The Laplacian is discretized on the stretched grid with a five-point
+ * stencil, multiplied by the area of the cell around each point so that the
+ * operator is symmetric positive definite; the streamfunction is zero on the
+ * non-periodic boundaries, one spacing (the spacing at that end) outside the
+ * first and last stations.
+ * The system is solved with CG preconditioned by geometric multigrid (PCMG),
+ * with the coarse levels obtained by coarsening the DMDA and Galerkin coarse
+ * operators; with fewer than 3 levels (the DMDA cannot be coarsened twice),
+ * algebraic multigrid (PCGAMG) is used instead.
+ * The number of levels is chosen from the sizes of the DMDA unless set with
+ * `-streamfunction_levels`; the solver accepts options with the prefix
+ * `streamfunction_`.
+ *
+ * \param grid The grid of the field (gridlines decomposed as the DMDA).
+ * \param da The DMDA of the field (2D, stencil width at least 1).
+ * \param solver The solver to initialize (passed by reference).
+ */
+PetscErrorCode PetibmStreamFunctionInitialize(
+	const PetibmGrid grid, const DM da, PetibmStreamFunction &solver)
+{
+	PetscErrorCode ierr;
+	PetscInt dim, M, N, m, n, s, xs, ys, xm, ym, i, j, nc;
+	DMBoundaryType bx, by;
+	PetscBool periodic_x, periodic_y, found;
+	std::vector<PetscReal> x, y;
+	PetscReal hxm, hxp, hym, hyp, hx, hy, vals[5], **area;
+	MatStencil row, cols[5];
+	PC pc;
+
+	PetscFunctionBeginUser;
+
+	ierr = DMDAGetInfo(da, &dim, &M, &N, nullptr, &m, &n, nullptr,
+	                   nullptr, &s, &bx, &by, nullptr,
+	                   nullptr); CHKERRQ(ierr);
+	if (dim != 2)
+		SETERRQ(PETSC_COMM_WORLD, PETSC_ERR_SUP,
+		        "The streamfunction is only computed from 2D fields");
+	if (s < 1)
+		SETERRQ(PETSC_COMM_WORLD, PETSC_ERR_ARG_INCOMP,
+		        "The DMDA should have a stencil width of at least 1");
+	periodic_x = (bx == DM_BOUNDARY_PERIODIC) ? PETSC_TRUE : PETSC_FALSE;
+	periodic_y = (by == DM_BOUNDARY_PERIODIC) ? PETSC_TRUE : PETSC_FALSE;
+	ierr = DMDAGetCorners(
+		da, &xs, &ys, nullptr, &xm, &ym, nullptr); CHKERRQ(ierr);
+	ierr = PetibmStreamFunctionStations(
+		grid.x, periodic_x, xs, xm, x); CHKERRQ(ierr);
+	ierr = PetibmStreamFunctionStations(
+		grid.y, periodic_y, ys, ym, y); CHKERRQ(ierr);
+
+	// assemble the operator and the cell areas
+	ierr = DMCreateMatrix(da, &solver.A); CHKERRQ(ierr);
+	ierr = DMCreateGlobalVector(da, &solver.area); CHKERRQ(ierr);
+	ierr = VecDuplicate(solver.area, &solver.rhs); CHKERRQ(ierr);
+	ierr = DMDAVecGetArray(da, solver.area, &area); CHKERRQ(ierr);
+	for (j=ys; j<ys+ym; j++)
+	{
+		hym = y[j-ys+1] - y[j-ys];
+		hyp = y[j-ys+2] - y[j-ys+1];
+		hy = 0.5 * (hym + hyp);
+		for (i=xs; i<xs+xm; i++)
+		{
+			hxm = x[i-xs+1] - x[i-xs];
+			hxp = x[i-xs+2] - x[i-xs+1];
+			hx = 0.5 * (hxm + hxp);
+			row.i = i; row.j = j;
+			nc = 0;
+			cols[nc].i = i; cols[nc].j = j;
+			vals[nc++] = hy * (1.0/hxm + 1.0/hxp) + hx * (1.0/hym + 1.0/hyp);
+			// neighbors beyond a non-periodic boundary are zero
+			if (i > 0 or periodic_x)
+			{
+				cols[nc].i = i-1; cols[nc].j = j;
+				vals[nc++] = -hy / hxm;
+			}
+			if (i < M-1 or periodic_x)
+			{
+				cols[nc].i = i+1; cols[nc].j = j;
+				vals[nc++] = -hy / hxp;
+			}
+			if (j > 0 or periodic_y)
+			{
+				cols[nc].i = i; cols[nc].j = j-1;
+				vals[nc++] = -hx / hym;
+			}
+			if (j < N-1 or periodic_y)
+			{
+				cols[nc].i = i; cols[nc].j = j+1;
+				vals[nc++] = -hx / hyp;
+			}
+			ierr = MatSetValuesStencil(
+				solver.A, 1, &row, nc, cols, vals, INSERT_VALUES); CHKERRQ(ierr);
+			area[j][i] = hx * hy;
+		}
+	}
+	ierr = DMDAVecRestoreArray(da, solver.area, &area); CHKERRQ(ierr);
+	ierr = MatAssemblyBegin(solver.A, MAT_FINAL_ASSEMBLY); CHKERRQ(ierr);
+	ierr = MatAssemblyEnd(solver.A, MAT_FINAL_ASSEMBLY); CHKERRQ(ierr);
+	// fully periodic: the streamfunction is defined up to a constant
+	if (periodic_x and periodic_y)
+	{
+		MatNullSpace nullspace;
+		ierr = MatNullSpaceCreate(PETSC_COMM_WORLD, PETSC_TRUE, 0, nullptr,
+		                          &nullspace); CHKERRQ(ierr);
+		ierr = MatSetNullSpace(solver.A, nullspace); CHKERRQ(ierr);
+		ierr = MatSetTransposeNullSpace(solver.A, nullspace); CHKERRQ(ierr);
+		ierr = MatNullSpaceDestroy(&nullspace); CHKERRQ(ierr);
+	}
+
+	// number of levels of the geometric multigrid
+	solver.levels = 1 + PetscMin(
+		PetibmStreamFunctionCoarsenings(M, m, periodic_x),
+		PetibmStreamFunctionCoarsenings(N, n, periodic_y));
+	ierr = PetscOptionsGetInt(nullptr, "streamfunction_", "-levels",
+	                          &solver.levels, &found); CHKERRQ(ierr);
+
+	// CG with multigrid, warm-started from the values of the solution
+	ierr = KSPCreate(PETSC_COMM_WORLD, &solver.ksp); CHKERRQ(ierr);
+	ierr = KSPSetOptionsPrefix(solver.ksp, "streamfunction_"); CHKERRQ(ierr);
+	ierr = KSPSetDM(solver.ksp, da); CHKERRQ(ierr);
+	ierr = KSPSetDMActive(solver.ksp, PETSC_FALSE); CHKERRQ(ierr);
+	ierr = KSPSetOperators(solver.ksp, solver.A, solver.A); CHKERRQ(ierr);
+	ierr = KSPSetType(solver.ksp, KSPCG); CHKERRQ(ierr);
+	ierr = KSPSetInitialGuessNonzero(solver.ksp, PETSC_TRUE); CHKERRQ(ierr);
+	ierr = KSPGetPC(solver.ksp, &pc); CHKERRQ(ierr);
+	if (solver.levels > 2)
+	{
+		ierr = PCSetType(pc, PCMG); CHKERRQ(ierr);
+		ierr = PCMGSetLevels(pc, solver.levels, nullptr); CHKERRQ(ierr);
+		ierr = PCMGSetGalerkin(pc, PC_MG_GALERKIN_BOTH); CHKERRQ(ierr);
+	}
+	else
+	{
+		ierr = PCSetType(pc, PCGAMG); CHKERRQ(ierr);
+	}
+	ierr = KSPSetFromOptions(solver.ksp); CHKERRQ(ierr);
+	ierr = KSPSetUp(solver.ksp); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmStreamFunctionInitialize
+
+
+/*! Solves for the streamfunction, Laplacian(psi) = -wz.
+ *
+ * The values of psi on input are the initial guess: when solving the time
+ * steps in sequence, the streamfunction of a step seeds the solve of the
+ * next one.
+ *
+ * \param solver The solver.
+ * \param wz The vorticity field.
+ * \param psi The streamfunction (passed by reference).
+ */
+PetscErrorCode PetibmStreamFunctionSolve(
+	PetibmStreamFunction &solver, const PetibmField wz, PetibmField &psi)
+{
+	PetscErrorCode ierr;
+	KSPConvergedReason reason;
+
+	PetscFunctionBeginUser;
+
+	// the operator is the negative Laplacian scaled by the cell areas
+	ierr = VecPointwiseMult(solver.rhs, solver.area, wz.global); CHKERRQ(ierr);
+	ierr = KSPSolve(solver.ksp, solver.rhs, psi.global); CHKERRQ(ierr);
+	ierr = KSPGetConvergedReason(solver.ksp, &reason); CHKERRQ(ierr);
+	if (reason < 0)
+		SETERRQ1(PETSC_COMM_WORLD, PETSC_ERR_CONV_FAILED,
+		         "The solve of the streamfunction diverged (reason %D)",
+		         (PetscInt) reason);
+
+	PetscFunctionReturn(0);
+} // PetibmStreamFunctionSolve
+
+
+/*! Destroys a PetibmStreamFunction structure.
+ *
+ * \param solver The solver to destroy (passed by reference).
+ */
+PetscErrorCode PetibmStreamFunctionDestroy(PetibmStreamFunction &solver)
+{
+	PetscErrorCode ierr;
+
+	PetscFunctionBeginUser;
+
+	ierr = KSPDestroy(&solver.ksp); CHKERRQ(ierr);
+	ierr = MatDestroy(&solver.A); CHKERRQ(ierr);
+	ierr = VecDestroy(&solver.area); CHKERRQ(ierr);
+	ierr = VecDestroy(&solver.rhs); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmStreamFunctionDestroy
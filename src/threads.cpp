@@ -0,0 +1,297 @@
+/*! Implementation of the functions related to the threads of a process.
+ * \file threads.cpp
+ */
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <petscdmda.h>
+
+#include "petibm-utilities/threads.h"
+
+
+/*! Structure holding the persistent pool of threads of the process.
+ */
+struct PetibmThreads
+{
+	std::vector<std::thread> workers;  /// threads other than the calling one
+	std::mutex mutex;  /// mutex protecting the members below
+	std::condition_variable start,  /// signals a new task to the workers
+	                        done;  /// signals the completion of the workers
+	std::function<void(const PetscInt, const PetscInt)> task;  /// current task
+	PetscInt size = 1,  /// number of threads (calling thread included)
+	         generation = 0,  /// number of tasks started
+	         pending = 0;  /// number of workers still running the task
+	bool stop = false;  /// should the workers exit?
+}; // PetibmThreads
+
+
+static PetibmThreads threads;
+
+
+/*! Pins the calling thread to the t-th core allowed for the process.
+ *
+ * \param t Index of the thread.
+ * \param cores The cores allowed for the process.
+ */
+static void PetibmThreadsBind(const PetscInt t, const std::vector<int> &cores)
+{
+#if defined(__linux__)
+	cpu_set_t set;
+
+	if (cores.empty())
+		return;
+	CPU_ZERO(&set);
+	CPU_SET(cores[t % cores.size()], &set);
+	pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
+} // PetibmThreadsBind
+
+
+/*! Loop of a worker thread: waits for a task, runs it, and signals completion.
+ *
+ * \param t Index of the thread.
+ * \param cores The cores to bind the thread to (empty: no binding).
+ */
+static void PetibmThreadsWork(const PetscInt t, const std::vector<int> cores)
+{
+	PetscInt seen = 0;
+
+	PetibmThreadsBind(t, cores);
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(threads.mutex);
+			threads.start.wait(lock, [&seen] {
+				return threads.stop or threads.generation != seen; });
+			if (threads.stop)
+				return;
+			seen = threads.generation;
+		}
+		threads.task(t, threads.size);
+		{
+			std::lock_guard<std::mutex> lock(threads.mutex);
+			if (--threads.pending == 0)
+				threads.done.notify_one();
+		}
+	}
+} // PetibmThreadsWork
+
+
+/*! Starts the persistent pool of threads of the process.
+ *
+ * `-threads <n>` sets the number of threads per process (default 1: the
+ * kernels run on the calling thread only); `-threads_bind` pins each thread
+ * to one of the cores the process is allowed to run on (Linux only), which
+ * keeps the pages first touched by a thread local to its NUMA node.
+ * The threads wait on a condition variable between kernels.
+ */
+PetscErrorCode PetibmThreadsInitialize()
+{
+	PetscErrorCode ierr;
+	PetscInt n = 1;
+	PetscBool bind = PETSC_FALSE, found;
+	std::vector<int> cores;
+
+	PetscFunctionBeginUser;
+
+	if (!threads.workers.empty())
+		SETERRQ(PETSC_COMM_SELF, PETSC_ERR_ARG_WRONGSTATE,
+		        "The threads are already started");
+	ierr = PetscOptionsGetInt(nullptr, nullptr, "-threads", &n, &found);
+	CHKERRQ(ierr);
+	ierr = PetscOptionsGetBool(nullptr, nullptr, "-threads_bind", &bind, &found);
+	CHKERRQ(ierr);
+	if (n < 1)
+		SETERRQ1(PETSC_COMM_WORLD, PETSC_ERR_ARG_OUTOFRANGE,
+		         "The number of threads must be positive (got %D)", n);
+#if defined(__linux__)
+	if (bind)
+	{
+		cpu_set_t set;
+		if (sched_getaffinity(0, sizeof(set), &set) == 0)
+			for (int c=0; c<CPU_SETSIZE; c++)
+				if (CPU_ISSET(c, &set))
+					cores.push_back(c);
+		PetibmThreadsBind(0, cores);
+	}
+#endif
+	threads.size = n;
+	threads.stop = false;
+	for (PetscInt t=1; t<n; t++)
+		threads.workers.emplace_back(PetibmThreadsWork, t, cores);
+
+	PetscFunctionReturn(0);
+} // PetibmThreadsInitialize
+
+
+/*! Stops and joins the threads of the pool.
+ */
+PetscErrorCode PetibmThreadsFinalize()
+{
+	PetscFunctionBeginUser;
+
+	{
+		std::lock_guard<std::mutex> lock(threads.mutex);
+		threads.stop = true;
+	}
+	threads.start.notify_all();
+	for (auto &worker : threads.workers)
+		worker.join();
+	threads.workers.clear();
+	threads.size = 1;
+
+	PetscFunctionReturn(0);
+} // PetibmThreadsFinalize
+
+
+/*! Gets the number of threads of the pool (the calling thread included).
+ *
+ * \param n The number of threads (passed by pointer).
+ */
+PetscErrorCode PetibmThreadsGetSize(PetscInt *n)
+{
+	PetscFunctionBeginUser;
+
+	*n = threads.size;
+
+	PetscFunctionReturn(0);
+} // PetibmThreadsGetSize
+
+
+/*! Runs a task on all the threads of the pool and waits for its completion.
+ *
+ * The calling thread runs the task as thread 0. The task is called with the
+ * index of the thread and the number of threads, and must not call PETSc or
+ * MPI.
+ *
+ * \param task The task.
+ */
+PetscErrorCode PetibmThreadsRun(
+	const std::function<void(const PetscInt, const PetscInt)> &task)
+{
+	PetscFunctionBeginUser;
+
+	if (threads.size == 1)
+	{
+		task(0, 1);
+		PetscFunctionReturn(0);
+	}
+	{
+		std::lock_guard<std::mutex> lock(threads.mutex);
+		threads.task = task;
+		threads.pending = threads.size - 1;
+		threads.generation++;
+	}
+	threads.start.notify_all();
+	task(0, threads.size);
+	{
+		std::unique_lock<std::mutex> lock(threads.mutex);
+		threads.done.wait(lock, [] { return threads.pending == 0; });
+		threads.task = nullptr;
+	}
+
+	PetscFunctionReturn(0);
+} // PetibmThreadsRun
+
+
+/*! Gets the static slab of a thread in a range of indices.
+ *
+ * The range is split in contiguous slabs of nearly equal sizes, the same for
+ * every kernel, so that a thread works on the memory it first touched.
+ *
+ * \param begin First index of the range.
+ * \param end One past the last index of the range.
+ * \param t Index of the thread.
+ * \param n Number of threads.
+ * \param s First index of the slab (passed by pointer).
+ * \param e One past the last index of the slab (passed by pointer).
+ */
+void PetibmThreadsGetSlab(
+	const PetscInt begin, const PetscInt end, const PetscInt t, const PetscInt n,
+	PetscInt *s, PetscInt *e)
+{
+	const PetscInt size = end - begin;
+
+	*s = begin + (PetscInt) ((PetscInt64) size * t / n);
+	*e = begin + (PetscInt) ((PetscInt64) size * (t+1) / n);
+} // PetibmThreadsGetSlab
+
+
+/*! Touches an array for the first time by slabs of planes, one slab per thread.
+ *
+ * \param arr The array (not yet touched).
+ * \param planes Number of planes in the array.
+ * \param size Number of values per plane.
+ */
+PetscErrorCode PetibmThreadsTouch(
+	PetscScalar *arr, const PetscInt planes, const PetscInt size)
+{
+	PetscErrorCode ierr;
+
+	PetscFunctionBeginUser;
+
+	ierr = PetibmThreadsRun([&](const PetscInt t, const PetscInt n)
+	{
+		PetscInt s, e;
+		PetibmThreadsGetSlab(0, planes, t, n, &s, &e);
+		for (PetscInt64 i=(PetscInt64) s*size; i<(PetscInt64) e*size; i++)
+			arr[i] = 0.0;
+	}); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmThreadsTouch
+
+
+/*! Replaces the storage of a vector by an array first touched by the threads.
+ *
+ * The vector is split in planes along its slowest dimension (z in 3D, y in
+ * 2D) and each thread first touches the planes of its slab.
+ * Nothing is done with a single thread.
+ *
+ * \param vec The vector (of a DMDA).
+ */
+PetscErrorCode PetibmThreadsFirstTouch(Vec vec)
+{
+	PetscErrorCode ierr;
+	DM da;
+	PetscInt dim, dof, m, n, p, nlocal, planes;
+	PetscScalar *arr;
+
+	PetscFunctionBeginUser;
+
+	if (threads.size == 1)
+		PetscFunctionReturn(0);
+
+	ierr = VecGetDM(vec, &da); CHKERRQ(ierr);
+	ierr = VecGetLocalSize(vec, &nlocal); CHKERRQ(ierr);
+	if (nlocal == 0)
+		PetscFunctionReturn(0);
+	ierr = DMDAGetInfo(da, &dim, nullptr, nullptr, nullptr, nullptr, nullptr,
+	                   nullptr, &dof, nullptr, nullptr, nullptr, nullptr,
+	                   nullptr); CHKERRQ(ierr);
+	ierr = DMDAGetCorners(
+		da, nullptr, nullptr, nullptr, &m, &n, &p); CHKERRQ(ierr);
+	if (dim == 2)
+		p = 1;
+	// a local vector spans the ghosted corners
+	if (m*n*p*dof != nlocal)
+	{
+		ierr = DMDAGetGhostCorners(
+			da, nullptr, nullptr, nullptr, &m, &n, &p); CHKERRQ(ierr);
+	}
+	planes = (dim == 3) ? p : n;
+	ierr = PetscMalloc1(nlocal, &arr); CHKERRQ(ierr);
+	ierr = PetibmThreadsTouch(arr, planes, nlocal/planes); CHKERRQ(ierr);
+	// the array allocated by PETSc (touched by the calling thread) is freed
+	ierr = VecReplaceArray(vec, arr); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmThreadsFirstTouch
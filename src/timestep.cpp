@@ -3,6 +3,7 @@
  */
 
 #include "petibm-utilities/timestep.h"
+#include "petibm-utilities/misc.h"
 
 
 /*! Gets options from command-line or config file.
@@ -24,8 +25,7 @@ PetscErrorCode PetibmTimeStepGetOptions(
 	                             path, sizeof(path), &found); CHKERRQ(ierr);
 	if (found)
 	{
-		ierr = PetscOptionsInsertFile(
-			PETSC_COMM_WORLD, nullptr, path, PETSC_FALSE); CHKERRQ(ierr);
+		ierr = PetibmOptionsInsertFile(path); CHKERRQ(ierr);
 	}
 	// get starting time step
 	ierr = PetscOptionsGetInt(
@@ -0,0 +1,279 @@
+/*! Implementation of the functions to identify vortices (Q-criterion, lambda2).
+ * \file vortex.cpp
+ */
+
+#include <vector>
+
+#include "petibm-utilities/vortex.h"
+
+
+/*! Computes the inverse spacings along a direction for the cells on process.
+ *
+ * The direction is periodic when the faces are as many as the cells (the
+ * face on the first boundary is not stored): the neighbors of the end cells
+ * are then the ghost cells across the periodic boundary.
+ *
+ * \param centers Sequential vector with the cell-centered stations.
+ * \param faces Sequential vector with the stations of the staggered velocity.
+ * \param s Index of the first cell on process.
+ * \param m Number of cells on process.
+ * \param idf Inverse of the cell widths (passed by reference).
+ * \param idc Inverse of the distances between neighboring cell centers
+ *            (passed by reference).
+ * \param lo Index of the lower neighbor, clamped to the domain unless periodic
+ *           (passed by reference).
+ * \param hi Index of the upper neighbor, clamped to the domain unless periodic
+ *           (passed by reference).
+ */
+static PetscErrorCode PetibmVortexGetSpacings(
+	const Vec centers, const Vec faces, const PetscInt s, const PetscInt m,
+	std::vector<PetscReal> &idf, std::vector<PetscReal> &idc,
+	std::vector<PetscInt> &lo, std::vector<PetscInt> &hi)
+{
+	PetscErrorCode ierr;
+	const PetscReal *c, *f;
+	PetscInt n, nf, i;
+	PetscReal width, period = 0.0;
+
+	PetscFunctionBeginUser;
+
+	ierr = VecGetSize(centers, &n); CHKERRQ(ierr);
+	ierr = VecGetSize(faces, &nf); CHKERRQ(ierr);
+	ierr = VecGetArrayRead(centers, &c); CHKERRQ(ierr);
+	ierr = VecGetArrayRead(faces, &f); CHKERRQ(ierr);
+	// the first boundary is mirrored from the first cell center and face
+	if (nf == n)
+		period = f[nf-1] - (2.0*c[0] - f[0]);
+	// cell-centered station, wrapped across the periodic boundaries
+	auto center = [&](const PetscInt p) -> PetscReal
+	{
+		if (p < 0)
+			return c[p+n] - period;
+		else if (p >= n)
+			return c[p-n] + period;
+		return c[p];
+	};
+	idf.resize(m);
+	idc.resize(m);
+	lo.resize(m);
+	hi.resize(m);
+	for (i=s; i<s+m; i++)
+	{
+		// width of the cell between faces i-1 and i
+		if (i == 0)
+			width = 2.0*(f[0] - c[0]);
+		else if (i == nf)
+			width = 2.0*(c[i] - f[i-1]);
+		else
+			width = f[i] - f[i-1];
+		idf[i-s] = 1.0/width;
+		lo[i-s] = (period > 0.0) ? i-1 : PetscMax(i-1, 0);
+		hi[i-s] = (period > 0.0) ? i+1 : PetscMin(i+1, n-1);
+		idc[i-s] = 1.0/(center(hi[i-s]) - center(lo[i-s]));
+	}
+	ierr = VecRestoreArrayRead(faces, &f); CHKERRQ(ierr);
+	ierr = VecRestoreArrayRead(centers, &c); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmVortexGetSpacings
+
+
+/*! Returns the second eigenvalue of a symmetric 3x3 matrix.
+ *
+ * Closed-form trigonometric solution, without branches so that the loop
+ * calling it can be vectorized.
+ *
+ * \param a The symmetric matrix.
+ */
+static inline PetscReal PetibmSymmetricMiddleEigenvalue(const PetscReal a[3][3])
+{
+	const PetscReal third = 1.0/3.0;
+	const PetscReal p1 = a[0][1]*a[0][1] + a[0][2]*a[0][2] + a[1][2]*a[1][2];
+	const PetscReal t = third*(a[0][0] + a[1][1] + a[2][2]);
+	const PetscReal b00 = a[0][0] - t,
+	                b11 = a[1][1] - t,
+	                b22 = a[2][2] - t;
+	const PetscReal p = PetscMax(
+		PetscSqrtReal((b00*b00 + b11*b11 + b22*b22 + 2.0*p1)/6.0),
+		PETSC_MACHINE_EPSILON);
+	const PetscReal det = b00*(b11*b22 - a[1][2]*a[1][2])
+	                    - a[0][1]*(a[0][1]*b22 - a[1][2]*a[0][2])
+	                    + a[0][2]*(a[0][1]*a[1][2] - b11*a[0][2]);
+	const PetscReal r = PetscMin(PetscMax(0.5*det/(p*p*p), -1.0), 1.0);
+	const PetscReal phi = third*PetscAcosReal(r);
+	// largest and smallest eigenvalues; the trace gives the middle one
+	const PetscReal l1 = t + 2.0*p*PetscCosReal(phi),
+	                l3 = t + 2.0*p*PetscCosReal(phi + 2.0*third*PETSC_PI);
+	return 3.0*t - l1 - l3;
+} // PetibmSymmetricMiddleEigenvalue
+
+
+/*! Computes the Q-criterion, lambda2, and strain-rate magnitude at cell
+ * centers from the staggered 3D velocity field.
+ *
+ * The velocity-gradient tensor is assembled point-wise in a single sweep
+ * over the cells (normal derivatives on the faces of the cell, transverse
+ * derivatives with centered differences of the cell-centered velocities,
+ * one-sided at the non-periodic ends of the domain and wrapped through the
+ * ghost points on periodic directions), and never stored.
+ * The ghost points beyond the non-periodic boundaries hold the boundary
+ * values of the velocity components (see PetibmFieldSetBoundaryPoints).
+ * With S and W the symmetric and antisymmetric parts of the tensor:
+ * Q = (|W|^2 - |S|^2)/2, lambda2 is the second eigenvalue of S^2 + W^2
+ * (closed-form symmetric 3x3 eigenvalues), and the strain-rate magnitude is
+ * sqrt(2 S:S).
+ * Any of the output fields can be nullptr to skip it; the output fields
+ * should share the layout of the cell-centered grid.
+ *
+ * \param grid The cell-centered grid.
+ * \param gridux The grid for the velocity in the x-direction.
+ * \param griduy The grid for the velocity in the y-direction.
+ * \param griduz The grid for the velocity in the z-direction.
+ * \param ux The velocity field in the x-direction.
+ * \param uy The velocity field in the y-direction.
+ * \param uz The velocity field in the z-direction.
+ * \param q The Q-criterion field (passed by pointer).
+ * \param lambda2 The lambda2 field (passed by pointer).
+ * \param strain The strain-rate magnitude field (passed by pointer).
+ */
+PetscErrorCode PetibmVortexComputeFields(
+	const PetibmGrid grid, const PetibmGrid gridux, const PetibmGrid griduy,
+	const PetibmGrid griduz, PetibmField ux, PetibmField uy, PetibmField uz,
+	PetibmField *q, PetibmField *lambda2, PetibmField *strain)
+{
+	PetscErrorCode ierr;
+	DMDALocalInfo info;
+	DM da = nullptr;
+	PetibmField *outputs[3] = {q, lambda2, strain};
+	PetscReal ***out_a[3] = {nullptr, nullptr, nullptr};
+	PetscReal ***ux_a, ***uy_a, ***uz_a;
+	std::vector<PetscReal> idx, idy, idz, icx, icy, icz;
+	std::vector<PetscInt> xlo, xhi, ylo, yhi, zlo, zhi;
+	PetscInt i, j, k, o, a, b, c;
+
+	PetscFunctionBeginUser;
+
+	for (o=0; o<3; o++)
+	{
+		if (outputs[o])
+		{
+			da = outputs[o]->da;
+			break;
+		}
+	}
+	if (!da)
+		PetscFunctionReturn(0);
+
+	ierr = DMDAGetLocalInfo(da, &info); CHKERRQ(ierr);
+	if (info.dim != 3)
+		SETERRQ(PETSC_COMM_WORLD, PETSC_ERR_SUP,
+		        "Function only supports 3D fields");
+
+	// inverse spacings of the cells on process, computed once per sweep
+	ierr = PetibmVortexGetSpacings(grid.x.coords, gridux.x.coords,
+	                               info.xs, info.xm,
+	                               idx, icx, xlo, xhi); CHKERRQ(ierr);
+	ierr = PetibmVortexGetSpacings(grid.y.coords, griduy.y.coords,
+	                               info.ys, info.ym,
+	                               idy, icy, ylo, yhi); CHKERRQ(ierr);
+	ierr = PetibmVortexGetSpacings(grid.z.coords, griduz.z.coords,
+	                               info.zs, info.zm,
+	                               idz, icz, zlo, zhi); CHKERRQ(ierr);
+
+	ierr = PetibmFieldGetLocal(ux); CHKERRQ(ierr);
+	ierr = PetibmFieldGetLocal(uy); CHKERRQ(ierr);
+	ierr = PetibmFieldGetLocal(uz); CHKERRQ(ierr);
+	ierr = DMDAVecGetArray(ux.da, ux.local, &ux_a); CHKERRQ(ierr);
+	ierr = DMDAVecGetArray(uy.da, uy.local, &uy_a); CHKERRQ(ierr);
+	ierr = DMDAVecGetArray(uz.da, uz.local, &uz_a); CHKERRQ(ierr);
+	for (o=0; o<3; o++)
+	{
+		if (outputs[o])
+		{
+			ierr = DMDAVecGetArray(outputs[o]->da, outputs[o]->global,
+			                       &out_a[o]); CHKERRQ(ierr);
+		}
+	}
+
+	for (k=info.zs; k<info.zs+info.zm; k++)
+	{
+		const PetscInt kk = k - info.zs,
+		               km = zlo[kk], kp = zhi[kk];
+		for (j=info.ys; j<info.ys+info.ym; j++)
+		{
+			const PetscInt jj = j - info.ys,
+			               jm = ylo[jj], jp = yhi[jj];
+			for (i=info.xs; i<info.xs+info.xm; i++)
+			{
+				const PetscInt ii = i - info.xs,
+				               im = xlo[ii], ip = xhi[ii];
+				PetscReal g[3][3], s[3][3], w[3][3], m[3][3];
+				// velocity-gradient tensor g[a][b] = d(u_a)/d(x_b)
+				g[0][0] = (ux_a[k][j][i] - ux_a[k][j][i-1])*idx[ii];
+				g[0][1] = 0.5*(ux_a[k][jp][i] + ux_a[k][jp][i-1]
+				               - ux_a[k][jm][i] - ux_a[k][jm][i-1])*icy[jj];
+				g[0][2] = 0.5*(ux_a[kp][j][i] + ux_a[kp][j][i-1]
+				               - ux_a[km][j][i] - ux_a[km][j][i-1])*icz[kk];
+				g[1][0] = 0.5*(uy_a[k][j][ip] + uy_a[k][j-1][ip]
+				               - uy_a[k][j][im] - uy_a[k][j-1][im])*icx[ii];
+				g[1][1] = (uy_a[k][j][i] - uy_a[k][j-1][i])*idy[jj];
+				g[1][2] = 0.5*(uy_a[kp][j][i] + uy_a[kp][j-1][i]
+				               - uy_a[km][j][i] - uy_a[km][j-1][i])*icz[kk];
+				g[2][0] = 0.5*(uz_a[k][j][ip] + uz_a[k-1][j][ip]
+				               - uz_a[k][j][im] - uz_a[k-1][j][im])*icx[ii];
+				g[2][1] = 0.5*(uz_a[k][jp][i] + uz_a[k-1][jp][i]
+				               - uz_a[k][jm][i] - uz_a[k-1][jm][i])*icy[jj];
+				g[2][2] = (uz_a[k][j][i] - uz_a[k-1][j][i])*idz[kk];
+				// strain-rate and rotation-rate tensors
+				for (a=0; a<3; a++)
+				{
+					for (b=0; b<3; b++)
+					{
+						s[a][b] = 0.5*(g[a][b] + g[b][a]);
+						w[a][b] = 0.5*(g[a][b] - g[b][a]);
+					}
+				}
+				// symmetric tensor S^2 + W^2
+				for (a=0; a<3; a++)
+				{
+					for (b=0; b<3; b++)
+					{
+						m[a][b] = 0.0;
+						for (c=0; c<3; c++)
+							m[a][b] += s[a][c]*s[c][b] + w[a][c]*w[c][b];
+					}
+				}
+				// Q = -trace(S^2 + W^2)/2
+				if (out_a[0])
+					out_a[0][k][j][i] = -0.5*(m[0][0] + m[1][1] + m[2][2]);
+				if (out_a[1])
+					out_a[1][k][j][i] = PetibmSymmetricMiddleEigenvalue(m);
+				if (out_a[2])
+				{
+					PetscReal ss = 0.0;
+					for (a=0; a<3; a++)
+						for (b=0; b<3; b++)
+							ss += s[a][b]*s[a][b];
+					out_a[2][k][j][i] = PetscSqrtReal(2.0*ss);
+				}
+			}
+		}
+	}
+
+	for (o=0; o<3; o++)
+	{
+		if (outputs[o])
+		{
+			ierr = DMDAVecRestoreArray(outputs[o]->da, outputs[o]->global,
+			                           &out_a[o]); CHKERRQ(ierr);
+		}
+	}
+	ierr = DMDAVecRestoreArray(uz.da, uz.local, &uz_a); CHKERRQ(ierr);
+	ierr = DMDAVecRestoreArray(uy.da, uy.local, &uy_a); CHKERRQ(ierr);
+	ierr = DMDAVecRestoreArray(ux.da, ux.local, &ux_a); CHKERRQ(ierr);
+	ierr = PetibmFieldRestoreLocal(ux); CHKERRQ(ierr);
+	ierr = PetibmFieldRestoreLocal(uy); CHKERRQ(ierr);
+	ierr = PetibmFieldRestoreLocal(uz); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmVortexComputeFields
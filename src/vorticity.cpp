@@ -2,9 +2,79 @@
  * \file vorticity.cpp
  */
 
+#include "petibm-utilities/array.h"
+#include "petibm-utilities/misc.h"
+#include "petibm-utilities/threads.h"
 #include "petibm-utilities/vorticity.h"
 
 
+/*! Gets options from command-line or config file.
+ *
+ * `-tile_j <n>` and `-tile_k <n>` (0: no tiling), `-flat <true|false>`,
+ * `-derivative_order <2|4>`.
+ *
+ * \param prefix String to prepend to options.
+ * \param ctx The PetibmVorticityCtx structure to fill (passed by pointer).
+ */
+PetscErrorCode PetibmVorticityGetOptions(
+	const char prefix[], PetibmVorticityCtx *ctx)
+{
+	PetscErrorCode ierr;
+	char path[PETSC_MAX_PATH_LEN];
+	PetscBool found;
+
+	PetscFunctionBeginUser;
+
+	// get path of configuration file
+	ierr = PetscOptionsGetString(nullptr, prefix, "-config_file",
+	                             path, sizeof(path), &found); CHKERRQ(ierr);
+	if (found)
+	{
+		ierr = PetibmOptionsInsertFile(path); CHKERRQ(ierr);
+	}
+	// get number of rows per tile in the y-direction
+	ierr = PetscOptionsGetInt(nullptr, prefix, "-tile_j",
+	                          &ctx->tile_j, &found); CHKERRQ(ierr);
+	// get number of planes per tile in the z-direction
+	ierr = PetscOptionsGetInt(nullptr, prefix, "-tile_k",
+	                          &ctx->tile_k, &found); CHKERRQ(ierr);
+	if (ctx->tile_j < 0 or ctx->tile_k < 0)
+		SETERRQ(PETSC_COMM_WORLD, PETSC_ERR_ARG_OUTOFRANGE,
+		        "The tile sizes should be positive (or 0 for no tiling)");
+	// get indexing path
+	ierr = PetscOptionsGetBool(nullptr, prefix, "-flat",
+	                           &ctx->flat, &found); CHKERRQ(ierr);
+	// get order of accuracy of the derivatives
+	ierr = PetscOptionsGetInt(nullptr, prefix, "-derivative_order",
+	                          &ctx->order, &found); CHKERRQ(ierr);
+	if (ctx->order != 2 and ctx->order != 4)
+		SETERRQ1(PETSC_COMM_WORLD, PETSC_ERR_ARG_OUTOFRANGE,
+		         "The order of the derivatives should be 2 or 4 (not %D)",
+		         ctx->order);
+
+	PetscFunctionReturn(0);
+} // PetibmVorticityGetOptions
+
+
+PetscErrorCode PetibmVorticityCtxPrintf(
+	const std::string name, const PetibmVorticityCtx ctx)
+{
+	PetscErrorCode ierr;
+
+	PetscFunctionBeginUser;
+
+	ierr = PetscPrintf(PETSC_COMM_WORLD, "+ %s:\n", name.c_str()); CHKERRQ(ierr);
+	ierr = PetscPrintf(PETSC_COMM_WORLD, "\t- tiles: %d (y) x %d (z)\n",
+	                   ctx.tile_j, ctx.tile_k); CHKERRQ(ierr);
+	ierr = PetscPrintf(PETSC_COMM_WORLD, "\t- indexing: %s\n",
+	                   (ctx.flat) ? "flat" : "pointers"); CHKERRQ(ierr);
+	ierr = PetscPrintf(PETSC_COMM_WORLD, "\t- derivative order: %d\n",
+	                   ctx.order); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmVorticityCtxPrintf
+
+
 /*! Computes the gridlines for the vorticity in the z-direction.
  *
  * \param ux The grid for the x-velocity.
@@ -53,94 +123,281 @@ PetscErrorCode PetibmVorticityZComputeGrid(
 } // PetibmVorticityZComputeGrid
 
 
-/*! Computes the vorticity in the z-direction.
+/*! Gets the period of a direction from the cell-centered and face stations.
  *
- * First-order.
+ * The direction is periodic when the faces are as many as the cells (the
+ * face on the first boundary is not stored); the first boundary is then
+ * mirrored from the first cell center and the first face.
  *
+ * \param centers The cell-centered stations.
+ * \param faces The face stations.
+ * \param period The period, 0 if not periodic (passed by pointer).
+ */
+static PetscErrorCode PetibmVorticityGetPeriod(
+	const Vec centers, const Vec faces, PetscReal *period)
+{
+	PetscErrorCode ierr;
+	const PetscReal *c, *f;
+	PetscInt nc, nf;
+
+	PetscFunctionBeginUser;
+
+	*period = 0.0;
+	ierr = VecGetSize(centers, &nc); CHKERRQ(ierr);
+	ierr = VecGetSize(faces, &nf); CHKERRQ(ierr);
+	if (nc != nf)
+		PetscFunctionReturn(0);
+	ierr = VecGetArrayRead(centers, &c); CHKERRQ(ierr);
+	ierr = VecGetArrayRead(faces, &f); CHKERRQ(ierr);
+	*period = f[nf-1] - (2.0*c[0] - f[0]);
+	ierr = VecRestoreArrayRead(faces, &f); CHKERRQ(ierr);
+	ierr = VecRestoreArrayRead(centers, &c); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmVorticityGetPeriod
+
+
+/*! Creates the derivative operators of the vorticity in the z-direction.
+ *
+ * Along a periodic direction (as many faces as cells), the stencils wrap
+ * across the ends of the gridline.
+ *
+ * \param ctx The context (order of accuracy).
  * \param gridux The grid for the velocity in the x-direction.
  * \param griduy The grid for the velocity in the y-direction.
- * \param ux The velocity field in the x-direction.
- * \param uy The velocity field in the y-direction.
- * \param wz The vorticity field in the z-direction (passed by reference).
+ * \param gridwz The grid for the vorticity in the z-direction.
+ * \param dx The x-derivative of the y-velocity (passed by reference).
+ * \param dy The y-derivative of the x-velocity (passed by reference).
  */
-PetscErrorCode PetibmVorticityZComputeField(
-	PetibmGrid gridux, PetibmGrid griduy, PetibmField ux, PetibmField uy,
-	PetibmField &wz)
+PetscErrorCode PetibmVorticityZCreateOperators(
+	const PetibmVorticityCtx ctx, const PetibmGrid gridux,
+	const PetibmGrid griduy, const PetibmGrid gridwz,
+	PetibmDerivativeOperator &dx, PetibmDerivativeOperator &dy)
 {
 	PetscErrorCode ierr;
-	DMDALocalInfo info;
-	PetscInt i, j, k;
-	PetscReal *x_a, *y_a;
-	PetscReal dx, dy, du, dv;
+	PetscInt nx, ny;
+	PetscReal Lx, Ly;
 
 	PetscFunctionBeginUser;
 
-	ierr = PetibmFieldGlobalToLocal(ux); CHKERRQ(ierr);
-	ierr = PetibmFieldGlobalToLocal(uy); CHKERRQ(ierr);
+	ierr = VecGetSize(gridwz.x.coords, &nx); CHKERRQ(ierr);
+	ierr = VecGetSize(gridwz.y.coords, &ny); CHKERRQ(ierr);
+	ierr = PetibmVorticityGetPeriod(
+		griduy.x.coords, gridux.x.coords, &Lx); CHKERRQ(ierr);
+	ierr = PetibmVorticityGetPeriod(
+		gridux.y.coords, griduy.y.coords, &Ly); CHKERRQ(ierr);
+	ierr = PetibmDerivativeOperatorCreate(griduy.x.coords, nx, ctx.order,
+	                                      PETIBM_DERIVATIVE_BACKWARD, Lx,
+	                                      dx); CHKERRQ(ierr);
+	ierr = PetibmDerivativeOperatorCreate(gridux.y.coords, ny, ctx.order,
+	                                      PETIBM_DERIVATIVE_BACKWARD, Ly,
+	                                      dy); CHKERRQ(ierr);
 
-	ierr = DMDAGetLocalInfo(wz.da, &info); CHKERRQ(ierr);
+	PetscFunctionReturn(0);
+} // PetibmVorticityZCreateOperators
 
-	if (info.dim == 2)
-	{
-		PetscReal **wz_a, **ux_a, **uy_a;
-		ierr = DMDAVecGetArray(wz.da, wz.global, &wz_a); CHKERRQ(ierr);
-		ierr = DMDAVecGetArray(ux.da, ux.local, &ux_a); CHKERRQ(ierr);
-		ierr = DMDAVecGetArray(uy.da, uy.local, &uy_a); CHKERRQ(ierr);
-		ierr = VecGetArray(griduy.x.coords, &x_a); CHKERRQ(ierr);
-		ierr = VecGetArray(gridux.y.coords, &y_a); CHKERRQ(ierr);
-		for (j=info.ys; j<info.ys+info.ym; j++)
-		{
-			for (i=info.xs; i<info.xs+info.xm; i++)
-			{
-				dx = x_a[i] - x_a[i-1];
-				dy = y_a[j] - y_a[j-1];
-				du = ux_a[j][i] - ux_a[j-1][i];
-				dv = uy_a[j][i] - uy_a[j][i-1];
-				wz_a[j][i] = dv/dx - du/dy;
-			}
-		}
-		ierr = VecRestoreArray(griduy.x.coords, &x_a); CHKERRQ(ierr);
-		ierr = VecRestoreArray(gridux.y.coords, &y_a); CHKERRQ(ierr);
-		ierr = DMDAVecRestoreArray(ux.da, ux.local, &ux_a); CHKERRQ(ierr);
-		ierr = DMDAVecRestoreArray(uy.da, uy.local, &uy_a); CHKERRQ(ierr);
-		ierr = DMDAVecRestoreArray(wz.da, wz.global, &wz_a); CHKERRQ(ierr);
-	}
-	else if (info.dim == 3)
+
+/*! Checks that a field has the ghost points required by a derivative operator.
+ *
+ * \param op The derivative operator.
+ * \param field The field the operator is applied to.
+ */
+static PetscErrorCode PetibmVorticityCheckGhosts(
+	const PetibmDerivativeOperator op, const PetibmField field)
+{
+	PetscErrorCode ierr;
+	PetscInt s;
+
+	PetscFunctionBeginUser;
+
+	ierr = DMDAGetInfo(field.da, nullptr, nullptr, nullptr, nullptr, nullptr,
+	                   nullptr, nullptr, nullptr, &s, nullptr, nullptr,
+	                   nullptr, nullptr); CHKERRQ(ierr);
+	if (s < op.width/2)
+		SETERRQ2(PETSC_COMM_WORLD, PETSC_ERR_ARG_INCOMP,
+		         "The derivative of order %D needs a stencil width of %D",
+		         op.order, op.width/2);
+
+	PetscFunctionReturn(0);
+} // PetibmVorticityCheckGhosts
+
+
+/*! Computes the vorticity in the z-direction on the slab of a thread.
+ *
+ * The slab is traversed by tiles of `tile_k` planes and `tile_j` rows, so the
+ * rows of the x-velocity below j are still in cache when reused.
+ *
+ * \param ctx The context (tile sizes).
+ * \param info Local information of the DMDA of the vorticity.
+ * \param dx The x-derivative of the y-velocity (W points).
+ * \param dy The y-derivative of the x-velocity (W points).
+ * \param ux The values of the velocity in the x-direction (with ghosts).
+ * \param uy The values of the velocity in the y-direction (with ghosts).
+ * \param wz The values of the vorticity in the z-direction (passed by reference).
+ * \param t Index of the thread.
+ * \param n Number of threads.
+ */
+template <PetscInt dim, typename A, PetscInt W>
+static void PetibmVorticityZKernel(
+	const PetibmVorticityCtx &ctx, const DMDALocalInfo &info,
+	const PetibmDerivativeOperator &dx, const PetibmDerivativeOperator &dy,
+	const A &ux, const A &uy, A &wz, const PetscInt t, const PetscInt n)
+{
+	typedef typename A::value_type T;
+	PetscInt i, j, k, s, jj, kk, je, ke;
+	PetscInt ys = info.ys, ye = info.ys+info.ym,
+	         zs = info.zs, ze = info.zs+info.zm;
+	const PetscReal *cx, *cy;
+	T *w, dv, du;
+	const T *u[W], *v;
+
+	// static slabs along the slowest dimension (z in 3D, y in 2D)
+	if (dim == 3)
+		PetibmThreadsGetSlab(info.zs, info.zs+info.zm, t, n, &zs, &ze);
+	else
+		PetibmThreadsGetSlab(info.ys, info.ys+info.ym, t, n, &ys, &ye);
+	const PetscInt tj = (ctx.tile_j > 0) ? ctx.tile_j : ye - ys,
+	               tk = (ctx.tile_k > 0 and dim == 3) ? ctx.tile_k : ze - zs;
+	for (kk=zs; kk<ze; kk+=tk)
 	{
-		PetscReal ***wz_a, ***ux_a, ***uy_a;
-		ierr = DMDAVecGetArray(wz.da, wz.global, &wz_a); CHKERRQ(ierr);
-		ierr = DMDAVecGetArray(ux.da, ux.local, &ux_a); CHKERRQ(ierr);
-		ierr = DMDAVecGetArray(uy.da, uy.local, &uy_a); CHKERRQ(ierr);
-		ierr = VecGetArray(griduy.x.coords, &x_a); CHKERRQ(ierr);
-		ierr = VecGetArray(gridux.y.coords, &y_a); CHKERRQ(ierr);
-		for (k=info.zs; k<info.zs+info.zm; k++)
+		ke = PetscMin(kk+tk, ze);
+		for (jj=ys; jj<ye; jj+=tj)
 		{
-			for (j=info.ys; j<info.ys+info.ym; j++)
+			je = PetscMin(jj+tj, ye);
+			for (k=kk; k<ke; k++)
 			{
-				for (i=info.xs; i<info.xs+info.xm; i++)
+				for (j=jj; j<je; j++)
 				{
-					dx = x_a[i] - x_a[i-1];
-					dy = y_a[j] - y_a[j-1];
-					du = ux_a[k][j][i] - ux_a[k][j-1][i];
-					dv = uy_a[k][j][i] - uy_a[k][j][i-1];
-					wz_a[k][j][i] = dv/dx - du/dy;
+					cy = dy.Coeffs(j);
+					for (s=0; s<W; s++)
+						u[s] = ux.Row(k, j+dy.offset+s);
+					w = wz.Row(k, j);
+					v = uy.Row(k, j) + dx.offset;
+					cx = dx.coeffs;
+					for (i=info.xs; i<info.xs+info.xm; i++)
+					{
+						dv = du = 0.0;
+						for (s=0; s<W; s++)
+						{
+							dv += cx[i*W+s] * v[i+s];
+							du += cy[s] * u[s][i];
+						}
+						w[i] = dv - du;
+					}
 				}
 			}
 		}
-		ierr = VecRestoreArray(griduy.x.coords, &x_a); CHKERRQ(ierr);
-		ierr = VecRestoreArray(gridux.y.coords, &y_a); CHKERRQ(ierr);
-		ierr = DMDAVecRestoreArray(ux.da, ux.local, &ux_a); CHKERRQ(ierr);
-		ierr = DMDAVecRestoreArray(uy.da, uy.local, &uy_a); CHKERRQ(ierr);
-		ierr = DMDAVecRestoreArray(wz.da, wz.global, &wz_a); CHKERRQ(ierr);
 	}
-	else
+} // PetibmVorticityZKernel
+
+
+/*! Computes the vorticity in the z-direction with a given view of the values.
+ *
+ * \param ctx The context.
+ * \param dx The x-derivative of the y-velocity.
+ * \param dy The y-derivative of the x-velocity.
+ * \param ux The velocity field in the x-direction (local vector set).
+ * \param uy The velocity field in the y-direction (local vector set).
+ * \param wz The vorticity field in the z-direction (passed by reference).
+ */
+template <PetscInt dim, typename A>
+static PetscErrorCode PetibmVorticityZRun(
+	const PetibmVorticityCtx ctx,
+	const PetibmDerivativeOperator &dx, const PetibmDerivativeOperator &dy,
+	const PetibmField ux, const PetibmField uy, PetibmField &wz)
+{
+	PetscErrorCode ierr;
+	DMDALocalInfo info;
+	A ux_a, uy_a, wz_a;
+
+	PetscFunctionBeginUser;
+
+	ierr = DMDAGetLocalInfo(wz.da, &info); CHKERRQ(ierr);
+	ierr = PetibmArrayGet(wz.da, wz.global, wz_a); CHKERRQ(ierr);
+	ierr = PetibmArrayGet(ux.da, ux.local, ux_a); CHKERRQ(ierr);
+	ierr = PetibmArrayGet(uy.da, uy.local, uy_a); CHKERRQ(ierr);
+	ierr = PetibmThreadsRun([&](const PetscInt t, const PetscInt n)
+	{
+		if (dx.width == 4)
+			PetibmVorticityZKernel<dim, A, 4>(
+				ctx, info, dx, dy, ux_a, uy_a, wz_a, t, n);
+		else
+			PetibmVorticityZKernel<dim, A, 2>(
+				ctx, info, dx, dy, ux_a, uy_a, wz_a, t, n);
+	}); CHKERRQ(ierr);
+	ierr = PetibmArrayRestore(ux.da, ux.local, ux_a); CHKERRQ(ierr);
+	ierr = PetibmArrayRestore(uy.da, uy.local, uy_a); CHKERRQ(ierr);
+	ierr = PetibmArrayRestore(wz.da, wz.global, wz_a); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmVorticityZRun
+
+
+/*! Computes the vorticity in the z-direction.
+ *
+ * The points are split between the threads of the process.
+ *
+ * \param ctx The context (tile sizes and indexing path).
+ * \param dx The x-derivative of the y-velocity.
+ * \param dy The y-derivative of the x-velocity.
+ * \param ux The velocity field in the x-direction.
+ * \param uy The velocity field in the y-direction.
+ * \param wz The vorticity field in the z-direction (passed by reference).
+ */
+PetscErrorCode PetibmVorticityZComputeField(
+	const PetibmVorticityCtx ctx,
+	const PetibmDerivativeOperator dx, const PetibmDerivativeOperator dy,
+	PetibmField ux, PetibmField uy, PetibmField &wz)
+{
+	PetscErrorCode ierr;
+	PetscInt dim;
+
+	PetscFunctionBeginUser;
+
+	ierr = DMDAGetInfo(wz.da, &dim, nullptr, nullptr, nullptr, nullptr,
+	                   nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+	                   nullptr, nullptr); CHKERRQ(ierr);
+	if (dim != 2 and dim != 3)
 		SETERRQ(PETSC_COMM_WORLD, PETSC_ERR_SUP,
 		        "Function only supports 2D or 3D fields");
+	if (dx.width != dy.width)
+		SETERRQ(PETSC_COMM_WORLD, PETSC_ERR_ARG_INCOMP,
+		        "The derivative operators should have the same order");
+	ierr = PetibmVorticityCheckGhosts(dx, uy); CHKERRQ(ierr);
+	ierr = PetibmVorticityCheckGhosts(dy, ux); CHKERRQ(ierr);
+
+	ierr = PetibmFieldGetLocal(ux); CHKERRQ(ierr);
+	ierr = PetibmFieldGetLocal(uy); CHKERRQ(ierr);
+
+	if (dim == 2 and ctx.flat)
+	{
+		ierr = PetibmVorticityZRun<2, PetibmFlatArray<PetscReal>>(
+			ctx, dx, dy, ux, uy, wz); CHKERRQ(ierr);
+	}
+	else if (dim == 2)
+	{
+		ierr = PetibmVorticityZRun<2, PetibmArray<2, PetscReal>>(
+			ctx, dx, dy, ux, uy, wz); CHKERRQ(ierr);
+	}
+	else if (ctx.flat)
+	{
+		ierr = PetibmVorticityZRun<3, PetibmFlatArray<PetscReal>>(
+			ctx, dx, dy, ux, uy, wz); CHKERRQ(ierr);
+	}
+	else
+	{
+		ierr = PetibmVorticityZRun<3, PetibmArray<3, PetscReal>>(
+			ctx, dx, dy, ux, uy, wz); CHKERRQ(ierr);
+	}
+
+	ierr = PetibmFieldRestoreLocal(ux); CHKERRQ(ierr);
+	ierr = PetibmFieldRestoreLocal(uy); CHKERRQ(ierr);
 
 	PetscFunctionReturn(0);
 } // PetibmVorticityZComputeField
 
 
+
 /*! Computes the gridlines for the vorticity in the x-direction.
  *
  * \param uy The grid for the y-velocity.
@@ -190,61 +447,376 @@ PetscErrorCode PetibmVorticityXComputeGrid(
 } // PetibmVorticityXComputeGrid
 
 
-/*! Computes the vorticity in the x-direction.
+/*! Creates the derivative operators of the vorticity in the x-direction.
  *
- * First-order.
+ * Along a periodic direction (as many faces as cells), the stencils wrap
+ * across the ends of the gridline.
  *
+ * \param ctx The context (order of accuracy).
  * \param griduy The grid for the velocity in the y-direction.
  * \param griduz The grid for the velocity in the z-direction.
+ * \param gridwx The grid for the vorticity in the x-direction.
+ * \param dy The y-derivative of the z-velocity (passed by reference).
+ * \param dz The z-derivative of the y-velocity (passed by reference).
+ */
+PetscErrorCode PetibmVorticityXCreateOperators(
+	const PetibmVorticityCtx ctx, const PetibmGrid griduy,
+	const PetibmGrid griduz, const PetibmGrid gridwx,
+	PetibmDerivativeOperator &dy, PetibmDerivativeOperator &dz)
+{
+	PetscErrorCode ierr;
+	PetscInt ny, nz;
+	PetscReal Ly, Lz;
+
+	PetscFunctionBeginUser;
+
+	ierr = VecGetSize(gridwx.y.coords, &ny); CHKERRQ(ierr);
+	ierr = VecGetSize(gridwx.z.coords, &nz); CHKERRQ(ierr);
+	ierr = PetibmVorticityGetPeriod(
+		griduz.y.coords, griduy.y.coords, &Ly); CHKERRQ(ierr);
+	ierr = PetibmVorticityGetPeriod(
+		griduy.z.coords, griduz.z.coords, &Lz); CHKERRQ(ierr);
+	ierr = PetibmDerivativeOperatorCreate(griduz.y.coords, ny, ctx.order,
+	                                      PETIBM_DERIVATIVE_BACKWARD, Ly,
+	                                      dy); CHKERRQ(ierr);
+	ierr = PetibmDerivativeOperatorCreate(griduy.z.coords, nz, ctx.order,
+	                                      PETIBM_DERIVATIVE_BACKWARD, Lz,
+	                                      dz); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmVorticityXCreateOperators
+
+
+/*! Computes the vorticity in the x-direction on the slab of a thread.
+ *
+ * The slab is traversed by tiles of `tile_k` planes and `tile_j` rows, so the
+ * rows of the planes of the y-velocity below k are still in cache when reused.
+ *
+ * \param ctx The context (tile sizes).
+ * \param info Local information of the DMDA of the vorticity.
+ * \param dy The y-derivative of the z-velocity (W points).
+ * \param dz The z-derivative of the y-velocity (W points).
+ * \param uy The values of the velocity in the y-direction (with ghosts).
+ * \param uz The values of the velocity in the z-direction (with ghosts).
+ * \param wx The values of the vorticity in the x-direction (passed by reference).
+ * \param t Index of the thread.
+ * \param n Number of threads.
+ */
+template <typename A, PetscInt W>
+static void PetibmVorticityXKernel(
+	const PetibmVorticityCtx &ctx, const DMDALocalInfo &info,
+	const PetibmDerivativeOperator &dy, const PetibmDerivativeOperator &dz,
+	const A &uy, const A &uz, A &wx, const PetscInt t, const PetscInt n)
+{
+	typedef typename A::value_type T;
+	PetscInt i, j, k, s, jj, kk, je, ke, zs, ze;
+	const PetscInt ys = info.ys, ye = info.ys+info.ym;
+	const PetscReal *cy, *cz;
+	T *w, dw, dv;
+	const T *v[W], *u[W];
+
+	// static slabs along the z-direction
+	PetibmThreadsGetSlab(info.zs, info.zs+info.zm, t, n, &zs, &ze);
+	const PetscInt tj = (ctx.tile_j > 0) ? ctx.tile_j : ye - ys,
+	               tk = (ctx.tile_k > 0) ? ctx.tile_k : ze - zs;
+	for (kk=zs; kk<ze; kk+=tk)
+	{
+		ke = PetscMin(kk+tk, ze);
+		for (jj=ys; jj<ye; jj+=tj)
+		{
+			je = PetscMin(jj+tj, ye);
+			for (k=kk; k<ke; k++)
+			{
+				cz = dz.Coeffs(k);
+				for (j=jj; j<je; j++)
+				{
+					cy = dy.Coeffs(j);
+					for (s=0; s<W; s++)
+					{
+						u[s] = uz.Row(k, j+dy.offset+s);
+						v[s] = uy.Row(k+dz.offset+s, j);
+					}
+					w = wx.Row(k, j);
+					for (i=info.xs; i<info.xs+info.xm; i++)
+					{
+						dw = dv = 0.0;
+						for (s=0; s<W; s++)
+						{
+							dw += cy[s] * u[s][i];
+							dv += cz[s] * v[s][i];
+						}
+						w[i] = dw - dv;
+					}
+				}
+			}
+		}
+	}
+} // PetibmVorticityXKernel
+
+
+/*! Computes the vorticity in the x-direction with a given view of the values.
+ *
+ * \param ctx The context.
+ * \param dy The y-derivative of the z-velocity.
+ * \param dz The z-derivative of the y-velocity.
+ * \param uy The velocity field in the y-direction (local vector set).
+ * \param uz The velocity field in the z-direction (local vector set).
+ * \param wx The vorticity field in the x-direction (passed by reference).
+ */
+template <typename A>
+static PetscErrorCode PetibmVorticityXRun(
+	const PetibmVorticityCtx ctx,
+	const PetibmDerivativeOperator &dy, const PetibmDerivativeOperator &dz,
+	const PetibmField uy, const PetibmField uz, PetibmField &wx)
+{
+	PetscErrorCode ierr;
+	DMDALocalInfo info;
+	A uy_a, uz_a, wx_a;
+
+	PetscFunctionBeginUser;
+
+	ierr = DMDAGetLocalInfo(wx.da, &info); CHKERRQ(ierr);
+	ierr = PetibmArrayGet(wx.da, wx.global, wx_a); CHKERRQ(ierr);
+	ierr = PetibmArrayGet(uy.da, uy.local, uy_a); CHKERRQ(ierr);
+	ierr = PetibmArrayGet(uz.da, uz.local, uz_a); CHKERRQ(ierr);
+	ierr = PetibmThreadsRun([&](const PetscInt t, const PetscInt n)
+	{
+		if (dy.width == 4)
+			PetibmVorticityXKernel<A, 4>(
+				ctx, info, dy, dz, uy_a, uz_a, wx_a, t, n);
+		else
+			PetibmVorticityXKernel<A, 2>(
+				ctx, info, dy, dz, uy_a, uz_a, wx_a, t, n);
+	}); CHKERRQ(ierr);
+	ierr = PetibmArrayRestore(uy.da, uy.local, uy_a); CHKERRQ(ierr);
+	ierr = PetibmArrayRestore(uz.da, uz.local, uz_a); CHKERRQ(ierr);
+	ierr = PetibmArrayRestore(wx.da, wx.global, wx_a); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmVorticityXRun
+
+
+/*! Computes the vorticity in the x-direction.
+ *
+ * The points are split between the threads of the process.
+ *
+ * \param ctx The context (tile sizes and indexing path).
+ * \param dy The y-derivative of the z-velocity.
+ * \param dz The z-derivative of the y-velocity.
  * \param uy The velocity field in the y-direction.
  * \param uz The velocity field in the z-direction.
  * \param wx The vorticity field in the x-direction (passed by reference).
  */
 PetscErrorCode PetibmVorticityXComputeField(
-	PetibmGrid griduy, PetibmGrid griduz, PetibmField uy, PetibmField uz,
-	PetibmField &wx)
+	const PetibmVorticityCtx ctx,
+	const PetibmDerivativeOperator dy, const PetibmDerivativeOperator dz,
+	PetibmField uy, PetibmField uz, PetibmField &wx)
 {
 	PetscErrorCode ierr;
-	DMDALocalInfo info;
-	PetscInt i, j, k;
-	PetscReal ***wx_a, ***uy_a, ***uz_a;
-	PetscReal *y_a, *z_a;
-	PetscReal dy, dz, dv, dw;
+	PetscInt dim;
 
 	PetscFunctionBeginUser;
 
-	ierr = DMDAGetLocalInfo(wx.da, &info); CHKERRQ(ierr);
-	if (info.dim != 3)
+	ierr = DMDAGetInfo(wx.da, &dim, nullptr, nullptr, nullptr, nullptr,
+	                   nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+	                   nullptr, nullptr); CHKERRQ(ierr);
+	if (dim != 3)
 		SETERRQ(PETSC_COMM_WORLD, PETSC_ERR_SUP,
 		        "Function only supports 3D fields");
+	if (dy.width != dz.width)
+		SETERRQ(PETSC_COMM_WORLD, PETSC_ERR_ARG_INCOMP,
+		        "The derivative operators should have the same order");
+	ierr = PetibmVorticityCheckGhosts(dy, uz); CHKERRQ(ierr);
+	ierr = PetibmVorticityCheckGhosts(dz, uy); CHKERRQ(ierr);
+
+	ierr = PetibmFieldGetLocal(uy); CHKERRQ(ierr);
+	ierr = PetibmFieldGetLocal(uz); CHKERRQ(ierr);
+
+	if (ctx.flat)
+	{
+		ierr = PetibmVorticityXRun<PetibmFlatArray<PetscReal>>(
+			ctx, dy, dz, uy, uz, wx); CHKERRQ(ierr);
+	}
+	else
+	{
+		ierr = PetibmVorticityXRun<PetibmArray<3, PetscReal>>(
+			ctx, dy, dz, uy, uz, wx); CHKERRQ(ierr);
+	}
+
+	ierr = PetibmFieldRestoreLocal(uy); CHKERRQ(ierr);
+	ierr = PetibmFieldRestoreLocal(uz); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmVorticityXComputeField
+
+
+/*! Reads the cell-centered and staggered gridlines of the 3D velocity.
+ *
+ * The grid of a velocity component has one station less along its direction
+ * if the direction is not periodic (the boundary face is not stored).
+ *
+ * \param filepath The path of the grid file.
+ * \param ctx The sizes of the cell-centered grid.
+ * \param fieldCtx The periodicity of the field.
+ * \param grid The cell-centered grid (passed by reference).
+ * \param gridux The grid of the x-velocity (passed by reference).
+ * \param griduy The grid of the y-velocity (passed by reference).
+ * \param griduz The grid of the z-velocity (passed by reference).
+ */
+PetscErrorCode PetibmVorticityReadGrids(
+	const std::string filepath, const PetibmGridCtx ctx,
+	const PetibmFieldCtx fieldCtx, PetibmGrid &grid, PetibmGrid &gridux,
+	PetibmGrid &griduy, PetibmGrid &griduz)
+{
+	PetscErrorCode ierr;
+	const PetscBool periodic[3] = {fieldCtx.periodic_x, fieldCtx.periodic_y,
+	                               fieldCtx.periodic_z};
+	const char *names[3] = {"u", "v", "w"};
+	PetibmGrid *grids[3] = {&gridux, &griduy, &griduz};
+	PetscInt d;
 
-	ierr = PetibmFieldGlobalToLocal(uy); CHKERRQ(ierr);
-	ierr = PetibmFieldGlobalToLocal(uz); CHKERRQ(ierr);
+	PetscFunctionBeginUser;
 
-	ierr = DMDAVecGetArray(wx.da, wx.global, &wx_a); CHKERRQ(ierr);
-	ierr = DMDAVecGetArray(uy.da, uy.local, &uy_a); CHKERRQ(ierr);
-	ierr = DMDAVecGetArray(uz.da, uz.local, &uz_a); CHKERRQ(ierr);
-	ierr = VecGetArray(griduz.y.coords, &y_a); CHKERRQ(ierr);
-	ierr = VecGetArray(griduy.z.coords, &z_a); CHKERRQ(ierr);
-	for (k=info.zs; k<info.zs+info.zm; k++)
+	// read cell-centered gridline stations
+	grid.dim = 3;
+	ierr = PetibmGridlineHDF5ReadShared(
+		filepath, "p", "x", ctx.nx, &grid.x.coords); CHKERRQ(ierr);
+	ierr = PetibmGridlineHDF5ReadShared(
+		filepath, "p", "y", ctx.ny, &grid.y.coords); CHKERRQ(ierr);
+	ierr = PetibmGridlineHDF5ReadShared(
+		filepath, "p", "z", ctx.nz, &grid.z.coords); CHKERRQ(ierr);
+	// read staggered gridline stations for each velocity component
+	for (d=0; d<3; d++)
 	{
-		for (j=info.ys; j<info.ys+info.ym; j++)
+		PetibmGrid &g = *grids[d];
+		g.dim = 3;
+		ierr = PetibmGridlineHDF5ReadShared(
+			filepath, names[d], "x", (d == 0 and !periodic[0]) ? ctx.nx-1 : ctx.nx,
+			&g.x.coords); CHKERRQ(ierr);
+		ierr = PetibmGridlineHDF5ReadShared(
+			filepath, names[d], "y", (d == 1 and !periodic[1]) ? ctx.ny-1 : ctx.ny,
+			&g.y.coords); CHKERRQ(ierr);
+		ierr = PetibmGridlineHDF5ReadShared(
+			filepath, names[d], "z", (d == 2 and !periodic[2]) ? ctx.nz-1 : ctx.nz,
+			&g.z.coords); CHKERRQ(ierr);
+	}
+
+	PetscFunctionReturn(0);
+} // PetibmVorticityReadGrids
+
+
+/*! Creates the cell-centered 3D DMDA object (star stencil of width 1).
+ *
+ * \param ctx The sizes of the cell-centered grid.
+ * \param fieldCtx The periodicity of the field.
+ * \param da The DMDA object to create (passed by pointer).
+ */
+PetscErrorCode PetibmVorticityCreateDM(
+	const PetibmGridCtx ctx, const PetibmFieldCtx fieldCtx, DM *da)
+{
+	PetscErrorCode ierr;
+	DMBoundaryType bType_x, bType_y, bType_z;
+
+	PetscFunctionBeginUser;
+
+	bType_x = (fieldCtx.periodic_x) ? DM_BOUNDARY_PERIODIC : DM_BOUNDARY_GHOSTED;
+	bType_y = (fieldCtx.periodic_y) ? DM_BOUNDARY_PERIODIC : DM_BOUNDARY_GHOSTED;
+	bType_z = (fieldCtx.periodic_z) ? DM_BOUNDARY_PERIODIC : DM_BOUNDARY_GHOSTED;
+	ierr = DMDACreate3d(PETSC_COMM_WORLD,
+	                    bType_x, bType_y, bType_z,
+	                    DMDA_STENCIL_STAR,
+	                    ctx.nx, ctx.ny, ctx.nz,
+	                    PETSC_DECIDE, PETSC_DECIDE, PETSC_DECIDE,
+	                    1, 1, nullptr, nullptr, nullptr,
+	                    da); CHKERRQ(ierr);
+	ierr = DMSetFromOptions(*da); CHKERRQ(ierr);
+	ierr = DMSetUp(*da); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmVorticityCreateDM
+
+
+/*! Creates a 3D DMDA object staggered from the cell-centered one.
+ *
+ * The staggered DMDA has the processes and the ownership ranges of the
+ * cell-centered one, except along the flagged directions where it has one
+ * point less, removed from the last process.
+ *
+ * \param da The cell-centered DMDA object.
+ * \param less Directions with one point less.
+ * \param stencil The stencil type.
+ * \param s The stencil width.
+ * \param sda The staggered DMDA object to create (passed by pointer).
+ */
+PetscErrorCode PetibmVorticityCreateStaggeredDM(
+	const DM da, const PetscBool less[3], const DMDAStencilType stencil,
+	const PetscInt s, DM *sda)
+{
+	PetscErrorCode ierr;
+	const PetscInt *pl[3];
+	PetscInt *l[3], sizes[3], procs[3], d;
+	DMBoundaryType bType[3];
+
+	PetscFunctionBeginUser;
+
+	ierr = DMDAGetInfo(da, nullptr, sizes, sizes+1, sizes+2,
+	                   procs, procs+1, procs+2, nullptr, nullptr,
+	                   bType, bType+1, bType+2, nullptr); CHKERRQ(ierr);
+	ierr = DMDAGetOwnershipRanges(da, pl, pl+1, pl+2); CHKERRQ(ierr);
+	for (d=0; d<3; d++)
+	{
+		ierr = PetscMalloc(procs[d]*sizeof(*l[d]), l+d); CHKERRQ(ierr);
+		ierr = PetscMemcpy(l[d], pl[d], procs[d]*sizeof(*l[d])); CHKERRQ(ierr);
+		if (less[d])
 		{
-			for (i=info.xs; i<info.xs+info.xm; i++)
-			{
-				dy = y_a[j] - y_a[j-1];
-				dz = z_a[k] - z_a[k-1];
-				dv = uy_a[k][j][i] - uy_a[k][j][i-1];
-				dw = uz_a[k][j][i] - uz_a[k-1][j][i];
-				wx_a[k][j][i] = dw/dy - dv/dz;
-			}
+			l[d][procs[d]-1]--;
+			sizes[d]--;
 		}
 	}
-	ierr = VecRestoreArray(griduz.y.coords, &y_a); CHKERRQ(ierr);
-	ierr = VecRestoreArray(griduy.z.coords, &z_a); CHKERRQ(ierr);
-	ierr = DMDAVecRestoreArray(uy.da, uy.local, &uy_a); CHKERRQ(ierr);
-	ierr = DMDAVecRestoreArray(uz.da, uz.local, &uz_a); CHKERRQ(ierr);
-	ierr = DMDAVecRestoreArray(wx.da, wx.global, &wx_a); CHKERRQ(ierr);
+	ierr = DMDACreate3d(PETSC_COMM_WORLD,
+	                    bType[0], bType[1], bType[2],
+	                    stencil,
+	                    sizes[0], sizes[1], sizes[2],
+	                    procs[0], procs[1], procs[2], 1, s, l[0], l[1], l[2],
+	                    sda); CHKERRQ(ierr);
+	ierr = DMSetFromOptions(*sda); CHKERRQ(ierr);
+	ierr = DMSetUp(*sda); CHKERRQ(ierr);
+	for (d=0; d<3; d++)
+	{
+		ierr = PetscFree(l[d]); CHKERRQ(ierr);
+	}
 
 	PetscFunctionReturn(0);
-} // PetibmVorticityXComputeField
+} // PetibmVorticityCreateStaggeredDM
+
+
+/*! Creates the 3D DMDA object of a velocity component.
+ *
+ * The component is staggered in its direction: if the direction is not
+ * periodic, the last face (on the boundary) is not stored.
+ *
+ * \param da The cell-centered DMDA object.
+ * \param d The direction of the component.
+ * \param stencil The stencil type.
+ * \param s The stencil width.
+ * \param dau The DMDA object to create (passed by pointer).
+ */
+PetscErrorCode PetibmVorticityCreateVelocityDM(
+	const DM da, const PetscInt d, const DMDAStencilType stencil,
+	const PetscInt s, DM *dau)
+{
+	PetscErrorCode ierr;
+	DMBoundaryType bType[3];
+	PetscBool less[3] = {PETSC_FALSE, PETSC_FALSE, PETSC_FALSE};
+
+	PetscFunctionBeginUser;
+
+	ierr = DMDAGetInfo(da, nullptr, nullptr, nullptr, nullptr,
+	                   nullptr, nullptr, nullptr, nullptr, nullptr,
+	                   bType, bType+1, bType+2, nullptr); CHKERRQ(ierr);
+	less[d] = (PetscBool) (bType[d] != DM_BOUNDARY_PERIODIC);
+	ierr = PetibmVorticityCreateStaggeredDM(
+		da, less, stencil, s, dau); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmVorticityCreateVelocityDM
@@ -0,0 +1,246 @@
+/*! Implementation of the functions to write rectilinear VTK files.
+ * \file vtk.cpp
+ */
+
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include "petibm-utilities/vtk.h"
+
+
+/*! Formats an extent (six indices) for a VTK attribute.
+ *
+ * \param ext The extent (first and last index in each direction).
+ */
+static std::string PetibmVTKExtent(const PetscInt ext[])
+{
+	std::ostringstream ss;
+
+	ss << ext[0] << " " << ext[1] << " " << ext[2] << " "
+	   << ext[3] << " " << ext[4] << " " << ext[5];
+
+	return ss.str();
+} // PetibmVTKExtent
+
+
+/*! Appends a block of raw binary data (size, then values) to a VTK file.
+ *
+ * \param outfile The output stream (passed by reference).
+ * \param values The values.
+ */
+static void PetibmVTKWriteBlock(
+	std::ofstream &outfile, const std::vector<PetscReal> &values)
+{
+	uint64_t nbytes = values.size() * sizeof(PetscReal);
+
+	outfile.write((const char *) &nbytes, sizeof(nbytes));
+	outfile.write((const char *) values.data(), nbytes);
+} // PetibmVTKWriteBlock
+
+
+/*! Writes the piece of the process and the index of the pieces.
+ *
+ * \param filepath Path of the output files, without extension.
+ * \param name Name of the field.
+ * \param grid The grid (passed by reference).
+ * \param field The field (nullptr to write the grid only).
+ */
+static PetscErrorCode PetibmVTKWrite(
+	const std::string filepath, const std::string name,
+	PetibmGrid &grid, PetibmField *field)
+{
+	PetscErrorCode ierr;
+	const PetibmGridline *lines[3] = {&grid.x, &grid.y, &grid.z};
+	const char *dirs[3] = {"x", "y", "z"};
+	const int one = 1;
+	const std::string type = (sizeof(PetscReal) == 8) ? "Float64" : "Float32",
+	                  order = (*(const char *) &one) ? "LittleEndian"
+	                                                 : "BigEndian",
+	                  base = filepath.substr(filepath.find_last_of('/') + 1);
+	std::vector<PetscReal> coords[3], values;
+	std::vector<PetscInt> extents;
+	DMDALocalInfo info;
+	PetscInt ext[6] = {0, 0, 0, 0, 0, 0}, whole[6] = {0, 0, 0, 0, 0, 0},
+	         d, i, j, k;
+	PetscReal *x, **v2, ***v3;
+	uint64_t offset = 0;
+	PetscMPIInt rank, size, r;
+
+	PetscFunctionBeginUser;
+
+	ierr = MPI_Comm_rank(PETSC_COMM_WORLD, &rank); CHKERRQ(ierr);
+	ierr = MPI_Comm_size(PETSC_COMM_WORLD, &size); CHKERRQ(ierr);
+
+	// stations of the piece: owned stations and one ghost station above
+	ierr = PetibmGridGlobalToLocal(grid); CHKERRQ(ierr);
+	coords[2].assign(1, 0.0);
+	for (d=0; d<grid.dim; d++)
+	{
+		ierr = DMDAGetLocalInfo(lines[d]->da, &info); CHKERRQ(ierr);
+		ext[2*d] = info.xs;
+		ext[2*d+1] = PetscMin(info.xs + info.xm, info.mx - 1);
+		whole[2*d+1] = info.mx - 1;
+		ierr = DMDAVecGetArray(lines[d]->da, lines[d]->local, &x); CHKERRQ(ierr);
+		coords[d].assign(x + ext[2*d], x + ext[2*d+1] + 1);
+		ierr = DMDAVecRestoreArray(
+			lines[d]->da, lines[d]->local, &x); CHKERRQ(ierr);
+	}
+
+	// field values of the piece, x-direction running fastest
+	if (field != nullptr)
+	{
+		ierr = PetibmFieldGetLocal(*field); CHKERRQ(ierr);
+		values.reserve(coords[0].size() * coords[1].size() * coords[2].size());
+		if (grid.dim == 3)
+		{
+			ierr = DMDAVecGetArray(field->da, field->local, &v3); CHKERRQ(ierr);
+			for (k=ext[4]; k<=ext[5]; k++)
+				for (j=ext[2]; j<=ext[3]; j++)
+					for (i=ext[0]; i<=ext[1]; i++)
+						values.push_back(v3[k][j][i]);
+			ierr = DMDAVecRestoreArray(field->da, field->local, &v3); CHKERRQ(ierr);
+		}
+		else
+		{
+			ierr = DMDAVecGetArray(field->da, field->local, &v2); CHKERRQ(ierr);
+			for (j=ext[2]; j<=ext[3]; j++)
+				for (i=ext[0]; i<=ext[1]; i++)
+					values.push_back(v2[j][i]);
+			ierr = DMDAVecRestoreArray(field->da, field->local, &v2); CHKERRQ(ierr);
+		}
+		ierr = PetibmFieldRestoreLocal(*field); CHKERRQ(ierr);
+	}
+
+	// piece of the process: XML header, then appended raw data
+	{
+		std::ostringstream ss;
+		ss << filepath << "_" << rank << ".vtr";
+		std::ofstream outfile(ss.str().c_str(), std::ios::binary);
+		if (!outfile.good())
+			SETERRQ(PETSC_COMM_SELF, PETSC_ERR_FILE_OPEN,
+			        "Cannot open the VTK piece file");
+		outfile << "<?xml version=\"1.0\"?>\n"
+		        << "<VTKFile type=\"RectilinearGrid\" version=\"1.0\" "
+		        << "byte_order=\"" << order << "\" header_type=\"UInt64\">\n"
+		        << "  <RectilinearGrid WholeExtent=\""
+		        << PetibmVTKExtent(whole) << "\">\n"
+		        << "    <Piece Extent=\"" << PetibmVTKExtent(ext) << "\">\n";
+		if (field != nullptr)
+		{
+			outfile << "      <PointData Scalars=\"" << name << "\">\n"
+			        << "        <DataArray type=\"" << type << "\" Name=\""
+			        << name << "\" format=\"appended\" offset=\"" << offset
+			        << "\"/>\n"
+			        << "      </PointData>\n";
+			offset += sizeof(uint64_t) + values.size() * sizeof(PetscReal);
+		}
+		outfile << "      <Coordinates>\n";
+		for (d=0; d<3; d++)
+		{
+			outfile << "        <DataArray type=\"" << type << "\" Name=\""
+			        << dirs[d] << "\" format=\"appended\" offset=\"" << offset
+			        << "\"/>\n";
+			offset += sizeof(uint64_t) + coords[d].size() * sizeof(PetscReal);
+		}
+		outfile << "      </Coordinates>\n"
+		        << "    </Piece>\n"
+		        << "  </RectilinearGrid>\n"
+		        << "  <AppendedData encoding=\"raw\">\n_";
+		if (field != nullptr)
+			PetibmVTKWriteBlock(outfile, values);
+		for (d=0; d<3; d++)
+			PetibmVTKWriteBlock(outfile, coords[d]);
+		outfile << "\n  </AppendedData>\n"
+		        << "</VTKFile>\n";
+		if (!outfile.good())
+			SETERRQ(PETSC_COMM_SELF, PETSC_ERR_FILE_WRITE,
+			        "Cannot write the VTK piece file");
+	}
+
+	// index of the pieces written by rank 0
+	if (rank == 0)
+		extents.resize(6*size);
+	ierr = MPI_Gather(ext, 6, MPIU_INT, extents.data(), 6, MPIU_INT,
+	                  0, PETSC_COMM_WORLD); CHKERRQ(ierr);
+	if (rank != 0)
+		PetscFunctionReturn(0);
+	std::ofstream outfile((filepath+".pvtr").c_str());
+	if (!outfile.good())
+		SETERRQ(PETSC_COMM_SELF, PETSC_ERR_FILE_OPEN,
+		        "Cannot open the VTK index file");
+	outfile << "<?xml version=\"1.0\"?>\n"
+	        << "<VTKFile type=\"PRectilinearGrid\" version=\"1.0\" "
+	        << "byte_order=\"" << order << "\" header_type=\"UInt64\">\n"
+	        << "  <PRectilinearGrid WholeExtent=\"" << PetibmVTKExtent(whole)
+	        << "\" GhostLevel=\"0\">\n";
+	if (field != nullptr)
+		outfile << "    <PPointData Scalars=\"" << name << "\">\n"
+		        << "      <PDataArray type=\"" << type << "\" Name=\""
+		        << name << "\"/>\n"
+		        << "    </PPointData>\n";
+	outfile << "    <PCoordinates>\n";
+	for (d=0; d<3; d++)
+		outfile << "      <PDataArray type=\"" << type << "\" Name=\""
+		        << dirs[d] << "\"/>\n";
+	outfile << "    </PCoordinates>\n";
+	for (r=0; r<size; r++)
+		outfile << "    <Piece Extent=\"" << PetibmVTKExtent(&extents[6*r])
+		        << "\" Source=\"" << base << "_" << r << ".vtr\"/>\n";
+	outfile << "  </PRectilinearGrid>\n"
+	        << "</VTKFile>\n";
+
+	PetscFunctionReturn(0);
+} // PetibmVTKWrite
+
+
+/*! Writes the gridlines into parallel rectilinear VTK files.
+ *
+ * Collective; each process writes the piece `<filepath>_<rank>.vtr` with the
+ * stations of its part of the grid (raw binary appended data), and rank 0
+ * writes the index `<filepath>.pvtr`.
+ * The gridlines should be distributed (PetibmGridInitialize).
+ *
+ * \param filepath Path of the output files, without extension.
+ * \param grid The grid (passed by reference).
+ */
+PetscErrorCode PetibmGridVTKWrite(
+	const std::string filepath, PetibmGrid &grid)
+{
+	PetscErrorCode ierr;
+
+	PetscFunctionBeginUser;
+
+	ierr = PetibmVTKWrite(filepath, "", grid, nullptr); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmGridVTKWrite
+
+
+/*! Writes a field into parallel rectilinear VTK files.
+ *
+ * Collective; each process writes the piece `<filepath>_<rank>.vtr` with the
+ * stations and the field values of its local DMDA box (raw binary appended
+ * data), and rank 0 writes the index `<filepath>.pvtr`.
+ * Neighboring pieces share one layer of points, taken from the ghost values,
+ * so that the pieces tile the domain without gaps.
+ * The gridlines should be distributed with the layout of the field.
+ *
+ * \param filepath Path of the output files, without extension.
+ * \param name Name of the field.
+ * \param grid The grid of the field (passed by reference).
+ * \param field The field (passed by reference).
+ */
+PetscErrorCode PetibmFieldVTKWrite(
+	const std::string filepath, const std::string name,
+	PetibmGrid &grid, PetibmField &field)
+{
+	PetscErrorCode ierr;
+
+	PetscFunctionBeginUser;
+
+	ierr = PetibmVTKWrite(filepath, name, grid, &field); CHKERRQ(ierr);
+
+	PetscFunctionReturn(0);
+} // PetibmFieldVTKWrite